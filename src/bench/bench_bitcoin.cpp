@@ -4,7 +4,10 @@
 
 #include <bench/bench.h>
 #include <common/args.h>
+#include <crypto/chacha20.h>
+#include <crypto/poly1305.h>
 #include <crypto/sha256.h>
+#include <crypto/sha3.h>
 #include <tinyformat.h>
 #include <util/fs.h>
 #include <util/string.h>
@@ -79,6 +82,9 @@ int main(int argc, char** argv)
     ArgsManager argsman;
     SetupBenchArgs(argsman);
     SHA256AutoDetect();
+    SHA3AutoDetect();
+    ChaCha20AutoDetect();
+    Poly1305AutoDetect();
     std::string error;
     if (!argsman.ParseParameters(argc, argv, error)) {
         tfm::format(std::cerr, "Error parsing command line arguments: %s\n", error);
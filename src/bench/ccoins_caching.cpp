@@ -8,11 +8,15 @@
 #include <key.h>
 #include <policy/policy.h>
 #include <primitives/transaction.h>
+#include <random.h>
 #include <script/script.h>
 #include <script/signingprovider.h>
 #include <test/util/transaction_utils.h>
 
+#include <algorithm>
 #include <cassert>
+#include <ostream>
+#include <string>
 #include <vector>
 
 // Microbenchmark for simple accesses to a CCoinsViewCache database. Note from
@@ -54,4 +58,37 @@ static void CCoinsCaching(benchmark::Bench& bench)
     });
 }
 
+// Random lookups in a cache holding many coins with Dilithium-sized P2PK
+// scripts, which is the access pattern of ConnectBlock on a warm dbcache. Also
+// reports the memory each coin takes, as counted against -dbcache.
+static void CCoinsCachingDilithiumLookup(benchmark::Bench& bench)
+{
+    constexpr size_t NUM_COINS{20'000};
+    FastRandomContext rng{/*fDeterministic=*/true};
+    CCoinsView coins_dummy;
+    CCoinsViewCache coins(&coins_dummy, /*deterministic=*/true);
+
+    const CScript script{CScript() << std::vector<unsigned char>(DILITHIUM_PUBLICKEY_SIZE, 0x02) << OP_CHECKSIG};
+    std::vector<COutPoint> outpoints;
+    outpoints.reserve(NUM_COINS);
+    for (size_t i = 0; i < NUM_COINS; ++i) {
+        const COutPoint outpoint{Txid::FromUint256(rng.rand256()), static_cast<uint32_t>(rng.randrange(4))};
+        coins.AddCoin(outpoint, Coin{CTxOut{COIN, script}, /*nHeightIn=*/1, /*fCoinBaseIn=*/false}, /*possible_overwrite=*/false);
+        outpoints.push_back(outpoint);
+    }
+    std::shuffle(outpoints.begin(), outpoints.end(), rng);
+
+    bench.batch(outpoints.size()).unit("lookup").run([&] {
+        for (const auto& outpoint : outpoints) {
+            const bool unspent{!coins.AccessCoin(outpoint).IsSpent()};
+            assert(unspent);
+        }
+    });
+
+    const std::string bytes_per_coin{std::to_string(coins.DynamicMemoryUsage() / coins.GetCacheSize())};
+    bench.context("bytes_per_coin", bytes_per_coin);
+    if (bench.output()) *bench.output() << "CCoinsCachingDilithiumLookup: " << bytes_per_coin << " bytes per coin" << std::endl;
+}
+
 BENCHMARK(CCoinsCaching, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CCoinsCachingDilithiumLookup, benchmark::PriorityLevel::HIGH);
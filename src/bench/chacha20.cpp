@@ -7,6 +7,7 @@
 #include <crypto/chacha20.h>
 #include <crypto/chacha20poly1305.h>
 #include <span.h>
+#include <tinyformat.h>
 
 #include <cstddef>
 #include <cstdint>
@@ -15,7 +16,10 @@
 /* Number of bytes to process per iteration */
 static const uint64_t BUFFER_SIZE_TINY  = 64;
 static const uint64_t BUFFER_SIZE_SMALL = 256;
+static const uint64_t BUFFER_SIZE_1KB   = 1024;
+static const uint64_t BUFFER_SIZE_64KB  = 64*1024;
 static const uint64_t BUFFER_SIZE_LARGE = 1024*1024;
+static const uint64_t BUFFER_SIZE_4MB   = 4*1024*1024;
 
 static void CHACHA20(benchmark::Bench& bench, size_t buffersize)
 {
@@ -29,6 +33,13 @@ static void CHACHA20(benchmark::Bench& bench, size_t buffersize)
     });
 }
 
+static void CHACHA20_IMPL(benchmark::Bench& bench, size_t buffersize, chacha20_implementation::UseImplementation use_implementation)
+{
+    bench.name(strprintf("%s using the '%s' ChaCha20 implementation", bench.name(), ChaCha20AutoDetect(use_implementation)));
+    CHACHA20(bench, buffersize);
+    ChaCha20AutoDetect();
+}
+
 static void FSCHACHA20POLY1305(benchmark::Bench& bench, size_t buffersize)
 {
     std::vector<std::byte> key(32);
@@ -51,11 +62,30 @@ static void CHACHA20_256BYTES(benchmark::Bench& bench)
     CHACHA20(bench, BUFFER_SIZE_SMALL);
 }
 
+static void CHACHA20_1KB(benchmark::Bench& bench)
+{
+    CHACHA20(bench, BUFFER_SIZE_1KB);
+}
+
+static void CHACHA20_64KB(benchmark::Bench& bench)
+{
+    CHACHA20(bench, BUFFER_SIZE_64KB);
+}
+
 static void CHACHA20_1MB(benchmark::Bench& bench)
 {
     CHACHA20(bench, BUFFER_SIZE_LARGE);
 }
 
+static void CHACHA20_4MB(benchmark::Bench& bench)
+{
+    CHACHA20(bench, BUFFER_SIZE_4MB);
+}
+
+static void CHACHA20_1MB_STANDARD(benchmark::Bench& bench) { CHACHA20_IMPL(bench, BUFFER_SIZE_LARGE, chacha20_implementation::STANDARD); }
+static void CHACHA20_1MB_AVX2(benchmark::Bench& bench) { CHACHA20_IMPL(bench, BUFFER_SIZE_LARGE, chacha20_implementation::USE_AVX2); }
+static void CHACHA20_1MB_AVX512(benchmark::Bench& bench) { CHACHA20_IMPL(bench, BUFFER_SIZE_LARGE, chacha20_implementation::USE_AVX512); }
+
 static void FSCHACHA20POLY1305_64BYTES(benchmark::Bench& bench)
 {
     FSCHACHA20POLY1305(bench, BUFFER_SIZE_TINY);
@@ -66,14 +96,38 @@ static void FSCHACHA20POLY1305_256BYTES(benchmark::Bench& bench)
     FSCHACHA20POLY1305(bench, BUFFER_SIZE_SMALL);
 }
 
+static void FSCHACHA20POLY1305_1KB(benchmark::Bench& bench)
+{
+    FSCHACHA20POLY1305(bench, BUFFER_SIZE_1KB);
+}
+
+static void FSCHACHA20POLY1305_64KB(benchmark::Bench& bench)
+{
+    FSCHACHA20POLY1305(bench, BUFFER_SIZE_64KB);
+}
+
 static void FSCHACHA20POLY1305_1MB(benchmark::Bench& bench)
 {
     FSCHACHA20POLY1305(bench, BUFFER_SIZE_LARGE);
 }
 
+static void FSCHACHA20POLY1305_4MB(benchmark::Bench& bench)
+{
+    FSCHACHA20POLY1305(bench, BUFFER_SIZE_4MB);
+}
+
 BENCHMARK(CHACHA20_64BYTES, benchmark::PriorityLevel::HIGH);
 BENCHMARK(CHACHA20_256BYTES, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_64KB, benchmark::PriorityLevel::HIGH);
 BENCHMARK(CHACHA20_1MB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_4MB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_1MB_STANDARD, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_1MB_AVX2, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_1MB_AVX512, benchmark::PriorityLevel::HIGH);
 BENCHMARK(FSCHACHA20POLY1305_64BYTES, benchmark::PriorityLevel::HIGH);
 BENCHMARK(FSCHACHA20POLY1305_256BYTES, benchmark::PriorityLevel::HIGH);
+BENCHMARK(FSCHACHA20POLY1305_1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(FSCHACHA20POLY1305_64KB, benchmark::PriorityLevel::HIGH);
 BENCHMARK(FSCHACHA20POLY1305_1MB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(FSCHACHA20POLY1305_4MB, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,146 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <coins.h>
+#include <consensus/amount.h>
+#include <dbwrapper.h>
+#include <key.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <txdb.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Flush and lookup throughput of the chainstate database for several leveldb
+// tuning profiles (see -dboption), on coins with Dilithium-sized P2PK scripts.
+// The database lives in leveldb's memory environment, so these measure the
+// CPU side of each profile (table building, bloom filters, block decoding)
+// rather than disk I/O.
+
+namespace {
+constexpr size_t NUM_COINS{5'000};
+
+std::vector<std::pair<COutPoint, Coin>> MakeDilithiumCoins(FastRandomContext& rng)
+{
+    std::vector<std::pair<COutPoint, Coin>> coins;
+    coins.reserve(NUM_COINS);
+    for (size_t i{0}; i < NUM_COINS; ++i) {
+        const CScript script{CScript() << rng.randbytes(DILITHIUM_PUBLICKEY_SIZE) << OP_CHECKSIG};
+        coins.emplace_back(COutPoint{Txid::FromUint256(rng.rand256()), static_cast<uint32_t>(rng.randrange(4))},
+                           Coin{CTxOut{static_cast<CAmount>(rng.randrange(100 * COIN)), script}, /*nHeightIn=*/static_cast<int>(i), /*fCoinBaseIn=*/false});
+    }
+    return coins;
+}
+
+void FlushCoins(CCoinsViewDB& db, const std::vector<std::pair<COutPoint, Coin>>& coins, FastRandomContext& rng)
+{
+    CCoinsViewCache cache{&db, /*deterministic=*/true};
+    for (const auto& [outpoint, coin] : coins) {
+        cache.AddCoin(outpoint, Coin{coin}, /*possible_overwrite=*/false);
+    }
+    cache.SetBestBlock(rng.rand256());
+    const bool flushed{cache.Flush()};
+    assert(flushed);
+}
+
+DBParams BenchDBParams(const DBOptions& options)
+{
+    return {.path = "coins_db_bench", .cache_bytes = 8 << 20, .memory_only = true, .options = options};
+}
+
+void CoinsDBFlush(benchmark::Bench& bench, const DBOptions& options)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    const auto coins{MakeDilithiumCoins(rng)};
+    bench.batch(coins.size()).unit("coin").run([&] {
+        CCoinsViewDB db{BenchDBParams(options), {}};
+        FlushCoins(db, coins, rng);
+    });
+}
+
+void CoinsDBRead(benchmark::Bench& bench, const DBOptions& options)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    const auto coins{MakeDilithiumCoins(rng)};
+    CCoinsViewDB db{BenchDBParams(options), {}};
+    FlushCoins(db, coins, rng);
+
+    // Alternate hits with misses, which is where the bloom filters matter.
+    std::vector<COutPoint> lookups;
+    for (const auto& [outpoint, coin] : coins) {
+        lookups.push_back(outpoint);
+        lookups.emplace_back(Txid::FromUint256(rng.rand256()), outpoint.n);
+    }
+    std::shuffle(lookups.begin(), lookups.end(), rng);
+
+    bench.batch(lookups.size()).unit("lookup").run([&] {
+        size_t found{0};
+        for (const auto& outpoint : lookups) {
+            if (db.GetCoin(outpoint)) ++found;
+        }
+        assert(found == coins.size());
+    });
+}
+
+// Block-shaped lookups, like the prevouts spent by ConnectBlock: a random
+// subset of existing coins, resolved either one GetCoin() at a time or with
+// one GetCoins() batch.
+void CoinsDBReadBlock(benchmark::Bench& bench, bool batched)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    auto coins{MakeDilithiumCoins(rng)};
+    CCoinsViewDB db{BenchDBParams({}), {}};
+    FlushCoins(db, coins, rng);
+
+    std::shuffle(coins.begin(), coins.end(), rng);
+    std::vector<COutPoint> prevouts;
+    for (size_t i{0}; i < NUM_COINS / 2; ++i) prevouts.push_back(coins[i].first);
+
+    bench.batch(prevouts.size()).unit("lookup").run([&] {
+        size_t found{0};
+        if (batched) {
+            for (const auto& coin : db.GetCoins(prevouts)) {
+                if (coin) ++found;
+            }
+        } else {
+            for (const auto& outpoint : prevouts) {
+                if (db.GetCoin(outpoint)) ++found;
+            }
+        }
+        assert(found == prevouts.size());
+    });
+}
+
+const DBOptions PROFILE_LARGE_BLOCKS{.block_size = 64 << 10};
+const DBOptions PROFILE_NO_BLOOM{.bloom_bits = 0};
+const DBOptions PROFILE_COMPRESSED{.compression = true};
+} // namespace
+
+static void CoinsDBFlushDefault(benchmark::Bench& bench) { CoinsDBFlush(bench, {}); }
+static void CoinsDBFlushLargeBlocks(benchmark::Bench& bench) { CoinsDBFlush(bench, PROFILE_LARGE_BLOCKS); }
+static void CoinsDBFlushNoBloom(benchmark::Bench& bench) { CoinsDBFlush(bench, PROFILE_NO_BLOOM); }
+static void CoinsDBFlushCompressed(benchmark::Bench& bench) { CoinsDBFlush(bench, PROFILE_COMPRESSED); }
+static void CoinsDBReadDefault(benchmark::Bench& bench) { CoinsDBRead(bench, {}); }
+static void CoinsDBReadLargeBlocks(benchmark::Bench& bench) { CoinsDBRead(bench, PROFILE_LARGE_BLOCKS); }
+static void CoinsDBReadNoBloom(benchmark::Bench& bench) { CoinsDBRead(bench, PROFILE_NO_BLOOM); }
+static void CoinsDBReadCompressed(benchmark::Bench& bench) { CoinsDBRead(bench, PROFILE_COMPRESSED); }
+static void CoinsDBReadBlockSingle(benchmark::Bench& bench) { CoinsDBReadBlock(bench, /*batched=*/false); }
+static void CoinsDBReadBlockBatched(benchmark::Bench& bench) { CoinsDBReadBlock(bench, /*batched=*/true); }
+
+BENCHMARK(CoinsDBFlushDefault, benchmark::PriorityLevel::LOW);
+BENCHMARK(CoinsDBFlushLargeBlocks, benchmark::PriorityLevel::LOW);
+BENCHMARK(CoinsDBFlushNoBloom, benchmark::PriorityLevel::LOW);
+BENCHMARK(CoinsDBFlushCompressed, benchmark::PriorityLevel::LOW);
+BENCHMARK(CoinsDBReadDefault, benchmark::PriorityLevel::LOW);
+BENCHMARK(CoinsDBReadLargeBlocks, benchmark::PriorityLevel::LOW);
+BENCHMARK(CoinsDBReadNoBloom, benchmark::PriorityLevel::LOW);
+BENCHMARK(CoinsDBReadCompressed, benchmark::PriorityLevel::LOW);
+BENCHMARK(CoinsDBReadBlockSingle, benchmark::PriorityLevel::LOW);
+BENCHMARK(CoinsDBReadBlockBatched, benchmark::PriorityLevel::LOW);
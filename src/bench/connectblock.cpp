@@ -7,11 +7,14 @@
 #include <interfaces/chain.h>
 #include <kernel/cs_main.h>
 #include <script/interpreter.h>
+#include <script/solver.h>
 #include <sync.h>
 #include <test/util/setup_common.h>
 #include <validation.h>
 
 #include <cassert>
+#include <ostream>
+#include <string>
 #include <vector>
 
 /*
@@ -66,15 +69,17 @@ CBlock CreateTestBlock(
  * Creates key pairs and corresponding outputs for the benchmark transactions.
  * - For Schnorr signatures: Creates simple key path spendable outputs
  * - For Ecdsa signatures: Creates P2WPKH (native SegWit v0) outputs
+ * - For P2PK: Creates outputs holding the full Dilithium public key, so each
+ *   spent coin carries a large script
  * - All outputs have value of 1 BTC
  */
-std::pair<std::vector<CKey>, std::vector<CTxOut>> CreateKeysAndOutputs(const CKey& coinbaseKey, size_t num_schnorr, size_t num_ecdsa)
+std::pair<std::vector<CKey>, std::vector<CTxOut>> CreateKeysAndOutputs(const CKey& coinbaseKey, size_t num_schnorr, size_t num_ecdsa, size_t num_p2pk = 0)
 {
     std::vector<CKey> keys{coinbaseKey};
-    keys.reserve(num_schnorr + num_ecdsa + 1);
+    keys.reserve(num_schnorr + num_ecdsa + num_p2pk + 1);
 
     std::vector<CTxOut> outputs;
-    outputs.reserve(num_schnorr + num_ecdsa);
+    outputs.reserve(num_schnorr + num_ecdsa + num_p2pk);
 
     for (size_t i{0}; i < num_ecdsa; ++i) {
         keys.emplace_back(GenerateRandomKey());
@@ -86,6 +91,11 @@ std::pair<std::vector<CKey>, std::vector<CTxOut>> CreateKeysAndOutputs(const CKe
         outputs.emplace_back(COIN, GetScriptForDestination(WitnessV1Taproot{XOnlyPubKey(keys.back().GetPubKey())}));
     }
 
+    for (size_t i{0}; i < num_p2pk; ++i) {
+        keys.emplace_back(GenerateRandomKey());
+        outputs.emplace_back(COIN, GetScriptForRawPubKey(keys.back().GetPubKey()));
+    }
+
     return {keys, outputs};
 }
 
@@ -102,6 +112,17 @@ void BenchmarkConnectBlock(benchmark::Bench& bench, std::vector<CKey>& keys, std
 
         assert(chainstate.ConnectBlock(test_block, test_block_state, pindex, viewNew));
     });
+
+    // The coins spent by the block were loaded into the tip cache, which is
+    // what -dbcache limits.
+    std::string bytes_per_coin;
+    {
+        LOCK(cs_main);
+        const CCoinsViewCache& coins_tip{test_setup.m_node.chainman->ActiveChainstate().CoinsTip()};
+        bytes_per_coin = std::to_string(coins_tip.DynamicMemoryUsage() / coins_tip.GetCacheSize());
+    }
+    bench.context("bytes_per_coin", bytes_per_coin);
+    if (bench.output()) *bench.output() << bench.name() << ": " << bytes_per_coin << " bytes per coin in the coins tip cache" << std::endl;
 }
 
 static void ConnectBlockAllSchnorr(benchmark::Bench& bench)
@@ -126,6 +147,14 @@ static void ConnectBlockAllEcdsa(benchmark::Bench& bench)
     BenchmarkConnectBlock(bench, keys, outputs, *test_setup);
 }
 
+static void ConnectBlockDilithiumP2PK(benchmark::Bench& bench)
+{
+    const auto test_setup{MakeNoLogFileContext<TestChain100Setup>()};
+    auto [keys, outputs]{CreateKeysAndOutputs(test_setup->coinbaseKey, /*num_schnorr=*/0, /*num_ecdsa=*/0, /*num_p2pk=*/5)};
+    BenchmarkConnectBlock(bench, keys, outputs, *test_setup);
+}
+
 BENCHMARK(ConnectBlockAllSchnorr, benchmark::PriorityLevel::HIGH);
 BENCHMARK(ConnectBlockMixedEcdsaSchnorr, benchmark::PriorityLevel::HIGH);
 BENCHMARK(ConnectBlockAllEcdsa, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ConnectBlockDilithiumP2PK, benchmark::PriorityLevel::HIGH);
@@ -11,6 +11,7 @@
 #include <crypto/sha3.h>
 #include <crypto/sha512.h>
 #include <crypto/siphash.h>
+#include <hash.h>
 #include <random.h>
 #include <span.h>
 #include <tinyformat.h>
@@ -181,6 +182,68 @@ static void SHA256D64_1024_SHANI(benchmark::Bench& bench)
     SHA256AutoDetect();
 }
 
+/* SHAKE128 of 8 lanes of 34-byte seeds, squeezing 5 blocks each, as in the expansion of a Dilithium matrix */
+static void SHAKE128_8x840b(benchmark::Bench& bench, sha3_implementation::UseImplementation use_implementation)
+{
+    bench.name(strprintf("%s using the '%s' Keccak implementation", bench.name(), SHA3AutoDetect(use_implementation)));
+    std::vector<uint8_t> seeds(34 * SHAKEMulti::MAX_LANES, 1), out(840 * SHAKEMulti::MAX_LANES);
+    std::vector<const unsigned char*> inputs;
+    std::vector<unsigned char*> outputs;
+    for (size_t lane = 0; lane < SHAKEMulti::MAX_LANES; ++lane) {
+        inputs.push_back(seeds.data() + 34 * lane);
+        outputs.push_back(out.data() + 840 * lane);
+    }
+    bench.batch(SHAKEMulti::MAX_LANES).unit("lane").run([&] {
+        SHAKEMulti(SHAKEMulti::SHAKE128_RATE, SHAKEMulti::MAX_LANES).Absorb(inputs, 34).Squeeze(outputs, 840);
+    });
+    SHA3AutoDetect();
+}
+
+static void SHAKE128_8x840b_STANDARD(benchmark::Bench& bench) { SHAKE128_8x840b(bench, sha3_implementation::STANDARD); }
+static void SHAKE128_8x840b_AVX2(benchmark::Bench& bench) { SHAKE128_8x840b(bench, sha3_implementation::USE_AVX2); }
+static void SHAKE128_8x840b_AVX512(benchmark::Bench& bench) { SHAKE128_8x840b(bench, sha3_implementation::USE_AVX512); }
+
+/* Hash160 of 1024 Dilithium3 public key sized messages, as computed for their key IDs */
+static const size_t PUBKEY_SIZE = 1952;
+
+static std::vector<std::vector<uint8_t>> MakePubkeySized()
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<std::vector<uint8_t>> keys;
+    for (int i = 0; i < 1024; ++i) {
+        keys.push_back(rng.randbytes(PUBKEY_SIZE));
+    }
+    return keys;
+}
+
+static void HASH160_1952b_1024(benchmark::Bench& bench, sha256_implementation::UseImplementation use_implementation)
+{
+    bench.name(strprintf("%s using the '%s' SHA256 implementation", bench.name(), SHA256AutoDetect(use_implementation)));
+    const auto keys{MakePubkeySized()};
+    bench.batch(keys.size()).unit("key").run([&] {
+        for (const auto& key : keys) {
+            ankerl::nanobench::doNotOptimizeAway(Hash160(key));
+        }
+    });
+    SHA256AutoDetect();
+}
+
+static void HASH160_MULTI_1952b_1024(benchmark::Bench& bench, sha256_implementation::UseImplementation use_implementation)
+{
+    bench.name(strprintf("%s using the '%s' SHA256 implementation", bench.name(), SHA256AutoDetect(use_implementation)));
+    const auto keys{MakePubkeySized()};
+    std::vector<const unsigned char*> inputs;
+    for (const auto& key : keys) inputs.push_back(key.data());
+    bench.batch(keys.size()).unit("key").run([&] {
+        ankerl::nanobench::doNotOptimizeAway(Hash160Multi(inputs, PUBKEY_SIZE));
+    });
+    SHA256AutoDetect();
+}
+
+static void HASH160_1952b_1024_SSE4(benchmark::Bench& bench) { HASH160_1952b_1024(bench, sha256_implementation::USE_SSE4); }
+static void HASH160_1952b_1024_SHANI(benchmark::Bench& bench) { HASH160_1952b_1024(bench, sha256_implementation::USE_SSE4_AND_SHANI); }
+static void HASH160_MULTI_1952b_1024_AVX2(benchmark::Bench& bench) { HASH160_MULTI_1952b_1024(bench, sha256_implementation::USE_SSE4_AND_AVX2); }
+
 static void SHA512(benchmark::Bench& bench)
 {
     uint8_t hash[CSHA512::OUTPUT_SIZE];
@@ -270,6 +333,9 @@ BENCHMARK(SHA256_AVX2, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256_SHANI, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA512, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA3_256_1M, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SHAKE128_8x840b_STANDARD, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SHAKE128_8x840b_AVX2, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SHAKE128_8x840b_AVX512, benchmark::PriorityLevel::HIGH);
 
 BENCHMARK(SHA256_32b_STANDARD, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256_32b_SSE4, benchmark::PriorityLevel::HIGH);
@@ -280,6 +346,9 @@ BENCHMARK(SHA256D64_1024_STANDARD, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256D64_1024_SSE4, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256D64_1024_AVX2, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256D64_1024_SHANI, benchmark::PriorityLevel::HIGH);
+BENCHMARK(HASH160_1952b_1024_SSE4, benchmark::PriorityLevel::HIGH);
+BENCHMARK(HASH160_1952b_1024_SHANI, benchmark::PriorityLevel::HIGH);
+BENCHMARK(HASH160_MULTI_1952b_1024_AVX2, benchmark::PriorityLevel::HIGH);
 
 BENCHMARK(MuHash, benchmark::PriorityLevel::HIGH);
 BENCHMARK(MuHashMul, benchmark::PriorityLevel::HIGH);
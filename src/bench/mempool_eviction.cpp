@@ -14,8 +14,10 @@
 #include <txmempool.h>
 #include <util/check.h>
 
+#include <cassert>
 #include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
 
@@ -144,4 +146,109 @@ static void MempoolEviction(benchmark::Bench& bench)
     });
 }
 
+// Update the mempool for a block that confirms the first half of many
+// chains of mempool transactions, whose remaining descendants need their
+// ancestor state updated, and that conflicts with some other transactions.
+// The mempool is refilled in every iteration, which is included in the
+// measurement.
+static void MempoolRemoveForBlock(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>();
+    constexpr size_t NUM_CHAINS{1000};
+    constexpr size_t CHAIN_LENGTH{4};
+    constexpr size_t NUM_CONFLICTS{200};
+
+    std::vector<CTransactionRef> mempool_txs;
+    std::vector<CTransactionRef> block_txs;
+    const auto make_tx{[](const COutPoint& prevout, uint32_t n) {
+        CMutableTransaction tx;
+        tx.vin.emplace_back(prevout);
+        tx.vin[0].scriptWitness.stack.push_back({1});
+        tx.vout.emplace_back(10 * COIN, CScript() << OP_1 << OP_EQUAL);
+        tx.nLockTime = n;
+        return MakeTransactionRef(tx);
+    }};
+    for (uint32_t chain{0}; chain < NUM_CHAINS; ++chain) {
+        COutPoint prevout{Txid::FromUint256(uint256{1}), chain};
+        for (size_t i{0}; i < CHAIN_LENGTH; ++i) {
+            mempool_txs.push_back(make_tx(prevout, chain));
+            if (i < CHAIN_LENGTH / 2) block_txs.push_back(mempool_txs.back());
+            prevout = COutPoint{mempool_txs.back()->GetHash(), 0};
+        }
+    }
+    for (uint32_t i{0}; i < NUM_CONFLICTS; ++i) {
+        const COutPoint prevout{Txid::FromUint256(uint256{2}), i};
+        mempool_txs.push_back(make_tx(prevout, 0));
+        mempool_txs.push_back(make_tx(COutPoint{mempool_txs.back()->GetHash(), 0}, 0));
+        block_txs.push_back(make_tx(prevout, 1));
+    }
+
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+    LOCK2(cs_main, pool.cs);
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        for (const auto& tx : mempool_txs) {
+            AddTx(tx, 1000, pool);
+        }
+        pool.removeForBlock(block_txs, 1);
+        assert(pool.size() == NUM_CHAINS * (CHAIN_LENGTH - CHAIN_LENGTH / 2));
+        pool.removeForBlock(mempool_txs, 2);
+    });
+}
+
+// Keep a full mempool of transaction chains at its size limit while it is
+// flooded with waves of spam, most of which evicts parts of the chains. The
+// mempool is refilled in every iteration, which is included in the
+// measurement.
+static void MempoolTrimToSizeSpam(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>();
+    constexpr size_t NUM_CHAINS{200};
+    constexpr size_t CHAIN_LENGTH{25};
+    constexpr size_t NUM_WAVES{20};
+    constexpr size_t WAVE_SIZE{250};
+
+    const auto make_tx{[](const COutPoint& prevout, uint32_t n) {
+        CMutableTransaction tx;
+        tx.vin.emplace_back(prevout);
+        tx.vin[0].scriptWitness.stack.push_back({1});
+        tx.vout.emplace_back(10 * COIN, CScript() << OP_1 << OP_EQUAL);
+        tx.nLockTime = n;
+        return MakeTransactionRef(tx);
+    }};
+    std::vector<std::pair<CTransactionRef, CAmount>> chain_txs;
+    for (uint32_t chain{0}; chain < NUM_CHAINS; ++chain) {
+        COutPoint prevout{Txid::FromUint256(uint256{1}), chain};
+        for (uint32_t i{0}; i < CHAIN_LENGTH; ++i) {
+            chain_txs.emplace_back(make_tx(prevout, i), 1000 + (chain * 7919 + i * 104729) % 5000);
+            prevout = COutPoint{chain_txs.back().first->GetHash(), 0};
+        }
+    }
+    std::vector<std::pair<CTransactionRef, CAmount>> spam_txs;
+    for (uint32_t i{0}; i < NUM_WAVES * WAVE_SIZE; ++i) {
+        spam_txs.emplace_back(make_tx(COutPoint{Txid::FromUint256(uint256{2}), i}, 0), 1000 + (i * 7919) % 6000);
+    }
+    std::vector<CTransactionRef> all_txs;
+    for (const auto& [tx, fee] : chain_txs) all_txs.push_back(tx);
+    for (const auto& [tx, fee] : spam_txs) all_txs.push_back(tx);
+
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+    LOCK2(cs_main, pool.cs);
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        for (const auto& [tx, fee] : chain_txs) {
+            AddTx(tx, fee, pool);
+        }
+        const size_t limit{pool.DynamicMemoryUsage()};
+        for (size_t wave{0}; wave < NUM_WAVES; ++wave) {
+            for (size_t i{wave * WAVE_SIZE}; i < (wave + 1) * WAVE_SIZE; ++i) {
+                AddTx(spam_txs[i].first, spam_txs[i].second, pool);
+            }
+            pool.TrimToSize(limit);
+        }
+        pool.removeForBlock(all_txs, 1);
+        assert(pool.size() == 0);
+    });
+}
+
 BENCHMARK(MempoolEviction, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolRemoveForBlock, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolTrimToSizeSpam, benchmark::PriorityLevel::HIGH);
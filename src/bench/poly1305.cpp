@@ -6,6 +6,7 @@
 #include <bench/bench.h>
 #include <crypto/poly1305.h>
 #include <span.h>
+#include <tinyformat.h>
 
 #include <cstddef>
 #include <cstdint>
@@ -14,7 +15,10 @@
 /* Number of bytes to process per iteration */
 static constexpr uint64_t BUFFER_SIZE_TINY  = 64;
 static constexpr uint64_t BUFFER_SIZE_SMALL = 256;
+static constexpr uint64_t BUFFER_SIZE_1KB   = 1024;
+static constexpr uint64_t BUFFER_SIZE_64KB  = 64*1024;
 static constexpr uint64_t BUFFER_SIZE_LARGE = 1024*1024;
+static constexpr uint64_t BUFFER_SIZE_4MB   = 4*1024*1024;
 
 static void POLY1305(benchmark::Bench& bench, size_t buffersize)
 {
@@ -26,6 +30,13 @@ static void POLY1305(benchmark::Bench& bench, size_t buffersize)
     });
 }
 
+static void POLY1305_IMPL(benchmark::Bench& bench, size_t buffersize, poly1305_implementation::UseImplementation use_implementation)
+{
+    bench.name(strprintf("%s using the '%s' Poly1305 implementation", bench.name(), Poly1305AutoDetect(use_implementation)));
+    POLY1305(bench, buffersize);
+    Poly1305AutoDetect();
+}
+
 static void POLY1305_64BYTES(benchmark::Bench& bench)
 {
     POLY1305(bench, BUFFER_SIZE_TINY);
@@ -36,11 +47,34 @@ static void POLY1305_256BYTES(benchmark::Bench& bench)
     POLY1305(bench, BUFFER_SIZE_SMALL);
 }
 
+static void POLY1305_1KB(benchmark::Bench& bench)
+{
+    POLY1305(bench, BUFFER_SIZE_1KB);
+}
+
+static void POLY1305_64KB(benchmark::Bench& bench)
+{
+    POLY1305(bench, BUFFER_SIZE_64KB);
+}
+
 static void POLY1305_1MB(benchmark::Bench& bench)
 {
     POLY1305(bench, BUFFER_SIZE_LARGE);
 }
 
+static void POLY1305_4MB(benchmark::Bench& bench)
+{
+    POLY1305(bench, BUFFER_SIZE_4MB);
+}
+
+static void POLY1305_1MB_STANDARD(benchmark::Bench& bench) { POLY1305_IMPL(bench, BUFFER_SIZE_LARGE, poly1305_implementation::STANDARD); }
+static void POLY1305_1MB_AVX2(benchmark::Bench& bench) { POLY1305_IMPL(bench, BUFFER_SIZE_LARGE, poly1305_implementation::USE_AVX2); }
+
 BENCHMARK(POLY1305_64BYTES, benchmark::PriorityLevel::HIGH);
 BENCHMARK(POLY1305_256BYTES, benchmark::PriorityLevel::HIGH);
+BENCHMARK(POLY1305_1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(POLY1305_64KB, benchmark::PriorityLevel::HIGH);
 BENCHMARK(POLY1305_1MB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(POLY1305_4MB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(POLY1305_1MB_STANDARD, benchmark::PriorityLevel::HIGH);
+BENCHMARK(POLY1305_1MB_AVX2, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,86 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <common/system.h>
+#include <hash.h>
+#include <kernel/script_verify_batch.h>
+#include <key.h>
+#include <primitives/transaction.h>
+#include <pubkey.h>
+#include <script/interpreter.h>
+#include <script/script.h>
+#include <test/util/transaction_utils.h>
+#include <uint256.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+static constexpr size_t NUM_SPENDS{256};
+static constexpr unsigned int FLAGS{SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_P2SH};
+
+//! P2WPKH spends of the same output, each with its own signature.
+static std::vector<CTransactionRef> CreateSpends(CTxOut& spent)
+{
+    const CKey key{GenerateRandomQKey()};
+    const CPubKey pubkey{key.GetPubKey()};
+    uint160 pubkey_hash;
+    CHash160().Write(pubkey).Finalize(pubkey_hash);
+    const CScript script_pubkey{CScript() << 0 << ToByteVector(pubkey_hash)};
+    const CScript script_code{CScript() << OP_DUP << OP_HASH160 << ToByteVector(pubkey_hash) << OP_EQUALVERIFY << OP_CHECKSIG};
+    const CMutableTransaction credit{BuildCreditingTransaction(script_pubkey, 1)};
+    spent = credit.vout[0];
+
+    std::vector<CTransactionRef> spends;
+    for (size_t i{0}; i < NUM_SPENDS; ++i) {
+        CMutableTransaction mtx{BuildSpendingTransaction(CScript(), CScriptWitness(), CTransaction(credit))};
+        mtx.nLockTime = i;
+        auto& witness{mtx.vin[0].scriptWitness};
+        witness.stack.emplace_back();
+        key.Sign(SignatureHash(script_code, mtx, 0, SIGHASH_ALL, spent.nValue, SigVersion::WITNESS_V0), witness.stack.back());
+        witness.stack.back().push_back(static_cast<unsigned char>(SIGHASH_ALL));
+        witness.stack.push_back(ToByteVector(pubkey));
+        spends.push_back(MakeTransactionRef(mtx));
+    }
+    return spends;
+}
+
+// Verify the inputs one after another, as a kernel user without the batch
+// interface would.
+static void VerifyScriptSequential(benchmark::Bench& bench)
+{
+    CTxOut spent;
+    const auto spends{CreateSpends(spent)};
+
+    bench.batch(NUM_SPENDS).unit("input").run([&] {
+        for (const auto& tx : spends) {
+            PrecomputedTransactionData txdata;
+            txdata.Init(*tx, {spent});
+            ScriptError err;
+            const bool success{VerifyScript(tx->vin[0].scriptSig, spent.scriptPubKey, &tx->vin[0].scriptWitness, FLAGS,
+                                            TransactionSignatureChecker{tx.get(), 0, spent.nValue, txdata, MissingDataBehavior::ASSERT_FAIL}, &err)};
+            assert(success);
+        }
+    });
+}
+
+static void VerifyScriptBatch(benchmark::Bench& bench)
+{
+    CTxOut spent;
+    const auto spends{CreateSpends(spent)};
+    kernel::ScriptVerifyBatch batch{GetNumCores() - 1};
+
+    bench.batch(NUM_SPENDS).unit("input").run([&] {
+        for (size_t i{0}; i < spends.size(); ++i) {
+            batch.AddTransaction(i, spends[i], {spent}, FLAGS);
+        }
+        for (const auto& result : batch.Complete()) {
+            assert(result.valid);
+        }
+    });
+}
+
+BENCHMARK(VerifyScriptSequential, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyScriptBatch, benchmark::PriorityLevel::HIGH);
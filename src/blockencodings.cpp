@@ -13,20 +13,32 @@
 #include <random.h>
 #include <streams.h>
 #include <txmempool.h>
+#include <util/check.h>
 #include <validation.h>
 
 #include <unordered_map>
+#include <vector>
 
-CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce) :
-        nonce(nonce),
-        shorttxids(block.vtx.size() - 1), prefilledtxn(1), header(block) {
+CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce, std::span<const size_t> prefill) :
+        nonce(nonce), header(block) {
     FillShortTxIDSelector();
-    //TODO: Use our mempool prior to block acceptance to predictively fill more than just the coinbase
-    prefilledtxn[0] = {0, block.vtx[0]};
+    prefilledtxn.reserve(1 + prefill.size());
+    shorttxids.reserve(block.vtx.size() - 1);
+    prefilledtxn.push_back({0, block.vtx[0]});
+    auto next_prefill = prefill.begin();
+    size_t last_prefilled = 0;
     for (size_t i = 1; i < block.vtx.size(); i++) {
         const CTransaction& tx = *block.vtx[i];
-        shorttxids[i - 1] = GetShortID(tx.GetWitnessHash());
+        if (next_prefill != prefill.end() && *next_prefill == i) {
+            // Prefilled indexes are encoded as the offset from the previous one.
+            prefilledtxn.push_back({static_cast<uint16_t>(i - last_prefilled - 1), block.vtx[i]});
+            last_prefilled = i;
+            ++next_prefill;
+        } else {
+            shorttxids.push_back(GetShortID(tx.GetWitnessHash()));
+        }
     }
+    Assume(next_prefill == prefill.end());
 }
 
 void CBlockHeaderAndShortTxIDs::FillShortTxIDSelector() const {
@@ -106,22 +118,23 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
     std::vector<bool> have_txn(txn_available.size());
     {
     LOCK(pool->cs);
-    for (const auto& tx : pool->txns_randomized) {
-        uint64_t shortid = cmpctblock.GetShortID(tx->GetWitnessHash());
-        std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
-        if (idit != shorttxids.end()) {
-            if (!have_txn[idit->second]) {
-                txn_available[idit->second] = tx;
-                have_txn[idit->second]  = true;
-                mempool_count++;
-            } else {
-                // If we find two mempool txn that match the short id, just request it.
-                // This should be rare enough that the extra bandwidth doesn't matter,
-                // but eating a round-trip due to FillBlock failure would be annoying
-                if (txn_available[idit->second]) {
-                    txn_available[idit->second].reset();
-                    mempool_count--;
-                }
+    // Hash the mempool's contiguous array of witness hashes rather than
+    // dereferencing every transaction.
+    for (size_t pos = 0; pos < pool->wtxids_randomized.size(); ++pos) {
+        const auto idit{shorttxids.find(cmpctblock.GetShortID(pool->wtxids_randomized[pos]))};
+        if (idit == shorttxids.end()) continue;
+        const uint16_t index{idit->second};
+        if (!have_txn[index]) {
+            txn_available[index] = pool->txns_randomized[pos];
+            have_txn[index] = true;
+            mempool_count++;
+        } else {
+            // If we find two mempool txn that match the short id, just request it.
+            // This should be rare enough that the extra bandwidth doesn't matter,
+            // but eating a round-trip due to FillBlock failure would be annoying
+            if (txn_available[index]) {
+                txn_available[index].reset();
+                mempool_count--;
             }
         }
         // Though ideally we'd continue scanning for the two-txn-match-shortid case,
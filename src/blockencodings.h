@@ -8,6 +8,7 @@
 #include <primitives/block.h>
 
 #include <functional>
+#include <span>
 
 class CTxMemPool;
 class BlockValidationState;
@@ -112,9 +113,11 @@ public:
     CBlockHeaderAndShortTxIDs() = default;
 
     /**
-     * @param[in]  nonce  This should be randomly generated, and is used for the siphash secret key
+     * @param[in]  nonce    This should be randomly generated, and is used for the siphash secret key
+     * @param[in]  prefill  Ascending indexes of non-coinbase transactions to send in full, in
+     *                      addition to the coinbase
      */
-    CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce);
+    CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce, std::span<const size_t> prefill = {});
 
     uint64_t GetShortID(const Wtxid& wtxid) const;
 
@@ -9,11 +9,21 @@
 #include <random.h>
 #include <util/trace.h>
 
+#include <algorithm>
+#include <bit>
+
 TRACEPOINT_SEMAPHORE(utxocache, add);
 TRACEPOINT_SEMAPHORE(utxocache, spent);
 TRACEPOINT_SEMAPHORE(utxocache, uncache);
 
 std::optional<Coin> CCoinsView::GetCoin(const COutPoint& outpoint) const { return std::nullopt; }
+std::vector<std::optional<Coin>> CCoinsView::GetCoins(std::span<const COutPoint> outpoints) const
+{
+    std::vector<std::optional<Coin>> coins;
+    coins.reserve(outpoints.size());
+    for (const auto& outpoint : outpoints) coins.push_back(GetCoin(outpoint));
+    return coins;
+}
 uint256 CCoinsView::GetBestBlock() const { return uint256(); }
 std::vector<uint256> CCoinsView::GetHeadBlocks() const { return std::vector<uint256>(); }
 bool CCoinsView::BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &hashBlock) { return false; }
@@ -170,6 +180,45 @@ bool CCoinsViewCache::HaveCoinInCache(const COutPoint &outpoint) const {
     return (it != cacheCoins.end() && !it->second.coin.IsSpent());
 }
 
+void CCoinsViewCache::PrefetchCoins(std::span<const COutPoint> outpoints) const
+{
+    std::vector<COutPoint> missing;
+    for (const auto& outpoint : outpoints) {
+        if (!cacheCoins.count(outpoint)) missing.push_back(outpoint);
+    }
+    if (missing.empty()) return;
+    std::sort(missing.begin(), missing.end());
+    missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+
+    auto coins{base->GetCoins(missing)};
+    for (size_t i{0}; i < missing.size(); ++i) {
+        if (!coins[i]) continue;
+        // Same as FetchCoin, for each coin the backing view has.
+        const auto [it, inserted] = cacheCoins.try_emplace(missing[i]);
+        Assume(inserted);
+        it->second.coin = std::move(*coins[i]);
+        cachedCoinsUsage += it->second.coin.DynamicMemoryUsage();
+        if (it->second.coin.IsSpent()) {
+            CCoinsCacheEntry::SetFresh(*it, m_sentinel);
+        }
+    }
+}
+
+std::vector<std::optional<Coin>> CCoinsViewCache::GetCoins(std::span<const COutPoint> outpoints) const
+{
+    PrefetchCoins(outpoints);
+    std::vector<std::optional<Coin>> coins;
+    coins.reserve(outpoints.size());
+    for (const auto& outpoint : outpoints) {
+        if (auto it{cacheCoins.find(outpoint)}; it != cacheCoins.end() && !it->second.coin.IsSpent()) {
+            coins.emplace_back(it->second.coin);
+        } else {
+            coins.emplace_back();
+        }
+    }
+    return coins;
+}
+
 uint256 CCoinsViewCache::GetBestBlock() const {
     if (hashBlock.IsNull())
         hashBlock = base->GetBestBlock();
@@ -382,7 +431,156 @@ std::optional<Coin> CCoinsViewErrorCatcher::GetCoin(const COutPoint& outpoint) c
     return ExecuteBackedWrapper<std::optional<Coin>>([&]() { return CCoinsViewBacked::GetCoin(outpoint); }, m_err_callbacks);
 }
 
+std::vector<std::optional<Coin>> CCoinsViewErrorCatcher::GetCoins(std::span<const COutPoint> outpoints) const
+{
+    return ExecuteBackedWrapper<std::vector<std::optional<Coin>>>([&]() { return base->GetCoins(outpoints); }, m_err_callbacks);
+}
+
 bool CCoinsViewErrorCatcher::HaveCoin(const COutPoint& outpoint) const
 {
     return ExecuteBackedWrapper<bool>([&]() { return CCoinsViewBacked::HaveCoin(outpoint); }, m_err_callbacks);
 }
+
+CCoinsViewSharded::CCoinsViewSharded(CCoinsView* view, size_t max_cache_bytes, size_t shard_count, bool deterministic)
+    : CCoinsViewBacked(view),
+      m_hasher{/*deterministic=*/deterministic},
+      m_shard_max_bytes{max_cache_bytes / std::bit_ceil(std::max<size_t>(shard_count, 1))},
+      m_shard_mask{std::bit_ceil(std::max<size_t>(shard_count, 1)) - 1}
+{
+    m_shards.reserve(m_shard_mask + 1);
+    for (size_t i{0}; i <= m_shard_mask; ++i) {
+        m_shards.push_back(std::make_unique<Shard>(m_hasher));
+    }
+}
+
+CCoinsViewSharded::Shard& CCoinsViewSharded::GetShard(const COutPoint& outpoint) const
+{
+    // The shard maps consume the low bits of the same hash; pick the shard from the high ones.
+    return *m_shards[(m_hasher(outpoint) >> 32) & m_shard_mask];
+}
+
+void CCoinsViewSharded::Insert(Shard& shard, const COutPoint& outpoint, const Coin& coin) const
+{
+    const auto [it, inserted]{shard.m_coins.try_emplace(outpoint, coin)};
+    if (!inserted) return;
+    shard.m_coins_usage += coin.DynamicMemoryUsage();
+    // Evict arbitrary other entries until the shard is back within its budget.
+    while (shard.m_coins.size() > 1 && memusage::DynamicUsage(shard.m_coins) + shard.m_coins_usage > m_shard_max_bytes) {
+        auto victim{shard.m_coins.begin()};
+        if (victim == it) ++victim;
+        shard.m_coins_usage -= victim->second.DynamicMemoryUsage();
+        shard.m_coins.erase(victim);
+    }
+    if (memusage::DynamicUsage(shard.m_coins) + shard.m_coins_usage > m_shard_max_bytes) {
+        shard.m_coins_usage -= it->second.DynamicMemoryUsage();
+        shard.m_coins.erase(it);
+    }
+}
+
+std::optional<Coin> CCoinsViewSharded::GetCoin(const COutPoint& outpoint) const
+{
+    if (m_shard_max_bytes == 0) return base->GetCoin(outpoint);
+    Shard& shard{GetShard(outpoint)};
+    {
+        LOCK(shard.m_mutex);
+        if (auto it{shard.m_coins.find(outpoint)}; it != shard.m_coins.end()) return it->second;
+    }
+    const uint64_t write_seq{m_write_seq.load()};
+    auto coin{base->GetCoin(outpoint)};
+    if (coin && !coin->IsSpent() && write_seq % 2 == 0) {
+        LOCK(shard.m_mutex);
+        // Only cache the coin if no commit started since it was read.
+        if (m_write_seq.load() == write_seq) Insert(shard, outpoint, *coin);
+    }
+    return coin;
+}
+
+std::vector<std::optional<Coin>> CCoinsViewSharded::GetCoins(std::span<const COutPoint> outpoints) const
+{
+    if (m_shard_max_bytes == 0) return base->GetCoins(outpoints);
+    std::vector<std::optional<Coin>> coins(outpoints.size());
+    std::vector<COutPoint> missing;
+    std::vector<size_t> missing_pos;
+    for (size_t i{0}; i < outpoints.size(); ++i) {
+        Shard& shard{GetShard(outpoints[i])};
+        LOCK(shard.m_mutex);
+        if (auto it{shard.m_coins.find(outpoints[i])}; it != shard.m_coins.end()) {
+            coins[i] = it->second;
+        } else {
+            missing.push_back(outpoints[i]);
+            missing_pos.push_back(i);
+        }
+    }
+    if (missing.empty()) return coins;
+
+    const uint64_t write_seq{m_write_seq.load()};
+    auto fetched{base->GetCoins(missing)};
+    for (size_t i{0}; i < missing.size(); ++i) {
+        if (fetched[i] && !fetched[i]->IsSpent() && write_seq % 2 == 0) {
+            Shard& shard{GetShard(missing[i])};
+            LOCK(shard.m_mutex);
+            if (m_write_seq.load() == write_seq) Insert(shard, missing[i], *fetched[i]);
+        }
+        coins[missing_pos[i]] = std::move(fetched[i]);
+    }
+    return coins;
+}
+
+bool CCoinsViewSharded::HaveCoin(const COutPoint& outpoint) const
+{
+    if (m_shard_max_bytes > 0) {
+        Shard& shard{GetShard(outpoint)};
+        LOCK(shard.m_mutex);
+        if (shard.m_coins.contains(outpoint)) return true;
+    }
+    return base->HaveCoin(outpoint);
+}
+
+bool CCoinsViewSharded::BatchWrite(CoinsViewCacheCursor& cursor, const uint256& hashBlock)
+{
+    LOCK(m_write_mutex);
+    if (m_shard_max_bytes == 0) return base->BatchWrite(cursor, hashBlock);
+
+    ++m_write_seq;
+    // No reader can insert into the shards until m_write_seq is incremented
+    // again, so dropping the affected entries up front is enough to keep
+    // stale coins out once the base view has been updated.
+    for (auto it{cursor.Begin()}; it != cursor.End(); it = it->second.Next()) {
+        if (!it->second.IsDirty()) continue;
+        Shard& shard{GetShard(it->first)};
+        LOCK(shard.m_mutex);
+        if (auto cached{shard.m_coins.find(it->first)}; cached != shard.m_coins.end()) {
+            shard.m_coins_usage -= cached->second.DynamicMemoryUsage();
+            shard.m_coins.erase(cached);
+        }
+    }
+    bool ret;
+    try {
+        ret = base->BatchWrite(cursor, hashBlock);
+    } catch (...) {
+        ++m_write_seq;
+        throw;
+    }
+    ++m_write_seq;
+    return ret;
+}
+
+size_t CCoinsViewSharded::GetCacheSize() const
+{
+    size_t count{0};
+    for (const auto& shard : m_shards) {
+        LOCK(shard->m_mutex);
+        count += shard->m_coins.size();
+    }
+    return count;
+}
+
+size_t CCoinsViewSharded::DynamicMemoryUsage() const
+{
+    size_t usage{memusage::DynamicUsage(m_shards) + m_shards.size() * memusage::MallocUsage(sizeof(Shard))};
+    for (const auto& shard : m_shards) {
+        LOCK(shard->m_mutex);
+        usage += memusage::DynamicUsage(shard->m_coins) + shard->m_coins_usage;
+    }
+    return usage;
+}
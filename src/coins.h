@@ -9,9 +9,11 @@
 #include <compressor.h>
 #include <core_memusage.h>
 #include <memusage.h>
+#include <nodehashmap.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
 #include <support/allocators/pool.h>
+#include <sync.h>
 #include <uint256.h>
 #include <util/check.h>
 #include <util/hasher.h>
@@ -19,8 +21,12 @@
 #include <assert.h>
 #include <stdint.h>
 
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <span>
 #include <unordered_map>
+#include <vector>
 
 /**
  * A UTXO entry.
@@ -214,19 +220,17 @@ public:
 };
 
 /**
- * PoolAllocator's MAX_BLOCK_SIZE_BYTES parameter here uses sizeof the data, and adds the size
- * of 4 pointers. We do not know the exact node size used in the std::unordered_node implementation
- * because it is implementation defined. Most implementations have an overhead of 1 or 2 pointers,
- * so nodes can be connected in a linked list, and in some cases the hash value is stored as well.
- * Using an additional sizeof(void*)*4 for MAX_BLOCK_SIZE_BYTES should thus be sufficient so that
- * all implementations can allocate the nodes from the PoolAllocator.
+ * The coins cache map. Its open-addressing index keeps lookups to roughly one
+ * cache line of metadata plus the entry itself, and its nodes are allocated
+ * from a PoolResource sized exactly for a CoinsCachePair. Nodes never move, so
+ * the DIRTY/FRESH linked list can point into them.
  */
-using CCoinsMap = std::unordered_map<COutPoint,
-                                     CCoinsCacheEntry,
-                                     SaltedOutpointHasher,
-                                     std::equal_to<COutPoint>,
-                                     PoolAllocator<CoinsCachePair,
-                                                   sizeof(CoinsCachePair) + sizeof(void*) * 4>>;
+using CCoinsMap = NodeHashMap<COutPoint,
+                              CCoinsCacheEntry,
+                              SaltedOutpointHasher,
+                              std::equal_to<COutPoint>,
+                              sizeof(CoinsCachePair),
+                              alignof(CoinsCachePair)>;
 
 using CCoinsMapMemoryResource = CCoinsMap::allocator_type::ResourceType;
 
@@ -312,6 +316,11 @@ public:
     //! Retrieve the Coin (unspent transaction output) for a given outpoint.
     virtual std::optional<Coin> GetCoin(const COutPoint& outpoint) const;
 
+    //! Retrieve the Coins for many outpoints at once, in the order given.
+    //! Views that can serve a batch faster than one lookup at a time override this;
+    //! the default calls GetCoin for each outpoint.
+    virtual std::vector<std::optional<Coin>> GetCoins(std::span<const COutPoint> outpoints) const;
+
     //! Just check whether a given outpoint is unspent.
     virtual bool HaveCoin(const COutPoint &outpoint) const;
 
@@ -388,6 +397,7 @@ public:
 
     // Standard CCoinsView methods
     std::optional<Coin> GetCoin(const COutPoint& outpoint) const override;
+    std::vector<std::optional<Coin>> GetCoins(std::span<const COutPoint> outpoints) const override;
     bool HaveCoin(const COutPoint &outpoint) const override;
     uint256 GetBestBlock() const override;
     void SetBestBlock(const uint256 &hashBlock);
@@ -403,6 +413,16 @@ public:
      */
     bool HaveCoinInCache(const COutPoint &outpoint) const;
 
+    /**
+     * Pull the coins for the given outpoints that are not cached yet from the
+     * backing view with a single GetCoins call, so that later lookups are served
+     * from memory. Missing coins are not cached.
+     *
+     * @note this is marked const, but may actually append to `cacheCoins`, increasing
+     * memory usage.
+     */
+    void PrefetchCoins(std::span<const COutPoint> outpoints) const;
+
     /**
      * Return a reference to Coin in the cache, or coinEmpty if not found. This is
      * more efficient than GetCoin.
@@ -518,6 +538,7 @@ public:
     }
 
     std::optional<Coin> GetCoin(const COutPoint& outpoint) const override;
+    std::vector<std::optional<Coin>> GetCoins(std::span<const COutPoint> outpoints) const override;
     bool HaveCoin(const COutPoint &outpoint) const override;
 
 private:
@@ -526,4 +547,64 @@ private:
 
 };
 
+/**
+ * A thread-safe read-through cache of coins from another, thread-safe, CCoinsView.
+ *
+ * Cached coins are spread over a power-of-two number of shards selected by
+ * outpoint hash, each with its own lock and memory budget, so that lookups
+ * for different outpoints from different threads rarely contend and never
+ * need cs_main. A single writer at a time may commit changes through
+ * BatchWrite; while a commit is in progress readers are served from the
+ * shards or the base view, but nothing read from the base view is inserted
+ * into the shards, and entries touched by the commit are dropped before it
+ * reaches the base view. Readers therefore never see an outpoint revert to
+ * a value older than one they could already observe.
+ *
+ * Only unspent coins are cached. A budget of zero bytes makes this a plain
+ * pass-through view.
+ */
+class CCoinsViewSharded final : public CCoinsViewBacked
+{
+public:
+    static constexpr size_t DEFAULT_SHARDS{16};
+
+    CCoinsViewSharded(CCoinsView* view, size_t max_cache_bytes, size_t shard_count = DEFAULT_SHARDS, bool deterministic = false);
+
+    std::optional<Coin> GetCoin(const COutPoint& outpoint) const override;
+    std::vector<std::optional<Coin>> GetCoins(std::span<const COutPoint> outpoints) const override;
+    bool HaveCoin(const COutPoint& outpoint) const override;
+    bool BatchWrite(CoinsViewCacheCursor& cursor, const uint256& hashBlock) override;
+
+    //! Calculate the size of the cache (in number of coins)
+    size_t GetCacheSize() const;
+
+    //! Calculate the size of the cache (in bytes)
+    size_t DynamicMemoryUsage() const;
+
+private:
+    struct Shard {
+        mutable Mutex m_mutex;
+        std::unordered_map<COutPoint, Coin, SaltedOutpointHasher> m_coins GUARDED_BY(m_mutex);
+        //! Dynamic memory usage of the coins held in m_coins.
+        size_t m_coins_usage GUARDED_BY(m_mutex){0};
+
+        explicit Shard(const SaltedOutpointHasher& hasher) : m_coins{0, hasher} {}
+    };
+
+    Shard& GetShard(const COutPoint& outpoint) const;
+    void Insert(Shard& shard, const COutPoint& outpoint, const Coin& coin) const EXCLUSIVE_LOCKS_REQUIRED(shard.m_mutex);
+
+    const SaltedOutpointHasher m_hasher;
+    const size_t m_shard_max_bytes;
+    const size_t m_shard_mask;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+
+    //! Serializes BatchWrite calls.
+    Mutex m_write_mutex;
+    //! Incremented at the start and end of every BatchWrite, so it is odd
+    //! while a commit is in progress. A reader only inserts a coin read from
+    //! the base view if this did not change since before the read.
+    std::atomic<uint64_t> m_write_seq{0};
+};
+
 #endif // BITCOIN_COINS_H
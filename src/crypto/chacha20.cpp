@@ -12,8 +12,21 @@
 
 #include <algorithm>
 #include <bit>
+#include <string>
 #include <string.h>
 
+#include <compat/cpuid.h>
+
+namespace chacha20_avx2
+{
+void Crypt_8way(const uint32_t input[12], const std::byte* in, std::byte* out);
+}
+
+namespace chacha20_avx512
+{
+void Crypt_16way(const uint32_t input[12], const std::byte* in, std::byte* out);
+}
+
 #define QUARTERROUND(a,b,c,d) \
   a += b; d = std::rotl(d ^ a, 16); \
   c += d; b = std::rotl(b ^ c, 12); \
@@ -22,6 +35,36 @@
 
 #define REPEAT10(a) do { {a}; {a}; {a}; {a}; {a}; {a}; {a}; {a}; {a}; {a}; } while(0)
 
+namespace {
+
+typedef void (*CryptMultiType)(const uint32_t*, const std::byte*, std::byte*);
+
+CryptMultiType Crypt_8way = nullptr;
+CryptMultiType Crypt_16way = nullptr;
+
+/** Process as many whole groups of 16 and 8 blocks as possible with the
+ *  vectorized implementations, advancing the block counter in input. Returns
+ *  the number of blocks processed. in may be nullptr to output keystream. */
+size_t CryptMulti(uint32_t input[12], const std::byte* in, std::byte* out, size_t blocks)
+{
+    size_t done = 0;
+    const auto run = [&](CryptMultiType crypt, uint32_t n) {
+        crypt(input, in ? in + 64 * done : nullptr, out + 64 * done);
+        input[8] += n;
+        if (input[8] < n) ++input[9];
+        done += n;
+    };
+    if (Crypt_16way) {
+        while (blocks - done >= 16) run(Crypt_16way, 16);
+    }
+    if (Crypt_8way) {
+        while (blocks - done >= 8) run(Crypt_8way, 8);
+    }
+    return done;
+}
+
+} // namespace
+
 void ChaCha20Aligned::SetKey(std::span<const std::byte> key) noexcept
 {
     assert(key.size() == KEYLEN);
@@ -63,6 +106,10 @@ inline void ChaCha20Aligned::Keystream(std::span<std::byte> output) noexcept
     size_t blocks = output.size() / BLOCKLEN;
     assert(blocks * BLOCKLEN == output.size());
 
+    const size_t done = CryptMulti(input, nullptr, c, blocks);
+    c += BLOCKLEN * done;
+    blocks -= done;
+
     uint32_t x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
     uint32_t j4, j5, j6, j7, j8, j9, j10, j11, j12, j13, j14, j15;
 
@@ -166,6 +213,11 @@ inline void ChaCha20Aligned::Crypt(std::span<const std::byte> in_bytes, std::spa
     size_t blocks = out_bytes.size() / BLOCKLEN;
     assert(blocks * BLOCKLEN == out_bytes.size());
 
+    const size_t done = CryptMulti(input, m, c, blocks);
+    m += BLOCKLEN * done;
+    c += BLOCKLEN * done;
+    blocks -= done;
+
     uint32_t x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
     uint32_t j4, j5, j6, j7, j8, j9, j10, j11, j12, j13, j14, j15;
 
@@ -370,3 +422,65 @@ void FSChaCha20::Crypt(std::span<const std::byte> input, std::span<std::byte> ou
         m_chunk_counter = 0;
     }
 }
+
+namespace {
+/** Check the selected implementation against the scalar code, across a wrap of the block counter. */
+bool SelfTest()
+{
+    std::byte key[ChaCha20Aligned::KEYLEN];
+    for (size_t i = 0; i < sizeof(key); ++i) key[i] = std::byte(i);
+    std::byte out[24 * ChaCha20Aligned::BLOCKLEN], expected[sizeof(out)];
+    ChaCha20Aligned chacha{key};
+    chacha.Seek({7, 0x0102030405060708}, 0xfffffffa);
+    chacha.Keystream(out);
+
+    const CryptMultiType saved_8way = Crypt_8way, saved_16way = Crypt_16way;
+    Crypt_8way = Crypt_16way = nullptr;
+    chacha.Seek({7, 0x0102030405060708}, 0xfffffffa);
+    chacha.Keystream(expected);
+    Crypt_8way = saved_8way;
+    Crypt_16way = saved_16way;
+    return std::equal(std::begin(out), std::end(out), expected);
+}
+
+} // namespace
+
+std::string ChaCha20AutoDetect([[maybe_unused]] chacha20_implementation::UseImplementation use_implementation)
+{
+    std::string ret = "standard";
+    Crypt_8way = nullptr;
+    Crypt_16way = nullptr;
+
+#if defined(HAVE_GETCPUID)
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    const bool have_xsave = (ecx >> 27) & 1;
+    const bool have_avx = (ecx >> 28) & 1;
+    // YMM state, and additionally the opmask and ZMM state for AVX-512.
+    const uint32_t xcr0 = have_xsave && have_avx ? GetXCR0() : 0;
+    GetCPUID(0, 0, eax, ebx, ecx, edx);
+    if (eax >= 7) {
+        GetCPUID(7, 0, eax, ebx, ecx, edx);
+    } else {
+        ebx = 0;
+    }
+    [[maybe_unused]] const bool have_avx2 = (use_implementation & chacha20_implementation::USE_AVX2) && ((ebx >> 5) & 1) && (xcr0 & 0x6) == 0x6;
+    [[maybe_unused]] const bool have_avx512 = (use_implementation & chacha20_implementation::USE_AVX512) && ((ebx >> 16) & 1) && (xcr0 & 0xe6) == 0xe6;
+
+#if defined(ENABLE_AVX2)
+    if (have_avx2) {
+        Crypt_8way = chacha20_avx2::Crypt_8way;
+        ret = "avx2(8way)";
+    }
+#endif
+#if defined(ENABLE_AVX512)
+    if (have_avx512) {
+        Crypt_16way = chacha20_avx512::Crypt_16way;
+        ret = Crypt_8way ? ret + ",avx512(16way)" : "avx512(16way)";
+    }
+#endif
+#endif // defined(HAVE_GETCPUID)
+
+    assert(SelfTest());
+    return ret;
+}
@@ -11,6 +11,7 @@
 #include <cstddef>
 #include <cstdlib>
 #include <stdint.h>
+#include <string>
 #include <utility>
 
 // classes for ChaCha20 256-bit stream cipher developed by Daniel J. Bernstein
@@ -156,4 +157,19 @@ public:
     void Crypt(std::span<const std::byte> input, std::span<std::byte> output) noexcept;
 };
 
+namespace chacha20_implementation {
+enum UseImplementation : uint8_t {
+    STANDARD = 0,
+    USE_AVX2 = 1 << 0,
+    USE_AVX512 = 1 << 1,
+    USE_ALL = USE_AVX2 | USE_AVX512,
+};
+}
+
+/** Autodetect the best available ChaCha20 implementation, which computes 8
+ *  (AVX2) or 16 (AVX-512) blocks at once for long inputs.
+ *  Returns the name of the implementation.
+ */
+std::string ChaCha20AutoDetect(chacha20_implementation::UseImplementation use_implementation = chacha20_implementation::USE_ALL);
+
 #endif // BITCOIN_CRYPTO_CHACHA20_H
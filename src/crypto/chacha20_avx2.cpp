@@ -0,0 +1,100 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+namespace chacha20_avx2 {
+namespace {
+
+__m256i inline K(uint32_t x) { return _mm256_set1_epi32(x); }
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi32(x, y); }
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+__m256i inline Rotl16(__m256i x) { return _mm256_shuffle_epi8(x, _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2, 13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2)); }
+__m256i inline Rotl8(__m256i x) { return _mm256_shuffle_epi8(x, _mm256_set_epi8(14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3, 14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3)); }
+__m256i inline Rotl(__m256i x, int n) { return _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - n)); }
+
+void inline QuarterRound(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+{
+    a = Add(a, b); d = Rotl16(Xor(d, a));
+    c = Add(c, d); b = Rotl(Xor(b, c), 12);
+    a = Add(a, b); d = Rotl8(Xor(d, a));
+    c = Add(c, d); b = Rotl(Xor(b, c), 7);
+}
+
+/** Write the 8 words of x0..x7 of block i (lane i of each) to out + 64 * i, XORed with in if given. */
+void inline Write8(const __m256i x[8], const std::byte* in, std::byte* out)
+{
+    // Transpose 2x2 words, then 2x2 pairs of words, within each 128-bit half...
+    const __m256i t0 = _mm256_unpacklo_epi32(x[0], x[1]), t1 = _mm256_unpackhi_epi32(x[0], x[1]);
+    const __m256i t2 = _mm256_unpacklo_epi32(x[2], x[3]), t3 = _mm256_unpackhi_epi32(x[2], x[3]);
+    const __m256i t4 = _mm256_unpacklo_epi32(x[4], x[5]), t5 = _mm256_unpackhi_epi32(x[4], x[5]);
+    const __m256i t6 = _mm256_unpacklo_epi32(x[6], x[7]), t7 = _mm256_unpackhi_epi32(x[6], x[7]);
+    const __m256i u[8] = {
+        _mm256_unpacklo_epi64(t0, t2), _mm256_unpackhi_epi64(t0, t2), _mm256_unpacklo_epi64(t1, t3), _mm256_unpackhi_epi64(t1, t3),
+        _mm256_unpacklo_epi64(t4, t6), _mm256_unpackhi_epi64(t4, t6), _mm256_unpacklo_epi64(t5, t7), _mm256_unpackhi_epi64(t5, t7),
+    };
+    // ... after which half h of u[r] holds words 0-3 (r < 4) or 4-7 of block 4 * h + r.
+    for (int r = 0; r < 4; ++r) {
+        __m256i lo = _mm256_permute2x128_si256(u[r], u[r + 4], 0x20);
+        __m256i hi = _mm256_permute2x128_si256(u[r], u[r + 4], 0x31);
+        if (in) {
+            lo = Xor(lo, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 64 * r)));
+            hi = Xor(hi, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 64 * (r + 4))));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 64 * r), lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 64 * (r + 4)), hi);
+    }
+}
+
+}
+
+/** Compute 8 consecutive ChaCha20 blocks for the state in input (as in
+ *  ChaCha20Aligned), XOR them with in, or output the keystream if in is
+ *  nullptr. The block counter in input is not updated. */
+void Crypt_8way(const uint32_t input[12], const std::byte* in, std::byte* out)
+{
+    // Per-block counters, carrying into the nonce like the scalar implementation.
+    const __m256i j12 = Add(K(input[8]), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i wrapped = _mm256_cmpgt_epi32(Xor(K(input[8]), K(0x80000000)), Xor(j12, K(0x80000000)));
+    const __m256i j13 = _mm256_sub_epi32(K(input[9]), wrapped);
+
+    __m256i x[16] = {
+        K(0x61707865), K(0x3320646e), K(0x79622d32), K(0x6b206574),
+        K(input[0]), K(input[1]), K(input[2]), K(input[3]),
+        K(input[4]), K(input[5]), K(input[6]), K(input[7]),
+        j12, j13, K(input[10]), K(input[11]),
+    };
+    for (int i = 0; i < 10; ++i) {
+        QuarterRound(x[0], x[4], x[8], x[12]);
+        QuarterRound(x[1], x[5], x[9], x[13]);
+        QuarterRound(x[2], x[6], x[10], x[14]);
+        QuarterRound(x[3], x[7], x[11], x[15]);
+        QuarterRound(x[0], x[5], x[10], x[15]);
+        QuarterRound(x[1], x[6], x[11], x[12]);
+        QuarterRound(x[2], x[7], x[8], x[13]);
+        QuarterRound(x[3], x[4], x[9], x[14]);
+    }
+    x[0] = Add(x[0], K(0x61707865));
+    x[1] = Add(x[1], K(0x3320646e));
+    x[2] = Add(x[2], K(0x79622d32));
+    x[3] = Add(x[3], K(0x6b206574));
+    for (int i = 4; i < 12; ++i) {
+        x[i] = Add(x[i], K(input[i - 4]));
+    }
+    x[12] = Add(x[12], j12);
+    x[13] = Add(x[13], j13);
+    x[14] = Add(x[14], K(input[10]));
+    x[15] = Add(x[15], K(input[11]));
+
+    Write8(x, in, out);
+    Write8(x + 8, in ? in + 32 : nullptr, out + 32);
+}
+
+}
+
+#endif
@@ -0,0 +1,111 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX512
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+namespace chacha20_avx512 {
+namespace {
+
+__m512i inline K(uint32_t x) { return _mm512_set1_epi32(x); }
+__m512i inline Add(__m512i x, __m512i y) { return _mm512_add_epi32(x, y); }
+__m512i inline Xor(__m512i x, __m512i y) { return _mm512_xor_si512(x, y); }
+//! The masked forms with all lanes selected avoid a spurious -Wuninitialized
+//! from GCC 12's definitions of the unmasked ones. Immediate operands make
+//! these macros.
+#define Rotl(x, n) _mm512_mask_rol_epi32((x), 0xffff, (x), (n))
+#define UnpackLo32(x, y) _mm512_mask_unpacklo_epi32((x), 0xffff, (x), (y))
+#define UnpackHi32(x, y) _mm512_mask_unpackhi_epi32((x), 0xffff, (x), (y))
+#define UnpackLo64(x, y) _mm512_mask_unpacklo_epi64((x), 0xff, (x), (y))
+#define UnpackHi64(x, y) _mm512_mask_unpackhi_epi64((x), 0xff, (x), (y))
+#define Shuffle128(x, y, imm) _mm512_mask_shuffle_i32x4((x), 0xffff, (x), (y), (imm))
+
+void inline QuarterRound(__m512i& a, __m512i& b, __m512i& c, __m512i& d)
+{
+    a = Add(a, b); d = Rotl(Xor(d, a), 16);
+    c = Add(c, d); b = Rotl(Xor(b, c), 12);
+    a = Add(a, b); d = Rotl(Xor(d, a), 8);
+    c = Add(c, d); b = Rotl(Xor(b, c), 7);
+}
+
+}
+
+/** Compute 16 consecutive ChaCha20 blocks for the state in input (as in
+ *  ChaCha20Aligned), XOR them with in, or output the keystream if in is
+ *  nullptr. The block counter in input is not updated. */
+void Crypt_16way(const uint32_t input[12], const std::byte* in, std::byte* out)
+{
+    // Per-block counters, carrying into the nonce like the scalar implementation.
+    const __m512i j12 = Add(K(input[8]), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    const __mmask16 wrapped = _mm512_cmplt_epu32_mask(j12, K(input[8]));
+    const __m512i j13 = _mm512_mask_add_epi32(K(input[9]), wrapped, K(input[9]), K(1));
+
+    __m512i x[16] = {
+        K(0x61707865), K(0x3320646e), K(0x79622d32), K(0x6b206574),
+        K(input[0]), K(input[1]), K(input[2]), K(input[3]),
+        K(input[4]), K(input[5]), K(input[6]), K(input[7]),
+        j12, j13, K(input[10]), K(input[11]),
+    };
+    for (int i = 0; i < 10; ++i) {
+        QuarterRound(x[0], x[4], x[8], x[12]);
+        QuarterRound(x[1], x[5], x[9], x[13]);
+        QuarterRound(x[2], x[6], x[10], x[14]);
+        QuarterRound(x[3], x[7], x[11], x[15]);
+        QuarterRound(x[0], x[5], x[10], x[15]);
+        QuarterRound(x[1], x[6], x[11], x[12]);
+        QuarterRound(x[2], x[7], x[8], x[13]);
+        QuarterRound(x[3], x[4], x[9], x[14]);
+    }
+    x[0] = Add(x[0], K(0x61707865));
+    x[1] = Add(x[1], K(0x3320646e));
+    x[2] = Add(x[2], K(0x79622d32));
+    x[3] = Add(x[3], K(0x6b206574));
+    for (int i = 4; i < 12; ++i) {
+        x[i] = Add(x[i], K(input[i - 4]));
+    }
+    x[12] = Add(x[12], j12);
+    x[13] = Add(x[13], j13);
+    x[14] = Add(x[14], K(input[10]));
+    x[15] = Add(x[15], K(input[11]));
+
+    // Transpose within 128-bit quarters, after which quarter q of u[g][r]
+    // holds words 4 * g to 4 * g + 3 of block 4 * q + r.
+    __m512i u[4][4];
+    for (int g = 0; g < 4; ++g) {
+        const __m512i t0 = UnpackLo32(x[4 * g], x[4 * g + 1]), t1 = UnpackHi32(x[4 * g], x[4 * g + 1]);
+        const __m512i t2 = UnpackLo32(x[4 * g + 2], x[4 * g + 3]), t3 = UnpackHi32(x[4 * g + 2], x[4 * g + 3]);
+        u[g][0] = UnpackLo64(t0, t2);
+        u[g][1] = UnpackHi64(t0, t2);
+        u[g][2] = UnpackLo64(t1, t3);
+        u[g][3] = UnpackHi64(t1, t3);
+    }
+    // Then transpose the quarters, to get whole blocks.
+    for (int r = 0; r < 4; ++r) {
+        const __m512i a0 = Shuffle128(u[0][r], u[1][r], 0x44), a1 = Shuffle128(u[0][r], u[1][r], 0xee);
+        const __m512i b0 = Shuffle128(u[2][r], u[3][r], 0x44), b1 = Shuffle128(u[2][r], u[3][r], 0xee);
+        __m512i blocks[4] = {
+            Shuffle128(a0, b0, 0x88), Shuffle128(a0, b0, 0xdd),
+            Shuffle128(a1, b1, 0x88), Shuffle128(a1, b1, 0xdd),
+        };
+        for (int q = 0; q < 4; ++q) {
+            const size_t offset = 64 * (4 * q + r);
+            if (in) blocks[q] = Xor(blocks[q], _mm512_loadu_si512(in + offset));
+            _mm512_storeu_si512(out + offset, blocks[q]);
+        }
+    }
+}
+
+}
+
+#undef Rotl
+#undef UnpackLo32
+#undef UnpackHi32
+#undef UnpackLo64
+#undef UnpackHi64
+#undef Shuffle128
+
+#endif
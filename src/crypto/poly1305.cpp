@@ -5,8 +5,26 @@
 #include <crypto/common.h>
 #include <crypto/poly1305.h>
 
+#include <compat/cpuid.h>
+
+#include <cassert>
+#include <string>
 #include <string.h>
 
+namespace poly1305_avx2
+{
+size_t Blocks_4way(uint32_t h[5], const uint32_t r[5], const unsigned char* m, size_t bytes);
+}
+
+namespace {
+typedef size_t (*BlocksMultiType)(uint32_t*, const uint32_t*, const unsigned char*, size_t);
+
+BlocksMultiType Blocks_4way = nullptr;
+
+/** Below this many bytes, computing the powers of r for the 4-way code costs more than it saves. */
+constexpr size_t BLOCKS_4WAY_MIN_BYTES = 256;
+} // namespace
+
 namespace poly1305_donna {
 
 // Based on the public domain implementation by Andrew Moon
@@ -45,6 +63,12 @@ static void poly1305_blocks(poly1305_context *st, const unsigned char *m, size_t
     uint64_t d0,d1,d2,d3,d4;
     uint32_t c;
 
+    if (Blocks_4way && !st->final && bytes >= BLOCKS_4WAY_MIN_BYTES) {
+        const size_t done = Blocks_4way(st->h, st->r, m, bytes);
+        m += done;
+        bytes -= done;
+    }
+
     r0 = st->r[0];
     r1 = st->r[1];
     r2 = st->r[2];
@@ -221,3 +245,54 @@ void poly1305_update(poly1305_context *st, const unsigned char *m, size_t bytes)
 }
 
 }  // namespace poly1305_donna
+
+namespace {
+/** Check the selected implementation against the scalar code. */
+bool SelfTest()
+{
+    unsigned char key[32], msg[20 * POLY1305_BLOCK_SIZE + 5];
+    for (size_t i = 0; i < sizeof(key); ++i) key[i] = 0xff - i;
+    for (size_t i = 0; i < sizeof(msg); ++i) msg[i] = i * 7;
+    unsigned char tag[16], expected[16];
+    poly1305_donna::poly1305_context ctx;
+    poly1305_donna::poly1305_init(&ctx, key);
+    poly1305_donna::poly1305_update(&ctx, msg, sizeof(msg));
+    poly1305_donna::poly1305_finish(&ctx, tag);
+
+    const BlocksMultiType saved_4way = Blocks_4way;
+    Blocks_4way = nullptr;
+    poly1305_donna::poly1305_init(&ctx, key);
+    poly1305_donna::poly1305_update(&ctx, msg, sizeof(msg));
+    poly1305_donna::poly1305_finish(&ctx, expected);
+    Blocks_4way = saved_4way;
+    return memcmp(tag, expected, sizeof(tag)) == 0;
+}
+
+} // namespace
+
+std::string Poly1305AutoDetect([[maybe_unused]] poly1305_implementation::UseImplementation use_implementation)
+{
+    std::string ret = "standard";
+    Blocks_4way = nullptr;
+
+#if defined(HAVE_GETCPUID) && defined(ENABLE_AVX2)
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    const bool have_xsave = (ecx >> 27) & 1;
+    const bool have_avx = (ecx >> 28) & 1;
+    const uint32_t xcr0 = have_xsave && have_avx ? GetXCR0() : 0;
+    GetCPUID(0, 0, eax, ebx, ecx, edx);
+    if (eax >= 7) {
+        GetCPUID(7, 0, eax, ebx, ecx, edx);
+    } else {
+        ebx = 0;
+    }
+    if ((use_implementation & poly1305_implementation::USE_AVX2) && ((ebx >> 5) & 1) && (xcr0 & 0x6) == 0x6) {
+        Blocks_4way = poly1305_avx2::Blocks_4way;
+        ret = "avx2(4way)";
+    }
+#endif
+
+    assert(SelfTest());
+    return ret;
+}
@@ -10,6 +10,7 @@
 #include <cassert>
 #include <cstdlib>
 #include <stdint.h>
+#include <string>
 
 #define POLY1305_BLOCK_SIZE 16
 
@@ -67,4 +68,18 @@ public:
     }
 };
 
+namespace poly1305_implementation {
+enum UseImplementation : uint8_t {
+    STANDARD = 0,
+    USE_AVX2 = 1 << 0,
+    USE_ALL = USE_AVX2,
+};
+}
+
+/** Autodetect the best available Poly1305 implementation, which absorbs 4
+ *  blocks at once (AVX2) for long messages.
+ *  Returns the name of the implementation.
+ */
+std::string Poly1305AutoDetect(poly1305_implementation::UseImplementation use_implementation = poly1305_implementation::USE_ALL);
+
 #endif // BITCOIN_CRYPTO_POLY1305_H
@@ -0,0 +1,140 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <crypto/common.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+namespace poly1305_avx2 {
+namespace {
+
+constexpr uint32_t MASK26 = 0x3ffffff;
+//! The 2^128 bit, in the top limb.
+constexpr uint32_t HIBIT = 1UL << 24;
+
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi64(x, y); }
+__m256i inline Mul(__m256i x, __m256i y) { return _mm256_mul_epu32(x, y); }
+
+/** a = a * b mod 2^130-5, partially reduced, in radix 2^26 like poly1305-donna-32. */
+void MulMod(uint32_t a[5], const uint32_t b[5])
+{
+    const uint32_t s1 = b[1] * 5, s2 = b[2] * 5, s3 = b[3] * 5, s4 = b[4] * 5;
+    uint64_t d0 = (uint64_t)a[0] * b[0] + (uint64_t)a[1] * s4 + (uint64_t)a[2] * s3 + (uint64_t)a[3] * s2 + (uint64_t)a[4] * s1;
+    uint64_t d1 = (uint64_t)a[0] * b[1] + (uint64_t)a[1] * b[0] + (uint64_t)a[2] * s4 + (uint64_t)a[3] * s3 + (uint64_t)a[4] * s2;
+    uint64_t d2 = (uint64_t)a[0] * b[2] + (uint64_t)a[1] * b[1] + (uint64_t)a[2] * b[0] + (uint64_t)a[3] * s4 + (uint64_t)a[4] * s3;
+    uint64_t d3 = (uint64_t)a[0] * b[3] + (uint64_t)a[1] * b[2] + (uint64_t)a[2] * b[1] + (uint64_t)a[3] * b[0] + (uint64_t)a[4] * s4;
+    uint64_t d4 = (uint64_t)a[0] * b[4] + (uint64_t)a[1] * b[3] + (uint64_t)a[2] * b[2] + (uint64_t)a[3] * b[1] + (uint64_t)a[4] * b[0];
+    uint64_t c;
+                 c = d0 >> 26; a[0] = d0 & MASK26;
+    d1 += c;     c = d1 >> 26; a[1] = d1 & MASK26;
+    d2 += c;     c = d2 >> 26; a[2] = d2 & MASK26;
+    d3 += c;     c = d3 >> 26; a[3] = d3 & MASK26;
+    d4 += c;     c = d4 >> 26; a[4] = d4 & MASK26;
+    d0 = a[0] + c * 5; c = d0 >> 26; a[0] = d0 & MASK26;
+    a[1] += c;
+}
+
+/** Load the limbs of 4 consecutive message blocks, block j into 64-bit lane j. */
+void inline LoadBlocks(const unsigned char* m, __m256i limbs[5])
+{
+    limbs[0] = _mm256_setr_epi64x(ReadLE32(m + 0) & MASK26, ReadLE32(m + 16) & MASK26, ReadLE32(m + 32) & MASK26, ReadLE32(m + 48) & MASK26);
+    limbs[1] = _mm256_setr_epi64x((ReadLE32(m + 3) >> 2) & MASK26, (ReadLE32(m + 19) >> 2) & MASK26, (ReadLE32(m + 35) >> 2) & MASK26, (ReadLE32(m + 51) >> 2) & MASK26);
+    limbs[2] = _mm256_setr_epi64x((ReadLE32(m + 6) >> 4) & MASK26, (ReadLE32(m + 22) >> 4) & MASK26, (ReadLE32(m + 38) >> 4) & MASK26, (ReadLE32(m + 54) >> 4) & MASK26);
+    limbs[3] = _mm256_setr_epi64x((ReadLE32(m + 9) >> 6) & MASK26, (ReadLE32(m + 25) >> 6) & MASK26, (ReadLE32(m + 41) >> 6) & MASK26, (ReadLE32(m + 57) >> 6) & MASK26);
+    limbs[4] = _mm256_setr_epi64x((ReadLE32(m + 12) >> 8) | HIBIT, (ReadLE32(m + 28) >> 8) | HIBIT, (ReadLE32(m + 44) >> 8) | HIBIT, (ReadLE32(m + 60) >> 8) | HIBIT);
+}
+
+/** Multiply the 4 lanes of h by the 4 lanes of r (s = 5 * r), without carrying. */
+void inline Mul(const __m256i h[5], const __m256i r[5], const __m256i s[5], __m256i d[5])
+{
+    d[0] = Add(Add(Mul(h[0], r[0]), Mul(h[1], s[4])), Add(Add(Mul(h[2], s[3]), Mul(h[3], s[2])), Mul(h[4], s[1])));
+    d[1] = Add(Add(Mul(h[0], r[1]), Mul(h[1], r[0])), Add(Add(Mul(h[2], s[4]), Mul(h[3], s[3])), Mul(h[4], s[2])));
+    d[2] = Add(Add(Mul(h[0], r[2]), Mul(h[1], r[1])), Add(Add(Mul(h[2], r[0]), Mul(h[3], s[4])), Mul(h[4], s[3])));
+    d[3] = Add(Add(Mul(h[0], r[3]), Mul(h[1], r[2])), Add(Add(Mul(h[2], r[1]), Mul(h[3], r[0])), Mul(h[4], s[4])));
+    d[4] = Add(Add(Mul(h[0], r[4]), Mul(h[1], r[3])), Add(Add(Mul(h[2], r[2]), Mul(h[3], r[1])), Mul(h[4], r[0])));
+}
+
+}
+
+/** Absorb as many whole groups of 4 blocks of m as possible into the
+ *  accumulator h, given the clamped key r, both in radix 2^26 as in
+ *  poly1305-donna-32. Returns the number of bytes absorbed.
+ *
+ *  Block j of each group is accumulated in lane j, multiplied by r^4 per
+ *  group, and the lanes are combined at the end using r^4, r^3, r^2 and r:
+ *  (h + m0) * r^4 + m1 * r^3 + m2 * r^2 + m3 * r for a single group.
+ */
+size_t Blocks_4way(uint32_t h[5], const uint32_t r[5], const unsigned char* m, size_t bytes)
+{
+    const size_t groups = bytes / 64;
+    if (groups == 0) return 0;
+
+    uint32_t r2[5] = {r[0], r[1], r[2], r[3], r[4]};
+    MulMod(r2, r);
+    uint32_t r3[5] = {r2[0], r2[1], r2[2], r2[3], r2[4]};
+    MulMod(r3, r);
+    uint32_t r4[5] = {r3[0], r3[1], r3[2], r3[3], r3[4]};
+    MulMod(r4, r);
+
+    __m256i acc[5], d[5];
+    LoadBlocks(m, acc);
+    for (int i = 0; i < 5; ++i) {
+        acc[i] = Add(acc[i], _mm256_setr_epi64x(h[i], 0, 0, 0));
+    }
+
+    __m256i rv[5], sv[5];
+    const __m256i mask = _mm256_set1_epi64x(MASK26);
+    for (int i = 0; i < 5; ++i) {
+        rv[i] = _mm256_set1_epi64x(r4[i]);
+        sv[i] = _mm256_set1_epi64x(r4[i] * 5);
+    }
+    for (size_t group = 1; group < groups; ++group) {
+        __m256i msg[5];
+        LoadBlocks(m + 64 * group, msg);
+        Mul(acc, rv, sv, d);
+        // Partial reduction, as in the scalar code, but for all lanes at once.
+        __m256i c;
+                            c = _mm256_srli_epi64(d[0], 26); acc[0] = _mm256_and_si256(d[0], mask);
+        d[1] = Add(d[1], c); c = _mm256_srli_epi64(d[1], 26); acc[1] = _mm256_and_si256(d[1], mask);
+        d[2] = Add(d[2], c); c = _mm256_srli_epi64(d[2], 26); acc[2] = _mm256_and_si256(d[2], mask);
+        d[3] = Add(d[3], c); c = _mm256_srli_epi64(d[3], 26); acc[3] = _mm256_and_si256(d[3], mask);
+        d[4] = Add(d[4], c); c = _mm256_srli_epi64(d[4], 26); acc[4] = _mm256_and_si256(d[4], mask);
+        acc[0] = Add(acc[0], Add(c, _mm256_slli_epi64(c, 2)));
+        c = _mm256_srli_epi64(acc[0], 26); acc[0] = _mm256_and_si256(acc[0], mask);
+        acc[1] = Add(acc[1], c);
+        for (int i = 0; i < 5; ++i) {
+            acc[i] = Add(acc[i], msg[i]);
+        }
+    }
+
+    // Multiply lane j by r^(4-j), and sum the lanes.
+    for (int i = 0; i < 5; ++i) {
+        rv[i] = _mm256_setr_epi64x(r4[i], r3[i], r2[i], r[i]);
+        sv[i] = _mm256_setr_epi64x(r4[i] * 5, r3[i] * 5, r2[i] * 5, r[i] * 5);
+    }
+    Mul(acc, rv, sv, d);
+    uint64_t t[5];
+    for (int i = 0; i < 5; ++i) {
+        const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(d[i]), _mm256_extracti128_si256(d[i], 1));
+        t[i] = (uint64_t)_mm_cvtsi128_si64(sum) + (uint64_t)_mm_extract_epi64(sum, 1);
+    }
+    uint64_t c;
+                 c = t[0] >> 26; h[0] = t[0] & MASK26;
+    t[1] += c;   c = t[1] >> 26; h[1] = t[1] & MASK26;
+    t[2] += c;   c = t[2] >> 26; h[2] = t[2] & MASK26;
+    t[3] += c;   c = t[3] >> 26; h[3] = t[3] & MASK26;
+    t[4] += c;   c = t[4] >> 26; h[4] = t[4] & MASK26;
+    t[0] = h[0] + c * 5; c = t[0] >> 26; h[0] = t[0] & MASK26;
+    h[1] += c;
+
+    return 64 * groups;
+}
+
+}
+
+#endif
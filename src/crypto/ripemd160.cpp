@@ -290,3 +290,11 @@ CRIPEMD160& CRIPEMD160::Reset()
     ripemd160::Initialize(s);
     return *this;
 }
+
+void RIPEMD160Multi(unsigned char* output, const unsigned char* input, size_t len, size_t count)
+{
+    CRIPEMD160 hasher;
+    for (size_t i = 0; i < count; ++i) {
+        hasher.Reset().Write(input + len * i, len).Finalize(output + CRIPEMD160::OUTPUT_SIZE * i);
+    }
+}
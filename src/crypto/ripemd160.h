@@ -25,4 +25,10 @@ public:
     CRIPEMD160& Reset();
 };
 
+/** Compute the RIPEMD-160's of multiple independent messages of the same length.
+ *  output:  pointer to a count*20 byte output buffer
+ *  input:   pointer to count consecutive len byte messages
+ */
+void RIPEMD160Multi(unsigned char* output, const unsigned char* input, size_t len, size_t count);
+
 #endif // BITCOIN_CRYPTO_RIPEMD160_H
@@ -39,6 +39,11 @@ namespace sha256d64_avx2
 void Transform_8way(unsigned char* out, const unsigned char* in);
 }
 
+namespace sha256_avx2
+{
+void Transform_8way(uint32_t* s, const unsigned char* const chunk[8], size_t blocks);
+}
+
 namespace sha256d64_x86_shani
 {
 void Transform_2way(unsigned char* out, const unsigned char* in);
@@ -437,6 +442,7 @@ void TransformD64(unsigned char* out, const unsigned char* in)
 
 typedef void (*TransformType)(uint32_t*, const unsigned char*, size_t);
 typedef void (*TransformD64Type)(unsigned char*, const unsigned char*);
+typedef void (*TransformMultiType)(uint32_t*, const unsigned char* const*, size_t);
 
 template<TransformType tr>
 void TransformD64Wrapper(unsigned char* out, const unsigned char* in)
@@ -482,6 +488,7 @@ TransformD64Type TransformD64 = sha256::TransformD64;
 TransformD64Type TransformD64_2way = nullptr;
 TransformD64Type TransformD64_4way = nullptr;
 TransformD64Type TransformD64_8way = nullptr;
+TransformMultiType TransformMulti_8way = nullptr;
 
 bool SelfTest() {
     // Input state (equal to the initial SHA256 state)
@@ -565,20 +572,24 @@ bool SelfTest() {
         if (!std::equal(out, out + 256, result_d64)) return false;
     }
 
+    // Test TransformMulti_8way, if available. Stream i continues from the
+    // state after i chunks with chunk i, so every stream has different data.
+    if (TransformMulti_8way) {
+        uint32_t state[64];
+        const unsigned char* chunks[8];
+        for (size_t i = 0; i < 8; ++i) {
+            std::copy(result[i], result[i] + 8, state + 8 * i);
+            chunks[i] = data + 1 + 64 * i;
+        }
+        TransformMulti_8way(state, chunks, 1);
+        for (size_t i = 0; i < 8; ++i) {
+            if (!std::equal(state + 8 * i, state + 8 * i + 8, result[i + 1])) return false;
+        }
+    }
+
     return true;
 }
 
-#if !defined(DISABLE_OPTIMIZED_SHA256)
-#if (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
-/** Check whether the OS has enabled AVX registers. */
-bool AVXEnabled()
-{
-    uint32_t a, d;
-    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
-    return (a & 6) == 6;
-}
-#endif
-#endif // DISABLE_OPTIMIZED_SHA256
 } // namespace
 
 
@@ -590,6 +601,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
     TransformD64_2way = nullptr;
     TransformD64_4way = nullptr;
     TransformD64_8way = nullptr;
+    TransformMulti_8way = nullptr;
 
 #if !defined(DISABLE_OPTIMIZED_SHA256)
 #if defined(HAVE_GETCPUID)
@@ -608,7 +620,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
     have_xsave = (ecx >> 27) & 1;
     have_avx = (ecx >> 28) & 1;
     if (have_xsave && have_avx) {
-        enabled_avx = AVXEnabled();
+        enabled_avx = (GetXCR0() & 6) == 6;
     }
     if (have_sse4) {
         GetCPUID(7, 0, eax, ebx, ecx, edx);
@@ -646,6 +658,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
 #if defined(ENABLE_AVX2)
     if (have_avx2 && have_avx && enabled_avx) {
         TransformD64_8way = sha256d64_avx2::Transform_8way;
+        TransformMulti_8way = sha256_avx2::Transform_8way;
         ret += ",avx2(8way)";
     }
 #endif
@@ -779,3 +792,41 @@ void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
         --blocks;
     }
 }
+
+void SHA256Multi(unsigned char* output, const unsigned char* const* inputs, size_t len, size_t count)
+{
+    if (TransformMulti_8way) {
+        const size_t blocks = len / 64;
+        const size_t tail = len % 64;
+        // The remaining bytes, 0x80 and the 8-byte length need one or two more chunks.
+        const size_t last_blocks = tail < 56 ? 1 : 2;
+        while (count >= 8) {
+            uint32_t s[64];
+            unsigned char last[8][128] = {};
+            const unsigned char* last_chunks[8];
+            for (size_t i = 0; i < 8; ++i) {
+                sha256::Initialize(s + 8 * i);
+                if (tail) memcpy(last[i], inputs[i] + 64 * blocks, tail);
+                last[i][tail] = 0x80;
+                WriteBE64(last[i] + 64 * last_blocks - 8, uint64_t{len} << 3);
+                last_chunks[i] = last[i];
+            }
+            TransformMulti_8way(s, inputs, blocks);
+            TransformMulti_8way(s, last_chunks, last_blocks);
+            for (size_t i = 0; i < 8; ++i) {
+                for (size_t j = 0; j < 8; ++j) {
+                    WriteBE32(output + 32 * i + 4 * j, s[8 * i + j]);
+                }
+            }
+            output += 256;
+            inputs += 8;
+            count -= 8;
+        }
+    }
+    while (count) {
+        CSHA256().Write(*inputs, len).Finalize(output);
+        output += 32;
+        ++inputs;
+        --count;
+    }
+}
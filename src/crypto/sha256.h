@@ -50,4 +50,13 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
  */
 void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
+/** Compute the SHA256's of multiple independent messages of the same length,
+ *  eight at a time when a multi-buffer implementation is available.
+ *  output:  pointer to a count*32 byte output buffer
+ *  inputs:  pointer to count pointers to len byte messages
+ *  len:     the length of every message
+ *  count:   the number of hashes to compute.
+ */
+void SHA256Multi(unsigned char* output, const unsigned char* const* inputs, size_t len, size_t count);
+
 #endif // BITCOIN_CRYPTO_SHA256_H
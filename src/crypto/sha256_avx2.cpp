@@ -4,6 +4,7 @@
 
 #ifdef ENABLE_AVX2
 
+#include <stddef.h>
 #include <stdint.h>
 #include <immintrin.h>
 
@@ -326,4 +327,94 @@ void Transform_8way(unsigned char* out, const unsigned char* in)
 
 }
 
+namespace sha256_avx2 {
+namespace {
+
+using namespace sha256d64_avx2;
+
+constexpr uint32_t ROUND_CONSTANTS[64] = {
+    0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul, 0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+    0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul, 0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+    0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul, 0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+    0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul, 0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+    0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul, 0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+    0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul, 0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+    0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul, 0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+    0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul, 0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul,
+};
+
+/** Read the same big endian word from 8 independent chunks, chunk i ending up in element i. */
+__m256i inline Gather8(const unsigned char* const chunk[8], size_t offset) {
+    return _mm256_setr_epi32(
+        ReadBE32(chunk[0] + offset),
+        ReadBE32(chunk[1] + offset),
+        ReadBE32(chunk[2] + offset),
+        ReadBE32(chunk[3] + offset),
+        ReadBE32(chunk[4] + offset),
+        ReadBE32(chunk[5] + offset),
+        ReadBE32(chunk[6] + offset),
+        ReadBE32(chunk[7] + offset)
+    );
+}
+
+/** Message word t of the current block, expanding the schedule in place from round 16 on. */
+__m256i inline Schedule(__m256i w[16], int t) {
+    if (t >= 16) {
+        Inc(w[t & 15], sigma1(w[(t - 2) & 15]), w[(t - 7) & 15], sigma0(w[(t - 15) & 15]));
+    }
+    return w[t & 15];
+}
+
+}
+
+/** Run the SHA-256 compression function on 8 independent streams of @p blocks
+ *  64-byte chunks each. s holds the 8 states one after another (s[8 * i + j]
+ *  is word j of stream i), and chunk[i] points to the data of stream i.
+ */
+void Transform_8way(uint32_t* s, const unsigned char* const chunk[8], size_t blocks)
+{
+    __m256i state[8];
+    for (int j = 0; j < 8; ++j) {
+        state[j] = _mm256_setr_epi32(s[j], s[8 + j], s[16 + j], s[24 + j], s[32 + j], s[40 + j], s[48 + j], s[56 + j]);
+    }
+
+    for (size_t block = 0; block < blocks; ++block) {
+        __m256i w[16];
+        for (int t = 0; t < 16; ++t) {
+            w[t] = Gather8(chunk, 64 * block + 4 * t);
+        }
+
+        __m256i a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int t = 0; t < 64; t += 8) {
+            Round(a, b, c, d, e, f, g, h, Add(K(ROUND_CONSTANTS[t + 0]), Schedule(w, t + 0)));
+            Round(h, a, b, c, d, e, f, g, Add(K(ROUND_CONSTANTS[t + 1]), Schedule(w, t + 1)));
+            Round(g, h, a, b, c, d, e, f, Add(K(ROUND_CONSTANTS[t + 2]), Schedule(w, t + 2)));
+            Round(f, g, h, a, b, c, d, e, Add(K(ROUND_CONSTANTS[t + 3]), Schedule(w, t + 3)));
+            Round(e, f, g, h, a, b, c, d, Add(K(ROUND_CONSTANTS[t + 4]), Schedule(w, t + 4)));
+            Round(d, e, f, g, h, a, b, c, Add(K(ROUND_CONSTANTS[t + 5]), Schedule(w, t + 5)));
+            Round(c, d, e, f, g, h, a, b, Add(K(ROUND_CONSTANTS[t + 6]), Schedule(w, t + 6)));
+            Round(b, c, d, e, f, g, h, a, Add(K(ROUND_CONSTANTS[t + 7]), Schedule(w, t + 7)));
+        }
+
+        Inc(state[0], a);
+        Inc(state[1], b);
+        Inc(state[2], c);
+        Inc(state[3], d);
+        Inc(state[4], e);
+        Inc(state[5], f);
+        Inc(state[6], g);
+        Inc(state[7], h);
+    }
+
+    for (int j = 0; j < 8; ++j) {
+        alignas(32) uint32_t words[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(words), state[j]);
+        for (int i = 0; i < 8; ++i) {
+            s[8 * i + j] = words[i];
+        }
+    }
+}
+
+}
+
 #endif
@@ -11,8 +11,22 @@
 #include <algorithm>
 #include <array>
 #include <bit>
+#include <cassert>
 #include <cstdint>
 #include <span>
+#include <string>
+
+#include <compat/cpuid.h>
+
+namespace sha3_avx2
+{
+void KeccakF_4way(uint64_t* st);
+}
+
+namespace sha3_avx512
+{
+void KeccakF_8way(uint64_t* st);
+}
 
 void KeccakF(uint64_t (&st)[25])
 {
@@ -153,3 +167,184 @@ SHA3_256& SHA3_256::Reset()
     std::fill(std::begin(m_state), std::end(m_state), 0);
     return *this;
 }
+
+namespace {
+
+typedef void (*KeccakFMultiType)(uint64_t*);
+
+KeccakFMultiType KeccakF_4way = nullptr;
+KeccakFMultiType KeccakF_8way = nullptr;
+
+/** Run Keccak-f[1600] on the first lanes of an interleaved state, as laid out in SHAKEMulti. */
+void KeccakFLanes(uint64_t* st, size_t lanes)
+{
+    if (KeccakF_8way && (lanes > 4 || !KeccakF_4way)) {
+        KeccakF_8way(st);
+        return;
+    }
+    size_t lane = 0;
+    if (KeccakF_4way) {
+        // The state has room for MAX_LANES, so unused lanes can be permuted along.
+        for (; lane < lanes; lane += 4) {
+            KeccakF_4way(st + lane);
+        }
+    }
+    for (; lane < lanes; ++lane) {
+        uint64_t single[25];
+        for (int i = 0; i < 25; ++i) single[i] = st[SHAKEMulti::MAX_LANES * i + lane];
+        KeccakF(single);
+        for (int i = 0; i < 25; ++i) st[SHAKEMulti::MAX_LANES * i + lane] = single[i];
+    }
+}
+
+bool SelfTest()
+{
+    uint64_t st[25 * SHAKEMulti::MAX_LANES];
+    for (size_t i = 0; i < std::size(st); ++i) {
+        st[i] = 0x9e3779b97f4a7c15 * (i + 1);
+    }
+    uint64_t expected[25 * SHAKEMulti::MAX_LANES];
+    std::copy(std::begin(st), std::end(st), expected);
+    for (size_t lane = 0; lane < SHAKEMulti::MAX_LANES; ++lane) {
+        uint64_t single[25];
+        for (int i = 0; i < 25; ++i) single[i] = expected[SHAKEMulti::MAX_LANES * i + lane];
+        KeccakF(single);
+        for (int i = 0; i < 25; ++i) expected[SHAKEMulti::MAX_LANES * i + lane] = single[i];
+    }
+    KeccakFLanes(st, SHAKEMulti::MAX_LANES);
+    return std::equal(std::begin(st), std::end(st), expected);
+}
+
+} // namespace
+
+std::string SHA3AutoDetect([[maybe_unused]] sha3_implementation::UseImplementation use_implementation)
+{
+    std::string ret = "standard";
+    KeccakF_4way = nullptr;
+    KeccakF_8way = nullptr;
+
+#if defined(HAVE_GETCPUID)
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    const bool have_xsave = (ecx >> 27) & 1;
+    const bool have_avx = (ecx >> 28) & 1;
+    // YMM state, and additionally the opmask and ZMM state for AVX-512.
+    const uint32_t xcr0 = have_xsave && have_avx ? GetXCR0() : 0;
+    GetCPUID(0, 0, eax, ebx, ecx, edx);
+    const uint32_t max_leaf = eax;
+    if (max_leaf >= 7) {
+        GetCPUID(7, 0, eax, ebx, ecx, edx);
+    } else {
+        ebx = 0;
+    }
+    [[maybe_unused]] const bool have_avx2 = (use_implementation & sha3_implementation::USE_AVX2) && ((ebx >> 5) & 1) && (xcr0 & 0x6) == 0x6;
+    [[maybe_unused]] const bool have_avx512 = (use_implementation & sha3_implementation::USE_AVX512) && ((ebx >> 16) & 1) && (xcr0 & 0xe6) == 0xe6;
+
+#if defined(ENABLE_AVX2)
+    if (have_avx2) {
+        KeccakF_4way = sha3_avx2::KeccakF_4way;
+        ret = "avx2(4way)";
+    }
+#endif
+#if defined(ENABLE_AVX512)
+    if (have_avx512) {
+        KeccakF_8way = sha3_avx512::KeccakF_8way;
+        ret = KeccakF_4way ? ret + ",avx512(8way)" : "avx512(8way)";
+    }
+#endif
+#endif // defined(HAVE_GETCPUID)
+
+    assert(SelfTest());
+    return ret;
+}
+
+SHAKEMulti::SHAKEMulti(size_t rate, size_t lanes) : m_rate{rate}, m_lanes{lanes}
+{
+    assert(rate == SHAKE128_RATE || rate == SHAKE256_RATE);
+    assert(lanes >= 1 && lanes <= MAX_LANES);
+    Reset();
+}
+
+void SHAKEMulti::Permute()
+{
+    KeccakFLanes(m_state, m_lanes);
+}
+
+SHAKEMulti& SHAKEMulti::Absorb(std::span<const unsigned char* const> inputs, size_t len)
+{
+    assert(!m_squeezing);
+    assert(inputs.size() == m_lanes);
+    size_t offset = 0;
+    while (len) {
+        const size_t take = std::min(len, m_rate - m_pos);
+        for (size_t lane = 0; lane < m_lanes; ++lane) {
+            const unsigned char* in = inputs[lane] + offset;
+            for (size_t pos = m_pos; pos < m_pos + take;) {
+                if (pos % 8 == 0 && m_pos + take - pos >= 8) {
+                    m_state[MAX_LANES * (pos / 8) + lane] ^= ReadLE64(in);
+                    in += 8;
+                    pos += 8;
+                } else {
+                    m_state[MAX_LANES * (pos / 8) + lane] ^= uint64_t{*in++} << (8 * (pos % 8));
+                    ++pos;
+                }
+            }
+        }
+        m_pos += take;
+        offset += take;
+        len -= take;
+        if (m_pos == m_rate) {
+            Permute();
+            m_pos = 0;
+        }
+    }
+    return *this;
+}
+
+SHAKEMulti& SHAKEMulti::Squeeze(std::span<unsigned char* const> outputs, size_t len)
+{
+    assert(outputs.size() == m_lanes);
+    if (!m_squeezing) {
+        // SHAKE domain separation and padding.
+        for (size_t lane = 0; lane < m_lanes; ++lane) {
+            m_state[MAX_LANES * (m_pos / 8) + lane] ^= uint64_t{0x1f} << (8 * (m_pos % 8));
+            m_state[MAX_LANES * ((m_rate - 1) / 8) + lane] ^= 0x8000000000000000;
+        }
+        Permute();
+        m_pos = 0;
+        m_squeezing = true;
+    }
+    size_t offset = 0;
+    while (len) {
+        if (m_pos == m_rate) {
+            Permute();
+            m_pos = 0;
+        }
+        const size_t take = std::min(len, m_rate - m_pos);
+        for (size_t lane = 0; lane < m_lanes; ++lane) {
+            unsigned char* out = outputs[lane] + offset;
+            for (size_t pos = m_pos; pos < m_pos + take;) {
+                if (pos % 8 == 0 && m_pos + take - pos >= 8) {
+                    WriteLE64(out, m_state[MAX_LANES * (pos / 8) + lane]);
+                    out += 8;
+                    pos += 8;
+                } else {
+                    *out++ = m_state[MAX_LANES * (pos / 8) + lane] >> (8 * (pos % 8));
+                    ++pos;
+                }
+            }
+        }
+        m_pos += take;
+        offset += take;
+        len -= take;
+    }
+    return *this;
+}
+
+SHAKEMulti& SHAKEMulti::Reset()
+{
+    std::fill(std::begin(m_state), std::end(m_state), 0);
+    m_pos = 0;
+    m_squeezing = false;
+    return *this;
+}
@@ -9,6 +9,7 @@
 
 #include <cstdlib>
 #include <stdint.h>
+#include <string>
 
 //! The Keccak-f[1600] transform.
 void KeccakF(uint64_t (&st)[25]);
@@ -38,4 +39,58 @@ public:
     SHA3_256& Reset();
 };
 
+namespace sha3_implementation {
+enum UseImplementation : uint8_t {
+    STANDARD = 0,
+    USE_AVX2 = 1 << 0,
+    USE_AVX512 = 1 << 1,
+    USE_ALL = USE_AVX2 | USE_AVX512,
+};
+}
+
+/** Autodetect the best available multi-lane Keccak implementation.
+ *  Returns the name of the implementation.
+ */
+std::string SHA3AutoDetect(sha3_implementation::UseImplementation use_implementation = sha3_implementation::USE_ALL);
+
+/** SHAKE128 or SHAKE256 of up to MAX_LANES independent inputs at once.
+ *
+ * Every lane absorbs the same number of bytes and squeezes the same number of
+ * bytes, so that the Keccak permutations of all lanes can run in parallel on
+ * one vectorized implementation (8 lanes with AVX-512, 4 with AVX2). This
+ * suits uses like the expansion of a lattice matrix, where many
+ * equally sized seeds are each stretched into a stream of bytes.
+ */
+class SHAKEMulti
+{
+public:
+    static constexpr size_t MAX_LANES = 8;
+    static constexpr size_t SHAKE128_RATE = 168;
+    static constexpr size_t SHAKE256_RATE = 136;
+
+    //! Construct a sponge with the given rate in bytes (SHAKE128_RATE or SHAKE256_RATE) and number of lanes.
+    SHAKEMulti(size_t rate, size_t lanes);
+
+    /** Absorb len bytes into every lane, from inputs[i] for lane i. Must be
+     *  called before the first Squeeze(). */
+    SHAKEMulti& Absorb(std::span<const unsigned char* const> inputs, size_t len);
+    /** Squeeze len bytes from every lane into outputs[i] for lane i. Can be
+     *  called repeatedly to continue the output streams. */
+    SHAKEMulti& Squeeze(std::span<unsigned char* const> outputs, size_t len);
+    SHAKEMulti& Reset();
+
+    size_t Lanes() const { return m_lanes; }
+
+private:
+    //! Word i of lane j is m_state[MAX_LANES * i + j].
+    alignas(64) uint64_t m_state[25 * MAX_LANES];
+    size_t m_rate;
+    size_t m_lanes;
+    //! Position within the rate of the next byte to absorb or squeeze.
+    size_t m_pos{0};
+    bool m_squeezing{false};
+
+    void Permute();
+};
+
 #endif // BITCOIN_CRYPTO_SHA3_H
@@ -0,0 +1,170 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX512
+
+#include <stdint.h>
+#include <immintrin.h>
+
+namespace sha3_avx512 {
+namespace {
+
+constexpr uint64_t RNDC[24] = {
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000,
+    0x000000000000808b, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+    0x000000000000008a, 0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+    0x000000008000808b, 0x800000000000008b, 0x8000000000008089, 0x8000000000008003,
+    0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+    0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+};
+
+__m512i inline Xor(__m512i x, __m512i y) { return _mm512_xor_si512(x, y); }
+__m512i inline Xor(__m512i x, __m512i y, __m512i z) { return _mm512_ternarylogic_epi64(x, y, z, 0x96); }
+__m512i inline Xor(__m512i x, __m512i y, __m512i z, __m512i w, __m512i v) { return Xor(Xor(x, y, z), w, v); }
+//! x ^ (~y & z) in a single instruction.
+__m512i inline XorAndNot(__m512i x, __m512i y, __m512i z) { return _mm512_ternarylogic_epi64(x, y, z, 0xD2); }
+//! The rotation count must be an immediate, hence a macro. The masked form
+//! with all lanes selected avoids a spurious -Wuninitialized from GCC 12's
+//! definition of the unmasked one.
+#define Rotl(x, n) _mm512_mask_rol_epi64((x), 0xff, (x), (n))
+
+}
+
+/** Keccak-f[1600] on 8 independent states. Word i of state j is st[8 * i + j]. */
+void KeccakF_8way(uint64_t* st)
+{
+    __m512i a0 = _mm512_loadu_si512(st + 0);
+    __m512i a1 = _mm512_loadu_si512(st + 8);
+    __m512i a2 = _mm512_loadu_si512(st + 16);
+    __m512i a3 = _mm512_loadu_si512(st + 24);
+    __m512i a4 = _mm512_loadu_si512(st + 32);
+    __m512i a5 = _mm512_loadu_si512(st + 40);
+    __m512i a6 = _mm512_loadu_si512(st + 48);
+    __m512i a7 = _mm512_loadu_si512(st + 56);
+    __m512i a8 = _mm512_loadu_si512(st + 64);
+    __m512i a9 = _mm512_loadu_si512(st + 72);
+    __m512i a10 = _mm512_loadu_si512(st + 80);
+    __m512i a11 = _mm512_loadu_si512(st + 88);
+    __m512i a12 = _mm512_loadu_si512(st + 96);
+    __m512i a13 = _mm512_loadu_si512(st + 104);
+    __m512i a14 = _mm512_loadu_si512(st + 112);
+    __m512i a15 = _mm512_loadu_si512(st + 120);
+    __m512i a16 = _mm512_loadu_si512(st + 128);
+    __m512i a17 = _mm512_loadu_si512(st + 136);
+    __m512i a18 = _mm512_loadu_si512(st + 144);
+    __m512i a19 = _mm512_loadu_si512(st + 152);
+    __m512i a20 = _mm512_loadu_si512(st + 160);
+    __m512i a21 = _mm512_loadu_si512(st + 168);
+    __m512i a22 = _mm512_loadu_si512(st + 176);
+    __m512i a23 = _mm512_loadu_si512(st + 184);
+    __m512i a24 = _mm512_loadu_si512(st + 192);
+
+    for (int round = 0; round < 24; ++round) {
+        __m512i bc0, bc1, bc2, bc3, bc4, t;
+
+        // Theta
+        bc0 = Xor(a0, a5, a10, a15, a20);
+        bc1 = Xor(a1, a6, a11, a16, a21);
+        bc2 = Xor(a2, a7, a12, a17, a22);
+        bc3 = Xor(a3, a8, a13, a18, a23);
+        bc4 = Xor(a4, a9, a14, a19, a24);
+        t = Xor(bc4, Rotl(bc1, 1)); a0 = Xor(a0, t); a5 = Xor(a5, t); a10 = Xor(a10, t); a15 = Xor(a15, t); a20 = Xor(a20, t);
+        t = Xor(bc0, Rotl(bc2, 1)); a1 = Xor(a1, t); a6 = Xor(a6, t); a11 = Xor(a11, t); a16 = Xor(a16, t); a21 = Xor(a21, t);
+        t = Xor(bc1, Rotl(bc3, 1)); a2 = Xor(a2, t); a7 = Xor(a7, t); a12 = Xor(a12, t); a17 = Xor(a17, t); a22 = Xor(a22, t);
+        t = Xor(bc2, Rotl(bc4, 1)); a3 = Xor(a3, t); a8 = Xor(a8, t); a13 = Xor(a13, t); a18 = Xor(a18, t); a23 = Xor(a23, t);
+        t = Xor(bc3, Rotl(bc0, 1)); a4 = Xor(a4, t); a9 = Xor(a9, t); a14 = Xor(a14, t); a19 = Xor(a19, t); a24 = Xor(a24, t);
+
+        // Rho Pi
+        t = a1;
+        bc0 = a10; a10 = Rotl(t, 1); t = bc0;
+        bc0 = a7; a7 = Rotl(t, 3); t = bc0;
+        bc0 = a11; a11 = Rotl(t, 6); t = bc0;
+        bc0 = a17; a17 = Rotl(t, 10); t = bc0;
+        bc0 = a18; a18 = Rotl(t, 15); t = bc0;
+        bc0 = a3; a3 = Rotl(t, 21); t = bc0;
+        bc0 = a5; a5 = Rotl(t, 28); t = bc0;
+        bc0 = a16; a16 = Rotl(t, 36); t = bc0;
+        bc0 = a8; a8 = Rotl(t, 45); t = bc0;
+        bc0 = a21; a21 = Rotl(t, 55); t = bc0;
+        bc0 = a24; a24 = Rotl(t, 2); t = bc0;
+        bc0 = a4; a4 = Rotl(t, 14); t = bc0;
+        bc0 = a15; a15 = Rotl(t, 27); t = bc0;
+        bc0 = a23; a23 = Rotl(t, 41); t = bc0;
+        bc0 = a19; a19 = Rotl(t, 56); t = bc0;
+        bc0 = a13; a13 = Rotl(t, 8); t = bc0;
+        bc0 = a12; a12 = Rotl(t, 25); t = bc0;
+        bc0 = a2; a2 = Rotl(t, 43); t = bc0;
+        bc0 = a20; a20 = Rotl(t, 62); t = bc0;
+        bc0 = a14; a14 = Rotl(t, 18); t = bc0;
+        bc0 = a22; a22 = Rotl(t, 39); t = bc0;
+        bc0 = a9; a9 = Rotl(t, 61); t = bc0;
+        bc0 = a6; a6 = Rotl(t, 20); t = bc0;
+        a1 = Rotl(t, 44);
+
+        // Chi Iota
+        bc0 = a0; bc1 = a1; bc2 = a2; bc3 = a3; bc4 = a4;
+        a0 = XorAndNot(bc0, bc1, bc2);
+        a1 = XorAndNot(bc1, bc2, bc3);
+        a2 = XorAndNot(bc2, bc3, bc4);
+        a3 = XorAndNot(bc3, bc4, bc0);
+        a4 = XorAndNot(bc4, bc0, bc1);
+        bc0 = a5; bc1 = a6; bc2 = a7; bc3 = a8; bc4 = a9;
+        a5 = XorAndNot(bc0, bc1, bc2);
+        a6 = XorAndNot(bc1, bc2, bc3);
+        a7 = XorAndNot(bc2, bc3, bc4);
+        a8 = XorAndNot(bc3, bc4, bc0);
+        a9 = XorAndNot(bc4, bc0, bc1);
+        bc0 = a10; bc1 = a11; bc2 = a12; bc3 = a13; bc4 = a14;
+        a10 = XorAndNot(bc0, bc1, bc2);
+        a11 = XorAndNot(bc1, bc2, bc3);
+        a12 = XorAndNot(bc2, bc3, bc4);
+        a13 = XorAndNot(bc3, bc4, bc0);
+        a14 = XorAndNot(bc4, bc0, bc1);
+        bc0 = a15; bc1 = a16; bc2 = a17; bc3 = a18; bc4 = a19;
+        a15 = XorAndNot(bc0, bc1, bc2);
+        a16 = XorAndNot(bc1, bc2, bc3);
+        a17 = XorAndNot(bc2, bc3, bc4);
+        a18 = XorAndNot(bc3, bc4, bc0);
+        a19 = XorAndNot(bc4, bc0, bc1);
+        bc0 = a20; bc1 = a21; bc2 = a22; bc3 = a23; bc4 = a24;
+        a20 = XorAndNot(bc0, bc1, bc2);
+        a21 = XorAndNot(bc1, bc2, bc3);
+        a22 = XorAndNot(bc2, bc3, bc4);
+        a23 = XorAndNot(bc3, bc4, bc0);
+        a24 = XorAndNot(bc4, bc0, bc1);
+        a0 = Xor(a0, _mm512_set1_epi64(RNDC[round]));
+    }
+
+    _mm512_storeu_si512(st + 0, a0);
+    _mm512_storeu_si512(st + 8, a1);
+    _mm512_storeu_si512(st + 16, a2);
+    _mm512_storeu_si512(st + 24, a3);
+    _mm512_storeu_si512(st + 32, a4);
+    _mm512_storeu_si512(st + 40, a5);
+    _mm512_storeu_si512(st + 48, a6);
+    _mm512_storeu_si512(st + 56, a7);
+    _mm512_storeu_si512(st + 64, a8);
+    _mm512_storeu_si512(st + 72, a9);
+    _mm512_storeu_si512(st + 80, a10);
+    _mm512_storeu_si512(st + 88, a11);
+    _mm512_storeu_si512(st + 96, a12);
+    _mm512_storeu_si512(st + 104, a13);
+    _mm512_storeu_si512(st + 112, a14);
+    _mm512_storeu_si512(st + 120, a15);
+    _mm512_storeu_si512(st + 128, a16);
+    _mm512_storeu_si512(st + 136, a17);
+    _mm512_storeu_si512(st + 144, a18);
+    _mm512_storeu_si512(st + 152, a19);
+    _mm512_storeu_si512(st + 160, a20);
+    _mm512_storeu_si512(st + 168, a21);
+    _mm512_storeu_si512(st + 176, a22);
+    _mm512_storeu_si512(st + 184, a23);
+    _mm512_storeu_si512(st + 192, a24);
+}
+
+}
+
+#undef Rotl
+
+#endif
@@ -29,6 +29,7 @@
 #include <leveldb/status.h>
 #include <leveldb/write_batch.h>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <utility>
 
@@ -134,20 +135,22 @@ static void SetMaxOpenFiles(leveldb::Options *options) {
              options->max_open_files, default_open_files);
 }
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+static leveldb::Options GetOptions(size_t nCacheSize, const DBOptions& db_options)
 {
     leveldb::Options options;
     options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
-    options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
-    options.filter_policy = leveldb::NewBloomFilterPolicy(10);
-    options.compression = leveldb::kNoCompression;
+    // up to two write buffers may be held in memory simultaneously
+    options.write_buffer_size = db_options.write_buffer_bytes > 0 ? db_options.write_buffer_bytes : nCacheSize / 4;
+    options.block_size = db_options.block_size;
+    options.filter_policy = db_options.bloom_bits > 0 ? leveldb::NewBloomFilterPolicy(db_options.bloom_bits) : nullptr;
+    options.compression = db_options.compression && DBWRAPPER_COMPRESSION_SUPPORTED ? leveldb::kSnappyCompression : leveldb::kNoCompression;
     options.info_log = new CBitcoinLevelDBLogger();
     if (leveldb::kMajorVersion > 1 || (leveldb::kMajorVersion == 1 && leveldb::kMinorVersion >= 16)) {
         // LevelDB versions before 1.16 consider short writes to be corruption. Only trigger error
         // on corruption in later versions.
         options.paranoid_checks = true;
     }
-    options.max_file_size = std::max(options.max_file_size, DBWRAPPER_MAX_FILE_SIZE);
+    options.max_file_size = db_options.max_file_size;
     SetMaxOpenFiles(&options);
     return options;
 }
@@ -213,14 +216,14 @@ struct LevelDBContext {
 };
 
 CDBWrapper::CDBWrapper(const DBParams& params)
-    : m_db_context{std::make_unique<LevelDBContext>()}, m_name{fs::PathToString(params.path.stem())}, m_path{params.path}, m_is_memory{params.memory_only}
+    : m_db_context{std::make_unique<LevelDBContext>()}, m_name{fs::PathToString(params.path.stem())}, m_path{params.path}, m_is_memory{params.memory_only}, m_options{params.options}
 {
     DBContext().penv = nullptr;
     DBContext().readoptions.verify_checksums = true;
     DBContext().iteroptions.verify_checksums = true;
     DBContext().iteroptions.fill_cache = false;
     DBContext().syncoptions.sync = true;
-    DBContext().options = GetOptions(params.cache_bytes);
+    DBContext().options = GetOptions(params.cache_bytes, params.options);
     DBContext().options.create_if_missing = true;
     if (params.memory_only) {
         DBContext().penv = leveldb::NewMemEnv(leveldb::Env::Default());
@@ -241,6 +244,9 @@ CDBWrapper::CDBWrapper(const DBParams& params)
     leveldb::Status status = leveldb::DB::Open(DBContext().options, fs::PathToString(params.path), &DBContext().pdb);
     HandleError(status);
     LogPrintf("Opened LevelDB successfully\n");
+    LogDebug(BCLog::LEVELDB, "LevelDB %s using block_size=%u bloom_bits=%d write_buffer=%u compression=%u max_file_size=%u\n",
+             m_name, DBContext().options.block_size, params.options.bloom_bits, DBContext().options.write_buffer_size,
+             DBContext().options.compression != leveldb::kNoCompression, DBContext().options.max_file_size);
 
     if (params.options.force_compact) {
         LogPrintf("Starting database compaction of %s\n", fs::PathToString(params.path));
@@ -343,6 +349,78 @@ std::optional<std::string> CDBWrapper::ReadImpl(std::span<const std::byte> key)
     return strValue;
 }
 
+std::vector<std::optional<std::string>> CDBWrapper::ReadManyImpl(std::span<const std::span<const std::byte>> keys) const
+{
+    // Seeking costs a binary search in every level of the database, while
+    // stepping to the next entry is cheap. Step a few entries before giving up
+    // and seeking.
+    static constexpr int MAX_STEPS{8};
+
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return std::ranges::lexicographical_compare(keys[a], keys[b]);
+    });
+
+    // A key that shares at least half of its bytes with the key before or
+    // after it (like another output of the same transaction) is likely to be
+    // in the same block of the same table, and is found by moving an
+    // iterator. A key far from its neighbours is looked up on its own, which
+    // can skip the tables that don't have it using their bloom filters.
+    const auto close{[&](size_t a, size_t b) {
+        const auto [end_a, end_b]{std::ranges::mismatch(keys[a], keys[b])};
+        return 2 * size_t(end_a - keys[a].begin()) >= std::max(keys[a].size(), keys[b].size());
+    }};
+
+    // Read everything from the same snapshot, as a single Read() would.
+    leveldb::DB& db{*DBContext().pdb};
+    const auto release{[&db](const leveldb::Snapshot* snapshot) { db.ReleaseSnapshot(snapshot); }};
+    const std::unique_ptr<const leveldb::Snapshot, decltype(release)> snapshot{db.GetSnapshot(), release};
+    leveldb::ReadOptions readoptions{DBContext().readoptions};
+    readoptions.snapshot = snapshot.get();
+
+    std::vector<std::optional<std::string>> values(keys.size());
+    std::unique_ptr<leveldb::Iterator> it;
+    for (size_t pos{0}; pos < order.size(); ++pos) {
+        const size_t i{order[pos]};
+        const leveldb::Slice slKey(CharCast(keys[i].data()), keys[i].size());
+        if (!(pos > 0 && close(order[pos - 1], i)) && !(pos + 1 < order.size() && close(i, order[pos + 1]))) {
+            std::string strValue;
+            const leveldb::Status status{db.Get(readoptions, slKey, &strValue)};
+            if (status.ok()) {
+                values[i] = std::move(strValue);
+            } else if (!status.IsNotFound()) {
+                LogPrintf("LevelDB read failure: %s\n", status.ToString());
+                HandleError(status);
+            }
+            continue;
+        }
+        if (!it) {
+            it.reset(db.NewIterator(readoptions));
+            it->Seek(slKey);
+        }
+        // The iterator is at the first entry not before an earlier (smaller or
+        // equal) key, so it is already in place if it is not before this one.
+        for (int step{0}; step < MAX_STEPS && it->Valid() && it->key().compare(slKey) < 0; ++step) {
+            it->Next();
+        }
+        if (!it->Valid() || it->key().compare(slKey) < 0) {
+            it->Seek(slKey);
+        }
+        if (it->Valid() && it->key() == slKey) {
+            values[i] = it->value().ToString();
+        }
+    }
+    if (it) {
+        const leveldb::Status status{it->status()};
+        if (!status.ok()) {
+            LogPrintf("LevelDB read failure: %s\n", status.ToString());
+            HandleError(status);
+        }
+    }
+    return values;
+}
+
 bool CDBWrapper::ExistsImpl(std::span<const std::byte> key) const
 {
     leveldb::Slice slKey(CharCast(key.data()), key.size());
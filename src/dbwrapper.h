@@ -9,6 +9,7 @@
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <tinyformat.h>
 #include <util/check.h>
 #include <util/fs.h>
 
@@ -23,11 +24,26 @@
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
 static const size_t DBWRAPPER_MAX_FILE_SIZE = 32 << 20; // 32 MiB
+static const size_t DBWRAPPER_DEFAULT_BLOCK_SIZE = 4 << 10; // 4 KiB
+static const int DBWRAPPER_DEFAULT_BLOOM_BITS = 10;
+//! Whether leveldb can compress table blocks. The bundled leveldb is built
+//! without Snappy (HAVE_SNAPPY=0 in cmake/leveldb.cmake).
+static constexpr bool DBWRAPPER_COMPRESSION_SUPPORTED{false};
 
 //! User-controlled performance and debug options.
 struct DBOptions {
     //! Compact database on startup.
     bool force_compact = false;
+    //! Approximate size of user data packed per table block, in bytes.
+    size_t block_size = DBWRAPPER_DEFAULT_BLOCK_SIZE;
+    //! Bits per key of the bloom filter attached to each table, 0 to disable it.
+    int bloom_bits = DBWRAPPER_DEFAULT_BLOOM_BITS;
+    //! Size of the in-memory write buffer, in bytes. 0 derives it from the cache size.
+    size_t write_buffer_bytes = 0;
+    //! Compress table blocks. Only has an effect if DBWRAPPER_COMPRESSION_SUPPORTED.
+    bool compression = false;
+    //! Size at which leveldb switches to a new table file, in bytes.
+    size_t max_file_size = DBWRAPPER_MAX_FILE_SIZE;
 };
 
 //! Application-specific storage settings.
@@ -204,7 +220,11 @@ private:
     //! whether or not the database resides in memory
     bool m_is_memory;
 
+    //! the tuning this database was opened with
+    const DBOptions m_options;
+
     std::optional<std::string> ReadImpl(std::span<const std::byte> key) const;
+    std::vector<std::optional<std::string>> ReadManyImpl(std::span<const std::span<const std::byte>> keys) const;
     bool ExistsImpl(std::span<const std::byte> key) const;
     size_t EstimateSizeImpl(std::span<const std::byte> key1, std::span<const std::byte> key2) const;
     auto& DBContext() const LIFETIMEBOUND { return *Assert(m_db_context); }
@@ -216,6 +236,9 @@ public:
     CDBWrapper(const CDBWrapper&) = delete;
     CDBWrapper& operator=(const CDBWrapper&) = delete;
 
+    //! Options this database was opened with.
+    const DBOptions& GetDBOptions() const { return m_options; }
+
     template <typename K, typename V>
     bool Read(const K& key, V& value) const
     {
@@ -236,6 +259,47 @@ public:
         return true;
     }
 
+    /**
+     * Look up many keys at once, all from the same snapshot of the database.
+     * Keys are visited in database order. Keys close to each other (for
+     * example outputs of the same transaction) share an iterator that is
+     * moved from one to the next, while keys far from the others are read
+     * on their own, as with Read(), so the bloom filters can skip tables
+     * (see the CoinsDBReadBlock benchmarks).
+     *
+     * @returns one entry per key, in the order of the keys, that is
+     *          std::nullopt if the key is missing.
+     * @throws dbwrapper_error if a value fails to deserialize, as the
+     *         caller could not tell a corrupt entry from a missing one.
+     */
+    template <typename V, typename K>
+    std::vector<std::optional<V>> ReadMany(std::span<const K> keys) const
+    {
+        std::vector<DataStream> key_streams(keys.size());
+        std::vector<std::span<const std::byte>> key_spans;
+        key_spans.reserve(keys.size());
+        for (size_t i{0}; i < keys.size(); ++i) {
+            key_streams[i].reserve(DBWRAPPER_PREALLOC_KEY_SIZE);
+            key_streams[i] << keys[i];
+            key_spans.emplace_back(key_streams[i]);
+        }
+        std::vector<std::optional<std::string>> str_values{ReadManyImpl(key_spans)};
+        std::vector<std::optional<V>> values(keys.size());
+        for (size_t i{0}; i < keys.size(); ++i) {
+            if (!str_values[i]) continue;
+            try {
+                DataStream ssValue{MakeByteSpan(*str_values[i])};
+                ssValue.Xor(obfuscate_key);
+                V value;
+                ssValue >> value;
+                values[i] = std::move(value);
+            } catch (const std::exception& e) {
+                throw dbwrapper_error(strprintf("Failed to deserialize a value read from %s: %s", m_name, e.what()));
+            }
+        }
+        return values;
+    }
+
     template <typename K, typename V>
     bool Write(const K& key, const V& value, bool fSync = false)
     {
@@ -9,6 +9,7 @@
 
 #include <bit>
 #include <string>
+#include <vector>
 
 unsigned int MurmurHash3(unsigned int nHashSeed, std::span<const unsigned char> vDataToHash)
 {
@@ -82,6 +83,20 @@ uint256 SHA256Uint256(const uint256& input)
     return result;
 }
 
+std::vector<uint160> Hash160Multi(std::span<const unsigned char* const> inputs, size_t len)
+{
+    std::vector<unsigned char> sha(CSHA256::OUTPUT_SIZE * inputs.size());
+    std::vector<unsigned char> ripemd(CRIPEMD160::OUTPUT_SIZE * inputs.size());
+    SHA256Multi(sha.data(), inputs.data(), len, inputs.size());
+    RIPEMD160Multi(ripemd.data(), sha.data(), CSHA256::OUTPUT_SIZE, inputs.size());
+    std::vector<uint160> result;
+    result.reserve(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        result.emplace_back(std::span{ripemd}.subspan(CRIPEMD160::OUTPUT_SIZE * i, CRIPEMD160::OUTPUT_SIZE));
+    }
+    return result;
+}
+
 HashWriter TaggedHash(const std::string& tag)
 {
     HashWriter writer{};
@@ -120,6 +120,14 @@ inline uint160 Hash160(const T1& in1)
     return result;
 }
 
+/** Compute the 160-bit hashes of many objects of @p len bytes each.
+ *
+ * This uses the multi-buffer SHA256 implementation where available, which is
+ * considerably faster than calling Hash160 for each of them when hashing many
+ * long objects, like public keys.
+ */
+std::vector<uint160> Hash160Multi(std::span<const unsigned char* const> inputs, size_t len);
+
 /** A writer stream (for serialization) that computes a 256-bit hash. */
 class HashWriter
 {
@@ -18,12 +18,15 @@
 #include <walletinitinterface.h>
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using util::SplitString;
@@ -32,6 +35,26 @@ using util::TrimStringView;
 /** WWW-Authenticate to present with 401 Unauthorized response */
 static const char* WWW_AUTH_HEADER_DATA = "Basic realm=\"jsonrpc\"";
 
+/** Size of the parts a JSON reply is sent in, once it gets that large */
+static constexpr size_t JSON_REPLY_CHUNK_SIZE{1 << 20};
+
+/** Methods that read or compute large results, like blocks or the UTXO set.
+ * Calls to them run at low priority, so that they can't hold up other calls.
+ */
+static const std::set<std::string, std::less<>> LOW_PRIORITY_RPC_METHODS{
+    "dumptxoutset",
+    "getblock",
+    "getblockstats",
+    "getdescriptoractivity",
+    "getrawtransaction",
+    "getrawtransactions",
+    "gettxoutsetinfo",
+    "importdescriptors",
+    "rescanblockchain",
+    "scanblocks",
+    "scantxoutset",
+};
+
 /** Simple one-shot callback timer to be used by the RPC mechanism to e.g.
  * re-lock the wallet.
  */
@@ -90,11 +113,13 @@ static void JSONErrorReply(HTTPRequest* req, UniValue objError, const JSONRPCReq
         nStatus = HTTP_BAD_REQUEST;
     else if (code == RPC_METHOD_NOT_FOUND)
         nStatus = HTTP_NOT_FOUND;
+    else if (code == RPC_METHOD_BUSY)
+        nStatus = HTTP_SERVICE_UNAVAILABLE;
 
     std::string strReply = JSONRPCReplyObj(NullUniValue, std::move(objError), jreq.id, jreq.m_json_version).write() + "\n";
 
     req->WriteHeader("Content-Type", "application/json");
-    req->WriteReply(nStatus, strReply);
+    req->WriteReply(nStatus, std::move(strReply));
 }
 
 //This function checks username and password against -rpcauth
@@ -140,19 +165,146 @@ static bool RPCAuthorized(const std::string& strAuth, std::string& strAuthUserna
     return CheckUserAuthorized(user, pass);
 }
 
-static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
+/** Writes a JSON value as it serializes it, so that a large reply, like a
+ * block from getblock, doesn't have to be serialized into one string first.
+ * The output is the same as UniValue::write(). Replies that stay smaller than
+ * JSON_REPLY_CHUNK_SIZE are sent at once, and larger ones in parts.
+ */
+class JSONReplyWriter
+{
+private:
+    HTTPRequest& m_req;
+    std::string m_buffer;
+    bool m_streaming{false};
+    //! Whether the client still reads the reply
+    bool m_ok{true};
+
+    void Flush()
+    {
+        if (!m_streaming) {
+            m_req.StartReply(HTTP_OK);
+            m_streaming = true;
+        }
+        m_ok = m_req.WriteReplyChunk(std::as_bytes(std::span{m_buffer}));
+        m_buffer.clear();
+    }
+
+    void WriteString(std::string_view str)
+    {
+        if (str.size() <= JSON_REPLY_CHUNK_SIZE) {
+            m_buffer += UniValue{std::string{str}}.write();
+            return;
+        }
+        // Escape large strings, like the hex of a block, a slice at a time.
+        m_buffer += '"';
+        for (size_t pos{0}; pos < str.size() && m_ok; pos += JSON_REPLY_CHUNK_SIZE) {
+            const std::string quoted{UniValue{std::string{str.substr(pos, JSON_REPLY_CHUNK_SIZE)}}.write()};
+            m_buffer.append(quoted, 1, quoted.size() - 2);
+            Flush();
+        }
+        m_buffer += '"';
+    }
+
+public:
+    explicit JSONReplyWriter(HTTPRequest& req) : m_req{req} {}
+
+    void Write(const UniValue& value)
+    {
+        if (!m_ok) return;
+        switch (value.getType()) {
+        case UniValue::VOBJ:
+            m_buffer += '{';
+            for (size_t i{0}; i < value.size() && m_ok; ++i) {
+                if (i > 0) m_buffer += ',';
+                WriteString(value.getKeys()[i]);
+                m_buffer += ':';
+                Write(value.getValues()[i]);
+            }
+            m_buffer += '}';
+            break;
+        case UniValue::VARR:
+            m_buffer += '[';
+            for (size_t i{0}; i < value.size() && m_ok; ++i) {
+                if (i > 0) m_buffer += ',';
+                Write(value[i]);
+            }
+            m_buffer += ']';
+            break;
+        case UniValue::VSTR:
+            WriteString(value.get_str());
+            break;
+        default:
+            m_buffer += value.write();
+        }
+        if (m_buffer.size() >= JSON_REPLY_CHUNK_SIZE && m_ok) Flush();
+    }
+
+    /** Finish the reply. Don't use the request after calling this. */
+    void Finish()
+    {
+        m_buffer += '\n';
+        if (!m_streaming) {
+            m_req.WriteReply(HTTP_OK, std::move(m_buffer));
+            return;
+        }
+        if (m_ok) Flush();
+        m_req.EndReply();
+    }
+};
+
+void WriteJSONReply(HTTPRequest* req, const UniValue& value)
+{
+    req->WriteHeader("Content-Type", "application/json");
+    JSONReplyWriter writer{*req};
+    writer.Write(value);
+    writer.Finish();
+}
+
+/** Priority to run a call to a method at. Wallet calls are interactive, and
+ * control calls like getrpcinfo and stop must get through a busy server, so
+ * they run at high priority, unless they are one of the methods that run at
+ * low priority. */
+static HTTPPriority MethodPriority(std::string_view method)
+{
+    if (LOW_PRIORITY_RPC_METHODS.contains(method)) return HTTPPriority::LOW;
+    const auto category{tableRPC.getCategory(std::string{method})};
+    if (category == "wallet" || category == "control") return HTTPPriority::HIGH;
+    return HTTPPriority::NORMAL;
+}
+
+/** Priority to run a request at. A batch runs at the lowest priority of its
+ * calls. */
+static HTTPPriority RequestPriority(const UniValue& request)
+{
+    if (request.isObject()) {
+        const UniValue& method{request.find_value("method")};
+        return method.isStr() ? MethodPriority(method.get_str()) : HTTPPriority::NORMAL;
+    }
+    if (!request.isArray() || request.empty()) return HTTPPriority::NORMAL;
+    HTTPPriority priority{HTTPPriority::HIGH};
+    for (const UniValue& call : request.getValues()) {
+        priority = std::max(priority, call.isObject() ? RequestPriority(call) : HTTPPriority::NORMAL);
+    }
+    return priority;
+}
+
+static bool HTTPReq_JSONRPC(HTTPRequest* req, JSONRPCRequest jreq, const UniValue& valRequest);
+
+/** Read and authorize a JSON-RPC request, and dispatch it at the priority of
+ * the methods it calls. */
+static std::optional<HTTPDispatch> HTTPDispatch_JSONRPC(const std::any& context, HTTPRequest* req)
 {
     // JSONRPC handles only POST
     if (req->GetRequestMethod() != HTTPRequest::POST) {
         req->WriteReply(HTTP_BAD_METHOD, "JSONRPC server handles only POST requests");
-        return false;
+        return std::nullopt;
     }
     // Check authorization
     std::pair<bool, std::string> authHeader = req->GetHeader("authorization");
     if (!authHeader.first) {
         req->WriteHeader("WWW-Authenticate", WWW_AUTH_HEADER_DATA);
         req->WriteReply(HTTP_UNAUTHORIZED);
-        return false;
+        return std::nullopt;
     }
 
     JSONRPCRequest jreq;
@@ -168,15 +320,24 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
 
         req->WriteHeader("WWW-Authenticate", WWW_AUTH_HEADER_DATA);
         req->WriteReply(HTTP_UNAUTHORIZED);
-        return false;
+        return std::nullopt;
     }
 
-    try {
-        // Parse request
-        UniValue valRequest;
-        if (!valRequest.read(req->ReadBody()))
-            throw JSONRPCError(RPC_PARSE_ERROR, "Parse error");
+    // Parse request
+    UniValue valRequest;
+    if (!valRequest.read(req->ReadBody())) {
+        JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, "Parse error"), jreq);
+        return std::nullopt;
+    }
+    const HTTPPriority priority{RequestPriority(valRequest)};
+    return HTTPDispatch{priority, [jreq = std::move(jreq), valRequest = std::move(valRequest)](HTTPRequest* req, const std::string&) {
+        return HTTPReq_JSONRPC(req, jreq, valRequest);
+    }};
+}
 
+static bool HTTPReq_JSONRPC(HTTPRequest* req, JSONRPCRequest jreq, const UniValue& valRequest)
+{
+    try {
         // Set the URI
         jreq.URI = req->GetURI();
 
@@ -264,8 +425,7 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
         else
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
 
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, reply.write() + "\n");
+        WriteJSONReply(req, reply);
     } catch (UniValue& e) {
         JSONErrorReply(req, std::move(e), jreq);
         return false;
@@ -373,10 +533,10 @@ bool StartHTTPRPC(const std::any& context)
     if (!InitRPCAuthentication())
         return false;
 
-    auto handle_rpc = [context](HTTPRequest* req, const std::string&) { return HTTPReq_JSONRPC(context, req); };
-    RegisterHTTPHandler("/", true, handle_rpc);
+    auto dispatch_rpc = [context](HTTPRequest* req, const std::string&) { return HTTPDispatch_JSONRPC(context, req); };
+    RegisterHTTPDispatcher("/", true, dispatch_rpc);
     if (g_wallet_init_interface.HasWalletSupport()) {
-        RegisterHTTPHandler("/wallet/", false, handle_rpc);
+        RegisterHTTPDispatcher("/wallet/", false, dispatch_rpc);
     }
     struct event_base* eventBase = EventBase();
     assert(eventBase);
@@ -7,6 +7,9 @@
 
 #include <any>
 
+class HTTPRequest;
+class UniValue;
+
 /** Start HTTP RPC subsystem.
  * Precondition; HTTP and RPC has been started.
  */
@@ -19,6 +22,12 @@ void InterruptHTTPRPC();
  */
 void StopHTTPRPC();
 
+/** Send a JSON reply with status 200. Large replies are sent in parts as
+ * they are serialized.
+ * @note Like HTTPRequest::WriteReply, don't use the request after this.
+ */
+void WriteJSONReply(HTTPRequest* req, const UniValue& value);
+
 /** Start HTTP REST subsystem.
  * Precondition; HTTP and RPC has been started.
  */
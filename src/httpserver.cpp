@@ -17,8 +17,12 @@
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
 #include <util/threadnames.h>
+#include <util/time.h>
 #include <util/translation.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
@@ -49,6 +53,9 @@ using common::InvalidPortErrMsg;
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
 
+class HTTPWorkItem;
+static void EnqueueHTTPWork(std::unique_ptr<HTTPWorkItem> item, std::optional<HTTPPriority> priority, bool dispatched = false);
+
 /** HTTP request work item */
 class HTTPWorkItem final : public HTTPClosure
 {
@@ -57,8 +64,20 @@ public:
         req(std::move(_req)), path(_path), func(_func)
     {
     }
+    /** Work item that dispatches the request, and queues it again at the
+     * priority it was dispatched at. */
+    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, const std::string& _path, const HTTPRequestDispatcher& _dispatcher):
+        req(std::move(_req)), path(_path), dispatcher(_dispatcher)
+    {
+    }
     void operator()() override
     {
+        if (dispatcher) {
+            if (auto dispatch{dispatcher(req.get(), path)}) {
+                EnqueueHTTPWork(std::make_unique<HTTPWorkItem>(std::move(req), path, dispatch->handler), dispatch->priority, /*dispatched=*/true);
+            }
+            return;
+        }
         func(req.get(), path);
     }
 
@@ -67,36 +86,70 @@ public:
 private:
     std::string path;
     HTTPRequestHandler func;
+    HTTPRequestDispatcher dispatcher;
 };
 
-/** Simple work queue for distributing work over multiple threads.
- * Work items are simply callable objects.
+/** Work queue for distributing work over multiple threads.
+ * Work items are simply callable objects, queued by priority. Items that
+ * dispatch a request, which only read it to find its priority, are taken
+ * first, and then items of higher priority. HIGH priority items, and NORMAL
+ * and LOW priority items together, each run on at most maxBusy threads at
+ * once, so that neither can hold up the other by occupying every thread.
+ * LOW priority items run on at most maxBusyLow threads, so that they can't
+ * hold up NORMAL priority ones either.
  */
 template <typename WorkItem>
 class WorkQueue
 {
 private:
+    //! Index of the queue of items that dispatch a request, after the queues
+    //! of each priority
+    static constexpr size_t DISPATCH{size_t(HTTPPriority::LOW) + 1};
+
     Mutex cs;
     std::condition_variable cond GUARDED_BY(cs);
-    std::deque<std::unique_ptr<WorkItem>> queue GUARDED_BY(cs);
+    std::array<std::deque<std::unique_ptr<WorkItem>>, DISPATCH + 1> queues GUARDED_BY(cs);
+    //! Number of threads running items, by queue
+    std::array<size_t, DISPATCH + 1> busy GUARDED_BY(cs){};
+    //! Number of items in all queues
+    size_t depth GUARDED_BY(cs){0};
     bool running GUARDED_BY(cs){true};
     const size_t maxDepth;
+    const size_t maxBusy;
+    const size_t maxBusyLow;
+
+    /** Return the queue to take the next item of, if any can be run now. */
+    std::optional<size_t> NextQueue() EXCLUSIVE_LOCKS_REQUIRED(cs)
+    {
+        constexpr size_t high{size_t(HTTPPriority::HIGH)}, normal{size_t(HTTPPriority::NORMAL)}, low{size_t(HTTPPriority::LOW)};
+        if (!queues[DISPATCH].empty()) return DISPATCH;
+        if (!queues[high].empty() && busy[high] < maxBusy) return high;
+        if (busy[normal] + busy[low] >= maxBusy) return std::nullopt;
+        if (!queues[normal].empty()) return normal;
+        if (!queues[low].empty() && busy[low] < maxBusyLow) return low;
+        return std::nullopt;
+    }
 
 public:
-    explicit WorkQueue(size_t _maxDepth) : maxDepth(_maxDepth)
+    /** maxDepth limits the number of items in all queues together. */
+    WorkQueue(size_t _maxDepth, size_t _maxBusy, size_t _maxBusyLow)
+        : maxDepth(_maxDepth), maxBusy(_maxBusy), maxBusyLow(_maxBusyLow)
     {
     }
     /** Precondition: worker threads have all stopped (they have been joined).
      */
     ~WorkQueue() = default;
-    /** Enqueue a work item */
-    bool Enqueue(WorkItem* item) EXCLUSIVE_LOCKS_REQUIRED(!cs)
+    /** Enqueue a work item at a priority, or without one to dispatch a
+     * request. The item of a request that was dispatched already was counted
+     * against maxDepth when it was first queued, and isn't rejected again. */
+    bool Enqueue(WorkItem* item, std::optional<HTTPPriority> priority, bool dispatched = false) EXCLUSIVE_LOCKS_REQUIRED(!cs)
     {
         LOCK(cs);
-        if (!running || queue.size() >= maxDepth) {
+        if (!running || (!dispatched && depth >= maxDepth)) {
             return false;
         }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
+        queues[priority ? size_t(*priority) : DISPATCH].emplace_back(std::unique_ptr<WorkItem>(item));
+        ++depth;
         cond.notify_one();
         return true;
     }
@@ -105,16 +158,28 @@ public:
     {
         while (true) {
             std::unique_ptr<WorkItem> i;
+            size_t queue;
             {
                 WAIT_LOCK(cs, lock);
-                while (running && queue.empty())
+                std::optional<size_t> next;
+                // Items that can't be taken yet are run by another thread
+                // after the items of their priority that it's running.
+                while (!(next = NextQueue()) && (running || depth > 0))
                     cond.wait(lock);
-                if (!running && queue.empty())
+                if (!next)
                     break;
-                i = std::move(queue.front());
-                queue.pop_front();
+                queue = *next;
+                i = std::move(queues[queue].front());
+                queues[queue].pop_front();
+                --depth;
+                ++busy[queue];
             }
             (*i)();
+            {
+                LOCK(cs);
+                --busy[queue];
+                cond.notify_one();
+            }
         }
     }
     /** Interrupt and exit loops */
@@ -128,13 +193,20 @@ public:
 
 struct HTTPPathHandler
 {
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPPriority _priority):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), priority(_priority)
+    {
+    }
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestDispatcher _dispatcher):
+        prefix(_prefix), exactMatch(_exactMatch), dispatcher(_dispatcher)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPPriority priority{HTTPPriority::NORMAL};
+    //! Set instead of handler and priority for requests that are dispatched
+    HTTPRequestDispatcher dispatcher;
 };
 
 /** HTTP module state */
@@ -152,6 +224,10 @@ static GlobalMutex g_httppathhandlers_mutex;
 static std::vector<HTTPPathHandler> pathHandlers GUARDED_BY(g_httppathhandlers_mutex);
 //! Bound listening sockets
 static std::vector<evhttp_bound_socket *> boundSockets;
+//! How long a streamed reply waits for the client to read before giving up
+static std::chrono::seconds g_reply_stall_timeout{DEFAULT_HTTP_SERVER_TIMEOUT};
+//! How often a streamed reply that waits for the client checks for shutdown
+static constexpr auto REPLY_WAIT_INTERVAL{100ms};
 
 /**
  * @brief Helps keep track of open `evhttp_connection`s with active `evhttp_requests`
@@ -260,6 +336,12 @@ std::string RequestMethodString(HTTPRequest::RequestMethod m)
     assert(false);
 }
 
+/** Connection close callback, while no reply is being streamed */
+static void http_connection_close_cb(evhttp_connection* conn, void*)
+{
+    g_requests.RemoveConnection(conn);
+}
+
 /** HTTP request callback */
 static void http_request_cb(struct evhttp_request* req, void* arg)
 {
@@ -270,9 +352,7 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
         evhttp_request_set_on_complete_cb(req, [](struct evhttp_request* req, void*) {
             g_requests.RemoveRequest(req);
         }, nullptr);
-        evhttp_connection_set_closecb(conn, [](evhttp_connection* conn, void* arg) {
-            g_requests.RemoveConnection(conn);
-        }, nullptr);
+        evhttp_connection_set_closecb(conn, http_connection_close_cb, nullptr);
     }
 
     // Disable reading to work around a libevent bug, fixed in 2.1.9
@@ -327,19 +407,28 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
-        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
-        assert(g_work_queue);
-        if (g_work_queue->Enqueue(item.get())) {
-            item.release(); /* if true, queue took ownership */
+        if (i->dispatcher) {
+            EnqueueHTTPWork(std::make_unique<HTTPWorkItem>(std::move(hreq), path, i->dispatcher), std::nullopt);
         } else {
-            LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
-            item->req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Work queue depth exceeded");
+            EnqueueHTTPWork(std::make_unique<HTTPWorkItem>(std::move(hreq), path, i->handler), i->priority);
         }
     } else {
         hreq->WriteReply(HTTP_NOT_FOUND);
     }
 }
 
+/** Queue a request for a worker thread, or reply that the server is busy */
+static void EnqueueHTTPWork(std::unique_ptr<HTTPWorkItem> item, std::optional<HTTPPriority> priority, bool dispatched)
+{
+    assert(g_work_queue);
+    if (g_work_queue->Enqueue(item.get(), priority, dispatched)) {
+        item.release(); /* if true, queue took ownership */
+    } else {
+        LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
+        item->req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Work queue depth exceeded");
+    }
+}
+
 /** Callback to reject HTTP requests after shutdown. */
 static void http_reject_request_cb(struct evhttp_request* req, void*)
 {
@@ -480,7 +569,12 @@ bool InitHTTPServer(const util::SignalInterrupt& interrupt)
     int workQueueDepth = std::max((long)gArgs.GetIntArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
     LogDebug(BCLog::HTTP, "creating work queue of depth %d\n", workQueueDepth);
 
-    g_work_queue = std::make_unique<WorkQueue<HTTPClosure>>(workQueueDepth);
+    // Keep one worker thread for high priority requests, and one for the
+    // others, if there is more than one, and let low priority requests use at
+    // most half of the others.
+    int rpcThreads = std::max((long)gArgs.GetIntArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
+    g_work_queue = std::make_unique<WorkQueue<HTTPClosure>>(workQueueDepth, std::max(rpcThreads - 1, 1), std::max((rpcThreads - 1) / 2, 1));
+    g_reply_stall_timeout = std::chrono::seconds{std::max(gArgs.GetIntArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT), int64_t{1})};
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -600,7 +694,9 @@ HTTPRequest::HTTPRequest(struct evhttp_request* _req, const util::SignalInterrup
 
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (m_stream) {
+        EndReply();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL_SERVER_ERROR, "Unhandled request");
@@ -646,14 +742,42 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
     evhttp_add_header(headers, hdr.c_str(), value.c_str());
 }
 
+/** Re-enable reading from the socket. This is the second part of the libevent
+ * workaround in http_request_cb.
+ */
+static void http_reenable_read(evhttp_request* req)
+{
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02010900) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 /** Closure sent to main thread to request a reply to be sent to
  * a HTTP request.
  * Replies must be sent in the main loop in the main http thread,
  * this cannot be done from worker threads.
  */
+void HTTPRequest::SendReply(int nStatus)
+{
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
+        evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
+        http_reenable_read(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
 void HTTPRequest::WriteReply(int nStatus, std::span<const std::byte> reply)
 {
-    assert(!replySent && req);
+    assert(!replySent && req && !m_stream);
     if (m_interrupt) {
         WriteHeader("Connection", "close");
     }
@@ -661,24 +785,141 @@ void HTTPRequest::WriteReply(int nStatus, std::span<const std::byte> reply)
     struct evbuffer* evb = evhttp_request_get_output_buffer(req);
     assert(evb);
     evbuffer_add(evb, reply.data(), reply.size());
+    SendReply(nStatus);
+}
+
+void HTTPRequest::WriteReply(int nStatus, std::string&& reply)
+{
+    if (reply.empty()) return WriteReply(nStatus, std::string_view{});
+    assert(!replySent && req && !m_stream);
+    if (m_interrupt) {
+        WriteHeader("Connection", "close");
+    }
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    auto body{std::make_unique<std::string>(std::move(reply))};
+    if (evbuffer_add_reference(evb, body->data(), body->size(), [](const void*, size_t, void* arg) {
+            delete static_cast<std::string*>(arg);
+        }, body.get()) == 0) {
+        body.release(); // the buffer frees it once sent
+    } else {
+        evbuffer_add(evb, body->data(), body->size());
+    }
+    SendReply(nStatus);
+}
+
+/** Reply being streamed with HTTPRequest::WriteReplyChunk. */
+struct HTTPReplyStream
+{
+    Mutex mutex;
+    std::condition_variable cond;
+    //! Bytes passed to WriteReplyChunk
+    uint64_t produced GUARDED_BY(mutex){0};
+    //! Bytes written to the client
+    uint64_t written GUARDED_BY(mutex){0};
+    //! Set when the connection closed before the reply was finished
+    bool closed GUARDED_BY(mutex){false};
+
+    // Only accessed by the main thread:
+    //! Bytes handed to libevent
+    uint64_t submitted{0};
+    //! Keeps the stream alive for the libevent callbacks, until the reply is
+    //! finished or the connection closes.
+    std::shared_ptr<HTTPReplyStream> self;
+};
+
+/** Connection close callback while a reply is streamed */
+static void http_stream_close_cb(evhttp_connection* conn, void* arg)
+{
+    const auto stream{std::move(static_cast<HTTPReplyStream*>(arg)->self)};
+    WITH_LOCK(stream->mutex, stream->closed = true);
+    stream->cond.notify_all();
+    http_connection_close_cb(conn, nullptr);
+}
+
+/** Called when all chunks handed to libevent so far are written to the client */
+static void http_stream_written_cb(evhttp_connection*, void* arg)
+{
+    auto& stream{*static_cast<HTTPReplyStream*>(arg)};
+    WITH_LOCK(stream.mutex, stream.written = stream.submitted);
+    stream.cond.notify_all();
+}
+
+void HTTPRequest::StartReply(int nStatus)
+{
+    assert(!replySent && req && !m_stream);
+    if (m_interrupt) {
+        WriteHeader("Connection", "close");
+    }
+    m_stream = std::make_shared<HTTPReplyStream>();
+    m_stream->self = m_stream;
     auto req_copy = req;
-    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
-        evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02010900) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
+    auto* stream = m_stream.get();
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus, stream]{
+        evhttp_connection_set_closecb(evhttp_request_get_connection(req_copy), http_stream_close_cb, stream);
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+}
+
+bool HTTPRequest::WriteReplyChunk(std::span<const std::byte> chunk)
+{
+    assert(!replySent && req && m_stream);
+    if (chunk.empty()) return true;
+    {
+        WAIT_LOCK(m_stream->mutex, lock);
+        // Give up if the client stops reading for longer than
+        // -rpcservertimeout, and on shutdown, when nothing may be written
+        // anymore.
+        auto deadline{SteadyClock::now() + g_reply_stall_timeout};
+        uint64_t written{m_stream->written};
+        while (!m_stream->closed && m_stream->produced - m_stream->written >= MAX_HTTP_REPLY_BUFFERED) {
+            if (m_interrupt) return false;
+            if (m_stream->written != written) {
+                written = m_stream->written;
+                deadline = SteadyClock::now() + g_reply_stall_timeout;
+            } else if (SteadyClock::now() >= deadline) {
+                LogDebug(BCLog::HTTP, "Client stopped reading the reply to %s, giving up\n", SanitizeString(GetURI(), SAFE_CHARS_URI).substr(0, 100));
+                return false;
             }
+            m_stream->cond.wait_for(lock, REPLY_WAIT_INTERVAL);
+        }
+        if (m_stream->closed) return false;
+        m_stream->produced += chunk.size();
+    }
+    struct evbuffer* buf = evbuffer_new();
+    assert(buf);
+    evbuffer_add(buf, chunk.data(), chunk.size());
+    auto req_copy = req;
+    auto stream = m_stream;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, buf, stream]{
+        // The request was freed if the connection closed.
+        if (!WITH_LOCK(stream->mutex, return stream->closed)) {
+            stream->submitted += evbuffer_get_length(buf);
+            evhttp_send_reply_chunk_with_cb(req_copy, buf, http_stream_written_cb, stream.get());
         }
+        evbuffer_free(buf);
+    });
+    ev->trigger(nullptr);
+    return true;
+}
+
+void HTTPRequest::EndReply()
+{
+    assert(!replySent && req && m_stream);
+    auto req_copy = req;
+    auto stream = m_stream;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, stream]{
+        if (WITH_LOCK(stream->mutex, return stream->closed)) return;
+        evhttp_connection_set_closecb(evhttp_request_get_connection(req_copy), http_connection_close_cb, nullptr);
+        stream->self.reset();
+        http_reenable_read(req_copy);
+        evhttp_send_reply_end(req_copy);
     });
     ev->trigger(nullptr);
     replySent = true;
     req = nullptr; // transferred back to main thread
+    m_stream.reset();
 }
 
 CService HTTPRequest::GetPeer() const
@@ -756,11 +997,18 @@ std::optional<std::string> GetQueryParameterFromUri(const char* uri, const std::
     return result;
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, HTTPPriority priority)
+{
+    LogDebug(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d, priority %d)\n", prefix, exactMatch, int(priority));
+    LOCK(g_httppathhandlers_mutex);
+    pathHandlers.emplace_back(prefix, exactMatch, handler, priority);
+}
+
+void RegisterHTTPDispatcher(const std::string& prefix, bool exactMatch, const HTTPRequestDispatcher& dispatcher)
 {
-    LogDebug(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
+    LogDebug(BCLog::HTTP, "Registering HTTP dispatcher for %s (exactmatch %d)\n", prefix, exactMatch);
     LOCK(g_httppathhandlers_mutex);
-    pathHandlers.emplace_back(prefix, exactMatch, handler);
+    pathHandlers.emplace_back(prefix, exactMatch, dispatcher);
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
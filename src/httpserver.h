@@ -5,7 +5,9 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <cstddef>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <span>
 #include <string>
@@ -27,10 +29,18 @@ static const int DEFAULT_HTTP_WORKQUEUE=64;
 
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
 
+/**
+ * Maximum number of bytes of a reply sent with HTTPRequest::WriteReplyChunk
+ * that may be waiting to be written to the client, before the worker thread
+ * producing it has to wait.
+ */
+static constexpr size_t MAX_HTTP_REPLY_BUFFERED{4 << 20};
+
 struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+struct HTTPReplyStream;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -51,11 +61,43 @@ void UpdateHTTPServerLogging(bool enable);
 
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+
+/** Priority of a request.
+ * Worker threads take queued requests of higher priority first. Neither HIGH
+ * priority requests, nor NORMAL and LOW priority requests together, occupy all
+ * worker threads when there is more than one, so that neither can hold up the
+ * other. LOW priority requests occupy at most half of the threads left.
+ */
+enum class HTTPPriority {
+    HIGH,   //!< Interactive requests, like wallet RPCs
+    NORMAL,
+    LOW,    //!< Bulk requests, like fetching blocks
+};
+
+/** Priority a request was dispatched at, and the handler to run it with */
+struct HTTPDispatch {
+    HTTPPriority priority;
+    HTTPRequestHandler handler;
+};
+
+/** Dispatcher for requests to a certain HTTP path, for requests whose
+ * priority is only known once they are read. Returns nothing if it replied
+ * to the request already.
+ */
+typedef std::function<std::optional<HTTPDispatch>(HTTPRequest* req, const std::string&)> HTTPRequestDispatcher;
+
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
  * be invoked.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler,
+                         HTTPPriority priority = HTTPPriority::NORMAL);
+/** Register dispatcher for prefix.
+ * Requests are dispatched by worker threads ahead of any queued requests,
+ * and then queued again at the priority they were dispatched at.
+ * Unregister it with UnregisterHTTPHandler.
+ */
+void RegisterHTTPDispatcher(const std::string& prefix, bool exactMatch, const HTTPRequestDispatcher& dispatcher);
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
@@ -73,6 +115,11 @@ private:
     struct evhttp_request* req;
     const util::SignalInterrupt& m_interrupt;
     bool replySent;
+    //! State of a reply started with StartReply(), shared with the main thread
+    std::shared_ptr<HTTPReplyStream> m_stream;
+
+    /** Hand the reply in the output buffer to the main thread. */
+    void SendReply(int nStatus);
 
 public:
     explicit HTTPRequest(struct evhttp_request* req, const util::SignalInterrupt& interrupt, bool replySent = false);
@@ -142,7 +189,37 @@ public:
     {
         WriteReply(nStatus, std::as_bytes(std::span{reply}));
     }
+    void WriteReply(int nStatus, const char* reply)
+    {
+        WriteReply(nStatus, std::string_view{reply});
+    }
     void WriteReply(int nStatus, std::span<const std::byte> reply);
+    /** Write HTTP reply, handing the string to the reply instead of copying it. */
+    void WriteReply(int nStatus, std::string&& reply);
+
+    /**
+     * Start a reply whose body is sent in parts with WriteReplyChunk() as it
+     * is produced, using chunked transfer encoding, instead of being built in
+     * memory and handed over at once. Write headers before calling this.
+     */
+    void StartReply(int nStatus);
+
+    /**
+     * Send the next part of a reply started with StartReply(). Waits while
+     * more than MAX_HTTP_REPLY_BUFFERED bytes are waiting to be written to
+     * the client. Returns false if the client disconnected or stopped
+     * reading for longer than -rpcservertimeout, or the server is shutting
+     * down, after which producing the rest of the reply is pointless.
+     */
+    bool WriteReplyChunk(std::span<const std::byte> chunk);
+
+    /**
+     * Finish a reply started with StartReply().
+     *
+     * @note Like WriteReply, this gives the request back to the main thread,
+     * do not call any other HTTPRequest methods after calling this.
+     */
+    void EndReply();
 };
 
 /** Get the query parameter value from request uri for a specified key, or std::nullopt if the key
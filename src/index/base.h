@@ -13,6 +13,7 @@
 #include <validationinterface.h>
 
 #include <string>
+#include <string_view>
 
 class CBlock;
 class CBlockIndex;
@@ -27,6 +28,7 @@ struct IndexSummary {
     bool synced{false};
     int best_block_height{0};
     uint256 best_block_hash;
+    DBOptions db_options;
 };
 
 /**
@@ -52,7 +54,7 @@ protected:
     class DB : public CDBWrapper
     {
     public:
-        DB(const fs::path& path, size_t n_cache_size,
+        DB(std::string_view db_type, const fs::path& path, size_t n_cache_size,
            bool f_memory = false, bool f_wipe = false, bool f_obfuscate = false);
 
         /// Read block locator of the chain that the index is in sync with.
@@ -107,6 +109,8 @@ protected:
 
     void ChainStateFlushed(ChainstateRole role, const CBlockLocator& locator) override;
 
+    std::string ValidationInterfaceName() const override { return m_name; }
+
     /// Initialize internal state from the database and block index.
     [[nodiscard]] virtual bool CustomInit(const std::optional<interfaces::BlockRef>& block) { return true; }
 
@@ -11,6 +11,11 @@
 #include <node/blockstorage.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <optional>
+#include <tuple>
+#include <vector>
+
 constexpr uint8_t DB_TXINDEX{'t'};
 
 std::unique_ptr<TxIndex> g_txindex;
@@ -26,12 +31,16 @@ public:
     /// transaction hash is not indexed.
     bool ReadTxPos(const uint256& txid, CDiskTxPos& pos) const;
 
+    /// Read the disk locations of many transactions in one batch, std::nullopt for those that are
+    /// not indexed.
+    std::vector<std::optional<CDiskTxPos>> ReadTxPositions(std::span<const uint256> txids) const;
+
     /// Write a batch of transaction positions to the DB.
     [[nodiscard]] bool WriteTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos);
 };
 
 TxIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
-    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "txindex", n_cache_size, f_memory, f_wipe)
+    BaseIndex::DB("txindex", gArgs.GetDataDirNet() / "indexes" / "txindex", n_cache_size, f_memory, f_wipe)
 {}
 
 bool TxIndex::DB::ReadTxPos(const uint256 &txid, CDiskTxPos& pos) const
@@ -39,6 +48,14 @@ bool TxIndex::DB::ReadTxPos(const uint256 &txid, CDiskTxPos& pos) const
     return Read(std::make_pair(DB_TXINDEX, txid), pos);
 }
 
+std::vector<std::optional<CDiskTxPos>> TxIndex::DB::ReadTxPositions(std::span<const uint256> txids) const
+{
+    std::vector<std::pair<uint8_t, uint256>> keys;
+    keys.reserve(txids.size());
+    for (const auto& txid : txids) keys.emplace_back(DB_TXINDEX, txid);
+    return ReadMany<CDiskTxPos>(std::span<const std::pair<uint8_t, uint256>>{keys});
+}
+
 bool TxIndex::DB::WriteTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos)
 {
     CDBBatch batch(*this);
@@ -78,7 +95,48 @@ bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRe
     if (!m_db->ReadTxPos(tx_hash, postx)) {
         return false;
     }
+    return ReadTx(postx, tx_hash, block_hash, tx);
+}
+
+std::vector<CTransactionRef> TxIndex::FindTxs(std::span<const uint256> tx_hashes, std::vector<uint256>& block_hashes) const
+{
+    // Look up and read each distinct transaction once.
+    std::vector<uint256> unique_hashes(tx_hashes.begin(), tx_hashes.end());
+    std::sort(unique_hashes.begin(), unique_hashes.end());
+    unique_hashes.erase(std::unique(unique_hashes.begin(), unique_hashes.end()), unique_hashes.end());
+
+    const auto positions{m_db->ReadTxPositions(unique_hashes)};
+    std::vector<CTransactionRef> unique_txs(unique_hashes.size());
+    std::vector<uint256> unique_block_hashes(unique_hashes.size());
+
+    // Read the transactions in the order they are stored on disk.
+    std::vector<size_t> order;
+    for (size_t i{0}; i < positions.size(); ++i) {
+        if (positions[i]) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const CDiskTxPos& pa{*positions[a]};
+        const CDiskTxPos& pb{*positions[b]};
+        return std::tie(pa.nFile, pa.nPos, pa.nTxOffset) < std::tie(pb.nFile, pb.nPos, pb.nTxOffset);
+    });
+    for (const size_t i : order) {
+        if (!ReadTx(*positions[i], unique_hashes[i], unique_block_hashes[i], unique_txs[i])) unique_txs[i] = nullptr;
+    }
 
+    std::vector<CTransactionRef> txs;
+    txs.reserve(tx_hashes.size());
+    block_hashes.clear();
+    block_hashes.reserve(tx_hashes.size());
+    for (const auto& tx_hash : tx_hashes) {
+        const size_t i = std::lower_bound(unique_hashes.begin(), unique_hashes.end(), tx_hash) - unique_hashes.begin();
+        txs.push_back(unique_txs[i]);
+        block_hashes.push_back(unique_block_hashes[i]);
+    }
+    return txs;
+}
+
+bool TxIndex::ReadTx(const CDiskTxPos& postx, const uint256& tx_hash, uint256& block_hash, CTransactionRef& tx) const
+{
     AutoFile file{m_chainstate->m_blockman.OpenBlockFile(postx, true)};
     if (file.IsNull()) {
         LogError("%s: OpenBlockFile failed\n", __func__);
@@ -7,6 +7,11 @@
 
 #include <index/base.h>
 
+#include <span>
+#include <vector>
+
+struct CDiskTxPos;
+
 static constexpr bool DEFAULT_TXINDEX{false};
 
 /**
@@ -24,6 +29,9 @@ private:
 
     bool AllowPrune() const override { return false; }
 
+    /// Read the transaction at a known disk location, checking its hash.
+    bool ReadTx(const CDiskTxPos& postx, const uint256& tx_hash, uint256& block_hash, CTransactionRef& tx) const;
+
 protected:
     bool CustomAppend(const interfaces::BlockInfo& block) override;
 
@@ -43,6 +51,14 @@ public:
     /// @param[out]  tx  The transaction itself.
     /// @return  true if transaction is found, false otherwise
     bool FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRef& tx) const;
+
+    /// Look up many transactions by hash. The index is queried in one batch and
+    /// the transactions are read from the block files in the order they are stored.
+    ///
+    /// @param[in]   tx_hashes  The hashes of the transactions to be returned.
+    /// @param[out]  block_hashes  For each hash, the hash of the block the transaction is found in.
+    /// @return  For each hash, the transaction, or nullptr if it is not found.
+    std::vector<CTransactionRef> FindTxs(std::span<const uint256> tx_hashes, std::vector<uint256>& block_hashes) const;
 };
 
 /// The global transaction index, used in GetTransaction. May be null.
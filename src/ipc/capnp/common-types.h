@@ -7,6 +7,10 @@
 
 #include <clientversion.h>
 #include <interfaces/types.h>
+#include <ipc/capnp/common.capnp.h>
+#include <ipc/exception.h>
+#include <ipc/sharedmemory.h>
+#include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
 #include <streams.h>
@@ -27,6 +31,7 @@
 #include <mp/type-struct.h>
 #include <mp/type-threadmap.h>
 #include <mp/type-vector.h>
+#include <optional>
 #include <type_traits>
 #include <utility>
 
@@ -45,6 +50,17 @@ auto Wrap(S& s)
     return ParamsStream{s, TX_WITH_WITNESS};
 }
 
+//! Capability keeping a shared memory segment offered to the process holding
+//! it. The offer is withdrawn when that process releases the capability.
+class SharedMemoryServer final : public messages::SharedMemory::Server
+{
+public:
+    explicit SharedMemoryServer(SharedMemoryOffer&& offer) : m_offer{std::move(offer)} {}
+
+private:
+    SharedMemoryOffer m_offer;
+};
+
 //! Detect if type has a deserialize_type constructor, which is
 //! used to deserialize types like CTransaction that can't be unserialized into
 //! existing objects because they are immutable.
@@ -107,6 +123,72 @@ requires ipc::capnp::Deserializable<LocalType>
     return read_dest.construct(::deserialize, wrapper);
 }
 
+//! Overload CustomBuildField and CustomReadField to pass large blocks through
+//! shared memory when -ipcsharedmemory is enabled, for fields declared as
+//! Payload. The block is serialized directly into a sealed memfd segment, and
+//! only the socket and token to fetch its descriptor are sent. Smaller blocks,
+//! and blocks that can't be shared, are copied inline. CBlock fields declared
+//! as Data use the Priority<1> hooks above.
+template <typename Value, typename Output>
+void CustomBuildField(TypeList<CBlock>, Priority<2>, InvokeContext& invoke_context, Value&& value, Output&& output)
+requires std::is_same_v<std::decay_t<decltype(output.get())>, ipc::capnp::messages::Payload::Builder>
+{
+    auto payload = output.init();
+    const size_t size{::GetSerializeSize(TX_WITH_WITNESS(value))};
+    if (size >= ipc::SHARED_MEMORY_MIN_SIZE && ipc::SharedMemoryEnabled()) {
+        auto segment{ipc::SharedMemorySegment::Create(size, [&](std::span<std::byte> buffer) {
+            SpanWriter stream{buffer};
+            auto wrapper{ipc::capnp::Wrap(stream)};
+            value.Serialize(wrapper);
+        })};
+        auto offer{segment ? ipc::SharedMemoryOffer::Create(std::move(*segment)) : std::nullopt};
+        if (offer) {
+            payload.setSocket(offer->address().c_str());
+            auto token = payload.initToken(offer->token().size());
+            memcpy(token.begin(), offer->token().data(), offer->token().size());
+            // Capabilities have to be created on the event loop thread.
+            invoke_context.connection.m_loop.sync([&] {
+                payload.setSegment(kj::heap<ipc::capnp::SharedMemoryServer>(std::move(*offer)));
+            });
+            return;
+        }
+    }
+    DataStream stream;
+    auto wrapper{ipc::capnp::Wrap(stream)};
+    value.Serialize(wrapper);
+    auto data = payload.initData(stream.size());
+    memcpy(data.begin(), stream.data(), stream.size());
+}
+
+template <typename Input, typename ReadDest>
+decltype(auto) CustomReadField(TypeList<CBlock>, Priority<2>, InvokeContext& invoke_context, Input&& input, ReadDest&& read_dest)
+requires std::is_same_v<std::decay_t<decltype(input.get())>, ipc::capnp::messages::Payload::Reader>
+{
+    return read_dest.update([&](auto& value) {
+        if (!input.has()) return;
+        auto payload = input.get();
+        if (!payload.hasSegment()) {
+            auto data = payload.getData();
+            SpanReader stream({data.begin(), data.end()});
+            auto wrapper{ipc::capnp::Wrap(stream)};
+            value.Unserialize(wrapper);
+            return;
+        }
+        // Segments are only mapped if this process asked for shared memory.
+        if (!ipc::SharedMemoryEnabled()) {
+            throw ipc::Exception("Received a block in shared memory, which requires -ipcsharedmemory");
+        }
+        // The segment stays offered while the message holding the capability
+        // is being read.
+        auto token = payload.getToken();
+        const ipc::SharedMemoryMapping mapping{std::string_view{payload.getSocket().cStr(), payload.getSocket().size()},
+                                               std::span{reinterpret_cast<const std::byte*>(token.begin()), token.size()}};
+        SpanReader stream{UCharSpanCast(mapping.data())};
+        auto wrapper{ipc::capnp::Wrap(stream)};
+        value.Unserialize(wrapper);
+    });
+}
+
 //! Overload CustomBuildField and CustomReadField to serialize UniValue
 //! parameters and return values as JSON strings.
 template <typename Value, typename Output>
@@ -0,0 +1,32 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_IPC_CAPNP_MINING_CLIENT_H
+#define BITCOIN_IPC_CAPNP_MINING_CLIENT_H
+
+#include <interfaces/mining.h>
+#include <ipc/capnp/mining.capnp.h>
+#include <primitives/block.h>
+
+#include <mp/proxy.h>
+
+namespace mp {
+//! Client side of BlockTemplate, customized to pick the method getBlock()
+//! calls. With -ipcsharedmemory, blocks are requested as a Payload
+//! (getBlockPayload), which large blocks are passed in shared memory with.
+//! Otherwise, and on connections where that fails, for example because the
+//! server predates getBlockPayload, they are requested as inline Data
+//! (getBlockData). A connection falls back once, and then keeps using
+//! getBlockData.
+template <>
+class ProxyClientCustom<ipc::capnp::messages::BlockTemplate, interfaces::BlockTemplate>
+    : public ProxyClientBase<ipc::capnp::messages::BlockTemplate, interfaces::BlockTemplate>
+{
+public:
+    using ProxyClientBase::ProxyClientBase;
+    CBlock getBlock() override;
+};
+} // namespace mp
+
+#endif // BITCOIN_IPC_CAPNP_MINING_CLIENT_H
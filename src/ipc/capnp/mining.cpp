@@ -5,9 +5,55 @@
 #include <ipc/capnp/mining-types.h>
 #include <ipc/capnp/mining.capnp.proxy-types.h>
 
+#include <ipc/exception.h>
+#include <ipc/sharedmemory.h>
+#include <logging.h>
+#include <sync.h>
+
 #include <mp/proxy-types.h>
 
+#include <set>
+
 namespace mp {
+namespace {
+//! Connections that pass blocks as inline Data only. Connections are removed
+//! when they are destroyed, so their addresses can be reused.
+Mutex g_inline_blocks_mutex;
+std::set<const Connection*> g_inline_blocks_connections GUARDED_BY(g_inline_blocks_mutex);
+
+bool InlineBlocksOnly(const Connection& connection) EXCLUSIVE_LOCKS_REQUIRED(!g_inline_blocks_mutex)
+{
+    LOCK(g_inline_blocks_mutex);
+    return g_inline_blocks_connections.contains(&connection);
+}
+
+void SetInlineBlocksOnly(Connection& connection) EXCLUSIVE_LOCKS_REQUIRED(!g_inline_blocks_mutex)
+{
+    if (!WITH_LOCK(g_inline_blocks_mutex, return g_inline_blocks_connections.insert(&connection).second)) return;
+    connection.addSyncCleanup([&connection] {
+        LOCK(g_inline_blocks_mutex);
+        g_inline_blocks_connections.erase(&connection);
+    });
+}
+} // namespace
+
+CBlock ProxyClientCustom<ipc::capnp::messages::BlockTemplate, interfaces::BlockTemplate>::getBlock()
+{
+    auto& client{static_cast<ProxyClient<ipc::capnp::messages::BlockTemplate>&>(*this)};
+    Connection* connection{m_context.connection};
+    if (connection && ipc::SharedMemoryEnabled() && !InlineBlocksOnly(*connection)) {
+        try {
+            return client.getBlockPayload();
+        } catch (const ipc::Exception& e) {
+            // Nothing to fall back to if the connection is gone.
+            if (!m_context.connection) throw;
+            LogDebug(BCLog::IPC, "Falling back to inline blocks on this connection: %s\n", e.what());
+            SetInlineBlocksOnly(*connection);
+        }
+    }
+    return client.getBlockData();
+}
+
 void CustomBuildMessage(InvokeContext& invoke_context,
                         const BlockValidationState& src,
                         ipc::capnp::messages::BlockValidationState::Builder&& builder)
@@ -0,0 +1,334 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bitcoin-build-config.h> // IWYU pragma: keep
+
+#include <ipc/sharedmemory.h>
+
+#include <common/args.h>
+#include <ipc/exception.h>
+#include <logging.h>
+#include <random.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <util/strencodings.h>
+#include <util/syserror.h>
+#include <util/thread.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <utility>
+
+#if HAVE_DECL_MEMFD_CREATE
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace ipc {
+namespace {
+#if HAVE_DECL_MEMFD_CREATE && defined(F_ADD_SEALS)
+constexpr int REQUIRED_SEALS{F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL};
+//! How long either side waits for the other while a descriptor is passed.
+constexpr int DESCRIPTOR_TIMEOUT_SECONDS{5};
+
+//! Address of the abstract Unix socket with the given name, which is not a
+//! path and disappears with the socket.
+socklen_t MakeAbstractAddress(std::string_view name, sockaddr_un& addr)
+{
+    if (name.size() + 1 > sizeof(addr.sun_path)) {
+        throw Exception(strprintf("Shared memory socket name %s is too long", name));
+    }
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path + 1, name.data(), name.size());
+    return offsetof(sockaddr_un, sun_path) + 1 + name.size();
+}
+
+//! Set send and receive timeouts, and check that the peer runs as the same
+//! user as this process.
+bool PrepareSocket(int fd)
+{
+    const timeval timeout{DESCRIPTOR_TIMEOUT_SECONDS, 0};
+    ucred cred;
+    socklen_t cred_len{sizeof(cred)};
+    return setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0 &&
+           setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == 0 &&
+           getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) == 0 &&
+           cred.uid == geteuid();
+}
+
+//! Thread serving the descriptors of the segments offered by this process.
+//! Each connection sends the token of a segment, and gets back a status byte
+//! with the descriptor attached if the segment is still offered.
+class DescriptorServer
+{
+public:
+    //! Return the server of this process, starting it on first use, or
+    //! nullptr if it could not be started. The server is never stopped, so
+    //! offers can outlive static destructors.
+    static DescriptorServer* Get()
+    {
+        static DescriptorServer* const server{Start()};
+        return server;
+    }
+
+    const std::string m_address;
+
+    void Add(const SharedMemoryOffer::Token& token, int fd) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        m_segments.emplace(token, fd);
+    }
+
+    void Remove(const SharedMemoryOffer::Token& token) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        m_segments.erase(token);
+    }
+
+private:
+    DescriptorServer(int listen_fd, std::string address) : m_address{std::move(address)}, m_listen_fd{listen_fd} {}
+
+    static DescriptorServer* Start()
+    {
+        const int fd{socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)};
+        if (fd < 0) {
+            LogDebug(BCLog::IPC, "Could not create shared memory socket: %s\n", SysErrorString(errno));
+            return nullptr;
+        }
+        std::array<unsigned char, 8> name;
+        GetRandBytes(name);
+        std::string address{strprintf("qbtc-ipc-%d-%s", getpid(), HexStr(name))};
+        sockaddr_un addr;
+        const socklen_t addr_len{MakeAbstractAddress(address, addr)};
+        if (bind(fd, reinterpret_cast<const sockaddr*>(&addr), addr_len) != 0 || listen(fd, SOMAXCONN) != 0) {
+            LogDebug(BCLog::IPC, "Could not listen on shared memory socket: %s\n", SysErrorString(errno));
+            close(fd);
+            return nullptr;
+        }
+        auto* server{new DescriptorServer{fd, std::move(address)}};
+        std::thread{&util::TraceThread, "ipcshm", [server] { server->Run(); }}.detach();
+        return server;
+    }
+
+    void Run() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            const int fd{accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC)};
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                LogDebug(BCLog::IPC, "Shared memory socket failed: %s\n", SysErrorString(errno));
+                return;
+            }
+            Serve(fd);
+            close(fd);
+        }
+    }
+
+    void Serve(int fd) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        SharedMemoryOffer::Token token;
+        if (!PrepareSocket(fd) || recv(fd, token.data(), token.size(), 0) != ssize_t(token.size())) return;
+        // The lock keeps the offer, and so the descriptor, from going away
+        // until it has been sent.
+        LOCK(m_mutex);
+        const auto it{m_segments.find(token)};
+        unsigned char status{it != m_segments.end()};
+        iovec iov{&status, sizeof(status)};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        if (status) {
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            cmsghdr* cmsg{CMSG_FIRSTHDR(&msg)};
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(cmsg), &it->second, sizeof(int));
+        }
+        if (sendmsg(fd, &msg, MSG_NOSIGNAL) < 0) {
+            LogDebug(BCLog::IPC, "Could not send shared memory segment: %s\n", SysErrorString(errno));
+        }
+    }
+
+    const int m_listen_fd;
+    Mutex m_mutex;
+    std::map<SharedMemoryOffer::Token, int> m_segments GUARDED_BY(m_mutex);
+};
+
+//! Fetch the descriptor of a segment offered by another process.
+int FetchDescriptor(std::string_view address, std::span<const std::byte> token)
+{
+    if (token.size() != SHARED_MEMORY_TOKEN_SIZE) {
+        throw Exception("Invalid shared memory segment token");
+    }
+    sockaddr_un addr;
+    const socklen_t addr_len{MakeAbstractAddress(address, addr)};
+    const int sock{socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)};
+    if (sock < 0) {
+        throw Exception(strprintf("Could not create shared memory socket: %s", SysErrorString(errno)));
+    }
+    unsigned char status{0};
+    iovec iov{&status, sizeof(status)};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    const bool received{connect(sock, reinterpret_cast<const sockaddr*>(&addr), addr_len) == 0 && PrepareSocket(sock) &&
+                        send(sock, token.data(), token.size(), MSG_NOSIGNAL) == ssize_t(token.size()) &&
+                        recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) == sizeof(status)};
+    const int error{errno};
+    close(sock);
+    int fd{-1};
+    for (cmsghdr* cmsg{CMSG_FIRSTHDR(&msg)}; received && cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS && cmsg->cmsg_len == CMSG_LEN(sizeof(int))) {
+            std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+    if (!received) {
+        throw Exception(strprintf("Could not fetch shared memory segment from %s: %s", address, SysErrorString(error)));
+    }
+    if (fd < 0 || !status) {
+        if (fd >= 0) close(fd);
+        throw Exception(strprintf("Shared memory segment is no longer offered by %s", address));
+    }
+    return fd;
+}
+#endif
+} // namespace
+
+bool SharedMemoryEnabled()
+{
+#if HAVE_DECL_MEMFD_CREATE && defined(F_ADD_SEALS)
+    return gArgs.GetBoolArg("-ipcsharedmemory", DEFAULT_IPC_SHARED_MEMORY);
+#else
+    return false;
+#endif
+}
+
+std::optional<SharedMemorySegment> SharedMemorySegment::Create(size_t size, const std::function<void(std::span<std::byte>)>& fill)
+{
+#if HAVE_DECL_MEMFD_CREATE && defined(F_ADD_SEALS)
+    if (size == 0) return std::nullopt;
+    SharedMemorySegment segment{memfd_create("qbtc-ipc", MFD_CLOEXEC | MFD_ALLOW_SEALING)};
+    if (segment.m_fd < 0) {
+        LogDebug(BCLog::IPC, "Could not create shared memory segment: %s\n", SysErrorString(errno));
+        return std::nullopt;
+    }
+    if (ftruncate(segment.m_fd, size) != 0) {
+        LogDebug(BCLog::IPC, "Could not size shared memory segment to %u bytes: %s\n", size, SysErrorString(errno));
+        return std::nullopt;
+    }
+    void* addr{mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, segment.m_fd, 0)};
+    if (addr == MAP_FAILED) {
+        LogDebug(BCLog::IPC, "Could not map shared memory segment: %s\n", SysErrorString(errno));
+        return std::nullopt;
+    }
+    try {
+        fill({static_cast<std::byte*>(addr), size});
+    } catch (...) {
+        munmap(addr, size);
+        throw;
+    }
+    // The writable mapping has to be gone before F_SEAL_WRITE can be added.
+    munmap(addr, size);
+    if (fcntl(segment.m_fd, F_ADD_SEALS, REQUIRED_SEALS) != 0) {
+        LogDebug(BCLog::IPC, "Could not seal shared memory segment: %s\n", SysErrorString(errno));
+        return std::nullopt;
+    }
+    return segment;
+#else
+    return std::nullopt;
+#endif
+}
+
+SharedMemorySegment::SharedMemorySegment(SharedMemorySegment&& other) noexcept
+    : m_fd{std::exchange(other.m_fd, -1)}
+{
+}
+
+SharedMemorySegment::~SharedMemorySegment()
+{
+#if HAVE_DECL_MEMFD_CREATE
+    if (m_fd >= 0) close(m_fd);
+#endif
+}
+
+std::optional<SharedMemoryOffer> SharedMemoryOffer::Create(SharedMemorySegment&& segment)
+{
+#if HAVE_DECL_MEMFD_CREATE && defined(F_ADD_SEALS)
+    DescriptorServer* server{DescriptorServer::Get()};
+    if (!server) return std::nullopt;
+    SharedMemoryOffer offer{std::move(segment), server->m_address};
+    server->Add(offer.m_token, offer.m_segment.fd());
+    offer.m_registered = true;
+    return offer;
+#else
+    return std::nullopt;
+#endif
+}
+
+SharedMemoryOffer::SharedMemoryOffer(SharedMemorySegment&& segment, std::string address)
+    : m_segment{std::move(segment)}, m_address{std::move(address)}
+{
+    GetRandBytes(MakeWritableUCharSpan(m_token));
+}
+
+SharedMemoryOffer::SharedMemoryOffer(SharedMemoryOffer&& other) noexcept
+    : m_segment{std::move(other.m_segment)}, m_address{std::move(other.m_address)}, m_token{other.m_token},
+      m_registered{std::exchange(other.m_registered, false)}
+{
+}
+
+SharedMemoryOffer::~SharedMemoryOffer()
+{
+#if HAVE_DECL_MEMFD_CREATE && defined(F_ADD_SEALS)
+    if (m_registered) DescriptorServer::Get()->Remove(m_token);
+#endif
+}
+
+SharedMemoryMapping::SharedMemoryMapping(std::string_view address, std::span<const std::byte> token)
+{
+#if HAVE_DECL_MEMFD_CREATE && defined(F_ADD_SEALS)
+    const int fd{FetchDescriptor(address, token)};
+    // Only accept segments the sender can no longer modify or truncate, so the
+    // payload can't change while it is being read.
+    struct stat st;
+    const int seals{fcntl(fd, F_GET_SEALS)};
+    if (seals < 0 || (seals & REQUIRED_SEALS) != REQUIRED_SEALS || fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        throw Exception("Shared memory segment is not sealed or is empty");
+    }
+    m_length = uint64_t(st.st_size);
+    void* addr{mmap(nullptr, m_length, PROT_READ, MAP_SHARED, fd, 0)};
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw Exception(strprintf("Could not map shared memory segment: %s", SysErrorString(errno)));
+    }
+    m_addr = addr;
+    m_payload = {static_cast<const std::byte*>(addr), m_length};
+#else
+    throw Exception("Shared memory IPC is not supported on this platform");
+#endif
+}
+
+SharedMemoryMapping::~SharedMemoryMapping()
+{
+#if HAVE_DECL_MEMFD_CREATE && defined(F_ADD_SEALS)
+    if (m_addr) munmap(m_addr, m_length);
+#endif
+}
+} // namespace ipc
@@ -0,0 +1,106 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_IPC_SHAREDMEMORY_H
+#define BITCOIN_IPC_SHAREDMEMORY_H
+
+#include <span.h>
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace ipc {
+//! Default for -ipcsharedmemory.
+static constexpr bool DEFAULT_IPC_SHARED_MEMORY{false};
+//! Payloads smaller than this are always copied through the socket, because
+//! setting up a shared memory segment costs more than copying them.
+static constexpr size_t SHARED_MEMORY_MIN_SIZE{256 * 1024};
+
+//! Whether large payloads should be passed and accepted through shared memory
+//! (-ipcsharedmemory) and the platform supports it.
+bool SharedMemoryEnabled();
+
+//! Size of the random token identifying an offered segment.
+static constexpr size_t SHARED_MEMORY_TOKEN_SIZE{16};
+
+//! Sealed memfd segment holding a payload for another process. The descriptor
+//! is closed when the segment is destroyed.
+class SharedMemorySegment
+{
+public:
+    //! Create a sealed segment of the given size, and call fill to write its
+    //! contents. Returns nullopt if shared memory is not supported or the
+    //! segment could not be created, in which case the caller should fall back
+    //! to copying the payload.
+    static std::optional<SharedMemorySegment> Create(size_t size, const std::function<void(std::span<std::byte>)>& fill);
+
+    SharedMemorySegment(SharedMemorySegment&& other) noexcept;
+    SharedMemorySegment& operator=(SharedMemorySegment&&) = delete;
+    ~SharedMemorySegment();
+
+    int fd() const { return m_fd; }
+
+private:
+    explicit SharedMemorySegment(int fd) : m_fd{fd} {}
+    int m_fd{-1};
+};
+
+//! Segment made available to other processes. Cap'n Proto messages can't
+//! carry file descriptors, so the descriptor is passed separately: a thread of
+//! this process listens on an abstract Unix socket and sends the descriptor
+//! (SCM_RIGHTS) to processes of the same user that present the token, until
+//! the offer is destroyed. The socket address and token are what is sent in
+//! the message.
+class SharedMemoryOffer
+{
+public:
+    using Token = std::array<std::byte, SHARED_MEMORY_TOKEN_SIZE>;
+
+    //! Offer the segment. Returns nullopt if the descriptor server could not
+    //! be started, in which case the caller should fall back to copying the
+    //! payload.
+    static std::optional<SharedMemoryOffer> Create(SharedMemorySegment&& segment);
+
+    SharedMemoryOffer(SharedMemoryOffer&& other) noexcept;
+    SharedMemoryOffer& operator=(SharedMemoryOffer&&) = delete;
+    ~SharedMemoryOffer();
+
+    //! Name of the abstract Unix socket the descriptor is served on.
+    const std::string& address() const { return m_address; }
+    const Token& token() const { return m_token; }
+
+private:
+    SharedMemoryOffer(SharedMemorySegment&& segment, std::string address);
+    SharedMemorySegment m_segment;
+    std::string m_address;
+    Token m_token;
+    bool m_registered{false};
+};
+
+//! Read-only mapping of a segment offered by another process. The descriptor
+//! is fetched from the descriptor server of that process, and closed once the
+//! segment is mapped. Throws ipc::Exception if the descriptor can't be
+//! fetched, or the segment can't be mapped or is not sealed.
+class SharedMemoryMapping
+{
+public:
+    SharedMemoryMapping(std::string_view address, std::span<const std::byte> token);
+    ~SharedMemoryMapping();
+    SharedMemoryMapping(const SharedMemoryMapping&) = delete;
+    SharedMemoryMapping& operator=(const SharedMemoryMapping&) = delete;
+
+    std::span<const std::byte> data() const { return m_payload; }
+
+private:
+    void* m_addr{nullptr};
+    size_t m_length{0};
+    std::span<const std::byte> m_payload;
+};
+} // namespace ipc
+
+#endif // BITCOIN_IPC_SHAREDMEMORY_H
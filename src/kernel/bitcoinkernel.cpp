@@ -1,11 +1,177 @@
 // Copyright (c) 2022 The Bitcoin Core developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define BITCOINKERNEL_BUILD
+
+#include <kernel/bitcoinkernel.h>
+
+#include <kernel/script_verify_batch.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <script/interpreter.h>
+#include <script/script.h>
+#include <serialize.h>
+#include <span.h>
+#include <streams.h>
 #include <util/translation.h>
 
+#include <cstdint>
 #include <functional>
+#include <ios>
+#include <optional>
 #include <string>
+#include <vector>
 
 // Define G_TRANSLATION_FUN symbol in libbitcoinkernel library so users of the
 // library aren't required to export this symbol
 extern const TranslateFn G_TRANSLATION_FUN{nullptr};
+
+static_assert(static_cast<unsigned int>(kernel_SCRIPT_FLAGS_VERIFY_P2SH) == SCRIPT_VERIFY_P2SH);
+static_assert(static_cast<unsigned int>(kernel_SCRIPT_FLAGS_VERIFY_DERSIG) == SCRIPT_VERIFY_DERSIG);
+static_assert(static_cast<unsigned int>(kernel_SCRIPT_FLAGS_VERIFY_NULLDUMMY) == SCRIPT_VERIFY_NULLDUMMY);
+static_assert(static_cast<unsigned int>(kernel_SCRIPT_FLAGS_VERIFY_CHECKLOCKTIMEVERIFY) == SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY);
+static_assert(static_cast<unsigned int>(kernel_SCRIPT_FLAGS_VERIFY_CHECKSEQUENCEVERIFY) == SCRIPT_VERIFY_CHECKSEQUENCEVERIFY);
+static_assert(static_cast<unsigned int>(kernel_SCRIPT_FLAGS_VERIFY_WITNESS) == SCRIPT_VERIFY_WITNESS);
+static_assert(static_cast<unsigned int>(kernel_SCRIPT_FLAGS_VERIFY_TAPROOT) == SCRIPT_VERIFY_TAPROOT);
+
+struct kernel_ScriptVerifyBatch {
+    kernel::ScriptVerifyBatch batch;
+};
+
+namespace {
+std::vector<CTxOut> ToTxOuts(const kernel_TransactionOutput* spent_outputs, size_t spent_outputs_len)
+{
+    std::vector<CTxOut> outputs;
+    outputs.reserve(spent_outputs_len);
+    for (size_t i{0}; i < spent_outputs_len; ++i) {
+        const auto& out{spent_outputs[i]};
+        outputs.emplace_back(out.amount, CScript(out.script_pubkey, out.script_pubkey + out.script_pubkey_len));
+    }
+    return outputs;
+}
+
+//! Deserialize an object, requiring all of the input to be consumed.
+template <typename T>
+bool Decode(T& obj, const unsigned char* data, size_t len)
+{
+    try {
+        SpanReader stream{{data, len}};
+        stream >> TX_WITH_WITNESS(obj);
+        return stream.empty();
+    } catch (const std::ios_base::failure&) {
+        return false;
+    }
+}
+
+kernel_ScriptVerifyStatus CheckArgs(const kernel_TransactionOutput* spent_outputs, size_t spent_outputs_len, unsigned int flags)
+{
+    if (flags & ~static_cast<unsigned int>(kernel_SCRIPT_FLAGS_VERIFY_ALL)) return kernel_SCRIPT_VERIFY_ERROR_INVALID_FLAGS;
+    if ((flags & kernel_SCRIPT_FLAGS_VERIFY_WITNESS) && !(flags & kernel_SCRIPT_FLAGS_VERIFY_P2SH)) {
+        return kernel_SCRIPT_VERIFY_ERROR_INVALID_FLAGS_COMBINATION;
+    }
+    if (spent_outputs_len > 0 && spent_outputs == nullptr) return kernel_SCRIPT_VERIFY_ERROR_SPENT_OUTPUTS_MISMATCH;
+    return kernel_SCRIPT_VERIFY_OK;
+}
+
+kernel_ScriptVerifyStatus AddTransaction(kernel_ScriptVerifyBatch* batch, uint64_t job_id,
+                                         const unsigned char* tx_data, size_t tx_len,
+                                         const kernel_TransactionOutput* spent_outputs, size_t spent_outputs_len,
+                                         std::optional<uint32_t> input_index, unsigned int flags)
+{
+    if (const auto status{CheckArgs(spent_outputs, spent_outputs_len, flags)}; status != kernel_SCRIPT_VERIFY_OK) return status;
+    CMutableTransaction mtx;
+    if (!Decode(mtx, tx_data, tx_len)) return kernel_SCRIPT_VERIFY_ERROR_TX_DESERIALIZE;
+    if (spent_outputs_len != mtx.vin.size()) return kernel_SCRIPT_VERIFY_ERROR_SPENT_OUTPUTS_MISMATCH;
+    if (input_index && *input_index >= mtx.vin.size()) return kernel_SCRIPT_VERIFY_ERROR_TX_INPUT_INDEX;
+    batch->batch.AddTransaction(job_id, MakeTransactionRef(std::move(mtx)), ToTxOuts(spent_outputs, spent_outputs_len), flags, input_index);
+    return kernel_SCRIPT_VERIFY_OK;
+}
+} // namespace
+
+kernel_ScriptVerifyBatch* kernel_script_verify_batch_create(int worker_threads)
+{
+    if (worker_threads < 0) return nullptr;
+    try {
+        return new kernel_ScriptVerifyBatch{kernel::ScriptVerifyBatch{worker_threads}};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void kernel_script_verify_batch_destroy(kernel_ScriptVerifyBatch* batch)
+{
+    delete batch;
+}
+
+kernel_ScriptVerifyStatus kernel_script_verify_batch_add_transaction(
+    kernel_ScriptVerifyBatch* batch, uint64_t job_id,
+    const unsigned char* tx, size_t tx_len,
+    const kernel_TransactionOutput* spent_outputs, size_t spent_outputs_len,
+    unsigned int flags)
+{
+    try {
+        return AddTransaction(batch, job_id, tx, tx_len, spent_outputs, spent_outputs_len, std::nullopt, flags);
+    } catch (...) {
+        return kernel_SCRIPT_VERIFY_ERROR_INTERNAL;
+    }
+}
+
+kernel_ScriptVerifyStatus kernel_script_verify_batch_add_input(
+    kernel_ScriptVerifyBatch* batch, uint64_t job_id,
+    const unsigned char* tx, size_t tx_len,
+    const kernel_TransactionOutput* spent_outputs, size_t spent_outputs_len,
+    uint32_t input_index, unsigned int flags)
+{
+    try {
+        return AddTransaction(batch, job_id, tx, tx_len, spent_outputs, spent_outputs_len, input_index, flags);
+    } catch (...) {
+        return kernel_SCRIPT_VERIFY_ERROR_INTERNAL;
+    }
+}
+
+kernel_ScriptVerifyStatus kernel_script_verify_batch_add_block(
+    kernel_ScriptVerifyBatch* batch, uint64_t job_id,
+    const unsigned char* block_data, size_t block_len,
+    const kernel_TransactionOutput* spent_outputs, size_t spent_outputs_len,
+    unsigned int flags)
+{
+    if (const auto status{CheckArgs(spent_outputs, spent_outputs_len, flags)}; status != kernel_SCRIPT_VERIFY_OK) return status;
+    try {
+        CBlock block;
+        if (!Decode(block, block_data, block_len)) return kernel_SCRIPT_VERIFY_ERROR_TX_DESERIALIZE;
+        size_t num_inputs{0};
+        for (size_t i{1}; i < block.vtx.size(); ++i) {
+            num_inputs += block.vtx[i]->vin.size();
+        }
+        if (spent_outputs_len != num_inputs) return kernel_SCRIPT_VERIFY_ERROR_SPENT_OUTPUTS_MISMATCH;
+        batch->batch.AddBlock(job_id, block, ToTxOuts(spent_outputs, spent_outputs_len), flags);
+        return kernel_SCRIPT_VERIFY_OK;
+    } catch (...) {
+        return kernel_SCRIPT_VERIFY_ERROR_INTERNAL;
+    }
+}
+
+size_t kernel_script_verify_batch_pending(const kernel_ScriptVerifyBatch* batch)
+{
+    return batch->batch.Pending();
+}
+
+size_t kernel_script_verify_batch_complete(kernel_ScriptVerifyBatch* batch, kernel_ScriptVerifyCallback callback, void* user_data)
+{
+    std::vector<kernel::ScriptVerifyResult> results;
+    try {
+        results = batch->batch.Complete();
+    } catch (...) {
+        return SIZE_MAX;
+    }
+    size_t failures{0};
+    for (const auto& result : results) {
+        if (!result.valid) ++failures;
+        if (callback) {
+            callback(user_data, result.job_id, result.tx_index, result.input_index,
+                     result.valid ? kernel_SCRIPT_VERIFY_OK : kernel_SCRIPT_VERIFY_ERROR_INVALID);
+        }
+    }
+    return failures;
+}
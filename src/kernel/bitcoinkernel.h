@@ -0,0 +1,171 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_KERNEL_BITCOINKERNEL_H
+#define BITCOIN_KERNEL_BITCOINKERNEL_H
+
+#ifndef __cplusplus
+#include <stddef.h>
+#include <stdint.h>
+#else
+#include <cstddef>
+#include <cstdint>
+#endif // __cplusplus
+
+#if !defined(BITCOINKERNEL_API)
+    #if defined(_WIN32) && defined(BITCOINKERNEL_BUILD)
+        #define BITCOINKERNEL_API __declspec(dllexport)
+    #elif !defined(_WIN32) && defined(__GNUC__)
+        #define BITCOINKERNEL_API __attribute__((visibility("default")))
+    #else
+        #define BITCOINKERNEL_API
+    #endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/**
+ * @file bitcoinkernel.h
+ *
+ * C interface to the experimental bitcoinkernel library.
+ *
+ * Batch script verification
+ * -------------------------
+ *
+ * A kernel_ScriptVerifyBatch verifies the scripts of many transaction inputs
+ * on an internal pool of worker threads. Callers add transactions (or single
+ * inputs of them) or whole blocks, together with the outputs they spend, and
+ * verification starts right away. kernel_script_verify_batch_complete waits
+ * for the remaining inputs and reports the result of every input through a
+ * callback; kernel_script_verify_batch_pending can be polled in the meantime.
+ *
+ * @code
+ * kernel_ScriptVerifyBatch* batch = kernel_script_verify_batch_create(8);
+ * for (size_t i = 0; i < num_txs; ++i) {
+ *     kernel_script_verify_batch_add_transaction(batch, i, txs[i].data, txs[i].size,
+ *         txs[i].spent_outputs, txs[i].num_inputs, kernel_SCRIPT_FLAGS_VERIFY_ALL);
+ * }
+ * size_t failures = kernel_script_verify_batch_complete(batch, on_result, &state);
+ * kernel_script_verify_batch_destroy(batch);
+ * @endcode
+ *
+ * src/test/kernel/script_verify_example.c is a complete program using it.
+ *
+ * The functions don't throw. Failures inside the library, like running out of
+ * memory, are reported as kernel_SCRIPT_VERIFY_ERROR_INTERNAL. Nothing is
+ * queued then, except for the transactions of a block before the one that
+ * failed, whose results are still reported on completion.
+ *
+ * A batch must not be used from more than one thread at a time. Data passed
+ * to it is copied, so it can be released as soon as the call returns.
+ */
+
+/** Output being spent by a transaction input. */
+typedef struct {
+    const unsigned char* script_pubkey;
+    size_t script_pubkey_len;
+    int64_t amount;
+} kernel_TransactionOutput;
+
+/** Opaque handle to a batch of script verifications. */
+typedef struct kernel_ScriptVerifyBatch kernel_ScriptVerifyBatch;
+
+/** Status of adding work to a batch, or of verifying a single input. */
+typedef enum {
+    kernel_SCRIPT_VERIFY_OK = 0,
+    kernel_SCRIPT_VERIFY_ERROR_TX_DESERIALIZE,       //!< The transaction or block could not be decoded.
+    kernel_SCRIPT_VERIFY_ERROR_TX_INPUT_INDEX,       //!< The input index is out of range.
+    kernel_SCRIPT_VERIFY_ERROR_SPENT_OUTPUTS_MISMATCH, //!< The number of spent outputs doesn't match the inputs.
+    kernel_SCRIPT_VERIFY_ERROR_INVALID_FLAGS,        //!< Unknown flags were passed.
+    kernel_SCRIPT_VERIFY_ERROR_INVALID_FLAGS_COMBINATION, //!< Witness without P2SH, for example.
+    kernel_SCRIPT_VERIFY_ERROR_INVALID,              //!< The input's script failed verification.
+    kernel_SCRIPT_VERIFY_ERROR_INTERNAL,             //!< An internal error, like running out of memory.
+} kernel_ScriptVerifyStatus;
+
+/** Script verification flags that may be combined and passed to the batch. */
+typedef enum {
+    kernel_SCRIPT_FLAGS_VERIFY_NONE = 0,
+    kernel_SCRIPT_FLAGS_VERIFY_P2SH = (1U << 0),                //!< evaluate P2SH (BIP16) subscripts
+    kernel_SCRIPT_FLAGS_VERIFY_DERSIG = (1U << 2),              //!< enforce strict DER (BIP66) compliance
+    kernel_SCRIPT_FLAGS_VERIFY_NULLDUMMY = (1U << 4),           //!< enforce NULLDUMMY (BIP147)
+    kernel_SCRIPT_FLAGS_VERIFY_CHECKLOCKTIMEVERIFY = (1U << 9), //!< enable CHECKLOCKTIMEVERIFY (BIP65)
+    kernel_SCRIPT_FLAGS_VERIFY_CHECKSEQUENCEVERIFY = (1U << 10), //!< enable CHECKSEQUENCEVERIFY (BIP112)
+    kernel_SCRIPT_FLAGS_VERIFY_WITNESS = (1U << 11),            //!< enable WITNESS (BIP141)
+    kernel_SCRIPT_FLAGS_VERIFY_TAPROOT = (1U << 17),            //!< enable TAPROOT (BIPs 341 & 342)
+    kernel_SCRIPT_FLAGS_VERIFY_ALL = kernel_SCRIPT_FLAGS_VERIFY_P2SH | kernel_SCRIPT_FLAGS_VERIFY_DERSIG |
+                                     kernel_SCRIPT_FLAGS_VERIFY_NULLDUMMY | kernel_SCRIPT_FLAGS_VERIFY_CHECKLOCKTIMEVERIFY |
+                                     kernel_SCRIPT_FLAGS_VERIFY_CHECKSEQUENCEVERIFY | kernel_SCRIPT_FLAGS_VERIFY_WITNESS |
+                                     kernel_SCRIPT_FLAGS_VERIFY_TAPROOT
+} kernel_ScriptFlags;
+
+/**
+ * Called once for every verified input.
+ *
+ * @param[in] user_data    The pointer passed to kernel_script_verify_batch_complete.
+ * @param[in] job_id       Identifier the transaction or block was added with.
+ * @param[in] tx_index     Position of the transaction in its block, 0 for transactions added on their own.
+ * @param[in] input_index  Index of the verified input.
+ * @param[in] status       kernel_SCRIPT_VERIFY_OK or kernel_SCRIPT_VERIFY_ERROR_INVALID.
+ */
+typedef void (*kernel_ScriptVerifyCallback)(void* user_data, uint64_t job_id, uint32_t tx_index, uint32_t input_index, kernel_ScriptVerifyStatus status);
+
+/**
+ * Create a batch verified by the given number of worker threads, in addition
+ * to the thread calling kernel_script_verify_batch_complete. Returns NULL on
+ * failure.
+ */
+BITCOINKERNEL_API kernel_ScriptVerifyBatch* kernel_script_verify_batch_create(int worker_threads);
+
+/** Wait for outstanding verifications, and release the batch. */
+BITCOINKERNEL_API void kernel_script_verify_batch_destroy(kernel_ScriptVerifyBatch* batch);
+
+/**
+ * Queue all inputs of a serialized transaction.
+ *
+ * @param[in] spent_outputs      The outputs spent by the transaction, one for each input, in order.
+ * @param[in] spent_outputs_len  Number of elements in spent_outputs.
+ * @param[in] flags              Combination of kernel_ScriptFlags.
+ */
+BITCOINKERNEL_API kernel_ScriptVerifyStatus kernel_script_verify_batch_add_transaction(
+    kernel_ScriptVerifyBatch* batch, uint64_t job_id,
+    const unsigned char* tx, size_t tx_len,
+    const kernel_TransactionOutput* spent_outputs, size_t spent_outputs_len,
+    unsigned int flags);
+
+/** Queue a single input of a serialized transaction, see kernel_script_verify_batch_add_transaction. */
+BITCOINKERNEL_API kernel_ScriptVerifyStatus kernel_script_verify_batch_add_input(
+    kernel_ScriptVerifyBatch* batch, uint64_t job_id,
+    const unsigned char* tx, size_t tx_len,
+    const kernel_TransactionOutput* spent_outputs, size_t spent_outputs_len,
+    uint32_t input_index, unsigned int flags);
+
+/**
+ * Queue the inputs of all non-coinbase transactions of a serialized block.
+ * spent_outputs holds the outputs spent by those inputs, in block order.
+ */
+BITCOINKERNEL_API kernel_ScriptVerifyStatus kernel_script_verify_batch_add_block(
+    kernel_ScriptVerifyBatch* batch, uint64_t job_id,
+    const unsigned char* block, size_t block_len,
+    const kernel_TransactionOutput* spent_outputs, size_t spent_outputs_len,
+    unsigned int flags);
+
+/** Number of queued inputs whose verification hasn't finished yet. */
+BITCOINKERNEL_API size_t kernel_script_verify_batch_pending(const kernel_ScriptVerifyBatch* batch);
+
+/**
+ * Wait until all queued inputs are verified, and call the callback, if not
+ * NULL, for each of them in the order they were added. Returns the number of
+ * inputs that failed verification. The batch can be reused afterwards.
+ * Returns SIZE_MAX without calling the callback on an internal error, in
+ * which case the results are kept for the next call.
+ */
+BITCOINKERNEL_API size_t kernel_script_verify_batch_complete(kernel_ScriptVerifyBatch* batch, kernel_ScriptVerifyCallback callback, void* user_data);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // BITCOIN_KERNEL_BITCOINKERNEL_H
@@ -0,0 +1,150 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <kernel/script_verify_batch.h>
+
+#include <checkqueue.h>
+#include <primitives/block.h>
+#include <script/interpreter.h>
+#include <tinyformat.h>
+
+#include <stdexcept>
+#include <utility>
+
+namespace kernel {
+namespace {
+//! Number of inputs a worker takes from the queue at once, same as for block validation.
+constexpr unsigned int SCRIPT_CHECK_BATCH_SIZE{128};
+
+void CheckFlags(unsigned int flags)
+{
+    // VerifyScript asserts on these combinations, so reject them up front.
+    if ((flags & SCRIPT_VERIFY_WITNESS) && !(flags & SCRIPT_VERIFY_P2SH)) {
+        throw std::invalid_argument("SCRIPT_VERIFY_WITNESS requires SCRIPT_VERIFY_P2SH");
+    }
+    if ((flags & SCRIPT_VERIFY_CLEANSTACK) && !(flags & SCRIPT_VERIFY_WITNESS)) {
+        throw std::invalid_argument("SCRIPT_VERIFY_CLEANSTACK requires SCRIPT_VERIFY_WITNESS");
+    }
+}
+} // namespace
+
+struct ScriptVerifyBatch::Job {
+    CTransactionRef tx;
+    PrecomputedTransactionData txdata;
+};
+
+class ScriptVerifyBatch::Check
+{
+private:
+    const Job* m_job;
+    uint32_t m_input;
+    unsigned int m_flags;
+    ScriptVerifyResult* m_result;
+    std::atomic<size_t>* m_pending;
+
+public:
+    Check(const Job& job, uint32_t input, unsigned int flags, ScriptVerifyResult& result, std::atomic<size_t>& pending)
+        : m_job{&job}, m_input{input}, m_flags{flags}, m_result{&result}, m_pending{&pending} {}
+
+    //! Record the result of the input, and never report a failure to the
+    //! queue, so it keeps verifying the remaining inputs.
+    std::optional<int> operator()()
+    {
+        const CTransaction& tx{*m_job->tx};
+        const CTxIn& txin{tx.vin[m_input]};
+        const CTxOut& spent{m_job->txdata.m_spent_outputs[m_input]};
+        ScriptError error{SCRIPT_ERR_UNKNOWN_ERROR};
+        m_result->valid = VerifyScript(txin.scriptSig, spent.scriptPubKey, &txin.scriptWitness, m_flags,
+                                       TransactionSignatureChecker{&tx, m_input, spent.nValue, m_job->txdata, MissingDataBehavior::FAIL},
+                                       &error);
+        m_result->error = error;
+        m_pending->fetch_sub(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+};
+
+ScriptVerifyBatch::ScriptVerifyBatch(int worker_threads)
+    : m_queue{std::make_unique<CCheckQueue<Check, int>>(SCRIPT_CHECK_BATCH_SIZE, worker_threads, "scriptbatch")}
+{
+}
+
+ScriptVerifyBatch::~ScriptVerifyBatch()
+{
+    // Queued checks reference the jobs and results, so let them finish first.
+    Complete();
+}
+
+void ScriptVerifyBatch::Enqueue(const Job& job, uint64_t job_id, uint32_t tx_index, unsigned int flags, uint32_t begin, uint32_t end)
+{
+    const size_t num_results{m_results.size()};
+    bool counted{false};
+    std::vector<Check> checks;
+    try {
+        checks.reserve(end - begin);
+        for (uint32_t input{begin}; input < end; ++input) {
+            auto& result{m_results.emplace_back()};
+            result.job_id = job_id;
+            result.tx_index = tx_index;
+            result.input_index = input;
+            checks.emplace_back(job, input, flags, result, m_pending);
+        }
+        m_pending.fetch_add(checks.size(), std::memory_order_relaxed);
+        counted = true;
+        m_queue->Add(std::move(checks));
+    } catch (...) {
+        // The queue takes either all of the checks or none of them, so
+        // nothing references the new results yet. Drop them.
+        if (counted) m_pending.fetch_sub(checks.size(), std::memory_order_relaxed);
+        m_results.resize(num_results);
+        throw;
+    }
+}
+
+void ScriptVerifyBatch::AddTransaction(uint64_t job_id, CTransactionRef tx, std::vector<CTxOut> spent_outputs, unsigned int flags,
+                                       std::optional<uint32_t> input_index)
+{
+    CheckFlags(flags);
+    if (spent_outputs.size() != tx->vin.size()) {
+        throw std::invalid_argument(strprintf("Transaction has %u inputs, but %u spent outputs were given", tx->vin.size(), spent_outputs.size()));
+    }
+    if (input_index && *input_index >= tx->vin.size()) {
+        throw std::invalid_argument(strprintf("Input index %u out of range", *input_index));
+    }
+    auto& job{*m_jobs.emplace_back(std::make_unique<Job>())};
+    job.tx = std::move(tx);
+    job.txdata.Init(*job.tx, std::move(spent_outputs));
+    const uint32_t begin{input_index.value_or(0)};
+    const uint32_t end{input_index ? *input_index + 1 : uint32_t(job.tx->vin.size())};
+    Enqueue(job, job_id, /*tx_index=*/0, flags, begin, end);
+}
+
+void ScriptVerifyBatch::AddBlock(uint64_t job_id, const CBlock& block, std::span<const CTxOut> spent_outputs, unsigned int flags)
+{
+    CheckFlags(flags);
+    size_t num_inputs{0};
+    for (size_t i{1}; i < block.vtx.size(); ++i) {
+        num_inputs += block.vtx[i]->vin.size();
+    }
+    if (spent_outputs.size() != num_inputs) {
+        throw std::invalid_argument(strprintf("Block has %u non-coinbase inputs, but %u spent outputs were given", num_inputs, spent_outputs.size()));
+    }
+    for (size_t i{1}; i < block.vtx.size(); ++i) {
+        const size_t tx_inputs{block.vtx[i]->vin.size()};
+        auto& job{*m_jobs.emplace_back(std::make_unique<Job>())};
+        job.tx = block.vtx[i];
+        job.txdata.Init(*job.tx, std::vector<CTxOut>(spent_outputs.begin(), spent_outputs.begin() + tx_inputs));
+        spent_outputs = spent_outputs.subspan(tx_inputs);
+        Enqueue(job, job_id, uint32_t(i), flags, 0, uint32_t(tx_inputs));
+    }
+}
+
+std::vector<ScriptVerifyResult> ScriptVerifyBatch::Complete()
+{
+    m_queue->Complete();
+    std::vector<ScriptVerifyResult> results{std::make_move_iterator(m_results.begin()), std::make_move_iterator(m_results.end())};
+    m_results.clear();
+    m_jobs.clear();
+    return results;
+}
+} // namespace kernel
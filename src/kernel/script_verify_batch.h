@@ -0,0 +1,103 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_KERNEL_SCRIPT_VERIFY_BATCH_H
+#define BITCOIN_KERNEL_SCRIPT_VERIFY_BATCH_H
+
+#include <primitives/transaction.h>
+#include <script/script_error.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+class CBlock;
+template <typename T, typename R>
+class CCheckQueue;
+
+namespace kernel {
+//! Result of verifying one transaction input queued in a ScriptVerifyBatch.
+struct ScriptVerifyResult {
+    //! Identifier passed when the transaction or block was added.
+    uint64_t job_id{0};
+    //! Position of the transaction in its block, or 0 for single transactions.
+    uint32_t tx_index{0};
+    uint32_t input_index{0};
+    bool valid{false};
+    ScriptError error{SCRIPT_ERR_UNKNOWN_ERROR};
+};
+
+/**
+ * Verifies the scripts of many transaction inputs in parallel, for users of
+ * the kernel library that already know the outputs being spent, like external
+ * indexers. Inputs are handed to a pool of worker threads as soon as they are
+ * added, and Complete() waits for the remaining ones and returns a result for
+ * every input, rather than stopping at the first failure like block
+ * validation does.
+ *
+ * Adding and completing must happen from one thread at a time.
+ */
+class ScriptVerifyBatch
+{
+public:
+    //! Start a batch verified by @p worker_threads threads in addition to the
+    //! thread calling Complete().
+    explicit ScriptVerifyBatch(int worker_threads);
+    ~ScriptVerifyBatch();
+
+    ScriptVerifyBatch(const ScriptVerifyBatch&) = delete;
+    ScriptVerifyBatch& operator=(const ScriptVerifyBatch&) = delete;
+
+    /**
+     * Queue the inputs of a transaction for verification.
+     *
+     * @param[in] job_id         Identifier reported back in the results.
+     * @param[in] tx             The spending transaction.
+     * @param[in] spent_outputs  The outputs spent by tx, one for each input, in order.
+     * @param[in] flags          Script verification flags.
+     * @param[in] input_index    Only verify this input, instead of all of them.
+     *
+     * Throws std::invalid_argument if the spent outputs don't match the
+     * inputs, the input index is out of range, or the flags are inconsistent.
+     * Nothing is queued if it throws.
+     */
+    void AddTransaction(uint64_t job_id, CTransactionRef tx, std::vector<CTxOut> spent_outputs, unsigned int flags,
+                        std::optional<uint32_t> input_index = std::nullopt);
+
+    /**
+     * Queue the inputs of all non-coinbase transactions in a block.
+     * @p spent_outputs holds the spent outputs of those inputs, in block order.
+     * If it throws while queuing, the transactions before the one that failed
+     * stay queued.
+     */
+    void AddBlock(uint64_t job_id, const CBlock& block, std::span<const CTxOut> spent_outputs, unsigned int flags);
+
+    //! Number of queued inputs whose verification hasn't finished yet.
+    size_t Pending() const { return m_pending.load(std::memory_order_relaxed); }
+
+    //! Wait for all queued inputs, and return their results in the order they
+    //! were added. The batch can be reused afterwards.
+    std::vector<ScriptVerifyResult> Complete();
+
+private:
+    struct Job;
+    class Check;
+
+    void Enqueue(const Job& job, uint64_t job_id, uint32_t tx_index, unsigned int flags, uint32_t begin, uint32_t end);
+
+    std::unique_ptr<CCheckQueue<Check, int>> m_queue;
+    //! Jobs and results are referenced by queued checks, so they must not
+    //! move when more are added.
+    std::vector<std::unique_ptr<Job>> m_jobs;
+    std::deque<ScriptVerifyResult> m_results;
+    std::atomic<size_t> m_pending{0};
+};
+} // namespace kernel
+
+#endif // BITCOIN_KERNEL_SCRIPT_VERIFY_BATCH_H
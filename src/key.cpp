@@ -348,6 +348,21 @@ bool CQPubKey::IsFullyValid() const {
     return true;
 }
 
+std::vector<CQKeyID> GetKeyIDs(std::span<const CQPubKey> pubkeys)
+{
+    std::vector<const unsigned char*> inputs;
+    inputs.reserve(pubkeys.size());
+    for (const CQPubKey& pubkey : pubkeys) {
+        inputs.push_back(pubkey.data());
+    }
+    std::vector<CQKeyID> ids;
+    ids.reserve(pubkeys.size());
+    for (const uint160& hash : Hash160Multi(inputs, CQPubKey::SIZE)) {
+        ids.emplace_back(hash);
+    }
+    return ids;
+}
+
 // QXOnlyPubKey implementation
 QXOnlyPubKey::QXOnlyPubKey(const CQPubKey& pubkey) {
     // Take hash of the full Dilithium key as the "x-only" representation
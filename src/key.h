@@ -408,6 +408,11 @@ public:
     bool IsCompressed() const { return true; }
 };
 
+/** Get the KeyIDs of many public keys at once, in order. Equivalent to calling
+ *  GetID() on each of them, but hashes several keys in parallel where the CPU
+ *  supports it. */
+std::vector<CQKeyID> GetKeyIDs(std::span<const CQPubKey> pubkeys);
+
 /** Quantum-resistant X-only public key (simplified version for API compatibility) */
 class QXOnlyPubKey
 {
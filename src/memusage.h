@@ -6,6 +6,7 @@
 #define BITCOIN_MEMUSAGE_H
 
 #include <indirectmap.h>
+#include <nodehashmap.h>
 #include <prevector.h>
 #include <support/allocators/pool.h>
 
@@ -196,6 +197,17 @@ static inline size_t DynamicUsage(const std::unordered_map<X, Y, Z>& m)
     return MallocUsage(sizeof(unordered_node<std::pair<const X, Y> >)) * m.size() + MallocUsage(sizeof(void*) * m.bucket_count());
 }
 
+template <std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
+static inline size_t DynamicUsage(const PoolResource<MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>& pool_resource)
+{
+    // The allocated chunks are stored in a std::list. Size per node should
+    // therefore be 3 pointers: next, previous, and a pointer to the chunk.
+    size_t estimated_list_node_size = MallocUsage(sizeof(void*) * 3);
+    size_t usage_resource = estimated_list_node_size * pool_resource.NumAllocatedChunks();
+    size_t usage_chunks = MallocUsage(pool_resource.ChunkSizeBytes()) * pool_resource.NumAllocatedChunks();
+    return usage_resource + usage_chunks;
+}
+
 template <class Key, class T, class Hash, class Pred, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
 static inline size_t DynamicUsage(const std::unordered_map<Key,
                                                            T,
@@ -205,14 +217,14 @@ static inline size_t DynamicUsage(const std::unordered_map<Key,
                                                                          MAX_BLOCK_SIZE_BYTES,
                                                                          ALIGN_BYTES>>& m)
 {
-    auto* pool_resource = m.get_allocator().resource();
+    return DynamicUsage(*m.get_allocator().resource()) + MallocUsage(sizeof(void*) * m.bucket_count());
+}
 
-    // The allocated chunks are stored in a std::list. Size per node should
-    // therefore be 3 pointers: next, previous, and a pointer to the chunk.
-    size_t estimated_list_node_size = MallocUsage(sizeof(void*) * 3);
-    size_t usage_resource = estimated_list_node_size * pool_resource->NumAllocatedChunks();
-    size_t usage_chunks = MallocUsage(pool_resource->ChunkSizeBytes()) * pool_resource->NumAllocatedChunks();
-    return usage_resource + usage_chunks + MallocUsage(sizeof(void*) * m.bucket_count());
+template <class Key, class T, class Hash, class Pred, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
+static inline size_t DynamicUsage(const NodeHashMap<Key, T, Hash, Pred, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>& m)
+{
+    // One control byte and one node pointer per slot, in separate arrays.
+    return DynamicUsage(*m.get_allocator().resource()) + MallocUsage(m.bucket_count()) + MallocUsage(sizeof(void*) * m.bucket_count());
 }
 
 } // namespace memusage
@@ -136,6 +136,10 @@ static constexpr auto BLOCK_STALLING_TIMEOUT_MAX{64s};
 static const int MAX_CMPCTBLOCK_DEPTH = 5;
 /** Maximum depth of blocks we're willing to respond to GETBLOCKTXN requests for. */
 static const int MAX_BLOCKTXN_DEPTH = 10;
+/** Maximum total size of the transactions we prefill, besides the coinbase, in a
+ *  compact block announced to a high-bandwidth peer. Dilithium transactions are
+ *  large, but a getblocktxn round trip costs more than sending a few of them. */
+static constexpr size_t MAX_CMPCTBLOCK_PREFILL_BYTES{128'000};
 static_assert(MAX_BLOCKTXN_DEPTH <= MIN_BLOCKS_TO_KEEP, "MAX_BLOCKTXN_DEPTH too high");
 /** Size of the "block download window": how far ahead of our current height do we fetch?
  *  Larger windows tolerate larger download speed differences between peer, but increase the potential
@@ -310,6 +314,8 @@ struct Peer {
         /** The next time after which we will send an `inv` message containing
          *  transaction announcements to this peer. */
         std::chrono::microseconds m_next_inv_send_time GUARDED_BY(m_tx_inventory_mutex){0};
+        /** The next time we request a reconciliation, if we initiate reconciliations with this peer. */
+        std::chrono::microseconds m_next_recon_request GUARDED_BY(m_tx_inventory_mutex){0};
         /** The mempool sequence num at which we sent the last `inv` message to this peer.
          *  Can relay txs with lower sequence numbers than this (see CTxMempool::info_for_relay). */
         uint64_t m_last_inv_sequence GUARDED_BY(NetEventsInterface::g_msgproc_mutex){1};
@@ -382,6 +388,15 @@ struct Peer {
     /** Total number of addresses that were processed (excludes rate-limited ones). */
     std::atomic<uint64_t> m_addr_processed{0};
 
+    /** Number of blocks reconstructed from compact blocks this peer sent us. */
+    std::atomic<uint64_t> m_cmpctblock_reconstructed{0};
+    /** Number of getblocktxn round trips we made to this peer for missing transactions. */
+    std::atomic<uint64_t> m_cmpctblock_roundtrips{0};
+    /** Total size of the cmpctblock and blocktxn messages this peer sent us. */
+    std::atomic<uint64_t> m_cmpctblock_bytes{0};
+    /** Number of transactions we prefilled in compact blocks announced to this peer. */
+    std::atomic<uint64_t> m_cmpctblock_prefilled{0};
+
     /** Whether we've sent this peer a getheaders in response to an inv prior to initial-headers-sync completing */
     bool m_inv_triggered_getheaders_before_sync GUARDED_BY(NetEventsInterface::g_msgproc_mutex){false};
 
@@ -505,6 +520,7 @@ public:
                     CTxMemPool& pool, node::Warnings& warnings, Options opts);
 
     /** Overridden from CValidationInterface. */
+    std::string ValidationInterfaceName() const override { return "peerman"; }
     void ActiveTipChange(const CBlockIndex& new_tip, bool) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_tx_download_mutex);
     void BlockConnected(ChainstateRole role, const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexConnected) override
@@ -516,7 +532,7 @@ public:
     void BlockChecked(const CBlock& block, const BlockValidationState& state) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& pblock) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, !m_peer_mutex);
 
     /** Implement NetEventsInterface */
     void InitializeNode(const CNode& node, ServiceFlags our_services) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_tx_download_mutex);
@@ -950,6 +966,11 @@ private:
     CTransactionRef FindTxForGetData(const Peer::TxRelay& tx_relay, const GenTxid& gtxid)
         EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, NetEventsInterface::g_msgproc_mutex);
 
+    /** Announce transactions to a peer at the end of a reconciliation round, skipping
+     *  those which left our mempool meanwhile. */
+    void AnnounceReconciledTxs(CNode& node, Peer& peer, std::span<const Wtxid> wtxids)
+        EXCLUSIVE_LOCKS_REQUIRED(NetEventsInterface::g_msgproc_mutex);
+
     void ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic<bool>& interruptMsgProc)
         EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, peer.m_getdata_requests_mutex, NetEventsInterface::g_msgproc_mutex)
         LOCKS_EXCLUDED(::cs_main);
@@ -1128,6 +1149,55 @@ static void AddKnownTx(Peer& peer, const uint256& hash)
     tx_relay->m_tx_inventory_known_filter.insert(hash);
 }
 
+/** Pick the transactions to prefill in a compact block announced to a
+ *  high-bandwidth peer: those which neither side announced to the other, so the
+ *  peer probably lacks them, up to MAX_CMPCTBLOCK_PREFILL_BYTES. Returns
+ *  ascending indexes into block.vtx, excluding the coinbase. */
+static std::vector<size_t> GetCompactBlockPrefill(Peer& peer, const CBlock& block)
+{
+    std::vector<size_t> prefill;
+    auto tx_relay = peer.GetTxRelay();
+    // Without transaction relay we know nothing about what the peer has.
+    if (!tx_relay || !WITH_LOCK(tx_relay->m_bloom_filter_mutex, return tx_relay->m_relay_txs)) return prefill;
+
+    size_t prefill_bytes{0};
+    LOCK(tx_relay->m_tx_inventory_mutex);
+    for (size_t i = 1; i < block.vtx.size(); ++i) {
+        const CTransaction& tx{*block.vtx[i]};
+        if (tx_relay->m_tx_inventory_known_filter.contains(tx.GetWitnessHash().ToUint256()) ||
+            tx_relay->m_tx_inventory_known_filter.contains(tx.GetHash().ToUint256())) {
+            continue;
+        }
+        const size_t tx_size{tx.GetTotalSize()};
+        if (prefill_bytes + tx_size > MAX_CMPCTBLOCK_PREFILL_BYTES) continue;
+        prefill_bytes += tx_size;
+        prefill.push_back(i);
+    }
+    return prefill;
+}
+
+void PeerManagerImpl::AnnounceReconciledTxs(CNode& node, Peer& peer, std::span<const Wtxid> wtxids)
+{
+    auto tx_relay = peer.GetTxRelay();
+    if (!tx_relay) return;
+
+    std::vector<CInv> invs;
+    LOCK(tx_relay->m_tx_inventory_mutex);
+    for (const Wtxid& wtxid : wtxids) {
+        if (!m_mempool.exists(GenTxid::Wtxid(wtxid))) continue;
+        tx_relay->m_tx_inventory_known_filter.insert(wtxid.ToUint256());
+        invs.emplace_back(MSG_WTX, wtxid.ToUint256());
+        if (invs.size() == MAX_INV_SZ) {
+            MakeAndPushMessage(node, NetMsgType::INV, invs);
+            invs.clear();
+        }
+    }
+    if (!invs.empty()) MakeAndPushMessage(node, NetMsgType::INV, invs);
+    // Ensure we'll respond to GETDATA requests for anything we've just announced
+    LOCK(m_mempool.cs);
+    tx_relay->m_last_inv_sequence = m_mempool.GetSequence();
+}
+
 /** Whether this peer can serve us blocks. */
 static bool CanServeBlocks(const Peer& peer)
 {
@@ -1743,6 +1813,10 @@ bool PeerManagerImpl::GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats) c
     stats.m_addr_processed = peer->m_addr_processed.load();
     stats.m_addr_rate_limited = peer->m_addr_rate_limited.load();
     stats.m_addr_relay_enabled = peer->m_addr_relay_enabled.load();
+    stats.m_cmpctblock_reconstructed = peer->m_cmpctblock_reconstructed.load();
+    stats.m_cmpctblock_roundtrips = peer->m_cmpctblock_roundtrips.load();
+    stats.m_cmpctblock_bytes = peer->m_cmpctblock_bytes.load();
+    stats.m_cmpctblock_prefilled = peer->m_cmpctblock_prefilled.load();
     {
         LOCK(peer->m_headers_sync_mutex);
         if (peer->m_headers_sync) {
@@ -1929,8 +2003,7 @@ PeerManagerImpl::PeerManagerImpl(CConnman& connman, AddrMan& addrman,
       m_warnings{warnings},
       m_opts{opts}
 {
-    // While Erlay support is incomplete, it must be enabled explicitly via -txreconciliation.
-    // This argument can go away after Erlay support is complete.
+    // Erlay stays opt-in via -txreconciliation until it has seen wider deployment.
     if (opts.reconcile_txs) {
         m_txreconciliation = std::make_unique<TxReconciliationTracker>(TXRECONCILIATION_VERSION);
     }
@@ -2012,7 +2085,8 @@ void PeerManagerImpl::BlockDisconnected(const std::shared_ptr<const CBlock> &blo
  */
 void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& pblock)
 {
-    auto pcmpctblock = std::make_shared<const CBlockHeaderAndShortTxIDs>(*pblock, FastRandomContext().rand64());
+    const uint64_t nonce{FastRandomContext().rand64()};
+    auto pcmpctblock = std::make_shared<const CBlockHeaderAndShortTxIDs>(*pblock, nonce);
 
     LOCK(cs_main);
 
@@ -2040,7 +2114,7 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
         m_most_recent_block_txs = std::move(most_recent_block_txs);
     }
 
-    m_connman.ForEachNode([this, pindex, &lazy_ser, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+    m_connman.ForEachNode([this, pindex, &pblock, nonce, &lazy_ser, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
         AssertLockHeld(::cs_main);
 
         if (pnode->GetCommonVersion() < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect)
@@ -2054,8 +2128,15 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
             LogDebug(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", "PeerManager::NewPoWValidBlock",
                     hashBlock.ToString(), pnode->GetId());
 
-            const CSerializedNetMsg& ser_cmpctblock{lazy_ser.get()};
-            PushMessage(*pnode, ser_cmpctblock.Copy());
+            PeerRef peer{GetPeerRef(pnode->GetId())};
+            const std::vector<size_t> prefill{peer ? GetCompactBlockPrefill(*peer, *pblock) : std::vector<size_t>{}};
+            if (prefill.empty()) {
+                const CSerializedNetMsg& ser_cmpctblock{lazy_ser.get()};
+                PushMessage(*pnode, ser_cmpctblock.Copy());
+            } else {
+                MakeAndPushMessage(*pnode, NetMsgType::CMPCTBLOCK, CBlockHeaderAndShortTxIDs{*pblock, nonce, prefill});
+                peer->m_cmpctblock_prefilled += prefill.size();
+            }
             state.pindexBestHeaderSent = pindex;
         }
     });
@@ -3396,6 +3477,7 @@ void PeerManagerImpl::ProcessCompactBlockTxns(CNode& pfrom, Peer& peer, const Bl
             // updated, etc.
             RemoveBlockRequest(block_transactions.blockhash, pfrom.GetId()); // it is now an empty pointer
             fBlockRead = true;
+            ++peer.m_cmpctblock_reconstructed;
             // mapBlockSource is used for potentially punishing peers and
             // updating which peers send us compact blocks, so the race
             // between here and cs_main in ProcessNewBlock is fine.
@@ -4355,6 +4437,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             return;
         }
 
+        peer->m_cmpctblock_bytes += vRecv.size();
         CBlockHeaderAndShortTxIDs cmpctblock;
         vRecv >> cmpctblock;
 
@@ -4502,6 +4585,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                     // as long as it's first...
                     req.blockhash = pindex->GetBlockHash();
                     MakeAndPushMessage(pfrom, NetMsgType::GETBLOCKTXN, req);
+                    ++peer->m_cmpctblock_roundtrips;
                 } else if (pfrom.m_bip152_highbandwidth_to &&
                     (!pfrom.IsInboundConn() ||
                     IsBlockRequestedFromOutbound(blockhash) ||
@@ -4512,6 +4596,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                     // - it's not the final parallel download slot (which we may reserve for first outbound)
                     req.blockhash = pindex->GetBlockHash();
                     MakeAndPushMessage(pfrom, NetMsgType::GETBLOCKTXN, req);
+                    ++peer->m_cmpctblock_roundtrips;
                 } else {
                     // Give up for this peer and wait for other peer(s)
                     RemoveBlockRequest(pindex->GetBlockHash(), pfrom.GetId());
@@ -4532,6 +4617,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                 status = tempBlock.FillBlock(*pblock, dummy);
                 if (status == READ_STATUS_OK) {
                     fBlockReconstructed = true;
+                    ++peer->m_cmpctblock_reconstructed;
                 }
             }
         } else {
@@ -4601,6 +4687,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             return;
         }
 
+        peer->m_cmpctblock_bytes += vRecv.size();
         BlockTransactions resp;
         vRecv >> resp;
 
@@ -4920,6 +5007,43 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    if (msg_type == NetMsgType::REQRECON || msg_type == NetMsgType::SKETCH || msg_type == NetMsgType::RECONCILDIFF) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogDebug(BCLog::NET, "%s from peer=%d ignored, as we do not reconcile transactions with it\n", msg_type, pfrom.GetId());
+            return;
+        }
+        bool valid{false};
+        if (msg_type == NetMsgType::REQRECON) {
+            uint16_t peer_set_size, peer_q;
+            vRecv >> peer_set_size >> peer_q;
+            if (const auto sketch{m_txreconciliation->HandleReconciliationRequest(pfrom.GetId(), peer_set_size, peer_q, GetTime<std::chrono::microseconds>())}) {
+                MakeAndPushMessage(pfrom, NetMsgType::SKETCH, *sketch);
+                valid = true;
+            }
+        } else if (msg_type == NetMsgType::SKETCH) {
+            std::vector<uint8_t> skdata;
+            vRecv >> skdata;
+            if (const auto difference{m_txreconciliation->HandleSketch(pfrom.GetId(), skdata)}) {
+                AnnounceReconciledTxs(pfrom, *peer, difference->announce);
+                MakeAndPushMessage(pfrom, NetMsgType::RECONCILDIFF, uint8_t{difference->success}, difference->ask_shortids);
+                valid = true;
+            }
+        } else {
+            uint8_t success;
+            std::vector<uint32_t> ask_shortids;
+            vRecv >> success >> ask_shortids;
+            if (const auto announce{m_txreconciliation->HandleReconciliationDifference(pfrom.GetId(), success != 0, ask_shortids)}) {
+                AnnounceReconciledTxs(pfrom, *peer, *announce);
+                valid = true;
+            }
+        }
+        if (!valid) {
+            LogDebug(BCLog::NET, "txreconciliation protocol violation (unexpected %s), %s\n", msg_type, pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+        }
+        return;
+    }
+
     if (msg_type == NetMsgType::GETCFILTERS) {
         ProcessGetCFilters(pfrom, *peer, vRecv);
         return;
@@ -5660,22 +5784,32 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     LogDebug(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", __func__,
                             vHeaders.front().GetHash().ToString(), pto->GetId());
 
-                    std::optional<CSerializedNetMsg> cached_cmpctblock_msg;
+                    std::shared_ptr<const CBlock> cached_block;
+                    std::shared_ptr<const CBlockHeaderAndShortTxIDs> cached_cmpctblock;
                     {
                         LOCK(m_most_recent_block_mutex);
                         if (m_most_recent_block_hash == pBestIndex->GetBlockHash()) {
-                            cached_cmpctblock_msg = NetMsg::Make(NetMsgType::CMPCTBLOCK, *m_most_recent_compact_block);
+                            cached_block = m_most_recent_block;
+                            cached_cmpctblock = m_most_recent_compact_block;
                         }
                     }
-                    if (cached_cmpctblock_msg.has_value()) {
-                        PushMessage(*pto, std::move(cached_cmpctblock_msg.value()));
+                    std::vector<size_t> prefill;
+                    if (cached_block) {
+                        prefill = GetCompactBlockPrefill(*peer, *cached_block);
+                        if (prefill.empty()) {
+                            MakeAndPushMessage(*pto, NetMsgType::CMPCTBLOCK, *cached_cmpctblock);
+                        } else {
+                            MakeAndPushMessage(*pto, NetMsgType::CMPCTBLOCK, CBlockHeaderAndShortTxIDs{*cached_block, m_rng.rand64(), prefill});
+                        }
                     } else {
                         CBlock block;
                         const bool ret{m_chainman.m_blockman.ReadBlock(block, *pBestIndex)};
                         assert(ret);
-                        CBlockHeaderAndShortTxIDs cmpctblock{block, m_rng.rand64()};
+                        prefill = GetCompactBlockPrefill(*peer, block);
+                        CBlockHeaderAndShortTxIDs cmpctblock{block, m_rng.rand64(), prefill};
                         MakeAndPushMessage(*pto, NetMsgType::CMPCTBLOCK, cmpctblock);
                     }
+                    peer->m_cmpctblock_prefilled += prefill.size();
                     state.pindexBestHeaderSent = pBestIndex;
                 } else if (peer->m_prefers_headers) {
                     if (vHeaders.size() > 1) {
@@ -5739,8 +5873,17 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
             peer->m_blocks_for_inv_relay.clear();
         }
 
+        if (m_txreconciliation) {
+            // Flood what a stalled reconciliation round was holding back.
+            const auto expired{m_txreconciliation->ExpireReconciliation(pto->GetId(), current_time)};
+            if (!expired.empty()) AnnounceReconciledTxs(*pto, *peer, expired);
+        }
+
         if (auto tx_relay = peer->GetTxRelay(); tx_relay != nullptr) {
                 LOCK(tx_relay->m_tx_inventory_mutex);
+                // Reconciling peers learn about most transactions through set reconciliation
+                // (BIP 330); only a fraction of them is flooded.
+                const bool reconcile{m_txreconciliation && m_txreconciliation->IsPeerRegistered(pto->GetId())};
                 // Check whether periodic sends should happen
                 bool fSendTrickle = pto->HasPermission(NetPermissionFlags::NoBan);
                 if (tx_relay->m_next_inv_send_time < current_time) {
@@ -5833,6 +5976,13 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                             continue;
                         }
                         if (tx_relay->m_bloom_filter && !tx_relay->m_bloom_filter->IsRelevantAndUpdate(*txinfo.tx)) continue;
+                        // Leave it for the next reconciliation, unless it is picked for flooding
+                        // or the reconciliation set is full.
+                        if (reconcile && !m_txreconciliation->ShouldFanoutTo(Wtxid::FromUint256(hash), pto->GetId()) &&
+                            m_txreconciliation->AddToSet(pto->GetId(), Wtxid::FromUint256(hash))) {
+                            tx_relay->m_tx_inventory_known_filter.insert(hash);
+                            continue;
+                        }
                         // Send
                         vInv.push_back(inv);
                         nRelayedTransactions++;
@@ -5847,6 +5997,13 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     LOCK(m_mempool.cs);
                     tx_relay->m_last_inv_sequence = m_mempool.GetSequence();
                 }
+
+                if (reconcile && tx_relay->m_next_recon_request < current_time && m_txreconciliation->IsInitiator(pto->GetId())) {
+                    tx_relay->m_next_recon_request = current_time + RECON_REQUEST_INTERVAL;
+                    if (const auto request{m_txreconciliation->InitiateReconciliationRequest(pto->GetId(), current_time)}) {
+                        MakeAndPushMessage(*pto, NetMsgType::REQRECON, request->first, request->second);
+                    }
+                }
         }
         if (!vInv.empty())
             MakeAndPushMessage(*pto, NetMsgType::INV, vInv);
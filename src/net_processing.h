@@ -60,6 +60,10 @@ struct CNodeStateStats {
     uint64_t m_addr_processed = 0;
     uint64_t m_addr_rate_limited = 0;
     bool m_addr_relay_enabled{false};
+    uint64_t m_cmpctblock_reconstructed{0};
+    uint64_t m_cmpctblock_roundtrips{0};
+    uint64_t m_cmpctblock_bytes{0};
+    uint64_t m_cmpctblock_prefilled{0};
     ServiceFlags their_services;
     int64_t presync_height{-1};
     std::chrono::seconds time_offset{0};
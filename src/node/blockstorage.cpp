@@ -31,14 +31,20 @@
 #include <util/batchpriority.h>
 #include <util/check.h>
 #include <util/fs.h>
+#include <util/fs_helpers.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
+#include <util/time.h>
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <limits>
 #include <map>
 #include <optional>
+#include <stdexcept>
 #include <unordered_map>
 
 namespace kernel {
@@ -47,6 +53,7 @@ static constexpr uint8_t DB_BLOCK_INDEX{'b'};
 static constexpr uint8_t DB_FLAG{'F'};
 static constexpr uint8_t DB_REINDEX_FLAG{'R'};
 static constexpr uint8_t DB_LAST_BLOCK{'l'};
+static constexpr uint8_t DB_BLOCK_INDEX_SNAPSHOT{'s'};
 // Keys used in previous version that might still be found in the DB:
 // BlockTreeDB::DB_TXINDEX_BLOCK{'T'};
 // BlockTreeDB::DB_TXINDEX{'t'}
@@ -86,6 +93,8 @@ bool BlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFi
     for (const CBlockIndex* bi : blockinfo) {
         batch.Write(std::make_pair(DB_BLOCK_INDEX, bi->GetBlockHash()), CDiskBlockIndex{bi});
     }
+    // A block index snapshot no longer matches the database once this is written.
+    batch.Erase(DB_BLOCK_INDEX_SNAPSHOT);
     return WriteBatch(batch, true);
 }
 
@@ -149,6 +158,37 @@ bool BlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, s
 
     return true;
 }
+
+bool BlockTreeDB::BlockIndexKeysMatch(std::span<const uint256> sorted_hashes, const util::SignalInterrupt& interrupt)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
+    for (const uint256& hash : sorted_hashes) {
+        if (interrupt) return false;
+        std::pair<uint8_t, uint256> key;
+        if (!pcursor->Valid() || !pcursor->GetKey(key) || key != std::make_pair(DB_BLOCK_INDEX, hash)) return false;
+        pcursor->Next();
+    }
+    std::pair<uint8_t, uint256> key;
+    return !pcursor->Valid() || !pcursor->GetKey(key) || key.first != DB_BLOCK_INDEX;
+}
+
+bool BlockTreeDB::WriteBlockIndexSnapshotMarker(const uint256& checksum)
+{
+    return Write(DB_BLOCK_INDEX_SNAPSHOT, checksum, /*fSync=*/true);
+}
+
+std::optional<uint256> BlockTreeDB::ReadBlockIndexSnapshotMarker()
+{
+    uint256 checksum;
+    if (!Read(DB_BLOCK_INDEX_SNAPSHOT, checksum)) return std::nullopt;
+    return checksum;
+}
+
+bool BlockTreeDB::EraseBlockIndexSnapshotMarker()
+{
+    return Erase(DB_BLOCK_INDEX_SNAPSHOT, /*fSync=*/true);
+}
 } // namespace kernel
 
 namespace node {
@@ -395,13 +435,246 @@ CBlockIndex* BlockManager::InsertBlockIndex(const uint256& hash)
     return pindex;
 }
 
-bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockhash)
+namespace {
+static constexpr std::array<uint8_t, 4> BLOCK_INDEX_SNAPSHOT_MAGIC{'b', 'i', 'd', 'x'};
+static constexpr uint32_t BLOCK_INDEX_SNAPSHOT_VERSION{1};
+static constexpr uint32_t BLOCK_INDEX_SNAPSHOT_NO_PREV{std::numeric_limits<uint32_t>::max()};
+
+/**
+ * A block index entry in the snapshot file. All fields have a fixed size, so entries can be
+ * located by position, and the parent is referred to by its position rather than by its hash:
+ * entries are sorted by height, so it always comes earlier.
+ */
+struct BlockIndexSnapshotEntry {
+    uint256 hash;
+    uint32_t prev{BLOCK_INDEX_SNAPSHOT_NO_PREV};
+    int32_t height{0};
+    uint32_t status{0};
+    uint32_t tx_count{0};
+    int32_t file{0};
+    uint32_t data_pos{0};
+    uint32_t undo_pos{0};
+    int32_t version{0};
+    uint256 merkle_root;
+    uint32_t time{0};
+    uint32_t bits{0};
+    uint32_t nonce{0};
+
+    SERIALIZE_METHODS(BlockIndexSnapshotEntry, obj)
+    {
+        READWRITE(obj.hash, obj.prev, obj.height, obj.status, obj.tx_count, obj.file, obj.data_pos, obj.undo_pos,
+                  obj.version, obj.merkle_root, obj.time, obj.bits, obj.nonce);
+    }
+};
+
+/**
+ * Commit to the block file info last written to the database. It changes with every block
+ * stored, so a snapshot is discarded if blocks were added without it being updated.
+ */
+uint256 BlockFilesMarker(BlockTreeDB& db)
+{
+    int last_file{0};
+    CBlockFileInfo info;
+    db.ReadLastBlockFile(last_file);
+    db.ReadBlockFileInfo(last_file, info);
+    return (HashWriter{} << last_file << info).GetSHA256();
+}
+} // namespace
+
+bool BlockManager::LoadBlockIndexSnapshot(std::vector<CBlockIndex*>& sorted_by_height)
 {
-    if (!m_block_tree_db->LoadBlockIndexGuts(
-            GetConsensus(), [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); }, m_interrupt)) {
+    AssertLockHeld(cs_main);
+    const auto checksum{m_block_tree_db->ReadBlockIndexSnapshotMarker()};
+    if (!checksum) return false;
+    // The snapshot only matches the database until the block index is written to again, so it
+    // is used at most once.
+    if (!m_block_tree_db->EraseBlockIndexSnapshotMarker()) {
+        LogError("Failed to erase the block index snapshot marker\n");
+        return false;
+    }
+    const fs::path path{GetBlockIndexSnapshotPath()};
+    if (!m_opts.block_index_snapshot) {
+        fs::remove(path);
+        return false;
+    }
+
+    std::vector<BlockIndexSnapshotEntry> entries;
+    try {
+        const auto start{SteadyClock::now()};
+        AutoFile file{fsbridge::fopen(path, "rb")};
+        if (file.IsNull()) {
+            LogPrintf("Block index snapshot %s is missing, loading the block index database\n", fs::PathToString(path));
+            return false;
+        }
+        std::vector<uint8_t> data(fs::file_size(path));
+        file.read(MakeWritableByteSpan(data));
+        if (data.size() < uint256::size()) throw std::runtime_error{"file too short"};
+        const std::span<const uint8_t> payload{std::span{data}.first(data.size() - uint256::size())};
+        uint256 file_checksum;
+        SpanReader{std::span{data}.last(uint256::size())} >> file_checksum;
+        HashWriter hasher;
+        hasher.write(MakeByteSpan(payload));
+        if (hasher.GetHash() != file_checksum || file_checksum != *checksum) {
+            throw std::runtime_error{"checksum mismatch"};
+        }
+
+        SpanReader reader{payload};
+        std::array<uint8_t, 4> magic;
+        uint32_t version;
+        uint256 files_marker;
+        uint64_t count;
+        reader >> magic >> version >> files_marker >> count;
+        if (magic != BLOCK_INDEX_SNAPSHOT_MAGIC || version != BLOCK_INDEX_SNAPSHOT_VERSION) {
+            throw std::runtime_error{"unknown format"};
+        }
+        if (files_marker != BlockFilesMarker(*m_block_tree_db)) throw std::runtime_error{"block files changed"};
+        if (count > reader.size()) throw std::runtime_error{"bad entry count"};
+
+        entries.resize(count);
+        for (uint64_t i{0}; i < count; ++i) {
+            if (m_interrupt) return false;
+            BlockIndexSnapshotEntry& entry{entries[i]};
+            reader >> entry;
+            if (entry.prev != BLOCK_INDEX_SNAPSHOT_NO_PREV && (entry.prev >= i || entries[entry.prev].height + 1 != entry.height)) {
+                throw std::runtime_error{"inconsistent parent"};
+            }
+            if (!CheckProofOfWork(entry.hash, entry.bits, GetConsensus())) {
+                throw std::runtime_error{strprintf("CheckProofOfWork failed for %s", entry.hash.ToString())};
+            }
+        }
+        if (!reader.empty()) throw std::runtime_error{"trailing data"};
+
+        // The marker and the block file info only cover writes made by this code. Also check
+        // that the database holds the same blocks, which is much cheaper than loading them.
+        std::vector<uint256> hashes;
+        hashes.reserve(entries.size());
+        for (const BlockIndexSnapshotEntry& entry : entries) hashes.push_back(entry.hash);
+        std::sort(hashes.begin(), hashes.end());
+        if (!m_block_tree_db->BlockIndexKeysMatch(hashes, m_interrupt)) {
+            if (m_interrupt) return false;
+            throw std::runtime_error{"block index database changed"};
+        }
+        LogDebug(BCLog::BENCH, "Read block index snapshot of %u entries in %.2fms\n", count, Ticks<MillisecondsDouble>(SteadyClock::now() - start));
+    } catch (const std::exception& e) {
+        LogPrintf("Block index snapshot %s is unusable (%s), loading the block index database\n", fs::PathToString(path), e.what());
         return false;
     }
 
+    // Allocate the whole index at once, then link each entry to its parent by position.
+    m_block_index.reserve(entries.size());
+    sorted_by_height.clear();
+    sorted_by_height.reserve(entries.size());
+    for (const BlockIndexSnapshotEntry& entry : entries) {
+        CBlockIndex* pindex{InsertBlockIndex(entry.hash)};
+        pindex->pprev = entry.prev == BLOCK_INDEX_SNAPSHOT_NO_PREV ? nullptr : sorted_by_height[entry.prev];
+        pindex->nHeight = entry.height;
+        pindex->nFile = entry.file;
+        pindex->nDataPos = entry.data_pos;
+        pindex->nUndoPos = entry.undo_pos;
+        pindex->nVersion = entry.version;
+        pindex->hashMerkleRoot = entry.merkle_root;
+        pindex->nTime = entry.time;
+        pindex->nBits = entry.bits;
+        pindex->nNonce = entry.nonce;
+        pindex->nStatus = entry.status;
+        pindex->nTx = entry.tx_count;
+        sorted_by_height.push_back(pindex);
+    }
+    LogPrintf("Loaded %u block index entries from snapshot %s\n", entries.size(), fs::PathToString(path));
+    return true;
+}
+
+void BlockManager::WriteBlockIndexSnapshot()
+{
+    AssertLockHeld(cs_main);
+    if (!m_opts.block_index_snapshot || !m_block_index_loaded || !m_block_tree_db) return;
+    if (!m_dirty_blockindex.empty() || !m_dirty_fileinfo.empty()) {
+        LogPrintf("Not writing a block index snapshot, as the block index is not flushed\n");
+        return;
+    }
+
+    const auto start{SteadyClock::now()};
+    std::vector<CBlockIndex*> sorted_by_height{GetAllBlockIndices()};
+    std::sort(sorted_by_height.begin(), sorted_by_height.end(), CBlockIndexHeightOnlyComparator());
+    std::unordered_map<const CBlockIndex*, uint32_t> positions;
+    positions.reserve(sorted_by_height.size());
+
+    const fs::path path{GetBlockIndexSnapshotPath()};
+    const fs::path path_tmp{path + ".new"};
+    AutoFile file{fsbridge::fopen(path_tmp, "wb")};
+    if (file.IsNull()) {
+        LogError("Failed to open block index snapshot %s for writing\n", fs::PathToString(path_tmp));
+        return;
+    }
+    uint256 checksum;
+    try {
+        HashedSourceWriter writer{file};
+        writer << BLOCK_INDEX_SNAPSHOT_MAGIC << BLOCK_INDEX_SNAPSHOT_VERSION << BlockFilesMarker(*m_block_tree_db) << uint64_t(sorted_by_height.size());
+        // Serialize into a buffer first, so that the file is written in large chunks.
+        DataStream buffer;
+        for (const CBlockIndex* pindex : sorted_by_height) {
+            BlockIndexSnapshotEntry entry;
+            entry.hash = pindex->GetBlockHash();
+            if (pindex->pprev) {
+                const auto it{positions.find(pindex->pprev)};
+                if (it == positions.end()) throw std::runtime_error{"parent not sorted first"};
+                entry.prev = it->second;
+            }
+            entry.height = pindex->nHeight;
+            entry.status = pindex->nStatus;
+            entry.tx_count = pindex->nTx;
+            entry.file = pindex->nFile;
+            entry.data_pos = pindex->nDataPos;
+            entry.undo_pos = pindex->nUndoPos;
+            entry.version = pindex->nVersion;
+            entry.merkle_root = pindex->hashMerkleRoot;
+            entry.time = pindex->nTime;
+            entry.bits = pindex->nBits;
+            entry.nonce = pindex->nNonce;
+            positions.emplace(pindex, positions.size());
+            buffer << entry;
+            if (buffer.size() >= (1 << 20)) {
+                writer.write(MakeByteSpan(buffer));
+                buffer.clear();
+            }
+        }
+        writer.write(MakeByteSpan(buffer));
+        checksum = writer.GetHash();
+        file << checksum;
+    } catch (const std::exception& e) {
+        LogError("Failed to write block index snapshot: %s\n", e.what());
+        file.fclose();
+        fs::remove(path_tmp);
+        return;
+    }
+    if (!file.Commit() || file.fclose() != 0 || !RenameOver(path_tmp, path)) {
+        LogError("Failed to write block index snapshot %s\n", fs::PathToString(path));
+        file.fclose();
+        fs::remove(path_tmp);
+        return;
+    }
+    if (!m_block_tree_db->WriteBlockIndexSnapshotMarker(checksum)) {
+        LogError("Failed to mark the block index snapshot as current\n");
+        return;
+    }
+    LogPrintf("Wrote block index snapshot of %u entries to %s in %.2fms\n", sorted_by_height.size(), fs::PathToString(path),
+              Ticks<MillisecondsDouble>(SteadyClock::now() - start));
+}
+
+bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockhash)
+{
+    // Entries loaded from a block index snapshot come sorted by height already.
+    std::vector<CBlockIndex*> vSortedByHeight;
+    if (!LoadBlockIndexSnapshot(vSortedByHeight)) {
+        if (!m_block_tree_db->LoadBlockIndexGuts(
+                GetConsensus(), [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); }, m_interrupt)) {
+            return false;
+        }
+        vSortedByHeight = GetAllBlockIndices();
+        std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
+                  CBlockIndexHeightOnlyComparator());
+    }
+
     if (snapshot_blockhash) {
         const std::optional<AssumeutxoData> maybe_au_data = GetParams().AssumeutxoForBlockhash(*snapshot_blockhash);
         if (!maybe_au_data) {
@@ -427,10 +700,6 @@ bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockha
     Assert(m_snapshot_height.has_value() == snapshot_blockhash.has_value());
 
     // Calculate nChainWork
-    std::vector<CBlockIndex*> vSortedByHeight{GetAllBlockIndices()};
-    std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
-              CBlockIndexHeightOnlyComparator());
-
     CBlockIndex* previous_index{nullptr};
     for (CBlockIndex* pindex : vSortedByHeight) {
         if (m_interrupt) return false;
@@ -555,6 +824,7 @@ bool BlockManager::LoadBlockIndexDB(const std::optional<uint256>& snapshot_block
     m_block_tree_db->ReadReindexing(fReindexing);
     if (fReindexing) m_blockfiles_indexed = false;
 
+    m_block_index_loaded = true;
     return true;
 }
 
@@ -659,7 +929,11 @@ CBlockFileInfo* BlockManager::GetBlockFileInfo(size_t n)
 bool BlockManager::ReadBlockUndo(CBlockUndo& blockundo, const CBlockIndex& index) const
 {
     const FlatFilePos pos{WITH_LOCK(::cs_main, return index.GetUndoPos())};
+    return ReadBlockUndo(blockundo, pos, index.pprev->GetBlockHash());
+}
 
+bool BlockManager::ReadBlockUndo(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& prev_block_hash) const
+{
     // Open history file to read
     AutoFile file{OpenUndoFile(pos, true)};
     if (file.IsNull()) {
@@ -672,7 +946,7 @@ bool BlockManager::ReadBlockUndo(CBlockUndo& blockundo, const CBlockIndex& index
         // Read block
         HashVerifier verifier{filein}; // Use HashVerifier, as reserializing may lose data, c.f. commit d3424243
 
-        verifier << index.pprev->GetBlockHash();
+        verifier << prev_block_hash;
         verifier >> blockundo;
 
         uint256 hashChecksum;
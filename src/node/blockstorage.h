@@ -61,6 +61,18 @@ public:
     bool ReadFlag(const std::string& name, bool& fValue);
     bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, const util::SignalInterrupt& interrupt)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    /**
+     * Whether the block index entries in the database are exactly those with the given hashes,
+     * sorted in ascending order. Only the keys are compared.
+     */
+    bool BlockIndexKeysMatch(std::span<const uint256> sorted_hashes, const util::SignalInterrupt& interrupt);
+    /**
+     * Record the checksum of a block index snapshot matching the current database contents.
+     * Any later WriteBatchSync() erases it.
+     */
+    bool WriteBlockIndexSnapshotMarker(const uint256& checksum);
+    std::optional<uint256> ReadBlockIndexSnapshotMarker();
+    bool EraseBlockIndexSnapshotMarker();
 };
 } // namespace kernel
 
@@ -151,6 +163,20 @@ private:
     bool LoadBlockIndex(const std::optional<uint256>& snapshot_blockhash)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+     * Populate m_block_index from the snapshot written by WriteBlockIndexSnapshot(), if the
+     * database still matches it. The snapshot lists entries by height, and so are returned in
+     * @p sorted_by_height. Returns false, without touching m_block_index, if the block index
+     * must be loaded from the database instead.
+     */
+    bool LoadBlockIndexSnapshot(std::vector<CBlockIndex*>& sorted_by_height)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    fs::path GetBlockIndexSnapshotPath() const { return m_opts.blocks_dir / "blockindex.dat"; }
+
+    /** Whether m_block_index was loaded successfully and may be written to a snapshot. */
+    bool m_block_index_loaded GUARDED_BY(cs_main){false};
+
     /** Return false if block file or undo file flushing fails. */
     [[nodiscard]] bool FlushBlockFile(int blockfile_num, bool fFinalize, bool finalize_undo);
 
@@ -304,6 +330,14 @@ public:
     bool LoadBlockIndexDB(const std::optional<uint256>& snapshot_blockhash)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
+    /**
+     * Write the whole block index to a flat file which the next startup can load in one pass
+     * instead of iterating the block index database, and mark the database as matching it.
+     * Only meant to be called at shutdown, once the block index is flushed: any later write to
+     * the database would leave the snapshot stale. A no-op unless enabled in the options.
+     */
+    void WriteBlockIndexSnapshot() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
     /**
      * Remove any pruned block & undo files that are still on disk.
      * This could happen on some systems if the file was still being read while unlinked,
@@ -415,6 +449,7 @@ public:
     bool ReadBlock(CBlock& block, const CBlockIndex& index) const;
     bool ReadRawBlock(std::vector<uint8_t>& block, const FlatFilePos& pos) const;
 
+    bool ReadBlockUndo(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& prev_block_hash) const;
     bool ReadBlockUndo(CBlockUndo& blockundo, const CBlockIndex& index) const;
 
     void CleanupBlockRevFiles() const;
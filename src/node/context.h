@@ -79,6 +79,8 @@ struct NodeContext {
     std::unique_ptr<interfaces::Mining> mining;
     interfaces::WalletLoader* wallet_loader{nullptr};
     std::unique_ptr<CScheduler> scheduler;
+    //! Runs the per-subscriber queues of validation notifications
+    std::unique_ptr<CScheduler> notification_scheduler;
     std::function<void()> rpc_interruption_point = [] {};
     //! Issues blocking calls about sync status, errors and warnings
     std::unique_ptr<KernelNotifications> notifications;
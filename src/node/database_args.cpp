@@ -6,13 +6,93 @@
 
 #include <common/args.h>
 #include <dbwrapper.h>
+#include <tinyformat.h>
+#include <util/strencodings.h>
+#include <util/translation.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace node {
-void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options)
+namespace {
+constexpr std::array DB_TYPES{"chainstate", "blocks", "txindex", "coinstatsindex", "blockfilterindex"};
+
+struct DatabaseOption {
+    //! Database the option applies to, empty for all of them.
+    std::string db_type;
+    std::string name;
+    uint64_t value;
+};
+
+util::Result<DatabaseOption> ParseDatabaseOption(const std::string& arg)
+{
+    const auto error{[&] {
+        return util::Error{strprintf(_("Invalid -dboption value '%s'. Expected [<db>:]<option>=<value>"), arg)};
+    }};
+    DatabaseOption option;
+    const auto eq{arg.find('=')};
+    if (eq == std::string::npos) return error();
+    std::string key{arg.substr(0, eq)};
+    if (const auto colon{key.find(':')}; colon != std::string::npos) {
+        option.db_type = key.substr(0, colon);
+        key = key.substr(colon + 1);
+        if (std::find(DB_TYPES.begin(), DB_TYPES.end(), option.db_type) == DB_TYPES.end()) {
+            return util::Error{strprintf(_("Unknown database '%s' in -dboption. Valid databases are chainstate, blocks, txindex, coinstatsindex and blockfilterindex."), option.db_type)};
+        }
+    }
+    option.name = key;
+    const auto value{ToIntegral<uint64_t>(std::string_view{arg}.substr(eq + 1))};
+    if (!value) return error();
+    option.value = *value;
+
+    // Ranges follow the limits leveldb clamps these options to.
+    const auto check_range{[&](uint64_t min, uint64_t max) -> util::Result<DatabaseOption> {
+        if (option.value < min || option.value > max) {
+            return util::Error{strprintf(_("-dboption %s must be between %u and %u"), option.name, min, max)};
+        }
+        return option;
+    }};
+    if (option.name == "blocksize") return check_range(1 << 10, 4 << 20);
+    if (option.name == "bloombits") return check_range(0, 64);
+    if (option.name == "writebuffer") {
+        if (option.value == 0) return option;
+        return check_range(64 << 10, 1 << 30);
+    }
+    if (option.name == "compression") return check_range(0, 1);
+    if (option.name == "maxfilesize") return check_range(1 << 20, 1 << 30);
+    return util::Error{strprintf(_("Unknown -dboption '%s'. Valid options are blocksize, bloombits, writebuffer, compression and maxfilesize."), option.name)};
+}
+
+void ApplyDatabaseOption(const DatabaseOption& option, DBOptions& options)
+{
+    if (option.name == "blocksize") options.block_size = option.value;
+    if (option.name == "bloombits") options.bloom_bits = option.value;
+    if (option.name == "writebuffer") options.write_buffer_bytes = option.value;
+    if (option.name == "compression") options.compression = option.value != 0;
+    if (option.name == "maxfilesize") options.max_file_size = option.value;
+}
+} // namespace
+
+util::Result<void> ReadDatabaseArgs(const ArgsManager& args, DBOptions& options, std::string_view db_type)
 {
-    // Settings here apply to all databases (chainstate, blocks, and index
-    // databases), but it'd be easy to parse database-specific options by adding
-    // a database_type string or enum parameter to this function.
     if (auto value = args.GetBoolArg("-forcecompactdb")) options.force_compact = *value;
+
+    // Options for all databases apply first, so that a database-specific one
+    // wins regardless of the order they were given in.
+    std::vector<DatabaseOption> specific;
+    for (const std::string& arg : args.GetArgs("-dboption")) {
+        auto option{ParseDatabaseOption(arg)};
+        if (!option) return util::Error{util::ErrorString(option)};
+        if (option->db_type.empty()) {
+            ApplyDatabaseOption(*option, options);
+        } else if (option->db_type == db_type) {
+            specific.push_back(std::move(*option));
+        }
+    }
+    for (const auto& option : specific) ApplyDatabaseOption(option, options);
+    return {};
 }
 } // namespace node
@@ -5,11 +5,21 @@
 #ifndef BITCOIN_NODE_DATABASE_ARGS_H
 #define BITCOIN_NODE_DATABASE_ARGS_H
 
+#include <util/result.h>
+
+#include <string_view>
+
 class ArgsManager;
 struct DBOptions;
 
 namespace node {
-void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options);
+/**
+ * Apply -forcecompactdb and the -dboption entries that match db_type
+ * ("chainstate", "blocks", "txindex", "coinstatsindex" or
+ * "blockfilterindex"). Every -dboption entry is validated, whether it matches
+ * or not.
+ */
+[[nodiscard]] util::Result<void> ReadDatabaseArgs(const ArgsManager& args, DBOptions& options, std::string_view db_type);
 } // namespace node
 
 #endif // BITCOIN_NODE_DATABASE_ARGS_H
@@ -478,6 +478,7 @@ public:
     void ChainStateFlushed(ChainstateRole role, const CBlockLocator& locator) override {
         m_notifications->chainStateFlushed(role, locator);
     }
+    std::string ValidationInterfaceName() const override { return "chain_client"; }
     std::shared_ptr<Chain::Notifications> m_notifications;
 };
 
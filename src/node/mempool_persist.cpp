@@ -4,9 +4,14 @@
 
 #include <node/mempool_persist.h>
 
+#include <checkqueue.h>
 #include <clientversion.h>
+#include <coins.h>
 #include <consensus/amount.h>
+#include <crypto/common.h>
+#include <hash.h>
 #include <logging.h>
+#include <policy/policy.h>
 #include <primitives/transaction.h>
 #include <random.h>
 #include <serialize.h>
@@ -16,18 +21,29 @@
 #include <uint256.h>
 #include <util/fs.h>
 #include <util/fs_helpers.h>
+#include <util/hasher.h>
 #include <util/signalinterrupt.h>
+#include <util/thread.h>
 #include <util/time.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstdio>
 #include <exception>
 #include <functional>
+#include <ios>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
+#include <span>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -36,7 +52,244 @@ using fsbridge::FopenFn;
 namespace node {
 
 static const uint64_t MEMPOOL_DUMP_VERSION_NO_XOR_KEY{1};
-static const uint64_t MEMPOOL_DUMP_VERSION{2};
+static const uint64_t MEMPOOL_DUMP_VERSION_NO_CHUNKS{2};
+static const uint64_t MEMPOOL_DUMP_VERSION{3};
+//! Number of transactions read from mempool.dat whose scripts are verified in
+//! parallel before they are submitted to the mempool.
+static constexpr size_t LOAD_MEMPOOL_BATCH_SIZE{1000};
+
+/**
+ * Since version 3, the XOR-key of mempool.dat is followed by a sequence of
+ * chunks, each made of its type, the size of its payload, the payload and a
+ * checksum of the payload. The file can then be brought up to date by
+ * appending the transactions added to and removed from the mempool since it
+ * was last written, and a chunk torn by a crash while appending is detected
+ * when loading the file.
+ */
+enum class DumpChunk : uint8_t {
+    //! Transactions added to the mempool, each followed by its entry time.
+    ADD = 1,
+    //! Witness ids of transactions removed from the mempool.
+    REMOVE = 2,
+    //! Fee deltas and unbroadcast set, replacing those of earlier chunks.
+    STATE = 3,
+};
+//! Maximum number of transactions in a chunk.
+static constexpr size_t DUMP_CHUNK_MAX_TXS{1000};
+//! Payload size after which no more transactions are added to a chunk.
+static constexpr size_t DUMP_CHUNK_TARGET_SIZE{1 << 20};
+//! Size below which a mempool file is appended to however much of it is
+//! taken by removed transactions.
+static constexpr uint64_t DUMP_COMPACT_MIN_SIZE{1 << 20};
+
+/** What is known about the version 3 mempool file last written or loaded. */
+struct DumpState {
+    fs::path path;
+    std::vector<std::byte> xor_key;
+    //! Size of the file up to the end of its last valid chunk.
+    uint64_t file_size{0};
+    //! Size of the record of each transaction in the file that wasn't
+    //! removed since, by witness id.
+    std::unordered_map<Wtxid, uint64_t, SaltedTxidHasher> txs;
+    //! Sum of the sizes in txs.
+    uint64_t live_size{0};
+    //! Hash of the payload of the last STATE chunk.
+    uint256 state_hash;
+};
+
+static Mutex g_dump_mutex;
+static std::optional<DumpState> g_dump_state GUARDED_BY(g_dump_mutex);
+
+//! Thread rewriting the mempool file for a background checkpoint, and whether
+//! it is still running.
+static Mutex g_rewrite_mutex;
+static std::thread g_rewrite_thread GUARDED_BY(g_rewrite_mutex);
+static std::atomic<bool> g_rewriting{false};
+
+static uint32_t ChunkChecksum(std::span<const std::byte> payload)
+{
+    return ReadLE32(Hash(payload).begin());
+}
+
+static void WriteChunk(AutoFile& file, DumpChunk type, const DataStream& payload)
+{
+    file << uint8_t(type) << uint32_t(payload.size());
+    file.write(MakeByteSpan(payload));
+    file << ChunkChecksum(MakeByteSpan(payload));
+}
+
+static DataStream SerializeState(const std::map<uint256, CAmount>& deltas, const std::set<uint256>& unbroadcast_txids)
+{
+    DataStream payload;
+    payload << deltas << unbroadcast_txids;
+    return payload;
+}
+
+//! Write chunks with the added transactions and record them in state.
+static void WriteAdded(AutoFile& file, const std::vector<TxMempoolInfo>& added, DumpState& state)
+{
+    DataStream payload;
+    size_t txs{0};
+    for (const auto& info : added) {
+        const size_t start{payload.size()};
+        payload << TX_WITH_WITNESS(*info.tx) << int64_t{count_seconds(info.m_time)};
+        const auto [it, inserted]{state.txs.try_emplace(info.tx->GetWitnessHash(), payload.size() - start)};
+        if (inserted) state.live_size += it->second;
+        if (++txs == DUMP_CHUNK_MAX_TXS || payload.size() >= DUMP_CHUNK_TARGET_SIZE) {
+            WriteChunk(file, DumpChunk::ADD, payload);
+            payload.clear();
+            txs = 0;
+        }
+    }
+    if (txs > 0) WriteChunk(file, DumpChunk::ADD, payload);
+}
+
+//! Write chunks with the removed transactions and forget them in state.
+static void WriteRemoved(AutoFile& file, const std::vector<Wtxid>& removed, DumpState& state)
+{
+    DataStream payload;
+    for (size_t i{0}; i < removed.size(); ++i) {
+        payload << removed[i].ToUint256();
+        if (const auto it{state.txs.find(removed[i])}; it != state.txs.end()) {
+            state.live_size -= it->second;
+            state.txs.erase(it);
+        }
+        if ((i + 1) % DUMP_CHUNK_MAX_TXS == 0 || i + 1 == removed.size()) {
+            WriteChunk(file, DumpChunk::REMOVE, payload);
+            payload.clear();
+        }
+    }
+}
+
+/**
+ * Read the chunk at the position of @p file, of which @p end is the size.
+ * Throws if the chunk is incomplete or corrupt, as left behind by a crash
+ * while appending to the file.
+ */
+static std::pair<uint8_t, DataStream> ReadChunk(AutoFile& file, int64_t end)
+{
+    const int64_t pos{file.tell()};
+    uint8_t type;
+    uint32_t size;
+    file >> type >> size;
+    if (size > std::min<uint64_t>(MAX_SIZE, end - pos)) throw std::ios_base::failure("chunk size out of range");
+    DataStream payload;
+    payload.resize(size);
+    file.read(MakeWritableByteSpan(payload));
+    uint32_t checksum;
+    file >> checksum;
+    if (checksum != ChunkChecksum(MakeByteSpan(payload))) throw std::ios_base::failure("chunk checksum mismatch");
+    return {type, std::move(payload)};
+}
+
+/** A transaction of a version 3 mempool file that wasn't removed again. */
+struct LiveRecord {
+    //! Position of its last record among those of all ADD chunks.
+    uint64_t index;
+    Txid txid;
+};
+
+/**
+ * What the first pass over the chunks of a version 3 mempool file found. The
+ * transactions themselves are only kept by the second pass, one chunk at a
+ * time, as they are submitted.
+ */
+struct ChunkedDump {
+    //! Position of the first chunk in the file.
+    int64_t begin{0};
+    //! Transactions to submit, by witness id.
+    std::unordered_map<Wtxid, LiveRecord, SaltedTxidHasher> live;
+    //! Position of the record of the transactions to submit, by txid.
+    std::unordered_map<Txid, uint64_t, SaltedTxidHasher> live_txids;
+    std::map<uint256, CAmount> deltas;
+    std::set<uint256> unbroadcast_txids;
+    DumpState state;
+};
+
+/**
+ * Replay the chunks of a version 3 mempool file following its XOR-key, without
+ * keeping their transactions. Reading stops at the first incomplete or corrupt
+ * chunk, so the second pass only reads the chunks before it.
+ */
+static ChunkedDump ScanChunks(AutoFile& file)
+{
+    ChunkedDump dump;
+    DumpState& state{dump.state};
+    uint64_t records{0};
+    const auto remove{[&](const Wtxid& wtxid) {
+        if (const auto it{dump.live.find(wtxid)}; it != dump.live.end()) {
+            const auto txid_it{dump.live_txids.find(it->second.txid)};
+            if (txid_it != dump.live_txids.end() && txid_it->second == it->second.index) dump.live_txids.erase(txid_it);
+            dump.live.erase(it);
+        }
+        if (const auto it{state.txs.find(wtxid)}; it != state.txs.end()) {
+            state.live_size -= it->second;
+            state.txs.erase(it);
+        }
+    }};
+
+    dump.begin = file.tell();
+    file.seek(0, SEEK_END);
+    const int64_t end{file.tell()};
+    file.seek(dump.begin, SEEK_SET);
+    state.file_size = dump.begin;
+    while (int64_t(state.file_size) < end) {
+        try {
+            auto [type, payload]{ReadChunk(file, end)};
+            switch (DumpChunk{type}) {
+            case DumpChunk::ADD: {
+                // Decode the whole chunk before replaying it, so that a chunk
+                // that can't be decoded is ignored like a corrupt one.
+                std::vector<std::tuple<Wtxid, Txid, uint64_t>> txs;
+                while (!payload.empty()) {
+                    const size_t before{payload.size()};
+                    CTransactionRef tx;
+                    int64_t time;
+                    payload >> TX_WITH_WITNESS(tx) >> time;
+                    txs.emplace_back(tx->GetWitnessHash(), tx->GetHash(), before - payload.size());
+                }
+                for (const auto& [wtxid, txid, size] : txs) {
+                    remove(wtxid);
+                    dump.live.emplace(wtxid, LiveRecord{records, txid});
+                    dump.live_txids.insert_or_assign(txid, records);
+                    state.txs.emplace(wtxid, size);
+                    state.live_size += size;
+                    ++records;
+                }
+                break;
+            }
+            case DumpChunk::REMOVE: {
+                std::vector<uint256> wtxids;
+                while (!payload.empty()) {
+                    payload >> wtxids.emplace_back();
+                }
+                for (const uint256& wtxid : wtxids) {
+                    remove(Wtxid::FromUint256(wtxid));
+                }
+                break;
+            }
+            case DumpChunk::STATE: {
+                const uint256 state_hash{Hash(MakeByteSpan(payload))};
+                std::map<uint256, CAmount> deltas;
+                std::set<uint256> unbroadcast_txids;
+                payload >> deltas >> unbroadcast_txids;
+                dump.deltas = std::move(deltas);
+                dump.unbroadcast_txids = std::move(unbroadcast_txids);
+                state.state_hash = state_hash;
+                break;
+            }
+            default:
+                // Skip chunks of a type added by a later version.
+                break;
+            }
+        } catch (const std::exception& e) {
+            LogInfo("Ignoring the last %d bytes of the mempool file: %s\n", end - int64_t(state.file_size), e.what());
+            break;
+        }
+        state.file_size = file.tell();
+    }
+    return dump;
+}
 
 bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active_chainstate, ImportMempoolOptions&& opts)
 {
@@ -55,80 +308,253 @@ bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active
     int64_t unbroadcast = 0;
     const auto now{NodeClock::now()};
 
+    // Transactions are read in batches. The scripts of a batch are verified
+    // on the chainstate's script check queue first, which stores their valid
+    // signatures in the signature cache, so that submitting the transactions
+    // one at a time afterwards doesn't verify the signatures again.
+    ChainstateManager& chainman{active_chainstate.m_chainman};
+    struct LoadEntry {
+        CTransactionRef tx;
+        int64_t time;
+    };
+    std::vector<LoadEntry> batch;
+    const auto is_expired{[&](const LoadEntry& entry) {
+        return entry.time <= TicksSinceEpoch<std::chrono::seconds>(now - pool.m_opts.expiry);
+    }};
+    const auto warm_up_signature_cache{[&] {
+        // Same lock order as connecting a block. Blocks wait for the batch
+        // to be verified, like they wait for each other.
+        LOCK2(cs_main, pool.cs);
+        CCheckQueue<CScriptCheck>& queue{chainman.GetCheckQueue(active_chainstate)};
+        if (!queue.HasThreads()) return;
+        CCheckQueueControl<CScriptCheck> control{queue};
+        CCoinsViewMemPool view{&active_chainstate.CoinsTip(), pool};
+        // Referenced by the queued checks, so sized for the batch up front.
+        std::vector<PrecomputedTransactionData> txdata;
+        txdata.reserve(batch.size());
+        // Transactions of the batch spending an earlier one of the batch
+        // find their spent outputs here, as mempool.dat lists parents
+        // before their children.
+        std::unordered_map<Txid, const CTransaction*, SaltedTxidHasher> batch_txs;
+        for (const LoadEntry& entry : batch) {
+            const CTransaction& tx{*entry.tx};
+            batch_txs.emplace(tx.GetHash(), &tx);
+            if (is_expired(entry)) continue;
+            std::vector<CTxOut> spent_outputs;
+            spent_outputs.reserve(tx.vin.size());
+            for (const CTxIn& txin : tx.vin) {
+                if (const auto parent{batch_txs.find(txin.prevout.hash)}; parent != batch_txs.end()) {
+                    if (txin.prevout.n >= parent->second->vout.size()) break;
+                    spent_outputs.push_back(parent->second->vout[txin.prevout.n]);
+                } else if (const auto coin{view.GetCoin(txin.prevout)}) {
+                    spent_outputs.push_back(coin->out);
+                } else {
+                    break;
+                }
+            }
+            // Leave transactions with missing inputs to AcceptToMemoryPool.
+            if (spent_outputs.size() != tx.vin.size()) continue;
+            PrecomputedTransactionData& tx_data{txdata.emplace_back()};
+            std::vector<CScriptCheck> checks;
+            checks.reserve(tx.vin.size());
+            for (unsigned int i{0}; i < tx.vin.size(); ++i) {
+                checks.emplace_back(spent_outputs[i], tx, chainman.m_validation_cache.m_signature_cache, i,
+                                    STANDARD_SCRIPT_VERIFY_FLAGS, /*cacheIn=*/true, &tx_data);
+            }
+            tx_data.Init(tx, std::move(spent_outputs));
+            control.Add(std::move(checks));
+        }
+        // The queue stops at the first invalid input, which only leaves the
+        // rest of the batch to be verified by AcceptToMemoryPool, which
+        // rejects the invalid transaction.
+        control.Complete();
+    }};
+
     try {
         uint64_t version;
         file >> version;
         std::vector<std::byte> xor_key;
         if (version == MEMPOOL_DUMP_VERSION_NO_XOR_KEY) {
             // Leave XOR-key empty
-        } else if (version == MEMPOOL_DUMP_VERSION) {
+        } else if (version == MEMPOOL_DUMP_VERSION_NO_CHUNKS || version == MEMPOOL_DUMP_VERSION) {
             file >> xor_key;
         } else {
             return false;
         }
         file.SetXor(xor_key);
+        std::optional<ChunkedDump> chunked;
+        int64_t chunks_end{0};
         uint64_t total_txns_to_load;
-        file >> total_txns_to_load;
+        if (version == MEMPOOL_DUMP_VERSION) {
+            chunked.emplace(ScanChunks(file));
+            chunks_end = chunked->state.file_size;
+            total_txns_to_load = chunked->live.size();
+            chunked->state.path = load_path;
+            chunked->state.xor_key = xor_key;
+            LOCK(g_dump_mutex);
+            // Append to the loaded file from now on, unless a file was
+            // written by this process already.
+            if (!g_dump_state) g_dump_state.emplace(std::move(chunked->state));
+        } else {
+            file >> total_txns_to_load;
+        }
         uint64_t txns_tried = 0;
         LogInfo("Loading %u mempool transactions from file...\n", total_txns_to_load);
         int next_tenth_to_report = 0;
-        while (txns_tried < total_txns_to_load) {
-            const int percentage_done(100.0 * txns_tried / total_txns_to_load);
-            if (next_tenth_to_report < percentage_done / 10) {
-                LogInfo("Progress loading mempool transactions from file: %d%% (tried %u, %u remaining)\n",
-                        percentage_done, txns_tried, total_txns_to_load - txns_tried);
-                next_tenth_to_report = percentage_done / 10;
-            }
-            ++txns_tried;
-
-            CTransactionRef tx;
-            int64_t nTime;
-            int64_t nFeeDelta;
-            file >> TX_WITH_WITNESS(tx);
-            file >> nTime;
-            file >> nFeeDelta;
+        const auto submit_batch{[&] {
+            warm_up_signature_cache();
+            for (const LoadEntry& entry : batch) {
+                const int percentage_done(100.0 * txns_tried / total_txns_to_load);
+                if (next_tenth_to_report < percentage_done / 10) {
+                    LogInfo("Progress loading mempool transactions from file: %d%% (tried %u, %u remaining)\n",
+                            percentage_done, txns_tried, total_txns_to_load - txns_tried);
+                    next_tenth_to_report = percentage_done / 10;
+                }
+                ++txns_tried;
 
+                if (!is_expired(entry)) {
+                    LOCK(cs_main);
+                    const auto& accepted = AcceptToMemoryPool(active_chainstate, entry.tx, entry.time, /*bypass_limits=*/false, /*test_accept=*/false);
+                    if (accepted.m_result_type == MempoolAcceptResult::ResultType::VALID) {
+                        ++count;
+                    } else {
+                        // mempool may contain the transaction already, e.g. from
+                        // wallet(s) having loaded it while we were processing
+                        // mempool transactions; consider these as valid, instead of
+                        // failed, but mark them as 'already there'
+                        if (pool.exists(GenTxid::Txid(entry.tx->GetHash()))) {
+                            ++already_there;
+                        } else {
+                            ++failed;
+                        }
+                    }
+                } else {
+                    ++expired;
+                }
+                if (chainman.m_interrupt)
+                    return false;
+            }
+            batch.clear();
+            return true;
+        }};
+        const auto load_tx{[&](CTransactionRef tx, int64_t nTime) {
             if (opts.use_current_time) {
                 nTime = TicksSinceEpoch<std::chrono::seconds>(now);
             }
+            batch.push_back({std::move(tx), nTime});
+            return batch.size() < LOAD_MEMPOOL_BATCH_SIZE || submit_batch();
+        }};
 
-            CAmount amountdelta = nFeeDelta;
-            if (amountdelta && opts.apply_fee_delta_priority) {
-                pool.PrioritiseTransaction(tx->GetHash(), amountdelta);
+        std::set<uint256> unbroadcast_txids;
+        if (chunked) {
+            // The fee deltas of a chunked file include those of its
+            // transactions, so apply them before submitting these.
+            if (opts.apply_fee_delta_priority) {
+                for (const auto& [txid, delta] : chunked->deltas) {
+                    pool.PrioritiseTransaction(txid, delta);
+                }
             }
-            if (nTime > TicksSinceEpoch<std::chrono::seconds>(now - pool.m_opts.expiry)) {
-                LOCK(cs_main);
-                const auto& accepted = AcceptToMemoryPool(active_chainstate, tx, nTime, /*bypass_limits=*/false, /*test_accept=*/false);
-                if (accepted.m_result_type == MempoolAcceptResult::ResultType::VALID) {
-                    ++count;
-                } else {
-                    // mempool may contain the transaction already, e.g. from
-                    // wallet(s) having loaded it while we were processing
-                    // mempool transactions; consider these as valid, instead of
-                    // failed, but mark them as 'already there'
-                    if (pool.exists(GenTxid::Txid(tx->GetHash()))) {
-                        ++already_there;
-                    } else {
-                        ++failed;
+
+            // Read the chunks again, submitting the last record of each
+            // transaction that wasn't removed. A transaction added back to
+            // the mempool by a reorg comes after its children in the file, so
+            // these wait for it, by its txid.
+            std::unordered_map<Txid, std::vector<std::pair<CTransactionRef, int64_t>>, SaltedTxidHasher> waiting;
+            std::unordered_set<Txid, SaltedTxidHasher> waiting_txids;
+            uint64_t index{0};
+            const auto waits_for{[&](const CTransaction& tx) -> std::optional<Txid> {
+                for (const CTxIn& txin : tx.vin) {
+                    const auto parent{chunked->live_txids.find(txin.prevout.hash)};
+                    if (parent == chunked->live_txids.end()) continue;
+                    if (parent->second > index || waiting_txids.contains(parent->first)) return parent->first;
+                }
+                return std::nullopt;
+            }};
+            const auto submit{[&](CTransactionRef tx, int64_t nTime) {
+                std::vector<std::pair<CTransactionRef, int64_t>> ready;
+                ready.emplace_back(std::move(tx), nTime);
+                while (!ready.empty()) {
+                    auto next{std::move(ready.back())};
+                    ready.pop_back();
+                    const Txid txid{next.first->GetHash()};
+                    if (const auto parent{waits_for(*next.first)}) {
+                        waiting_txids.insert(txid);
+                        waiting[*parent].push_back(std::move(next));
+                        continue;
+                    }
+                    waiting_txids.erase(txid);
+                    if (!load_tx(std::move(next.first), next.second)) return false;
+                    if (auto children{waiting.extract(txid)}) {
+                        std::move(children.mapped().begin(), children.mapped().end(), std::back_inserter(ready));
                     }
                 }
-            } else {
-                ++expired;
+                return true;
+            }};
+            file.seek(chunked->begin, SEEK_SET);
+            try {
+                while (file.tell() < chunks_end) {
+                    auto [type, payload]{ReadChunk(file, chunks_end)};
+                    if (DumpChunk{type} != DumpChunk::ADD) continue;
+                    while (!payload.empty()) {
+                        CTransactionRef tx;
+                        int64_t nTime;
+                        payload >> TX_WITH_WITNESS(tx) >> nTime;
+                        const auto live{chunked->live.find(tx->GetWitnessHash())};
+                        if (live != chunked->live.end() && live->second.index == index) {
+                            if (!submit(std::move(tx), nTime)) return false;
+                        }
+                        ++index;
+                    }
+                }
+            } catch (const std::exception&) {
+                // The file changed since it was first read. Still submit the
+                // transactions read before the error.
+                if (!submit_batch()) return false;
+                throw;
             }
-            if (active_chainstate.m_chainman.m_interrupt)
-                return false;
-        }
-        std::map<uint256, CAmount> mapDeltas;
-        file >> mapDeltas;
+            // Leave transactions whose parent couldn't be read to
+            // AcceptToMemoryPool.
+            for (auto& [parent, children] : waiting) {
+                for (auto& [tx, nTime] : children) {
+                    if (!load_tx(std::move(tx), nTime)) return false;
+                }
+            }
+            if (!batch.empty() && !submit_batch()) return false;
+            unbroadcast_txids = std::move(chunked->unbroadcast_txids);
+        } else {
+            for (uint64_t txns_read{0}; txns_read < total_txns_to_load; ++txns_read) {
+                CTransactionRef tx;
+                int64_t nTime;
+                int64_t nFeeDelta;
+                try {
+                    file >> TX_WITH_WITNESS(tx);
+                    file >> nTime;
+                    file >> nFeeDelta;
+                } catch (const std::exception&) {
+                    // Still submit the transactions read before the error.
+                    if (!submit_batch()) return false;
+                    throw;
+                }
 
-        if (opts.apply_fee_delta_priority) {
-            for (const auto& i : mapDeltas) {
-                pool.PrioritiseTransaction(i.first, i.second);
+                CAmount amountdelta = nFeeDelta;
+                if (amountdelta && opts.apply_fee_delta_priority) {
+                    pool.PrioritiseTransaction(tx->GetHash(), amountdelta);
+                }
+                if (!load_tx(std::move(tx), nTime)) return false;
             }
-        }
+            if (!batch.empty() && !submit_batch()) return false;
 
-        std::set<uint256> unbroadcast_txids;
-        file >> unbroadcast_txids;
+            std::map<uint256, CAmount> mapDeltas;
+            file >> mapDeltas;
+
+            if (opts.apply_fee_delta_priority) {
+                for (const auto& i : mapDeltas) {
+                    pool.PrioritiseTransaction(i.first, i.second);
+                }
+            }
+
+            file >> unbroadcast_txids;
+        }
         if (opts.apply_unbroadcast_set) {
             unbroadcast = unbroadcast_txids.size();
             for (const auto& txid : unbroadcast_txids) {
@@ -146,58 +572,83 @@ bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active
     return true;
 }
 
-bool DumpMempool(const CTxMemPool& pool, const fs::path& dump_path, FopenFn mockable_fopen_function, bool skip_file_commit)
-{
-    auto start = SteadyClock::now();
-
-    std::map<uint256, CAmount> mapDeltas;
-    std::vector<TxMempoolInfo> vinfo;
+/** Contents of the mempool to write to a new file. */
+struct MempoolSnapshot {
+    std::map<uint256, CAmount> deltas;
+    std::vector<TxMempoolInfo> txs;
     std::set<uint256> unbroadcast_txids;
+    bool persist_v1_dat;
+    //! Time taken to copy the contents while holding pool.cs.
+    SteadyClock::duration copy_time;
+};
 
-    static Mutex dump_mutex;
-    LOCK(dump_mutex);
-
+static MempoolSnapshot TakeSnapshot(const CTxMemPool& pool)
+{
+    const auto start{SteadyClock::now()};
+    MempoolSnapshot snapshot;
+    snapshot.persist_v1_dat = pool.m_opts.persist_v1_dat;
     {
         LOCK(pool.cs);
         for (const auto &i : pool.mapDeltas) {
-            mapDeltas[i.first] = i.second;
+            snapshot.deltas[i.first] = i.second;
         }
-        vinfo = pool.infoAll();
-        unbroadcast_txids = pool.GetUnbroadcastTxs();
+        snapshot.txs = pool.infoAll();
+        snapshot.unbroadcast_txids = pool.GetUnbroadcastTxs();
     }
+    snapshot.copy_time = SteadyClock::now() - start;
+    return snapshot;
+}
 
+/** Write the snapshot to a new file and move it over dump_path. */
+static bool WriteMempoolFile(MempoolSnapshot snapshot, const fs::path& dump_path, FopenFn mockable_fopen_function, bool skip_file_commit)
+    EXCLUSIVE_LOCKS_REQUIRED(g_dump_mutex)
+{
     auto mid = SteadyClock::now();
 
+    std::map<uint256, CAmount>& mapDeltas{snapshot.deltas};
+    const std::vector<TxMempoolInfo>& vinfo{snapshot.txs};
+    const std::set<uint256>& unbroadcast_txids{snapshot.unbroadcast_txids};
+
     AutoFile file{mockable_fopen_function(dump_path + ".new", "wb")};
     if (file.IsNull()) {
         return false;
     }
 
     try {
-        const uint64_t version{pool.m_opts.persist_v1_dat ? MEMPOOL_DUMP_VERSION_NO_XOR_KEY : MEMPOOL_DUMP_VERSION};
-        file << version;
+        std::optional<DumpState> state;
+        LogInfo("Writing %u mempool transactions to file...\n", vinfo.size());
+        if (snapshot.persist_v1_dat) {
+            file << MEMPOOL_DUMP_VERSION_NO_XOR_KEY;
+            uint64_t mempool_transactions_to_write(vinfo.size());
+            file << mempool_transactions_to_write;
+            for (const auto& i : vinfo) {
+                file << TX_WITH_WITNESS(*(i.tx));
+                file << int64_t{count_seconds(i.m_time)};
+                file << int64_t{i.nFeeDelta};
+                mapDeltas.erase(i.tx->GetHash());
+            }
 
-        std::vector<std::byte> xor_key(8);
-        if (!pool.m_opts.persist_v1_dat) {
-            FastRandomContext{}.fillrand(xor_key);
-            file << xor_key;
-        }
-        file.SetXor(xor_key);
+            file << mapDeltas;
 
-        uint64_t mempool_transactions_to_write(vinfo.size());
-        file << mempool_transactions_to_write;
-        LogInfo("Writing %u mempool transactions to file...\n", mempool_transactions_to_write);
-        for (const auto& i : vinfo) {
-            file << TX_WITH_WITNESS(*(i.tx));
-            file << int64_t{count_seconds(i.m_time)};
-            file << int64_t{i.nFeeDelta};
-            mapDeltas.erase(i.tx->GetHash());
-        }
+            LogInfo("Writing %d unbroadcast transactions to file.\n", unbroadcast_txids.size());
+            file << unbroadcast_txids;
+        } else {
+            state.emplace();
+            state->path = dump_path;
+            state->xor_key.resize(8);
+            FastRandomContext{}.fillrand(state->xor_key);
+            file << MEMPOOL_DUMP_VERSION;
+            file << state->xor_key;
+            file.SetXor(state->xor_key);
 
-        file << mapDeltas;
+            WriteAdded(file, vinfo, *state);
 
-        LogInfo("Writing %d unbroadcast transactions to file.\n", unbroadcast_txids.size());
-        file << unbroadcast_txids;
+            LogInfo("Writing %d unbroadcast transactions to file.\n", unbroadcast_txids.size());
+            const DataStream payload{SerializeState(mapDeltas, unbroadcast_txids)};
+            state->state_hash = Hash(MakeByteSpan(payload));
+            WriteChunk(file, DumpChunk::STATE, payload);
+            state->file_size = file.tell();
+        }
 
         if (!skip_file_commit && !file.Commit())
             throw std::runtime_error("Commit failed");
@@ -205,10 +656,15 @@ bool DumpMempool(const CTxMemPool& pool, const fs::path& dump_path, FopenFn mock
         if (!RenameOver(dump_path + ".new", dump_path)) {
             throw std::runtime_error("Rename failed");
         }
+        if (state) {
+            g_dump_state.emplace(std::move(*state));
+        } else {
+            g_dump_state.reset();
+        }
         auto last = SteadyClock::now();
 
         LogInfo("Dumped mempool: %.3fs to copy, %.3fs to dump, %d bytes dumped to file\n",
-                  Ticks<SecondsDouble>(mid - start),
+                  Ticks<SecondsDouble>(snapshot.copy_time),
                   Ticks<SecondsDouble>(last - mid),
                   fs::file_size(dump_path));
     } catch (const std::exception& e) {
@@ -218,4 +674,119 @@ bool DumpMempool(const CTxMemPool& pool, const fs::path& dump_path, FopenFn mock
     return true;
 }
 
+bool DumpMempool(const CTxMemPool& pool, const fs::path& dump_path, FopenFn mockable_fopen_function, bool skip_file_commit)
+{
+    MempoolSnapshot snapshot{TakeSnapshot(pool)};
+    LOCK(g_dump_mutex);
+    return WriteMempoolFile(std::move(snapshot), dump_path, mockable_fopen_function, skip_file_commit);
+}
+
+bool CheckpointMempool(const CTxMemPool& pool, const fs::path& dump_path, FopenFn mockable_fopen_function, bool skip_file_commit, bool background)
+{
+    LOCK(g_rewrite_mutex);
+    if (g_rewrite_thread.joinable()) {
+        // The rewrite will be brought up to date by the next checkpoint.
+        if (background && g_rewriting) return true;
+        g_rewrite_thread.join();
+    }
+    LOCK(g_dump_mutex);
+    const auto rewrite{[&]() EXCLUSIVE_LOCKS_REQUIRED(g_rewrite_mutex, g_dump_mutex) {
+        MempoolSnapshot snapshot{TakeSnapshot(pool)};
+        if (!background) return WriteMempoolFile(std::move(snapshot), dump_path, mockable_fopen_function, skip_file_commit);
+        // Only the copy of the mempool is made on the calling thread, so that
+        // the scheduler isn't held up while the file is written.
+        g_rewriting = true;
+        g_rewrite_thread = std::thread(&util::TraceThread, "mempoolwrite", [snapshot = std::move(snapshot), dump_path, mockable_fopen_function, skip_file_commit]() mutable {
+            LOCK(g_dump_mutex);
+            WriteMempoolFile(std::move(snapshot), dump_path, mockable_fopen_function, skip_file_commit);
+            g_rewriting = false;
+        });
+        return true;
+    }};
+    // Rewrite the file if it can't be appended to, or to compact it once most
+    // of it is taken by transactions removed from the mempool since.
+    if (pool.m_opts.persist_v1_dat || !g_dump_state || g_dump_state->path != dump_path ||
+        (g_dump_state->file_size > DUMP_COMPACT_MIN_SIZE && g_dump_state->file_size > 2 * g_dump_state->live_size)) {
+        return rewrite();
+    }
+    DumpState& state{*g_dump_state};
+
+    auto start = SteadyClock::now();
+
+    std::vector<TxMempoolInfo> added;
+    std::vector<Wtxid> removed;
+    DataStream state_payload;
+
+    {
+        LOCK(pool.cs);
+        std::vector<CTxMemPool::txiter> new_entries;
+        for (auto it{pool.mapTx.begin()}; it != pool.mapTx.end(); ++it) {
+            if (!state.txs.contains(it->GetTx().GetWitnessHash())) new_entries.push_back(it);
+        }
+        // A transaction has more ancestors than any of its parents.
+        std::sort(new_entries.begin(), new_entries.end(), [](CTxMemPool::txiter a, CTxMemPool::txiter b) {
+            return a->GetCountWithAncestors() < b->GetCountWithAncestors();
+        });
+        added.reserve(new_entries.size());
+        for (const auto it : new_entries) {
+            added.push_back({it->GetSharedTx(), it->GetTime(), it->GetFee(), it->GetTxSize(), it->GetModifiedFee() - it->GetFee()});
+        }
+        if (pool.mapTx.size() - new_entries.size() < state.txs.size()) {
+            for (const auto& [wtxid, size] : state.txs) {
+                if (!pool.exists(GenTxid::Wtxid(wtxid))) removed.push_back(wtxid);
+            }
+        }
+        state_payload = SerializeState(pool.mapDeltas, pool.GetUnbroadcastTxs());
+    }
+
+    auto mid = SteadyClock::now();
+
+    AutoFile file{mockable_fopen_function(dump_path, "rb+")};
+    int64_t file_size{-1};
+    if (!file.IsNull()) {
+        try {
+            file.seek(0, SEEK_END);
+            file_size = file.tell();
+        } catch (const std::ios_base::failure&) {
+        }
+    }
+    if (file_size < 0 || uint64_t(file_size) != state.file_size) {
+        // The file was changed since this process last wrote or loaded it,
+        // e.g. truncated by a crash.
+        file.fclose();
+        return rewrite();
+    }
+
+    const uint256 state_hash{Hash(MakeByteSpan(state_payload))};
+    if (added.empty() && removed.empty() && state_hash == state.state_hash) return true;
+
+    try {
+        file.SetXor(state.xor_key);
+        WriteRemoved(file, removed, state);
+        WriteAdded(file, added, state);
+        if (state_hash != state.state_hash) {
+            WriteChunk(file, DumpChunk::STATE, state_payload);
+            state.state_hash = state_hash;
+        }
+
+        if (!skip_file_commit && !file.Commit())
+            throw std::runtime_error("Commit failed");
+        state.file_size = file.tell();
+        file.fclose();
+        auto last = SteadyClock::now();
+
+        LogInfo("Appended to mempool file: %u transactions added, %u removed, %.3fs to copy, %.3fs to dump, %d bytes appended\n",
+                added.size(), removed.size(),
+                Ticks<SecondsDouble>(mid - start),
+                Ticks<SecondsDouble>(last - mid),
+                state.file_size - file_size);
+    } catch (const std::exception& e) {
+        // The file may end with part of a chunk now, so rewrite it next time.
+        g_dump_state.reset();
+        LogInfo("Failed to dump mempool: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    return true;
+}
+
 } // namespace node
@@ -7,16 +7,36 @@
 
 #include <util/fs.h>
 
+#include <chrono>
+
 class Chainstate;
 class CTxMemPool;
 
 namespace node {
 
+//! How often the mempool file is brought up to date while the node runs.
+static constexpr std::chrono::minutes MEMPOOL_CHECKPOINT_INTERVAL{15};
+
 /** Dump the mempool to a file. */
 bool DumpMempool(const CTxMemPool& pool, const fs::path& dump_path,
                  fsbridge::FopenFn mockable_fopen_function = fsbridge::fopen,
                  bool skip_file_commit = false);
 
+/**
+ * Bring the mempool file up to date. If the file was last written or loaded
+ * by this process, only the transactions added to or removed from the mempool
+ * since are appended to it. Otherwise, or once most of the file is taken by
+ * removed transactions, it is rewritten like by DumpMempool.
+ *
+ * With @p background, a rewrite happens on a thread of its own, and
+ * checkpoints are skipped until it is done. Without it, a rewrite still
+ * running is waited for, and the file is brought up to date before returning.
+ */
+bool CheckpointMempool(const CTxMemPool& pool, const fs::path& dump_path,
+                       fsbridge::FopenFn mockable_fopen_function = fsbridge::fopen,
+                       bool skip_file_commit = false,
+                       bool background = false);
+
 struct ImportMempoolOptions {
     fsbridge::FopenFn mockable_fopen_function{fsbridge::fopen};
     bool use_current_time{false};
@@ -15,6 +15,7 @@
 #include <validationinterface.h>
 #include <node/transaction.h>
 
+#include <algorithm>
 #include <future>
 
 namespace node {
@@ -155,4 +156,52 @@ CTransactionRef GetTransaction(const CBlockIndex* const block_index, const CTxMe
     }
     return nullptr;
 }
+
+std::vector<CTransactionRef> GetTransactions(const CBlockIndex* const block_index, const CTxMemPool* const mempool, std::span<const uint256> hashes, std::vector<uint256>& hash_blocks, const BlockManager& blockman)
+{
+    std::vector<CTransactionRef> txs(hashes.size());
+    hash_blocks.assign(hashes.size(), uint256{});
+    if (mempool && !block_index) {
+        for (size_t i{0}; i < hashes.size(); ++i) txs[i] = mempool->get(hashes[i]);
+    }
+    const auto missing{[&] {
+        std::vector<size_t> missing;
+        for (size_t i{0}; i < hashes.size(); ++i) {
+            if (!txs[i]) missing.push_back(i);
+        }
+        return missing;
+    }};
+    if (g_txindex) {
+        const std::vector<size_t> indices{missing()};
+        std::vector<uint256> index_hashes;
+        index_hashes.reserve(indices.size());
+        for (const size_t i : indices) index_hashes.push_back(hashes[i]);
+        std::vector<uint256> block_hashes;
+        std::vector<CTransactionRef> index_txs{g_txindex->FindTxs(index_hashes, block_hashes)};
+        for (size_t j{0}; j < indices.size(); ++j) {
+            // Don't return a transaction if the provided block hash doesn't
+            // match, as in GetTransaction().
+            if (index_txs[j] && (!block_index || block_index->GetBlockHash() == block_hashes[j])) {
+                txs[indices[j]] = std::move(index_txs[j]);
+                hash_blocks[indices[j]] = block_hashes[j];
+            }
+        }
+    }
+    if (const std::vector<size_t> indices{missing()}; block_index && !indices.empty()) {
+        CBlock block;
+        if (blockman.ReadBlock(block, *block_index)) {
+            std::vector<std::pair<uint256, size_t>> wanted;
+            for (const size_t i : indices) wanted.emplace_back(hashes[i], i);
+            std::sort(wanted.begin(), wanted.end());
+            for (const auto& tx : block.vtx) {
+                const uint256& hash{tx->GetHash().ToUint256()};
+                for (auto it{std::lower_bound(wanted.begin(), wanted.end(), std::make_pair(hash, size_t{0}))}; it != wanted.end() && it->first == hash; ++it) {
+                    txs[it->second] = tx;
+                    hash_blocks[it->second] = block_index->GetBlockHash();
+                }
+            }
+        }
+    }
+    return txs;
+}
 } // namespace node
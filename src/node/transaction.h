@@ -9,6 +9,9 @@
 #include <policy/feerate.h>
 #include <primitives/transaction.h>
 
+#include <span>
+#include <vector>
+
 class CBlockIndex;
 class CTxMemPool;
 namespace Consensus {
@@ -64,6 +67,16 @@ static const CAmount DEFAULT_MAX_BURN_AMOUNT{0};
  * @returns                    The tx if found, otherwise nullptr
  */
 CTransactionRef GetTransaction(const CBlockIndex* const block_index, const CTxMemPool* const mempool, const uint256& hash, uint256& hashBlock, const BlockManager& blockman);
+
+/**
+ * Return transactions with the given hashes, looked up like GetTransaction(),
+ * with a single -txindex lookup and a single read of block_index for all of
+ * them.
+ *
+ * @param[out] hash_blocks     The block hash of each tx, if it was found via -txindex or block_index
+ * @returns                    One entry per hash, that is the tx if found, otherwise nullptr
+ */
+std::vector<CTransactionRef> GetTransactions(const CBlockIndex* const block_index, const CTxMemPool* const mempool, std::span<const uint256> hashes, std::vector<uint256>& hash_blocks, const BlockManager& blockman);
 } // namespace node
 
 #endif // BITCOIN_NODE_TRANSACTION_H
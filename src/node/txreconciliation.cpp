@@ -5,10 +5,18 @@
 #include <node/txreconciliation.h>
 
 #include <common/system.h>
+#include <crypto/siphash.h>
 #include <logging.h>
+#include <node/minisketchwrapper.h>
+#include <random.h>
 #include <util/check.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
 
 
@@ -29,6 +37,26 @@ uint256 ComputeSalt(uint64_t salt1, uint64_t salt2)
     return (HashWriter(RECON_SALT_HASHER) << std::min(salt1, salt2) << std::max(salt1, salt2)).GetSHA256();
 }
 
+/**
+ * Estimate the sketch capacity needed to decode the difference between two sets, following
+ * BIP-330: the size difference, plus q times the smaller set, plus one.
+ */
+size_t EstimateSketchCapacity(size_t local_set_size, size_t remote_set_size, double q)
+{
+    const size_t set_size_diff{local_set_size > remote_set_size ? local_set_size - remote_set_size : remote_set_size - local_set_size};
+    const size_t min_size{std::min(local_set_size, remote_set_size)};
+    return set_size_diff + static_cast<size_t>(std::ceil(q * min_size)) + 1;
+}
+
+/** Phase of the reconciliation round currently ongoing with a peer. */
+enum class ReconciliationPhase {
+    NONE,
+    /** We sent reqrecon and wait for the peer's sketch. */
+    INIT_REQUESTED,
+    /** We sent a sketch and wait for the peer's reconcildiff. */
+    INIT_RESPONDED,
+};
+
 /**
  * Keeps track of txreconciliation-related per-peer state.
  */
@@ -36,9 +64,6 @@ class TxReconciliationState
 {
 public:
     /**
-     * TODO: This field is public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * Reconciliation protocol assumes using one role consistently: either a reconciliation
      * initiator (requesting sketches), or responder (sending sketches). This defines our role,
      * based on the direction of the p2p connection.
@@ -47,14 +72,44 @@ public:
     bool m_we_initiate;
 
     /**
-     * TODO: These fields are public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * These values are used to salt short IDs, which is necessary for transaction reconciliations.
      */
     uint64_t m_k0, m_k1;
 
+    /** Transactions to announce to the peer in the next reconciliation round. */
+    std::set<Wtxid> m_local_set;
+
+    /**
+     * Responder only: the set we sent a sketch of. Transactions arriving meanwhile go to
+     * m_local_set and wait for the next round.
+     */
+    std::vector<Wtxid> m_local_set_snapshot;
+
+    ReconciliationPhase m_phase{ReconciliationPhase::NONE};
+
+    /** When the ongoing round entered m_phase. */
+    std::chrono::microseconds m_phase_start{0};
+
+    /** Initiator only: the q coefficient sent with our next request, learned from past rounds. */
+    double m_q{DEFAULT_RECON_Q};
+
     TxReconciliationState(bool we_initiate, uint64_t k0, uint64_t k1) : m_we_initiate(we_initiate), m_k0(k0), m_k1(k1) {}
+
+    /** Short ID of a transaction for sketches, as specified by BIP-330. Never zero. */
+    uint32_t ComputeShortID(const Wtxid& wtxid) const
+    {
+        const uint64_t s{SipHashUint256(m_k0, m_k1, wtxid.ToUint256())};
+        return 1 + static_cast<uint32_t>(s % 0xFFFFFFFF);
+    }
+
+    /** Build a sketch of the given capacity over the given transactions. */
+    template <typename Txs>
+    Minisketch ComputeSketch(const Txs& wtxids, size_t capacity) const
+    {
+        Minisketch sketch{node::MakeMinisketch32(capacity)};
+        for (const Wtxid& wtxid : wtxids) sketch.Add(ComputeShortID(wtxid));
+        return sketch;
+    }
 };
 
 } // namespace
@@ -76,6 +131,23 @@ private:
      */
     std::unordered_map<NodeId, std::variant<uint64_t, TxReconciliationState>> m_states GUARDED_BY(m_txreconciliation_mutex);
 
+    /** Secret used to pick the peers each transaction is flooded to. */
+    const uint64_t m_fanout_k0{FastRandomContext().rand64()}, m_fanout_k1{FastRandomContext().rand64()};
+
+    TxReconciliationState* GetRegisteredState(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return nullptr;
+        return std::get_if<TxReconciliationState>(&recon_state->second);
+    }
+
+    const TxReconciliationState* GetRegisteredState(NodeId peer_id) const EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return nullptr;
+        return std::get_if<TxReconciliationState>(&recon_state->second);
+    }
+
 public:
     explicit Impl(uint32_t recon_version) : m_recon_version(recon_version) {}
 
@@ -142,6 +214,165 @@ public:
         return (recon_state != m_states.end() &&
                 std::holds_alternative<TxReconciliationState>(recon_state->second));
     }
+
+    bool IsInitiator(NodeId peer_id) const EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        const auto* state{GetRegisteredState(peer_id)};
+        return state && state->m_we_initiate;
+    }
+
+    bool ShouldFanoutTo(const Wtxid& wtxid, NodeId peer_id) const EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        const auto* state{GetRegisteredState(peer_id)};
+        if (!state) return true;
+        const int percent{state->m_we_initiate ? OUTBOUND_FANOUT_PERCENT : INBOUND_FANOUT_PERCENT};
+        return SipHashUint256Extra(m_fanout_k0, m_fanout_k1, wtxid.ToUint256(), static_cast<uint32_t>(peer_id)) % 100 < static_cast<uint64_t>(percent);
+    }
+
+    bool AddToSet(NodeId peer_id, const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state{GetRegisteredState(peer_id)};
+        if (!state) return false;
+        if (state->m_local_set.size() >= MAX_RECONSET_SIZE) {
+            LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation set for peer=%d is full, flooding tx %s\n", peer_id, wtxid.ToString());
+            return false;
+        }
+        state->m_local_set.insert(wtxid);
+        return true;
+    }
+
+    std::optional<std::pair<uint16_t, uint16_t>> InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state{GetRegisteredState(peer_id)};
+        if (!state || !state->m_we_initiate || state->m_phase != ReconciliationPhase::NONE) return std::nullopt;
+
+        state->m_phase = ReconciliationPhase::INIT_REQUESTED;
+        state->m_phase_start = now;
+        const auto set_size{static_cast<uint16_t>(std::min<size_t>(state->m_local_set.size(), std::numeric_limits<uint16_t>::max()))};
+        const auto q{static_cast<uint16_t>(std::lround(state->m_q * Q_PRECISION))};
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Request reconciliation from peer=%d (set size %u, q %u)\n", peer_id, set_size, q);
+        return std::make_pair(set_size, q);
+    }
+
+    std::optional<std::vector<uint8_t>> HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q, std::chrono::microseconds now) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state{GetRegisteredState(peer_id)};
+        if (!state || state->m_we_initiate || state->m_phase != ReconciliationPhase::NONE) return std::nullopt;
+
+        state->m_phase = ReconciliationPhase::INIT_RESPONDED;
+        state->m_phase_start = now;
+        state->m_local_set_snapshot.assign(state->m_local_set.begin(), state->m_local_set.end());
+        state->m_local_set.clear();
+
+        const double q{double(peer_q) / Q_PRECISION};
+        const size_t capacity{EstimateSketchCapacity(state->m_local_set_snapshot.size(), peer_set_size, q)};
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Respond to reconciliation request from peer=%d (set sizes %u/%u, capacity %u)\n",
+                      peer_id, state->m_local_set_snapshot.size(), peer_set_size, capacity);
+        // An empty sketch tells the initiator to fall back to flooding.
+        if (capacity > MAX_SKETCH_CAPACITY) return std::vector<uint8_t>{};
+        return state->ComputeSketch(state->m_local_set_snapshot, capacity).Serialize();
+    }
+
+    std::optional<ReconciliationDifference> HandleSketch(NodeId peer_id, std::span<const uint8_t> skdata) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state{GetRegisteredState(peer_id)};
+        if (!state || !state->m_we_initiate || state->m_phase != ReconciliationPhase::INIT_REQUESTED) return std::nullopt;
+        // Sketches of 32-bit short IDs are a whole number of 4-byte elements.
+        if (skdata.size() % 4 != 0 || skdata.size() / 4 > MAX_SKETCH_CAPACITY) return std::nullopt;
+
+        state->m_phase = ReconciliationPhase::NONE;
+        ReconciliationDifference result;
+        const size_t capacity{skdata.size() / 4};
+        std::optional<std::vector<uint64_t>> differences;
+        if (capacity > 0) {
+            Minisketch sketch{state->ComputeSketch(state->m_local_set, capacity)};
+            sketch.Merge(node::MakeMinisketch32(capacity).Deserialize(skdata));
+            differences = sketch.Decode(capacity);
+        }
+
+        if (!differences) {
+            LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d failed, flooding %u txs\n", peer_id, state->m_local_set.size());
+            result.announce.assign(state->m_local_set.begin(), state->m_local_set.end());
+            state->m_local_set.clear();
+            return result;
+        }
+
+        std::unordered_map<uint32_t, Wtxid> local_shortids;
+        for (const Wtxid& wtxid : state->m_local_set) local_shortids.emplace(state->ComputeShortID(wtxid), wtxid);
+        for (const uint64_t shortid : *differences) {
+            if (auto it{local_shortids.find(shortid)}; it != local_shortids.end()) {
+                result.announce.push_back(it->second);
+            } else {
+                result.ask_shortids.push_back(shortid);
+            }
+        }
+        result.success = true;
+
+        // Learn q from the actual difference, for the capacity estimate of the next round.
+        const size_t local_size{state->m_local_set.size()};
+        const size_t remote_size{local_size - result.announce.size() + result.ask_shortids.size()};
+        const size_t min_size{std::min(local_size, remote_size)};
+        if (min_size > 0) {
+            const size_t size_diff{std::max(local_size, remote_size) - min_size};
+            const double q{double(differences->size() - std::min(differences->size(), size_diff)) / min_size};
+            state->m_q = std::clamp(q, 0.0, double(std::numeric_limits<uint16_t>::max()) / Q_PRECISION);
+        }
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d succeeded: announcing %u txs, asking for %u\n",
+                      peer_id, result.announce.size(), result.ask_shortids.size());
+        state->m_local_set.clear();
+        return result;
+    }
+
+    std::optional<std::vector<Wtxid>> HandleReconciliationDifference(NodeId peer_id, bool success, std::span<const uint32_t> ask_shortids) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state{GetRegisteredState(peer_id)};
+        if (!state || state->m_we_initiate || state->m_phase != ReconciliationPhase::INIT_RESPONDED) return std::nullopt;
+        // A decoded difference can't be larger than the sketch we sent.
+        if (ask_shortids.size() > MAX_SKETCH_CAPACITY) return std::nullopt;
+
+        state->m_phase = ReconciliationPhase::NONE;
+        std::vector<Wtxid> announce;
+        if (!success) {
+            announce = std::move(state->m_local_set_snapshot);
+        } else {
+            const std::unordered_set<uint32_t> asked(ask_shortids.begin(), ask_shortids.end());
+            for (const Wtxid& wtxid : state->m_local_set_snapshot) {
+                if (asked.contains(state->ComputeShortID(wtxid))) announce.push_back(wtxid);
+            }
+        }
+        state->m_local_set_snapshot.clear();
+        return announce;
+    }
+
+    std::vector<Wtxid> ExpireReconciliation(NodeId peer_id, std::chrono::microseconds now) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state{GetRegisteredState(peer_id)};
+        if (!state || state->m_phase == ReconciliationPhase::NONE || now <= state->m_phase_start + RECON_RESPONSE_TIMEOUT) return {};
+
+        state->m_phase = ReconciliationPhase::NONE;
+        std::vector<Wtxid> announce{std::move(state->m_local_set_snapshot)};
+        state->m_local_set_snapshot.clear();
+        announce.insert(announce.end(), state->m_local_set.begin(), state->m_local_set.end());
+        state->m_local_set.clear();
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d timed out, flooding %u txs\n", peer_id, announce.size());
+        return announce;
+    }
 };
 
 TxReconciliationTracker::TxReconciliationTracker(uint32_t recon_version) : m_impl{std::make_unique<TxReconciliationTracker::Impl>(recon_version)} {}
@@ -168,3 +399,43 @@ bool TxReconciliationTracker::IsPeerRegistered(NodeId peer_id) const
 {
     return m_impl->IsPeerRegistered(peer_id);
 }
+
+bool TxReconciliationTracker::IsInitiator(NodeId peer_id) const
+{
+    return m_impl->IsInitiator(peer_id);
+}
+
+bool TxReconciliationTracker::ShouldFanoutTo(const Wtxid& wtxid, NodeId peer_id) const
+{
+    return m_impl->ShouldFanoutTo(wtxid, peer_id);
+}
+
+bool TxReconciliationTracker::AddToSet(NodeId peer_id, const Wtxid& wtxid)
+{
+    return m_impl->AddToSet(peer_id, wtxid);
+}
+
+std::optional<std::pair<uint16_t, uint16_t>> TxReconciliationTracker::InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now)
+{
+    return m_impl->InitiateReconciliationRequest(peer_id, now);
+}
+
+std::optional<std::vector<uint8_t>> TxReconciliationTracker::HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q, std::chrono::microseconds now)
+{
+    return m_impl->HandleReconciliationRequest(peer_id, peer_set_size, peer_q, now);
+}
+
+std::optional<ReconciliationDifference> TxReconciliationTracker::HandleSketch(NodeId peer_id, std::span<const uint8_t> skdata)
+{
+    return m_impl->HandleSketch(peer_id, skdata);
+}
+
+std::optional<std::vector<Wtxid>> TxReconciliationTracker::HandleReconciliationDifference(NodeId peer_id, bool success, std::span<const uint32_t> ask_shortids)
+{
+    return m_impl->HandleReconciliationDifference(peer_id, success, ask_shortids);
+}
+
+std::vector<Wtxid> TxReconciliationTracker::ExpireReconciliation(NodeId peer_id, std::chrono::microseconds now)
+{
+    return m_impl->ExpireReconciliation(peer_id, now);
+}
@@ -7,12 +7,43 @@
 
 #include <net.h>
 #include <sync.h>
+#include <util/transaction_identifier.h>
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 #include <tuple>
+#include <vector>
 
 /** Supported transaction reconciliation protocol version */
 static constexpr uint32_t TXRECONCILIATION_VERSION{1};
+/** How often we request a reconciliation from each peer we initiate reconciliations with. */
+static constexpr std::chrono::seconds RECON_REQUEST_INTERVAL{8};
+/**
+ * How long a reconciliation round may wait for the peer's next message. After that the round
+ * ends and the transactions it held are flooded to the peer.
+ */
+static constexpr std::chrono::seconds RECON_RESPONSE_TIMEOUT{60};
+/**
+ * Maximum number of transactions waiting in a reconciliation set. Beyond it, transactions are
+ * flooded to the peer instead, so a slow or stuck reconciliation cannot hold up relay.
+ */
+static constexpr size_t MAX_RECONSET_SIZE{3000};
+/**
+ * Maximum capacity of a sketch we build or accept. Decoding cost grows quadratically with the
+ * capacity; a larger estimated difference falls back to flooding the whole set.
+ */
+static constexpr size_t MAX_SKETCH_CAPACITY{1024};
+/** The q coefficient of BIP-330 is sent as a fixed-point number with this precision. */
+static constexpr uint16_t Q_PRECISION{(1 << 15) - 1};
+/** Starting value of q, before any reconciliation with a peer finished. */
+static constexpr double DEFAULT_RECON_Q{0.25};
+/** Percentage of transactions flooded, rather than reconciled, to each reconciling outbound peer. */
+static constexpr int OUTBOUND_FANOUT_PERCENT{25};
+/** Percentage of transactions flooded, rather than reconciled, to each reconciling inbound peer. */
+static constexpr int INBOUND_FANOUT_PERCENT{10};
 
 enum class ReconciliationRegisterResult {
     NOT_FOUND,
@@ -21,6 +52,16 @@ enum class ReconciliationRegisterResult {
     PROTOCOL_VIOLATION,
 };
 
+/** What the reconciliation initiator learned from a peer's sketch. */
+struct ReconciliationDifference {
+    /** Whether the set difference could be decoded. If not, both sides flood their sets. */
+    bool success{false};
+    /** Transactions the peer is missing, to be announced to it. */
+    std::vector<Wtxid> announce;
+    /** Short IDs of transactions we are missing, to be requested from the peer. */
+    std::vector<uint32_t> ask_shortids;
+};
+
 /**
  * Transaction reconciliation is a way for nodes to efficiently announce transactions.
  * This object keeps track of all txreconciliation-related communications with the peers.
@@ -43,6 +84,10 @@ enum class ReconciliationRegisterResult {
  * FAILURE. The initiator notifies the peer about the failure and announces all transactions from
  *          the corresponding set. Once the peer received the failure notification, the peer
  *          announces all transactions from their set.
+ *
+ * Sketch extensions are not requested yet: a sketch which fails to decode leads to FAILURE.
+ * A round which gets no reply within RECON_RESPONSE_TIMEOUT ends, and the transactions it held
+ * are flooded.
 
  * This is a modification of the Erlay protocol (https://arxiv.org/abs/1905.10518) with two
  * changes (sketch extensions instead of bisections, and an extra INV exchange round), both
@@ -84,6 +129,61 @@ public:
      * Check if a peer is registered to reconcile transactions with us.
      */
     bool IsPeerRegistered(NodeId peer_id) const;
+
+    /**
+     * Whether we initiate reconciliations with a registered peer (true for outbound peers),
+     * rather than respond to them.
+     */
+    bool IsInitiator(NodeId peer_id) const;
+
+    /**
+     * Whether a transaction should be flooded to a peer instead of being added to its
+     * reconciliation set. Always true for peers which are not registered. The choice is random
+     * but stable for a given (transaction, peer) pair, and floods to a fraction of reconciling
+     * peers so that transactions still propagate quickly.
+     */
+    bool ShouldFanoutTo(const Wtxid& wtxid, NodeId peer_id) const;
+
+    /**
+     * Step 1. Add a transaction to the set we will reconcile with the peer. Returns false if the
+     * peer is not registered or the set is full, in which case the caller should flood it.
+     */
+    bool AddToSet(NodeId peer_id, const Wtxid& wtxid);
+
+    /**
+     * Step 2 (initiator). Start a reconciliation round with the peer if none is ongoing. Returns
+     * our set size and q (scaled by Q_PRECISION) to send in a reqrecon message.
+     */
+    std::optional<std::pair<uint16_t, uint16_t>> InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now);
+
+    /**
+     * Step 2 (responder). Answer a reqrecon message with a sketch of our set, and keep a snapshot
+     * of the set until the initiator reports the difference. An empty sketch means the difference
+     * is too large and both sides should flood. Returns std::nullopt on a protocol violation.
+     */
+    std::optional<std::vector<uint8_t>> HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q, std::chrono::microseconds now);
+
+    /**
+     * Steps 3 and 4 (initiator). Combine the peer's sketch with ours and decode the set
+     * difference. On failure, announce contains our whole set. Either way the round ends and
+     * our set is cleared. Returns std::nullopt on a protocol violation.
+     */
+    std::optional<ReconciliationDifference> HandleSketch(NodeId peer_id, std::span<const uint8_t> skdata);
+
+    /**
+     * Step 4 (responder). Handle the initiator's reconcildiff message and return the transactions
+     * from our snapshot to announce: those asked for, or all of them if reconciliation failed.
+     * Returns std::nullopt on a protocol violation.
+     */
+    std::optional<std::vector<Wtxid>> HandleReconciliationDifference(NodeId peer_id, bool success, std::span<const uint32_t> ask_shortids);
+
+    /**
+     * End the ongoing round with the peer if it started more than RECON_RESPONSE_TIMEOUT before
+     * now, and return the transactions it held, to be flooded instead: our set on the initiator
+     * side, the snapshot and the set on the responder side. A reply arriving after that is a
+     * message out of turn, and so a protocol violation.
+     */
+    std::vector<Wtxid> ExpireReconciliation(NodeId peer_id, std::chrono::microseconds now);
 };
 
 #endif // BITCOIN_NODE_TXRECONCILIATION_H
@@ -0,0 +1,386 @@
+// Copyright (c) 2025-present The QBTC developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODEHASHMAP_H
+#define BITCOIN_NODEHASHMAP_H
+
+#include <support/allocators/pool.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Hash map with an open-addressing index over individually allocated nodes.
+ *
+ * The index is a flat array of one control byte per slot (7 bits of the
+ * key's hash, or an empty/deleted marker) plus a parallel array of node
+ * pointers. Lookups compare a whole group of 16 control bytes at once (with
+ * SSE2 where available) and only dereference nodes whose tag matches, so a
+ * typical lookup touches one cache line of metadata and one node, instead of
+ * a bucket array and a chain of nodes.
+ *
+ * Nodes are allocated from a PoolResource and never move, so references and
+ * pointers to elements stay valid until the element is erased, just like
+ * with std::unordered_map. Iterators are invalidated by any insertion that
+ * grows the index.
+ *
+ * Only the subset of the std::unordered_map interface needed by its users is
+ * provided.
+ */
+template <typename Key, typename T, typename Hash, typename KeyEqual, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES = alignof(std::max_align_t)>
+class NodeHashMap
+{
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = PoolAllocator<value_type, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>;
+
+private:
+    //! Number of control bytes that are probed at once.
+    static constexpr size_t GROUP_WIDTH{16};
+    //! Control byte of a slot that was never used. Stops a probe sequence.
+    static constexpr uint8_t CTRL_EMPTY{0x80};
+    //! Control byte of a slot whose element was erased. Probing continues past it.
+    static constexpr uint8_t CTRL_DELETED{0xFE};
+
+    //! Control bytes, one per slot. Full slots hold the low 7 bits of the hash.
+    std::vector<uint8_t> m_ctrl;
+    //! Node pointers, one per slot. Only meaningful for full slots.
+    std::vector<value_type*> m_slots;
+    size_t m_size{0};
+    //! Number of slots that are either full or deleted.
+    size_t m_used{0};
+    Hash m_hash;
+    KeyEqual m_equal;
+    allocator_type m_alloc;
+
+    static bool IsFull(uint8_t ctrl) noexcept { return (ctrl & 0x80) == 0; }
+    static uint8_t Tag(size_t hash) noexcept { return hash & 0x7F; }
+    static size_t GroupIndex(size_t hash) noexcept { return hash >> 7; }
+
+    //! Bitmask of the control bytes in the group starting at @p ctrl that equal @p value.
+    static uint32_t MatchByte(const uint8_t* ctrl, uint8_t value) noexcept
+    {
+#if defined(__SSE2__)
+        const __m128i group{_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))};
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(value)))));
+#else
+        uint32_t mask{0};
+        for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+            mask |= uint32_t{ctrl[i] == value} << i;
+        }
+        return mask;
+#endif
+    }
+
+    //! Bitmask of the empty or deleted control bytes in the group starting at @p ctrl.
+    static uint32_t MatchFree(const uint8_t* ctrl) noexcept
+    {
+#if defined(__SSE2__)
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))));
+#else
+        uint32_t mask{0};
+        for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+            mask |= uint32_t{!IsFull(ctrl[i])} << i;
+        }
+        return mask;
+#endif
+    }
+
+    size_t GroupMask() const noexcept { return m_ctrl.size() / GROUP_WIDTH - 1; }
+
+    //! Maximum number of full or deleted slots before the index must grow (7/8 load).
+    static size_t MaxUsed(size_t capacity) noexcept { return capacity - capacity / 8; }
+
+    //! Return the slot holding @p key, or m_ctrl.size() if there is none.
+    size_t FindSlot(const Key& key, size_t hash) const
+    {
+        if (m_ctrl.empty()) return 0;
+        const uint8_t tag{Tag(hash)};
+        const size_t mask{GroupMask()};
+        size_t group{GroupIndex(hash) & mask};
+        for (size_t step = 1;; ++step) {
+            const uint8_t* ctrl{&m_ctrl[group * GROUP_WIDTH]};
+            for (uint32_t match{MatchByte(ctrl, tag)}; match; match &= match - 1) {
+                const size_t slot{group * GROUP_WIDTH + std::countr_zero(match)};
+                if (m_equal(m_slots[slot]->first, key)) return slot;
+            }
+            if (MatchByte(ctrl, CTRL_EMPTY)) return m_ctrl.size();
+            // Triangular probing visits every group of a power-of-two table.
+            group = (group + step) & mask;
+        }
+    }
+
+    //! Return the first empty or deleted slot in the probe sequence of @p hash.
+    size_t FindFreeSlot(size_t hash) const noexcept
+    {
+        const size_t mask{GroupMask()};
+        size_t group{GroupIndex(hash) & mask};
+        for (size_t step = 1;; ++step) {
+            if (const uint32_t free{MatchFree(&m_ctrl[group * GROUP_WIDTH])}) {
+                return group * GROUP_WIDTH + std::countr_zero(free);
+            }
+            group = (group + step) & mask;
+        }
+    }
+
+    //! Rebuild the index with @p capacity slots, dropping deleted markers.
+    void Rehash(size_t capacity)
+    {
+        std::vector<uint8_t> old_ctrl(capacity, CTRL_EMPTY);
+        std::vector<value_type*> old_slots(capacity, nullptr);
+        old_ctrl.swap(m_ctrl);
+        old_slots.swap(m_slots);
+        for (size_t i = 0; i < old_ctrl.size(); ++i) {
+            if (!IsFull(old_ctrl[i])) continue;
+            const size_t hash{m_hash(old_slots[i]->first)};
+            const size_t slot{FindFreeSlot(hash)};
+            m_ctrl[slot] = Tag(hash);
+            m_slots[slot] = old_slots[i];
+        }
+        m_used = m_size;
+    }
+
+    //! Make room for one more element.
+    void PrepareInsert()
+    {
+        if (m_used + 1 <= MaxUsed(m_ctrl.size())) return;
+        // If enough of the used slots are merely deleted, reclaim them
+        // instead of growing.
+        if (m_ctrl.size() > 0 && (m_size + 1) * 32 <= m_ctrl.size() * 25) {
+            Rehash(m_ctrl.size());
+        } else {
+            Rehash(std::max(GROUP_WIDTH, m_ctrl.size() * 2));
+        }
+    }
+
+    //! Put an already constructed node into the free slot for @p hash.
+    size_t InsertNode(value_type* node, size_t hash) noexcept
+    {
+        const size_t slot{FindFreeSlot(hash)};
+        if (m_ctrl[slot] == CTRL_EMPTY) ++m_used;
+        m_ctrl[slot] = Tag(hash);
+        m_slots[slot] = node;
+        ++m_size;
+        return slot;
+    }
+
+    template <typename... Args>
+    value_type* NewNode(Args&&... args)
+    {
+        value_type* node{m_alloc.allocate(1)};
+        try {
+            std::construct_at(node, std::forward<Args>(args)...);
+        } catch (...) {
+            m_alloc.deallocate(node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    void DeleteNode(value_type* node) noexcept
+    {
+        std::destroy_at(node);
+        m_alloc.deallocate(node, 1);
+    }
+
+    void EraseSlot(size_t slot) noexcept
+    {
+        DeleteNode(m_slots[slot]);
+        m_slots[slot] = nullptr;
+        // A probe sequence only continues past a group without empty slots, so
+        // if this group has one, no other element depends on this slot.
+        if (MatchByte(&m_ctrl[slot & ~(GROUP_WIDTH - 1)], CTRL_EMPTY)) {
+            m_ctrl[slot] = CTRL_EMPTY;
+            --m_used;
+        } else {
+            m_ctrl[slot] = CTRL_DELETED;
+        }
+        --m_size;
+    }
+
+    template <bool IS_CONST>
+    class Iterator
+    {
+        friend class NodeHashMap;
+        template <bool>
+        friend class Iterator;
+        using Map = std::conditional_t<IS_CONST, const NodeHashMap, NodeHashMap>;
+        Map* m_map{nullptr};
+        size_t m_slot{0};
+
+        Iterator(Map* map, size_t slot) noexcept : m_map{map}, m_slot{slot} {}
+
+        void SkipFree() noexcept
+        {
+            while (m_slot < m_map->m_ctrl.size() && !IsFull(m_map->m_ctrl[m_slot])) ++m_slot;
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = NodeHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IS_CONST, const value_type*, value_type*>;
+        using reference = std::conditional_t<IS_CONST, const value_type&, value_type&>;
+
+        Iterator() noexcept = default;
+        //! Allow conversion from iterator to const_iterator.
+        template <bool OTHER_CONST>
+            requires(IS_CONST && !OTHER_CONST)
+        Iterator(const Iterator<OTHER_CONST>& other) noexcept : m_map{other.m_map}, m_slot{other.m_slot} {}
+
+        reference operator*() const noexcept { return *m_map->m_slots[m_slot]; }
+        pointer operator->() const noexcept { return m_map->m_slots[m_slot]; }
+
+        Iterator& operator++() noexcept
+        {
+            ++m_slot;
+            SkipFree();
+            return *this;
+        }
+        Iterator operator++(int) noexcept
+        {
+            Iterator ret{*this};
+            ++*this;
+            return ret;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) noexcept { return a.m_slot == b.m_slot; }
+    };
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    NodeHashMap(size_t bucket_count, const Hash& hash, const KeyEqual& equal, const allocator_type& alloc)
+        : m_hash{hash}, m_equal{equal}, m_alloc{alloc}
+    {
+        reserve(bucket_count);
+    }
+
+    NodeHashMap(const NodeHashMap&) = delete;
+    NodeHashMap& operator=(const NodeHashMap&) = delete;
+
+    ~NodeHashMap() { clear(); }
+
+    iterator begin() noexcept
+    {
+        iterator it{this, 0};
+        it.SkipFree();
+        return it;
+    }
+    const_iterator begin() const noexcept
+    {
+        const_iterator it{this, 0};
+        it.SkipFree();
+        return it;
+    }
+    iterator end() noexcept { return {this, m_ctrl.size()}; }
+    const_iterator end() const noexcept { return {this, m_ctrl.size()}; }
+
+    size_t size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+    //! Number of slots in the index.
+    size_t bucket_count() const noexcept { return m_ctrl.size(); }
+    allocator_type get_allocator() const noexcept { return m_alloc; }
+    hasher hash_function() const { return m_hash; }
+    key_equal key_eq() const { return m_equal; }
+
+    //! Make sure @p count elements fit without growing the index.
+    void reserve(size_t count)
+    {
+        if (count <= MaxUsed(m_ctrl.size()) - (m_used - m_size)) return;
+        size_t capacity{std::max(GROUP_WIDTH, m_ctrl.size())};
+        while (MaxUsed(capacity) < count) capacity *= 2;
+        Rehash(capacity);
+    }
+
+    iterator find(const Key& key)
+    {
+        return {this, FindSlot(key, m_hash(key))};
+    }
+    const_iterator find(const Key& key) const
+    {
+        return {this, FindSlot(key, m_hash(key))};
+    }
+    size_t count(const Key& key) const { return find(key) != end(); }
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args)
+    {
+        const size_t hash{m_hash(key)};
+        if (const size_t slot{FindSlot(key, hash)}; slot != m_ctrl.size()) {
+            return {iterator{this, slot}, false};
+        }
+        PrepareInsert();
+        value_type* node{NewNode(std::piecewise_construct,
+                                 std::forward_as_tuple(std::forward<K>(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...))};
+        return {iterator{this, InsertNode(node, hash)}, true};
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        value_type* node{NewNode(std::forward<Args>(args)...)};
+        const size_t hash{m_hash(node->first)};
+        if (const size_t slot{FindSlot(node->first, hash)}; slot != m_ctrl.size()) {
+            DeleteNode(node);
+            return {iterator{this, slot}, false};
+        }
+        try {
+            PrepareInsert();
+        } catch (...) {
+            DeleteNode(node);
+            throw;
+        }
+        return {iterator{this, InsertNode(node, hash)}, true};
+    }
+
+    T& operator[](const Key& key) { return try_emplace(key).first->second; }
+
+    iterator erase(const_iterator pos) noexcept
+    {
+        EraseSlot(pos.m_slot);
+        iterator next{this, pos.m_slot};
+        next.SkipFree();
+        return next;
+    }
+
+    size_t erase(const Key& key) noexcept
+    {
+        const size_t slot{FindSlot(key, m_hash(key))};
+        if (slot == m_ctrl.size()) return 0;
+        EraseSlot(slot);
+        return 1;
+    }
+
+    //! Destroy all elements. Like std::unordered_map, the index keeps its size.
+    void clear() noexcept
+    {
+        for (size_t i = 0; i < m_ctrl.size(); ++i) {
+            if (IsFull(m_ctrl[i])) DeleteNode(m_slots[i]);
+        }
+        std::fill(m_ctrl.begin(), m_ctrl.end(), CTRL_EMPTY);
+        m_size = 0;
+        m_used = 0;
+    }
+};
+
+#endif // BITCOIN_NODEHASHMAP_H
@@ -270,6 +270,7 @@ protected:
         EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
     void MempoolTransactionsRemovedForBlock(const std::vector<RemovedMempoolTransactionInfo>& txs_removed_for_block, unsigned int nBlockHeight) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+    std::string ValidationInterfaceName() const override { return "fee_estimator"; }
 
 private:
     mutable Mutex m_cs_fee_estimator;
@@ -12,6 +12,7 @@
 #include <chainparams.h>
 #include <core_io.h>
 #include <flatfile.h>
+#include <httprpc.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/txindex.h>
@@ -32,6 +33,7 @@
 #include <util/strencodings.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <any>
 #include <vector>
 
@@ -43,6 +45,8 @@ using util::SplitString;
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
 static constexpr unsigned int MAX_REST_HEADERS_RESULTS = 2000;
+//! Size of the parts large replies are streamed in
+static constexpr size_t REST_REPLY_CHUNK_SIZE{1 << 20};
 
 static const struct {
     RESTResponseFormat rf;
@@ -323,17 +327,30 @@ static bool rest_block(const std::any& context,
         return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
     }
 
+    // Stream the block in parts, rather than copying all of it (or twice its
+    // size in hex) into the reply at once.
     switch (rf) {
     case RESTResponseFormat::BINARY: {
         req->WriteHeader("Content-Type", "application/octet-stream");
-        req->WriteReply(HTTP_OK, std::as_bytes(std::span{block_data}));
+        req->StartReply(HTTP_OK);
+        for (size_t pos{0}; pos < block_data.size(); pos += REST_REPLY_CHUNK_SIZE) {
+            const auto chunk{std::span{block_data}.subspan(pos, std::min(REST_REPLY_CHUNK_SIZE, block_data.size() - pos))};
+            if (!req->WriteReplyChunk(std::as_bytes(chunk))) break;
+        }
+        req->EndReply();
         return true;
     }
 
     case RESTResponseFormat::HEX: {
-        const std::string strHex{HexStr(block_data) + "\n"};
         req->WriteHeader("Content-Type", "text/plain");
-        req->WriteReply(HTTP_OK, strHex);
+        req->StartReply(HTTP_OK);
+        for (size_t pos{0}; pos < block_data.size(); pos += REST_REPLY_CHUNK_SIZE / 2) {
+            const auto chunk{std::span{block_data}.subspan(pos, std::min(REST_REPLY_CHUNK_SIZE / 2, block_data.size() - pos))};
+            const bool last{pos + chunk.size() == block_data.size()};
+            const std::string hex{HexStr(chunk) + (last ? "\n" : "")};
+            if (!req->WriteReplyChunk(std::as_bytes(std::span{hex}))) break;
+        }
+        req->EndReply();
         return true;
     }
 
@@ -342,9 +359,7 @@ static bool rest_block(const std::any& context,
         DataStream block_stream{block_data};
         block_stream >> TX_WITH_WITNESS(block);
         UniValue objBlock = blockToJSON(chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity, chainman.GetConsensus().powLimit);
-        std::string strJSON = objBlock.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        WriteJSONReply(req, objBlock);
         return true;
     }
 
@@ -1005,29 +1020,33 @@ static bool rest_blockhash_by_height(const std::any& context, HTTPRequest* req,
     }
 }
 
+//! Resources that read blocks, the mempool or many headers, filters or coins
+//! are fetched at low priority, so that bulk fetching can't hold up other
+//! requests.
 static const struct {
     const char* prefix;
     bool (*handler)(const std::any& context, HTTPRequest* req, const std::string& strReq);
+    HTTPPriority priority;
 } uri_prefixes[] = {
-      {"/rest/tx/", rest_tx},
-      {"/rest/block/notxdetails/", rest_block_notxdetails},
-      {"/rest/block/", rest_block_extended},
-      {"/rest/blockfilter/", rest_block_filter},
-      {"/rest/blockfilterheaders/", rest_filter_header},
-      {"/rest/chaininfo", rest_chaininfo},
-      {"/rest/mempool/", rest_mempool},
-      {"/rest/headers/", rest_headers},
-      {"/rest/getutxos", rest_getutxos},
-      {"/rest/deploymentinfo/", rest_deploymentinfo},
-      {"/rest/deploymentinfo", rest_deploymentinfo},
-      {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/tx/", rest_tx, HTTPPriority::LOW},
+      {"/rest/block/notxdetails/", rest_block_notxdetails, HTTPPriority::LOW},
+      {"/rest/block/", rest_block_extended, HTTPPriority::LOW},
+      {"/rest/blockfilter/", rest_block_filter, HTTPPriority::LOW},
+      {"/rest/blockfilterheaders/", rest_filter_header, HTTPPriority::LOW},
+      {"/rest/chaininfo", rest_chaininfo, HTTPPriority::NORMAL},
+      {"/rest/mempool/", rest_mempool, HTTPPriority::LOW},
+      {"/rest/headers/", rest_headers, HTTPPriority::LOW},
+      {"/rest/getutxos", rest_getutxos, HTTPPriority::LOW},
+      {"/rest/deploymentinfo/", rest_deploymentinfo, HTTPPriority::NORMAL},
+      {"/rest/deploymentinfo", rest_deploymentinfo, HTTPPriority::NORMAL},
+      {"/rest/blockhashbyheight/", rest_blockhash_by_height, HTTPPriority::NORMAL},
 };
 
 void StartREST(const std::any& context)
 {
     for (const auto& up : uri_prefixes) {
         auto handler = [context, up](HTTPRequest* req, const std::string& prefix) { return up.handler(context, req, prefix); };
-        RegisterHTTPHandler(up.prefix, false, handler);
+        RegisterHTTPHandler(up.prefix, false, handler, up.priority);
     }
 }
 
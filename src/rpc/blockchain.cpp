@@ -964,6 +964,28 @@ static std::optional<kernel::CCoinsStats> GetUTXOStats(CCoinsView* view, node::B
     return kernel::ComputeUTXOStats(hash_type, view, blockman, interruption_point);
 }
 
+UniValue DBOptionsToJSON(const DBOptions& options)
+{
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("block_size", static_cast<uint64_t>(options.block_size));
+    ret.pushKV("bloom_bits", options.bloom_bits);
+    ret.pushKV("write_buffer", static_cast<uint64_t>(options.write_buffer_bytes));
+    ret.pushKV("compression", options.compression && DBWRAPPER_COMPRESSION_SUPPORTED);
+    ret.pushKV("max_file_size", static_cast<uint64_t>(options.max_file_size));
+    return ret;
+}
+
+std::vector<RPCResult> DBOptionsDoc()
+{
+    return {
+        {RPCResult::Type::NUM, "block_size", "Approximate size in bytes of user data packed per table block"},
+        {RPCResult::Type::NUM, "bloom_bits", "Bits per key of the bloom filters, 0 if disabled"},
+        {RPCResult::Type::NUM, "write_buffer", "Size in bytes of the write buffer, 0 if derived from the cache size"},
+        {RPCResult::Type::BOOL, "compression", "Whether table blocks are compressed. Always false if the leveldb build doesn't support compression"},
+        {RPCResult::Type::NUM, "max_file_size", "Size in bytes at which a new table file is started"},
+    };
+}
+
 static RPCHelpMan gettxoutsetinfo()
 {
     return RPCHelpMan{
@@ -991,6 +1013,7 @@ static RPCHelpMan gettxoutsetinfo()
                         {RPCResult::Type::NUM, "transactions", /*optional=*/true, "The number of transactions with unspent outputs (not available when coinstatsindex is used)"},
                         {RPCResult::Type::NUM, "disk_size", /*optional=*/true, "The estimated size of the chainstate on disk (not available when coinstatsindex is used)"},
                         {RPCResult::Type::STR_AMOUNT, "total_amount", "The total amount of coins in the UTXO set"},
+                        {RPCResult::Type::OBJ, "db_options", "The leveldb tuning of the chainstate database", DBOptionsDoc()},
                         {RPCResult::Type::STR_AMOUNT, "total_unspendable_amount", /*optional=*/true, "The total amount of coins permanently excluded from the UTXO set (only available if coinstatsindex is used)"},
                         {RPCResult::Type::OBJ, "block_info", /*optional=*/true, "Info on amounts in the block at this block height (only available if coinstatsindex is used)",
                         {
@@ -1033,9 +1056,11 @@ static RPCHelpMan gettxoutsetinfo()
 
     CCoinsView* coins_view;
     BlockManager* blockman;
+    DBOptions db_options;
     {
         LOCK(::cs_main);
         coins_view = &active_chainstate.CoinsDB();
+        db_options = active_chainstate.CoinsDB().GetDBOptions();
         blockman = &active_chainstate.m_blockman;
         pindex = blockman->LookupBlockIndex(coins_view->GetBestBlock());
     }
@@ -1082,6 +1107,7 @@ static RPCHelpMan gettxoutsetinfo()
         }
         CHECK_NONFATAL(stats.total_amount.has_value());
         ret.pushKV("total_amount", ValueFromAmount(stats.total_amount.value()));
+        ret.pushKV("db_options", DBOptionsToJSON(db_options));
         if (!stats.index_used) {
             ret.pushKV("transactions", static_cast<int64_t>(stats.nTransactions));
             ret.pushKV("disk_size", stats.nDiskSize);
@@ -3339,6 +3365,9 @@ const std::vector<RPCResult> RPCHelpForChainstate{
     {RPCResult::Type::STR_HEX, "snapshot_blockhash", /*optional=*/true, "the base block of the snapshot this chainstate is based on, if any"},
     {RPCResult::Type::NUM, "coins_db_cache_bytes", "size of the coinsdb cache"},
     {RPCResult::Type::NUM, "coins_tip_cache_bytes", "size of the coinstip cache"},
+    {RPCResult::Type::NUM, "blocks_connected", "number of blocks connected to this chainstate since startup"},
+    {RPCResult::Type::NUM, "blocks_per_second", "average rate at which those blocks were connected"},
+    {RPCResult::Type::NUM, "background_validation_progress", /*optional=*/true, "for the chainstate validating the history of a snapshot in the background, the fraction of blocks up to the snapshot base validated so far"},
     {RPCResult::Type::BOOL, "validated", "whether the chainstate is fully validated. True if all blocks in the chainstate were validated, false if the chain is based on a snapshot and the snapshot has not yet been validated."},
 };
 
@@ -3382,6 +3411,14 @@ return RPCHelpMan{
         data.pushKV("verificationprogress", chainman.GuessVerificationProgress(tip));
         data.pushKV("coins_db_cache_bytes",  cs.m_coinsdb_cache_size_bytes);
         data.pushKV("coins_tip_cache_bytes", cs.m_coinstip_cache_size_bytes);
+        const double connect_seconds{Ticks<SecondsDouble>(cs.m_time_blocks_connected)};
+        data.pushKV("blocks_connected", cs.m_blocks_connected);
+        data.pushKV("blocks_per_second", connect_seconds > 0 ? cs.m_blocks_connected / connect_seconds : 0.0);
+        if (cs.GetRole() == ChainstateRole::BACKGROUND) {
+            if (const auto base_height{chainman.GetSnapshotBaseHeight()}; base_height && *base_height > 0) {
+                data.pushKV("background_validation_progress", std::min(1.0, double(chain.Height()) / *base_height));
+            }
+        }
         if (cs.m_from_snapshot_blockhash) {
             data.pushKV("snapshot_blockhash", cs.m_from_snapshot_blockhash->ToString());
         }
@@ -20,6 +20,8 @@ class CBlock;
 class CBlockIndex;
 class Chainstate;
 class UniValue;
+struct DBOptions;
+struct RPCResult;
 namespace node {
 class BlockManager;
 struct NodeContext;
@@ -44,6 +46,10 @@ UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex
 /** Used by getblockstats to get feerates at different percentiles by weight  */
 void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight);
 
+/** Describe the leveldb tuning a database was opened with. */
+UniValue DBOptionsToJSON(const DBOptions& options);
+std::vector<RPCResult> DBOptionsDoc();
+
 /**
  * Test-only helper to create UTXO snapshots given a chainstate and a file handle.
  * @return a UniValue map containing metadata about the snapshot.
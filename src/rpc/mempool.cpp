@@ -691,6 +691,13 @@ UniValue MempoolInfoToJSON(const CTxMemPool& pool)
     ret.pushKV("incrementalrelayfee", ValueFromAmount(pool.m_opts.incremental_relay_feerate.GetFeePerK()));
     ret.pushKV("unbroadcastcount", uint64_t{pool.GetUnbroadcastTxs().size()});
     ret.pushKV("fullrbf", true);
+    const auto& eviction_stats{pool.GetEvictionStats()};
+    UniValue eviction(UniValue::VOBJ);
+    eviction.pushKV("txs", eviction_stats.txs);
+    eviction.pushKV("bytes", eviction_stats.bytes);
+    eviction.pushKV("usage", eviction_stats.usage);
+    eviction.pushKV("time", Ticks<SecondsDouble>(eviction_stats.time));
+    ret.pushKV("eviction", std::move(eviction));
     return ret;
 }
 
@@ -713,6 +720,13 @@ static RPCHelpMan getmempoolinfo()
                 {RPCResult::Type::NUM, "incrementalrelayfee", "minimum fee rate increment for mempool limiting or replacement in " + CURRENCY_UNIT + "/kvB"},
                 {RPCResult::Type::NUM, "unbroadcastcount", "Current number of transactions that haven't passed initial broadcast yet"},
                 {RPCResult::Type::BOOL, "fullrbf", "True if the mempool accepts RBF without replaceability signaling inspection (DEPRECATED)"},
+                {RPCResult::Type::OBJ, "eviction", "Transactions evicted since startup because the mempool was full",
+                {
+                    {RPCResult::Type::NUM, "txs", "Number of evicted transactions"},
+                    {RPCResult::Type::NUM, "bytes", "Sum of their virtual transaction sizes"},
+                    {RPCResult::Type::NUM, "usage", "Memory usage released by evicting them"},
+                    {RPCResult::Type::NUM, "time", "Time spent evicting them, in seconds"},
+                }},
             }},
         RPCExamples{
             HelpExampleCli("getmempoolinfo", "")
@@ -158,6 +158,15 @@ static RPCHelpMan getpeerinfo()
                     {RPCResult::Type::BOOL, "inbound", "Inbound (true) or Outbound (false)"},
                     {RPCResult::Type::BOOL, "bip152_hb_to", "Whether we selected peer as (compact blocks) high-bandwidth peer"},
                     {RPCResult::Type::BOOL, "bip152_hb_from", "Whether peer selected us as (compact blocks) high-bandwidth peer"},
+                    {RPCResult::Type::OBJ, "cmpctblock", "Compact block relay statistics",
+                    {
+                        {RPCResult::Type::NUM, "reconstructed", "The number of blocks reconstructed from compact blocks this peer sent us"},
+                        {RPCResult::Type::NUM, "roundtrips", "The number of getblocktxn round trips made to this peer for missing transactions"},
+                        {RPCResult::Type::NUM, "roundtrip_rate", "Round trips per reconstructed block, or 0 if none was reconstructed"},
+                        {RPCResult::Type::NUM, "bytes", "The total bytes of cmpctblock and blocktxn messages received from this peer"},
+                        {RPCResult::Type::NUM, "bytes_per_block", "Bytes received per reconstructed block, or 0 if none was reconstructed"},
+                        {RPCResult::Type::NUM, "prefilled", "The number of transactions we prefilled, besides the coinbase, in compact blocks announced to this peer"},
+                    }},
                     {RPCResult::Type::NUM, "startingheight", "The starting height (block) of the peer"},
                     {RPCResult::Type::NUM, "presynced_headers", "The current height of header pre-synchronization with this peer, or -1 if no low-work sync is in progress"},
                     {RPCResult::Type::NUM, "synced_headers", "The last header we have in common with this peer"},
@@ -263,6 +272,15 @@ static RPCHelpMan getpeerinfo()
         obj.pushKV("inbound", stats.fInbound);
         obj.pushKV("bip152_hb_to", stats.m_bip152_highbandwidth_to);
         obj.pushKV("bip152_hb_from", stats.m_bip152_highbandwidth_from);
+        UniValue cmpctblock(UniValue::VOBJ);
+        const uint64_t reconstructed{statestats.m_cmpctblock_reconstructed};
+        cmpctblock.pushKV("reconstructed", reconstructed);
+        cmpctblock.pushKV("roundtrips", statestats.m_cmpctblock_roundtrips);
+        cmpctblock.pushKV("roundtrip_rate", reconstructed ? double(statestats.m_cmpctblock_roundtrips) / reconstructed : 0.0);
+        cmpctblock.pushKV("bytes", statestats.m_cmpctblock_bytes);
+        cmpctblock.pushKV("bytes_per_block", reconstructed ? statestats.m_cmpctblock_bytes / reconstructed : 0);
+        cmpctblock.pushKV("prefilled", statestats.m_cmpctblock_prefilled);
+        obj.pushKV("cmpctblock", std::move(cmpctblock));
         obj.pushKV("startingheight", statestats.m_starting_height);
         obj.pushKV("presynced_headers", statestats.presync_height);
         obj.pushKV("synced_headers", statestats.nSyncHeight);
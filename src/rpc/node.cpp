@@ -17,6 +17,7 @@
 #include <kernel/cs_main.h>
 #include <logging.h>
 #include <node/context.h>
+#include <rpc/blockchain.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
@@ -25,6 +26,7 @@
 #include <util/any.h>
 #include <util/check.h>
 #include <util/time.h>
+#include <validationinterface.h>
 
 #include <stdint.h>
 #ifdef HAVE_MALLOC_INFO
@@ -353,6 +355,7 @@ static UniValue SummaryToJSON(const IndexSummary&& summary, std::string index_na
     UniValue entry(UniValue::VOBJ);
     entry.pushKV("synced", summary.synced);
     entry.pushKV("best_block_height", summary.best_block_height);
+    entry.pushKV("db_options", DBOptionsToJSON(summary.db_options));
     ret_summary.pushKV(summary.name, std::move(entry));
     return ret_summary;
 }
@@ -372,6 +375,7 @@ static RPCHelpMan getindexinfo()
                             {
                                 {RPCResult::Type::BOOL, "synced", "Whether the index is synced or not"},
                                 {RPCResult::Type::NUM, "best_block_height", "The block height to which the index is synced"},
+                                {RPCResult::Type::OBJ, "db_options", "The leveldb tuning of the index database", DBOptionsDoc()},
                             }
                         },
                     },
@@ -404,12 +408,59 @@ static RPCHelpMan getindexinfo()
     };
 }
 
+static RPCHelpMan getvalidationqueueinfo()
+{
+    return RPCHelpMan{
+        "getvalidationqueueinfo",
+        "Returns the backlog of validation notifications (new blocks, mempool changes, ...) of every subscriber,\n"
+        "like the wallets, indices and ZMQ. Each subscriber has its own queue, so a slow one does not delay the others.\n",
+        {},
+        RPCResult{
+            RPCResult::Type::ARR, "", "",
+            {
+                {RPCResult::Type::OBJ, "", "",
+                {
+                    {RPCResult::Type::STR, "name", "The name of the subscriber"},
+                    {RPCResult::Type::NUM, "pending", "The number of notifications queued and not delivered yet"},
+                    {RPCResult::Type::NUM, "max_pending", "The largest number of notifications that were queued at once"},
+                    {RPCResult::Type::NUM, "delivered", "The number of notifications delivered"},
+                    {RPCResult::Type::NUM, "avg_wait_ms", "The average time notifications were queued before delivery, in milliseconds"},
+                    {RPCResult::Type::NUM, "max_wait_ms", "The longest time a notification was queued before delivery, in milliseconds"},
+                    {RPCResult::Type::NUM, "avg_run_ms", "The average time spent handling a notification, in milliseconds"},
+                }},
+            }},
+        RPCExamples{
+            HelpExampleCli("getvalidationqueueinfo", "")
+          + HelpExampleRpc("getvalidationqueueinfo", "")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const NodeContext& node{EnsureAnyNodeContext(request.context)};
+    UniValue result(UniValue::VARR);
+    for (const auto& stats : CHECK_NONFATAL(node.validation_signals)->GetSubscriberStats()) {
+        const double delivered{stats.delivered ? double(stats.delivered) : 1.0};
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("name", stats.name);
+        entry.pushKV("pending", uint64_t(stats.pending));
+        entry.pushKV("max_pending", uint64_t(stats.max_pending));
+        entry.pushKV("delivered", stats.delivered);
+        entry.pushKV("avg_wait_ms", Ticks<MillisecondsDouble>(stats.total_wait) / delivered);
+        entry.pushKV("max_wait_ms", Ticks<MillisecondsDouble>(stats.max_wait));
+        entry.pushKV("avg_run_ms", Ticks<MillisecondsDouble>(stats.total_run) / delivered);
+        result.push_back(std::move(entry));
+    }
+    return result;
+},
+    };
+}
+
 void RegisterNodeRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
         {"control", &getmemoryinfo},
         {"control", &logging},
         {"util", &getindexinfo},
+        {"control", &getvalidationqueueinfo},
         {"hidden", &setmocktime},
         {"hidden", &mockscheduler},
         {"hidden", &echo},
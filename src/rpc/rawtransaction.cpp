@@ -50,6 +50,7 @@
 using node::AnalyzePSBT;
 using node::FindCoins;
 using node::GetTransaction;
+using node::GetTransactions;
 using node::NodeContext;
 using node::PSBTAnalysis;
 
@@ -181,7 +182,22 @@ PartiallySignedTransaction ProcessPSBT(const std::string& psbt_string, const std
     std::map<COutPoint, Coin> coins;
 
     // Fetch previous transactions:
-    // First, look in the txindex and the mempool
+    // First, look in the txindex, with one batch for all inputs
+    std::vector<CTransactionRef> index_txs(psbtx.tx->vin.size());
+    if (g_txindex) {
+        std::vector<uint256> prev_hashes;
+        std::vector<unsigned int> prev_inputs;
+        for (unsigned int i = 0; i < psbtx.tx->vin.size(); ++i) {
+            if (psbtx.inputs.at(i).non_witness_utxo) continue;
+            prev_hashes.push_back(psbtx.tx->vin.at(i).prevout.hash);
+            prev_inputs.push_back(i);
+        }
+        std::vector<uint256> block_hashes;
+        std::vector<CTransactionRef> txs{g_txindex->FindTxs(prev_hashes, block_hashes)};
+        for (size_t j = 0; j < txs.size(); ++j) index_txs[prev_inputs[j]] = std::move(txs[j]);
+    }
+
+    // Then in the mempool
     for (unsigned int i = 0; i < psbtx.tx->vin.size(); ++i) {
         PSBTInput& psbt_input = psbtx.inputs.at(i);
         const CTxIn& tx_in = psbtx.tx->vin.at(i);
@@ -189,13 +205,8 @@ PartiallySignedTransaction ProcessPSBT(const std::string& psbt_string, const std
         // The `non_witness_utxo` is the whole previous transaction
         if (psbt_input.non_witness_utxo) continue;
 
-        CTransactionRef tx;
+        CTransactionRef tx{std::move(index_txs[i])};
 
-        // Look in the txindex
-        if (g_txindex) {
-            uint256 block_hash;
-            g_txindex->FindTx(tx_in.prevout.hash, block_hash, tx);
-        }
         // If we still don't have it look in the mempool
         if (!tx) {
             tx = node.mempool->get(tx_in.prevout.hash);
@@ -251,6 +262,53 @@ PartiallySignedTransaction ProcessPSBT(const std::string& psbt_string, const std
     return psbtx;
 }
 
+//! The result of getrawtransaction for a transaction found in hash_block, or
+//! in the mempool if hash_block is null. blockindex is the block the caller
+//! asked for, if any.
+static UniValue RawTransactionToJSON(ChainstateManager& chainman, const CTransactionRef& tx, const uint256& hash_block, const CBlockIndex* blockindex, int verbosity)
+{
+    if (verbosity <= 0) {
+        return EncodeHexTx(*tx);
+    }
+
+    UniValue result(UniValue::VOBJ);
+    if (blockindex) {
+        LOCK(cs_main);
+        result.pushKV("in_active_chain", chainman.ActiveChain().Contains(blockindex));
+    } else {
+        // If request is verbosity >= 1 but no blockhash was given, then look up the blockindex
+        LOCK(cs_main);
+        blockindex = chainman.m_blockman.LookupBlockIndex(hash_block); // May be nullptr for mempool transactions
+    }
+    if (verbosity == 1) {
+        TxToJSON(*tx, hash_block, result, chainman.ActiveChainstate());
+        return result;
+    }
+
+    CBlockUndo blockUndo;
+    CBlock block;
+
+    if (tx->IsCoinBase() || !blockindex || WITH_LOCK(::cs_main, return !(blockindex->nStatus & BLOCK_HAVE_MASK))) {
+        TxToJSON(*tx, hash_block, result, chainman.ActiveChainstate());
+        return result;
+    }
+    if (!chainman.m_blockman.ReadBlockUndo(blockUndo, *blockindex)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Undo data expected but can't be read. This could be due to disk corruption or a conflict with a pruning event.");
+    }
+    if (!chainman.m_blockman.ReadBlock(block, *blockindex)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Block data expected but can't be read. This could be due to disk corruption or a conflict with a pruning event.");
+    }
+
+    CTxUndo* undoTX {nullptr};
+    auto it = std::find_if(block.vtx.begin(), block.vtx.end(), [tx](CTransactionRef t){ return *t == *tx; });
+    if (it != block.vtx.end()) {
+        // -1 as blockundo does not have coinbase tx
+        undoTX = &blockUndo.vtxundo.at(it - block.vtx.begin() - 1);
+    }
+    TxToJSON(*tx, hash_block, result, chainman.ActiveChainstate(), undoTX, TxVerbosity::SHOW_DETAILS_AND_PREVOUT);
+    return result;
+}
+
 static RPCHelpMan getrawtransaction()
 {
     return RPCHelpMan{
@@ -367,46 +425,80 @@ static RPCHelpMan getrawtransaction()
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, errmsg + ". Use gettransaction for wallet transactions.");
     }
 
-    if (verbosity <= 0) {
-        return EncodeHexTx(*tx);
-    }
+    return RawTransactionToJSON(chainman, tx, hash_block, blockindex, verbosity);
+},
+    };
+}
 
-    UniValue result(UniValue::VOBJ);
-    if (blockindex) {
-        LOCK(cs_main);
-        result.pushKV("in_active_chain", chainman.ActiveChain().Contains(blockindex));
-    }
-    // If request is verbosity >= 1 but no blockhash was given, then look up the blockindex
-    if (request.params[2].isNull()) {
-        LOCK(cs_main);
-        blockindex = chainman.m_blockman.LookupBlockIndex(hash_block); // May be nullptr for mempool transactions
-    }
-    if (verbosity == 1) {
-        TxToJSON(*tx, hash_block, result, chainman.ActiveChainstate());
-        return result;
-    }
+static RPCHelpMan getrawtransactions()
+{
+    return RPCHelpMan{
+                "getrawtransactions",
 
-    CBlockUndo blockUndo;
-    CBlock block;
+                "Returns the transactions with the given txids, as getrawtransaction does for one txid.\n"
+                "The txindex is looked up once for all of them, and the block, if a blockhash argument\n"
+                "is passed, is read once.\n"
+                "Transactions that are not found are returned as null.",
+                {
+                    {"txids", RPCArg::Type::ARR, RPCArg::Optional::NO, "The transaction ids",
+                        {
+                            {"txid", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "A transaction id"},
+                        },
+                    },
+                    {"verbosity|verbose", RPCArg::Type::NUM, RPCArg::Default{0}, "0 for hex-encoded data, 1 for a JSON object, and 2 for JSON object with fee and prevout",
+                     RPCArgOptions{.skip_type_check = true}},
+                    {"blockhash", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "The block in which to look for the transactions"},
+                },
+                RPCResult{
+                    RPCResult::Type::ARR, "", "",
+                    {
+                        {RPCResult::Type::ELISION, "", "For each txid, the output of getrawtransaction, or null if the transaction was not found"},
+                    },
+                },
+                RPCExamples{
+                    HelpExampleCli("getrawtransactions", "'[\"mytxid\",\"mytxid2\"]'")
+            + HelpExampleCli("getrawtransactions", "'[\"mytxid\",\"mytxid2\"]' 1 \"myblockhash\"")
+            + HelpExampleRpc("getrawtransactions", "[\"mytxid\",\"mytxid2\"], 1")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const NodeContext& node = EnsureAnyNodeContext(request.context);
+    ChainstateManager& chainman = EnsureChainman(node);
 
-    if (tx->IsCoinBase() || !blockindex || WITH_LOCK(::cs_main, return !(blockindex->nStatus & BLOCK_HAVE_MASK))) {
-        TxToJSON(*tx, hash_block, result, chainman.ActiveChainstate());
-        return result;
+    std::vector<uint256> hashes;
+    for (const UniValue& txid : request.params[0].get_array().getValues()) {
+        hashes.push_back(ParseHashV(txid, "txid"));
+        if (hashes.back() == chainman.GetParams().GenesisBlock().hashMerkleRoot) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "The genesis block coinbase is not considered an ordinary transaction and cannot be retrieved");
+        }
     }
-    if (!chainman.m_blockman.ReadBlockUndo(blockUndo, *blockindex)) {
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Undo data expected but can't be read. This could be due to disk corruption or a conflict with a pruning event.");
+
+    int verbosity{ParseVerbosity(request.params[1], /*default_verbosity=*/0, /*allow_bool=*/true)};
+
+    const CBlockIndex* blockindex = nullptr;
+    if (!request.params[2].isNull()) {
+        LOCK(cs_main);
+
+        uint256 blockhash = ParseHashV(request.params[2], "parameter 3");
+        blockindex = chainman.m_blockman.LookupBlockIndex(blockhash);
+        if (!blockindex) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block hash not found");
+        }
+        if (!(blockindex->nStatus & BLOCK_HAVE_DATA)) {
+            throw JSONRPCError(RPC_MISC_ERROR, "Block not available");
+        }
     }
-    if (!chainman.m_blockman.ReadBlock(block, *blockindex)) {
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Block data expected but can't be read. This could be due to disk corruption or a conflict with a pruning event.");
+
+    if (g_txindex && !blockindex) {
+        g_txindex->BlockUntilSyncedToCurrentChain();
     }
 
-    CTxUndo* undoTX {nullptr};
-    auto it = std::find_if(block.vtx.begin(), block.vtx.end(), [tx](CTransactionRef t){ return *t == *tx; });
-    if (it != block.vtx.end()) {
-        // -1 as blockundo does not have coinbase tx
-        undoTX = &blockUndo.vtxundo.at(it - block.vtx.begin() - 1);
+    std::vector<uint256> hash_blocks;
+    const std::vector<CTransactionRef> txs{GetTransactions(blockindex, node.mempool.get(), hashes, hash_blocks, chainman.m_blockman)};
+    UniValue result(UniValue::VARR);
+    for (size_t i{0}; i < txs.size(); ++i) {
+        result.push_back(txs[i] ? RawTransactionToJSON(chainman, txs[i], hash_blocks[i], blockindex, verbosity) : UniValue{});
     }
-    TxToJSON(*tx, hash_block, result, chainman.ActiveChainstate(), undoTX, TxVerbosity::SHOW_DETAILS_AND_PREVOUT);
     return result;
 },
     };
@@ -2116,6 +2208,7 @@ void RegisterRawTransactionRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
         {"rawtransactions", &getrawtransaction},
+        {"rawtransactions", &getrawtransactions},
         {"rawtransactions", &createrawtransaction},
         {"rawtransactions", &decoderawtransaction},
         {"rawtransactions", &decodescript},
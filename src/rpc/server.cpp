@@ -19,12 +19,15 @@
 #include <util/strencodings.h>
 #include <util/string.h>
 #include <util/time.h>
+#include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <unordered_map>
 
 using util::SplitString;
@@ -50,6 +53,10 @@ struct RPCServerInfo
 {
     Mutex mutex;
     std::list<RPCCommandExecutionInfo> active_commands GUARDED_BY(mutex);
+    //! Maximum number of concurrent calls of methods, from -rpcmethodlimit
+    std::unordered_map<std::string, size_t> method_limits GUARDED_BY(mutex);
+    //! Number of running calls of the methods in method_limits
+    std::unordered_map<std::string, size_t> method_active GUARDED_BY(mutex);
 };
 
 static RPCServerInfo g_rpc_server_info;
@@ -57,15 +64,25 @@ static RPCServerInfo g_rpc_server_info;
 struct RPCCommandExecution
 {
     std::list<RPCCommandExecutionInfo>::iterator it;
+    size_t* m_active{nullptr};
     explicit RPCCommandExecution(const std::string& method)
     {
         LOCK(g_rpc_server_info.mutex);
+        if (const auto limit{g_rpc_server_info.method_limits.find(method)}; limit != g_rpc_server_info.method_limits.end()) {
+            size_t& active{g_rpc_server_info.method_active[method]};
+            if (active >= limit->second) {
+                throw JSONRPCError(RPC_METHOD_BUSY, strprintf("Too many concurrent %s calls (limit %u), try again later", method, limit->second));
+            }
+            m_active = &active;
+            ++active;
+        }
         it = g_rpc_server_info.active_commands.insert(g_rpc_server_info.active_commands.end(), {method, SteadyClock::now()});
     }
     ~RPCCommandExecution()
     {
         LOCK(g_rpc_server_info.mutex);
         g_rpc_server_info.active_commands.erase(it);
+        if (m_active) --*m_active;
     }
 };
 
@@ -281,10 +298,28 @@ bool CRPCTable::removeCommand(const std::string& name, const CRPCCommand* pcmd)
     return false;
 }
 
-void StartRPC()
+util::Result<void> StartRPC()
 {
     LogDebug(BCLog::RPC, "Starting RPC\n");
+    {
+        LOCK(g_rpc_server_info.mutex);
+        g_rpc_server_info.method_limits.clear();
+        const std::vector<std::string> methods{tableRPC.listCommands()};
+        for (const std::string& arg : gArgs.GetArgs("-rpcmethodlimit")) {
+            const auto pos{arg.find(':')};
+            const auto limit{pos == std::string::npos ? std::nullopt : ToIntegral<size_t>(arg.substr(pos + 1))};
+            if (!limit || *limit == 0) {
+                return util::Error{strprintf(_("Invalid -rpcmethodlimit=%s, expected <method>:<n> with n > 0"), arg)};
+            }
+            const std::string method{arg.substr(0, pos)};
+            if (std::find(methods.begin(), methods.end(), method) == methods.end()) {
+                return util::Error{strprintf(_("Invalid -rpcmethodlimit=%s, unknown RPC method %s"), arg, method)};
+            }
+            g_rpc_server_info.method_limits[method] = *limit;
+        }
+    }
     g_rpc_running = true;
+    return {};
 }
 
 void InterruptRPC()
@@ -530,6 +565,13 @@ std::vector<std::string> CRPCTable::listCommands() const
     return commandList;
 }
 
+std::optional<std::string> CRPCTable::getCategory(const std::string& name) const
+{
+    const auto it{mapCommands.find(name)};
+    if (it == mapCommands.end() || it->second.empty()) return std::nullopt;
+    return it->second.front()->category;
+}
+
 UniValue CRPCTable::dumpArgMap(const JSONRPCRequest& args_request) const
 {
     JSONRPCRequest request = args_request;
@@ -8,9 +8,11 @@
 
 #include <rpc/request.h>
 #include <rpc/util.h>
+#include <util/result.h>
 
 #include <functional>
 #include <map>
+#include <optional>
 #include <stdint.h>
 #include <string>
 
@@ -145,6 +147,12 @@ public:
     */
     std::vector<std::string> listCommands() const;
 
+    /**
+     * Returns the category of a command, like "wallet"
+     * @returns The category, or nothing if no command has that name.
+     */
+    std::optional<std::string> getCategory(const std::string& name) const;
+
     /**
      * Return all named arguments that need to be converted by the client from string to another JSON type
      */
@@ -170,7 +178,8 @@ bool IsDeprecatedRPCEnabled(const std::string& method);
 
 extern CRPCTable tableRPC;
 
-void StartRPC();
+/** Start the RPC server. Fails if the per-method limits are invalid. */
+util::Result<void> StartRPC();
 void InterruptRPC();
 void StopRPC();
 UniValue JSONRPCExec(const JSONRPCRequest& jreq, bool catch_errors);
@@ -18,6 +18,7 @@
 #include <map>
 #include <thread>
 #include <utility>
+#include <vector>
 
 /**
  * Simple class for background tasks that should be run
@@ -43,6 +44,9 @@ public:
     ~CScheduler();
 
     std::thread m_service_thread;
+    //! Further threads running serviceQueue, so that tasks (like the callbacks
+    //! of different SerialTaskRunners) can run in parallel
+    std::vector<std::thread> m_extra_service_threads;
 
     typedef std::function<void()> Function;
 
@@ -80,14 +84,14 @@ public:
     {
         WITH_LOCK(newTaskMutex, stopRequested = true);
         newTaskScheduled.notify_all();
-        if (m_service_thread.joinable()) m_service_thread.join();
+        JoinServiceThreads();
     }
     /** Tell any threads running serviceQueue to stop when there is no work left to be done */
     void StopWhenDrained() EXCLUSIVE_LOCKS_REQUIRED(!newTaskMutex)
     {
         WITH_LOCK(newTaskMutex, stopWhenEmpty = true);
         newTaskScheduled.notify_all();
-        if (m_service_thread.joinable()) m_service_thread.join();
+        JoinServiceThreads();
     }
 
     /**
@@ -109,6 +113,15 @@ private:
     bool stopRequested GUARDED_BY(newTaskMutex){false};
     bool stopWhenEmpty GUARDED_BY(newTaskMutex){false};
     bool shouldStop() const EXCLUSIVE_LOCKS_REQUIRED(newTaskMutex) { return stopRequested || (stopWhenEmpty && taskQueue.empty()); }
+
+    void JoinServiceThreads()
+    {
+        if (m_service_thread.joinable()) m_service_thread.join();
+        for (auto& thread : m_extra_service_threads) {
+            if (thread.joinable()) thread.join();
+        }
+        m_extra_service_threads.clear();
+    }
 };
 
 /**
@@ -242,8 +242,9 @@ public:
     {
         std::optional<CPubKey> pub = m_provider->GetPubKey(pos, arg, out, read_cache, write_cache);
         if (!pub) return std::nullopt;
-        Assert(out.pubkeys.contains(pub->GetID()));
-        auto& [pubkey, suborigin] = out.origins[pub->GetID()];
+        const CKeyID keyid{pub->GetID()};
+        Assert(out.pubkeys.contains(keyid));
+        auto& [pubkey, suborigin] = out.origins[keyid];
         Assert(pubkey == *pub); // m_provider must have a valid origin by this point.
         std::copy(std::begin(m_origin.fingerprint), std::end(m_origin.fingerprint), suborigin.fingerprint);
         suborigin.path.insert(suborigin.path.begin(), m_origin.path.begin(), m_origin.path.end());
@@ -363,6 +364,8 @@ class BIP32PubkeyProvider final : public PubkeyProvider
 {
     // Root xpub, path, and final derivation step type being used, if any
     CExtPubKey m_root_extkey;
+    // Key ID of the root xpub, hashed once rather than for every derived key
+    CKeyID m_root_keyid;
     KeyPath m_path;
     DeriveType m_derive;
     // Whether ' or h is used in harded derivation
@@ -371,7 +374,7 @@ class BIP32PubkeyProvider final : public PubkeyProvider
     bool GetExtKey(const SigningProvider& arg, CExtKey& ret) const
     {
         CKey key;
-        if (!arg.GetKey(m_root_extkey.pubkey.GetID(), key)) return false;
+        if (!arg.GetKey(m_root_keyid, key)) return false;
         ret.nDepth = m_root_extkey.nDepth;
         std::copy(m_root_extkey.vchFingerprint, m_root_extkey.vchFingerprint + sizeof(ret.vchFingerprint), ret.vchFingerprint);
         ret.nChild = m_root_extkey.nChild;
@@ -403,14 +406,13 @@ class BIP32PubkeyProvider final : public PubkeyProvider
     }
 
 public:
-    BIP32PubkeyProvider(uint32_t exp_index, const CExtPubKey& extkey, KeyPath path, DeriveType derive, bool apostrophe) : PubkeyProvider(exp_index), m_root_extkey(extkey), m_path(std::move(path)), m_derive(derive), m_apostrophe(apostrophe) {}
+    BIP32PubkeyProvider(uint32_t exp_index, const CExtPubKey& extkey, KeyPath path, DeriveType derive, bool apostrophe) : PubkeyProvider(exp_index), m_root_extkey(extkey), m_root_keyid(extkey.pubkey.GetID()), m_path(std::move(path)), m_derive(derive), m_apostrophe(apostrophe) {}
     bool IsRange() const override { return m_derive != DeriveType::NO; }
     size_t GetSize() const override { return 33; }
     std::optional<CPubKey> GetPubKey(int pos, const SigningProvider& arg, FlatSigningProvider& out, const DescriptorCache* read_cache = nullptr, DescriptorCache* write_cache = nullptr) const override
     {
         KeyOriginInfo info;
-        CKeyID keyid = m_root_extkey.pubkey.GetID();
-        std::copy(keyid.begin(), keyid.begin() + sizeof(info.fingerprint), info.fingerprint);
+        std::copy(m_root_keyid.begin(), m_root_keyid.begin() + sizeof(info.fingerprint), info.fingerprint);
         info.path = m_path;
         if (m_derive == DeriveType::UNHARDENED) info.path.push_back((uint32_t)pos);
         if (m_derive == DeriveType::HARDENED) info.path.push_back(((uint32_t)pos) | 0x80000000L);
@@ -449,8 +451,9 @@ public:
         }
         if (!der) return std::nullopt;
 
-        out.origins.emplace(final_extkey.pubkey.GetID(), std::make_pair(final_extkey.pubkey, info));
-        out.pubkeys.emplace(final_extkey.pubkey.GetID(), final_extkey.pubkey);
+        const CKeyID final_keyid{final_extkey.pubkey.GetID()};
+        out.origins.emplace(final_keyid, std::make_pair(final_extkey.pubkey, info));
+        out.pubkeys.emplace(final_keyid, final_extkey.pubkey);
 
         if (write_cache) {
             // Only cache parent if there is any unhardened derivation
@@ -525,8 +528,7 @@ public:
             end_path.push_back(m_path.at(k));
         }
         // Get the fingerprint
-        CKeyID id = m_root_extkey.pubkey.GetID();
-        std::copy(id.begin(), id.begin() + 4, origin.fingerprint);
+        std::copy(m_root_keyid.begin(), m_root_keyid.begin() + 4, origin.fingerprint);
 
         CExtPubKey xpub;
         CExtKey lh_xprv;
@@ -1303,11 +1305,14 @@ protected:
                                      FlatSigningProvider& provider) const override
     {
         const auto script_ctx{m_node->GetMsCtx()};
-        for (const auto& key : keys) {
-            if (miniscript::IsTapscript(script_ctx)) {
+        if (miniscript::IsTapscript(script_ctx)) {
+            for (const auto& key : keys) {
                 provider.pubkeys.emplace(Hash160(XOnlyPubKey{key}), key);
-            } else {
-                provider.pubkeys.emplace(key.GetID(), key);
+            }
+        } else {
+            const std::vector<CKeyID> keyids{GetKeyIDs(keys)};
+            for (size_t i = 0; i < keys.size(); ++i) {
+                provider.pubkeys.emplace(keyids[i], keys[i]);
             }
         }
         return Vector(m_node->ToScript(ScriptMaker(keys, script_ctx)));
@@ -138,6 +138,39 @@ public:
     }
 };
 
+/** Minimal stream for writing into an existing, fixed size byte array by std::span.
+ */
+class SpanWriter
+{
+private:
+    std::span<std::byte> m_data;
+
+public:
+    /**
+     * @param[in]  data Referenced byte array to overwrite, from the beginning
+     */
+    explicit SpanWriter(std::span<std::byte> data) : m_data{data} {}
+
+    template<typename T>
+    SpanWriter& operator<<(const T& obj)
+    {
+        ::Serialize(*this, obj);
+        return (*this);
+    }
+
+    //! Number of bytes that can still be written.
+    size_t size() const { return m_data.size(); }
+
+    void write(std::span<const std::byte> src)
+    {
+        if (src.size() > m_data.size()) {
+            throw std::ios_base::failure("SpanWriter::write(): end of data");
+        }
+        if (!src.empty()) memcpy(m_data.data(), src.data(), src.size());
+        m_data = m_data.subspan(src.size());
+    }
+};
+
 /** Double ended buffer combining vector and stream-like interfaces.
  *
  * >> and << read and write unformatted data using the above serialization templates.
@@ -14,8 +14,11 @@
 #include <undo.h>
 #include <util/strencodings.h>
 
+#include <algorithm>
+#include <atomic>
 #include <map>
 #include <string>
+#include <thread>
 #include <variant>
 #include <vector>
 
@@ -1074,4 +1077,149 @@ BOOST_AUTO_TEST_CASE(coins_resource_is_used)
     PoolResourceTester::CheckAllDataAccountedFor(resource);
 }
 
+BOOST_AUTO_TEST_CASE(ccoins_sharded_view)
+{
+    CCoinsViewDB base{{.path = "test", .cache_bytes = 1 << 23, .memory_only = true}, {}};
+    CCoinsViewSharded shared{&base, /*max_cache_bytes=*/1 << 20, /*shard_count=*/4, /*deterministic=*/true};
+
+    const auto make_coin{[](uint32_t height) {
+        Coin coin;
+        coin.out.nValue = height;
+        coin.out.scriptPubKey = CScript() << OP_TRUE;
+        coin.nHeight = height;
+        return coin;
+    }};
+    std::vector<COutPoint> outpoints;
+    for (uint32_t i{0}; i < 100; ++i) outpoints.emplace_back(Txid::FromUint256(m_rng.rand256()), i);
+
+    {
+        CCoinsViewCache cache{&shared};
+        for (const auto& outpoint : outpoints) cache.AddCoin(outpoint, make_coin(outpoint.n), /*possible_overwrite=*/false);
+        cache.SetBestBlock(m_rng.rand256());
+        BOOST_CHECK(cache.Flush());
+    }
+    // Writes only pass through.
+    BOOST_CHECK_EQUAL(shared.GetCacheSize(), 0U);
+    for (const auto& outpoint : outpoints) {
+        BOOST_CHECK(shared.GetCoin(outpoint).value() == make_coin(outpoint.n));
+        BOOST_CHECK(shared.HaveCoin(outpoint));
+    }
+    BOOST_CHECK_EQUAL(shared.GetCacheSize(), outpoints.size());
+    BOOST_CHECK(!shared.GetCoin(COutPoint{Txid::FromUint256(m_rng.rand256()), 0}));
+
+    // Committed changes replace cached coins.
+    {
+        CCoinsViewCache cache{&shared};
+        cache.SpendCoin(outpoints[0]);
+        cache.AddCoin(outpoints[1], make_coin(1000), /*possible_overwrite=*/true);
+        BOOST_CHECK(cache.Sync());
+    }
+    BOOST_CHECK(!shared.GetCoin(outpoints[0]));
+    BOOST_CHECK(!shared.HaveCoin(outpoints[0]));
+    BOOST_CHECK(shared.GetCoin(outpoints[1]).value() == make_coin(1000));
+    BOOST_CHECK(shared.GetCoin(outpoints[2]).value() == make_coin(2));
+
+    // The memory budget is respected.
+    CCoinsViewSharded small{&base, /*max_cache_bytes=*/4096, /*shard_count=*/4, /*deterministic=*/true};
+    for (const auto& outpoint : outpoints) small.GetCoin(outpoint);
+    BOOST_CHECK_GT(small.GetCacheSize(), 0U);
+    BOOST_CHECK_LT(small.GetCacheSize(), outpoints.size());
+
+    // A zero budget makes it a pass-through view.
+    CCoinsViewSharded none{&base, /*max_cache_bytes=*/0};
+    BOOST_CHECK(none.GetCoin(outpoints[2]).value() == make_coin(2));
+    BOOST_CHECK_EQUAL(none.GetCacheSize(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_get_coins_batch)
+{
+    CCoinsViewDB base{{.path = "test", .cache_bytes = 1 << 23, .memory_only = true}, {}};
+    CCoinsViewSharded shared{&base, /*max_cache_bytes=*/1 << 20, /*shard_count=*/4, /*deterministic=*/true};
+
+    std::vector<COutPoint> outpoints;
+    {
+        CCoinsViewCache cache{&base};
+        for (uint32_t i{0}; i < 200; ++i) {
+            outpoints.emplace_back(Txid::FromUint256(m_rng.rand256()), i);
+            Coin coin;
+            coin.out.nValue = i;
+            coin.out.scriptPubKey = CScript() << OP_TRUE;
+            coin.nHeight = i;
+            cache.AddCoin(outpoints.back(), std::move(coin), /*possible_overwrite=*/false);
+        }
+        cache.SetBestBlock(m_rng.rand256());
+        BOOST_CHECK(cache.Flush());
+    }
+    // Mix in missing and duplicate outpoints.
+    std::vector<COutPoint> lookups{outpoints};
+    for (uint32_t i{0}; i < 50; ++i) lookups.emplace_back(Txid::FromUint256(m_rng.rand256()), i);
+    lookups.push_back(outpoints[7]);
+    std::shuffle(lookups.begin(), lookups.end(), m_rng);
+
+    for (const CCoinsView* view : std::initializer_list<const CCoinsView*>{&base, &shared}) {
+        const auto coins{view->GetCoins(lookups)};
+        BOOST_REQUIRE_EQUAL(coins.size(), lookups.size());
+        for (size_t i{0}; i < lookups.size(); ++i) {
+            const auto expected{base.GetCoin(lookups[i])};
+            BOOST_CHECK_EQUAL(coins[i].has_value(), expected.has_value());
+            if (coins[i] && expected) BOOST_CHECK(*coins[i] == *expected);
+        }
+    }
+
+    // Prefetching only caches coins that exist, and lookups then hit the cache.
+    CCoinsViewCache cache{&shared};
+    cache.PrefetchCoins(lookups);
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), outpoints.size());
+    for (const auto& outpoint : outpoints) BOOST_CHECK(cache.HaveCoinInCache(outpoint));
+    BOOST_CHECK(cache.AccessCoin(outpoints[3]).nHeight == 3);
+    BOOST_CHECK(cache.GetCoins({}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_sharded_view_concurrent)
+{
+    CCoinsViewDB base{{.path = "test", .cache_bytes = 1 << 23, .memory_only = true}, {}};
+    CCoinsViewSharded shared{&base, /*max_cache_bytes=*/1 << 16, /*shard_count=*/8};
+
+    std::vector<COutPoint> outpoints;
+    for (uint32_t i{0}; i < 64; ++i) outpoints.emplace_back(Txid::FromUint256(m_rng.rand256()), i);
+    const auto commit{[&](uint32_t height) {
+        CCoinsViewCache cache{&shared};
+        for (const auto& outpoint : outpoints) {
+            Coin coin;
+            coin.out.nValue = 1;
+            coin.nHeight = height;
+            cache.AddCoin(outpoint, std::move(coin), /*possible_overwrite=*/true);
+        }
+        cache.SetBestBlock(m_rng.rand256());
+        return cache.Flush();
+    }};
+    BOOST_REQUIRE(commit(1));
+
+    // Readers must never observe a coin going back to an older height once a
+    // newer one has been seen, whether it came from the shards or the base.
+    std::atomic<bool> stop{false};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> readers;
+    for (int t{0}; t < 2; ++t) {
+        readers.emplace_back([&, seed = m_rng.rand256()] {
+            FastRandomContext rng{seed};
+            std::vector<uint32_t> seen(outpoints.size(), 0);
+            while (!stop) {
+                const size_t i{rng.randrange(outpoints.size())};
+                const auto coin{shared.GetCoin(outpoints[i])};
+                if (!coin || coin->nHeight < seen[i]) {
+                    ++failures;
+                } else {
+                    seen[i] = coin->nHeight;
+                }
+            }
+        });
+    }
+    for (uint32_t height{2}; height < 100; ++height) BOOST_CHECK(commit(height));
+    stop = true;
+    for (auto& reader : readers) reader.join();
+    BOOST_CHECK_EQUAL(failures, 0);
+    for (const auto& outpoint : outpoints) BOOST_CHECK_EQUAL(shared.GetCoin(outpoint)->nHeight, 99U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
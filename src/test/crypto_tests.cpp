@@ -15,6 +15,7 @@
 #include <crypto/sha3.h>
 #include <crypto/sha512.h>
 #include <crypto/muhash.h>
+#include <hash.h>
 #include <random.h>
 #include <streams.h>
 #include <test/util/random.h>
@@ -22,6 +23,9 @@
 #include <util/strencodings.h>
 
 #include <algorithm>
+#include <optional>
+#include <string>
+#include <tuple>
 #include <vector>
 
 #include <boost/test/unit_test.hpp>
@@ -969,6 +973,49 @@ BOOST_AUTO_TEST_CASE(poly1305_testvector)
                  "0e410fa9d7a40ac582e77546be9a72bb");
 }
 
+BOOST_AUTO_TEST_CASE(chacha20_poly1305_implementations)
+{
+    // The multi-block ChaCha20 and Poly1305 code must give the same output as
+    // the scalar code, including across a wrap of the 32-bit block counter
+    // and when the input is split at arbitrary points.
+    for (int i = 0; i < 40; ++i) {
+        const auto key{m_rng.randbytes<std::byte>(32)};
+        const ChaCha20::Nonce96 nonce{m_rng.rand32(), m_rng.rand64()};
+        const uint32_t block_counter = i % 2 ? 0xffffffff - m_rng.randrange(40) : m_rng.rand32();
+        const size_t len = m_rng.randrange(i % 4 ? 3000 : 70000);
+        const size_t split = m_rng.randrange(len + 1);
+        const auto input{m_rng.randbytes<std::byte>(len)};
+
+        std::optional<std::vector<std::byte>> expected_crypt, expected_keystream, expected_tag;
+        for (const auto use_implementation : {chacha20_implementation::STANDARD, chacha20_implementation::USE_AVX2, chacha20_implementation::USE_ALL}) {
+            BOOST_TEST_MESSAGE("Using the '" << ChaCha20AutoDetect(use_implementation) << "' ChaCha20 implementation");
+            std::vector<std::byte> crypt(len), keystream(len);
+            ChaCha20 chacha{key};
+            chacha.Seek(nonce, block_counter);
+            chacha.Crypt(std::span{input}.first(split), std::span{crypt}.first(split));
+            chacha.Crypt(std::span{input}.subspan(split), std::span{crypt}.subspan(split));
+            chacha.Seek(nonce, block_counter);
+            chacha.Keystream(std::span{keystream}.first(split));
+            chacha.Keystream(std::span{keystream}.subspan(split));
+            if (!expected_crypt) {
+                expected_crypt = crypt;
+                expected_keystream = keystream;
+            }
+            BOOST_CHECK(crypt == *expected_crypt);
+            BOOST_CHECK(keystream == *expected_keystream);
+        }
+        for (const auto use_implementation : {poly1305_implementation::STANDARD, poly1305_implementation::USE_ALL}) {
+            BOOST_TEST_MESSAGE("Using the '" << Poly1305AutoDetect(use_implementation) << "' Poly1305 implementation");
+            std::vector<std::byte> tag(Poly1305::TAGLEN);
+            Poly1305{key}.Update(std::span{input}.first(split)).Update(std::span{input}.subspan(split)).Finalize(tag);
+            if (!expected_tag) expected_tag = tag;
+            BOOST_CHECK(tag == *expected_tag);
+        }
+    }
+    ChaCha20AutoDetect();
+    Poly1305AutoDetect();
+}
+
 BOOST_AUTO_TEST_CASE(chacha20poly1305_testvectors)
 {
     // Note that in our implementation, the authentication is suffixed to the ciphertext.
@@ -1086,6 +1133,37 @@ BOOST_AUTO_TEST_CASE(sha256d64)
     }
 }
 
+BOOST_AUTO_TEST_CASE(sha256_multi)
+{
+    // Cover messages that need one and two padding chunks, and counts that
+    // aren't a multiple of the multi-buffer width.
+    for (const size_t len : {0, 1, 55, 56, 63, 64, 119, 1952}) {
+        for (size_t count = 0; count <= 17; ++count) {
+            std::vector<std::vector<unsigned char>> messages;
+            std::vector<const unsigned char*> inputs;
+            for (size_t i = 0; i < count; ++i) {
+                messages.push_back(m_rng.randbytes(len));
+                inputs.push_back(messages.back().data());
+            }
+            std::vector<unsigned char> out1(32 * count), out2(32 * count), out3(20 * count), out4(20 * count);
+            for (size_t i = 0; i < count; ++i) {
+                CSHA256().Write(inputs[i], len).Finalize(out1.data() + 32 * i);
+                CRIPEMD160().Write(out1.data() + 32 * i, 32).Finalize(out3.data() + 20 * i);
+            }
+            SHA256Multi(out2.data(), inputs.data(), len, count);
+            BOOST_CHECK(out1 == out2);
+            RIPEMD160Multi(out4.data(), out1.data(), 32, count);
+            BOOST_CHECK(out3 == out4);
+
+            const std::vector<uint160> hashes{Hash160Multi(inputs, len)};
+            BOOST_REQUIRE_EQUAL(hashes.size(), count);
+            for (size_t i = 0; i < count; ++i) {
+                BOOST_CHECK(hashes[i] == Hash160(messages[i]));
+            }
+        }
+    }
+}
+
 void CryptoTest::TestSHA3_256(const std::string& input, const std::string& output)
 {
     const auto in_bytes = ParseHex(input);
@@ -1197,6 +1275,85 @@ static MuHash3072 FromInt(unsigned char i) {
     return MuHash3072(tmp);
 }
 
+//! SHAKE with the given rate on the scalar Keccak permutation, one byte at a time.
+static std::vector<unsigned char> ScalarSHAKE(size_t rate, std::span<const unsigned char> input, size_t out_len)
+{
+    uint64_t st[25] = {0};
+    const auto xor_byte{[&](size_t pos, unsigned char byte) { st[pos / 8] ^= uint64_t{byte} << (8 * (pos % 8)); }};
+    size_t pos{0};
+    for (const unsigned char byte : input) {
+        xor_byte(pos, byte);
+        if (++pos == rate) {
+            KeccakF(st);
+            pos = 0;
+        }
+    }
+    xor_byte(pos, 0x1f);
+    xor_byte(rate - 1, 0x80);
+    KeccakF(st);
+    std::vector<unsigned char> out(out_len);
+    pos = 0;
+    for (auto& byte : out) {
+        if (pos == rate) {
+            KeccakF(st);
+            pos = 0;
+        }
+        byte = st[pos / 8] >> (8 * (pos % 8));
+        ++pos;
+    }
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(shake_multi_tests)
+{
+    for (const auto use_implementation : {sha3_implementation::STANDARD, sha3_implementation::USE_AVX2, sha3_implementation::USE_ALL}) {
+        BOOST_TEST_MESSAGE("Using the '" << SHA3AutoDetect(use_implementation) << "' Keccak implementation");
+
+        // SHAKE128("abc") and SHAKE256("") test vectors, in the last of 8 lanes.
+        for (const auto& [rate, input, expected] : std::vector<std::tuple<size_t, std::string, std::string>>{
+                 {SHAKEMulti::SHAKE128_RATE, "abc", "5881092dd818bf5cf8a3ddb793fbcba74097d5c526a6d35f97b83351940f2cc8"},
+                 {SHAKEMulti::SHAKE256_RATE, "", "46b9dd2b0ba88d13233b3feb743eeb243fcd52ea62b81b82b50c27646ed5762f"}}) {
+            const std::vector<const unsigned char*> inputs(SHAKEMulti::MAX_LANES, UCharCast(input.data()));
+            std::vector<unsigned char> out(32 * SHAKEMulti::MAX_LANES);
+            std::vector<unsigned char*> outputs;
+            for (size_t lane = 0; lane < SHAKEMulti::MAX_LANES; ++lane) outputs.push_back(out.data() + 32 * lane);
+            SHAKEMulti(rate, SHAKEMulti::MAX_LANES).Absorb(inputs, input.size()).Squeeze(outputs, 32);
+            BOOST_CHECK_EQUAL(HexStr(std::span{out}.last(32)), expected);
+            BOOST_CHECK_EQUAL(HexStr(ScalarSHAKE(rate, MakeUCharSpan(input), 32)), expected);
+        }
+
+        // Every lane of a sponge matches the scalar SHAKE, also with
+        // absorbing and squeezing split at arbitrary points.
+        for (const size_t rate : {SHAKEMulti::SHAKE128_RATE, SHAKEMulti::SHAKE256_RATE}) {
+            for (size_t lanes = 1; lanes <= SHAKEMulti::MAX_LANES; ++lanes) {
+                const size_t len = m_rng.randrange(3 * rate);
+                const size_t split = m_rng.randrange(len + 1);
+                const size_t out_len = 1 + m_rng.randrange(3 * rate);
+                const size_t out_split = m_rng.randrange(out_len + 1);
+                std::vector<std::vector<unsigned char>> in(lanes), out(lanes, std::vector<unsigned char>(out_len));
+                std::vector<const unsigned char*> inputs;
+                std::vector<unsigned char*> outputs;
+                for (size_t lane = 0; lane < lanes; ++lane) {
+                    in[lane] = m_rng.randbytes(len);
+                    inputs.push_back(in[lane].data());
+                    outputs.push_back(out[lane].data());
+                }
+                SHAKEMulti shake(rate, lanes);
+                shake.Absorb(inputs, split);
+                for (auto& input : inputs) input += split;
+                shake.Absorb(inputs, len - split).Squeeze(outputs, out_split);
+                for (auto& output : outputs) output += out_split;
+                shake.Squeeze(outputs, out_len - out_split);
+
+                for (size_t lane = 0; lane < lanes; ++lane) {
+                    BOOST_CHECK(out[lane] == ScalarSHAKE(rate, in[lane], out_len));
+                }
+            }
+        }
+    }
+    SHA3AutoDetect();
+}
+
 BOOST_AUTO_TEST_CASE(muhash_tests)
 {
     uint256 out;
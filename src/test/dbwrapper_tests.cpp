@@ -2,7 +2,9 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <common/args.h>
 #include <dbwrapper.h>
+#include <node/database_args.h>
 #include <test/util/random.h>
 #include <test/util/setup_common.h>
 #include <uint256.h>
@@ -126,6 +128,54 @@ BOOST_AUTO_TEST_CASE(dbwrapper_basic_data)
 }
 
 // Test batch operations
+BOOST_AUTO_TEST_CASE(dbwrapper_read_many)
+{
+    for (const bool obfuscate : {false, true}) {
+        fs::path ph = m_args.GetDataDirBase() / (obfuscate ? "dbwrapper_read_many_obfuscate_true" : "dbwrapper_read_many_obfuscate_false");
+        CDBWrapper dbw({.path = ph, .cache_bytes = 1 << 20, .memory_only = true, .wipe_data = false, .obfuscate = obfuscate});
+
+        // Store every third key, so that lookups mix hits, misses and short
+        // and long gaps between consecutive keys.
+        std::map<uint32_t, uint256> stored;
+        for (uint32_t i = 0; i < 3000; i += 3) {
+            stored[i] = m_rng.rand256();
+            BOOST_CHECK(dbw.Write(std::make_pair(uint8_t{'k'}, i), stored[i]));
+        }
+        std::vector<std::pair<uint8_t, uint32_t>> keys;
+        for (int i = 0; i < 2000; ++i) keys.emplace_back(uint8_t{'k'}, m_rng.randrange(3100));
+        keys.emplace_back(keys.front()); // duplicate
+        keys.emplace_back(uint8_t{'a'}, 0);       // before all entries
+        keys.emplace_back(uint8_t{'z'}, 0);       // after all entries
+
+        const auto values{dbw.ReadMany<uint256>(std::span<const std::pair<uint8_t, uint32_t>>{keys})};
+        BOOST_REQUIRE_EQUAL(values.size(), keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            const auto it{keys[i].first == 'k' ? stored.find(keys[i].second) : stored.end()};
+            if (it == stored.end()) {
+                BOOST_CHECK(!values[i]);
+            } else {
+                BOOST_CHECK(values[i] == it->second);
+            }
+        }
+        BOOST_CHECK(dbw.ReadMany<uint256>(std::span<const std::pair<uint8_t, uint32_t>>{}).empty());
+
+        // Keys far from all others are read on their own.
+        using Key = std::pair<uint8_t, uint32_t>;
+        const std::vector<Key> far_keys{{uint8_t{'a'}, 0}, {uint8_t{'k'}, 0}, {uint8_t{'z'}, 0}};
+        const auto far_values{dbw.ReadMany<uint256>(std::span<const Key>{far_keys})};
+        BOOST_REQUIRE_EQUAL(far_values.size(), far_keys.size());
+        BOOST_CHECK(!far_values[0]);
+        BOOST_CHECK(far_values[1] == stored[0]);
+        BOOST_CHECK(!far_values[2]);
+
+        // A value that fails to deserialize is not mistaken for a missing one.
+        BOOST_CHECK(dbw.Write(Key{uint8_t{'k'}, 1}, uint8_t{1}));
+        for (const auto& bad_keys : {std::vector<Key>{{uint8_t{'k'}, 1}}, std::vector<Key>{{uint8_t{'k'}, 1}, {uint8_t{'k'}, 1 + (1 << 24)}}}) {
+            BOOST_CHECK_THROW(dbw.ReadMany<uint256>(std::span<const Key>{bad_keys}), dbwrapper_error);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(dbwrapper_batch)
 {
     // Perform tests both obfuscated and non-obfuscated.
@@ -399,5 +449,49 @@ BOOST_AUTO_TEST_CASE(unicodepath)
     BOOST_CHECK(fs::exists(lockPath));
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_options)
+{
+    const auto read_args{[](std::vector<std::string> dboptions, std::string_view db_type) {
+        ArgsManager args;
+        args.AddArg("-dboption", "", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+        for (auto& option : dboptions) option.insert(0, "-dboption=");
+        std::vector<const char*> argv{"ignored"};
+        for (const auto& option : dboptions) argv.push_back(option.c_str());
+        std::string error;
+        BOOST_REQUIRE(args.ParseParameters(argv.size(), argv.data(), error));
+        DBOptions options;
+        auto result{node::ReadDatabaseArgs(args, options, db_type)};
+        return result ? std::optional{options} : std::nullopt;
+    }};
+
+    // Database-specific options win over general ones regardless of order.
+    auto options{read_args({"txindex:bloombits=0", "bloombits=20", "blocksize=16384", "compression=1"}, "txindex")};
+    BOOST_REQUIRE(options);
+    BOOST_CHECK_EQUAL(options->bloom_bits, 0);
+    BOOST_CHECK_EQUAL(options->block_size, 16384U);
+    BOOST_CHECK(options->compression);
+    BOOST_CHECK_EQUAL(options->max_file_size, DBWRAPPER_MAX_FILE_SIZE);
+    options = read_args({"txindex:bloombits=0", "bloombits=20"}, "chainstate");
+    BOOST_REQUIRE(options);
+    BOOST_CHECK_EQUAL(options->bloom_bits, 20);
+
+    // Every entry is validated, not only the ones for the requested database.
+    BOOST_CHECK(!read_args({"mempool:bloombits=1"}, "chainstate"));
+    BOOST_CHECK(!read_args({"txindex:blocksize=1"}, "chainstate"));
+    BOOST_CHECK(!read_args({"bloombits"}, "chainstate"));
+    BOOST_CHECK(!read_args({"bloombits=-1"}, "chainstate"));
+    BOOST_CHECK(!read_args({"cachesize=1"}, "chainstate"));
+
+    // A database opened with a non-default profile works and reports it.
+    DBOptions profile{.block_size = 64 << 10, .bloom_bits = 0, .write_buffer_bytes = 1 << 20, .compression = true, .max_file_size = 4 << 20};
+    CDBWrapper dbw({.path = m_args.GetDataDirBase() / "dbwrapper_options", .cache_bytes = 1 << 20, .memory_only = true, .options = profile});
+    BOOST_CHECK_EQUAL(dbw.GetDBOptions().block_size, profile.block_size);
+    BOOST_CHECK_EQUAL(dbw.GetDBOptions().bloom_bits, 0);
+    for (uint32_t i{0}; i < 1000; ++i) BOOST_CHECK(dbw.Write(i, m_rng.rand256()));
+    uint256 value;
+    BOOST_CHECK(dbw.Read(uint32_t{999}, value));
+    BOOST_CHECK(!dbw.Read(uint32_t{1000}, value));
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -148,10 +148,12 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "getrawaddrman",
     "getrawmempool",
     "getrawtransaction",
+    "getrawtransactions",
     "getrpcinfo",
     "gettxout",
     "gettxoutsetinfo",
     "gettxspendingprevout",
+    "getvalidationqueueinfo",
     "help",
     "invalidateblock",
     "joinpsbts",
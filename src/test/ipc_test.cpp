@@ -2,9 +2,11 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <common/args.h>
 #include <interfaces/init.h>
 #include <ipc/capnp/protocol.h>
 #include <ipc/process.h>
+#include <ipc/sharedmemory.h>
 #include <ipc/protocol.h>
 #include <logging.h>
 #include <mp/proxy-types.h>
@@ -125,6 +127,26 @@ void IpcPipeTest()
     auto script2{foo->passScript(script1)};
     BOOST_CHECK_EQUAL(HexStr(script1), HexStr(script2));
 
+    // Blocks above SHARED_MEMORY_MIN_SIZE are passed through shared memory
+    // when it is enabled, and copied through the pipe otherwise. The
+    // descriptor server of this process serves both sides.
+    CBlock block1;
+    block1.nVersion = 4;
+    block1.nTime = 5;
+    mtx.vout.assign(1, CTxOut{COIN, CScript() << std::vector<unsigned char>(1000, 0x6a)});
+    while (::GetSerializeSize(TX_WITH_WITNESS(block1)) < ipc::SHARED_MEMORY_MIN_SIZE) {
+        mtx.nLockTime = block1.vtx.size();
+        block1.vtx.push_back(MakeTransactionRef(mtx));
+    }
+    for (const bool shared_memory : {false, true}) {
+        gArgs.ForceSetArg("-ipcsharedmemory", shared_memory ? "1" : "0");
+        CBlock block2{foo->passBlock(block1)};
+        BOOST_CHECK(block1.GetHash() == block2.GetHash());
+        BOOST_CHECK_EQUAL(block1.vtx.size(), block2.vtx.size());
+        BOOST_CHECK(block1.vtx.back()->GetWitnessHash() == block2.vtx.back()->GetWitnessHash());
+    }
+    gArgs.ForceSetArg("-ipcsharedmemory", "0");
+
     // Test cleanup: disconnect pipe and join thread
     disconnect_client();
     thread.join();
@@ -2,7 +2,9 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <ipc/exception.h>
 #include <ipc/process.h>
+#include <ipc/sharedmemory.h>
 #include <test/ipc_test.h>
 
 #include <test/util/setup_common.h>
@@ -39,4 +41,31 @@ BOOST_AUTO_TEST_CASE(parse_address_test)
     check_address("invalid", "invalid", "Unrecognized address 'invalid'");
 }
 
+// Test passing shared memory segment descriptors between threads through the
+// descriptor server, as they are passed between processes.
+BOOST_AUTO_TEST_CASE(shared_memory_test)
+{
+    auto segment{ipc::SharedMemorySegment::Create(1000, [](std::span<std::byte> buffer) {
+        for (size_t i{0}; i < buffer.size(); ++i) buffer[i] = std::byte(i);
+    })};
+    // Not supported on this platform.
+    if (!segment) return;
+    auto offer{ipc::SharedMemoryOffer::Create(std::move(*segment))};
+    BOOST_REQUIRE(offer);
+    {
+        const ipc::SharedMemoryMapping mapping{offer->address(), offer->token()};
+        BOOST_REQUIRE_EQUAL(mapping.data().size(), 1000U);
+        BOOST_CHECK(mapping.data()[999] == std::byte(999 % 256));
+    }
+    auto token{offer->token()};
+    token[0] ^= std::byte{1};
+    BOOST_CHECK_THROW((ipc::SharedMemoryMapping{offer->address(), token}), ipc::Exception);
+
+    // Segments can't be fetched once the offer is withdrawn.
+    const std::string address{offer->address()};
+    token = offer->token();
+    offer.reset();
+    BOOST_CHECK_THROW((ipc::SharedMemoryMapping{address, token}), ipc::Exception);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
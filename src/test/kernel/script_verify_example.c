@@ -0,0 +1,115 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Example of verifying a transaction with the batch script verification C
+// interface of libbitcoinkernel, as an indexer would after looking up the
+// outputs it spends in its own database.
+//
+// Usage: script_verify_example [<tx hex> <spent scriptPubKey hex>...]
+//
+// The transaction is followed by the scriptPubKeys of the outputs it spends,
+// one for each of its inputs, in order. Without arguments, a built-in
+// transaction with one valid and one invalid input is verified. Exits with 0
+// if all inputs are valid.
+
+#include <kernel/bitcoinkernel.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Decode a hex string into a newly allocated buffer. Returns NULL on failure. */
+static unsigned char* ParseHex(const char* hex, size_t* len)
+{
+    const size_t hex_len = strlen(hex);
+    if (hex_len % 2 != 0) return NULL;
+    unsigned char* out = malloc(hex_len / 2 + 1);
+    if (out == NULL) return NULL;
+    for (size_t i = 0; i < hex_len / 2; ++i) {
+        unsigned int byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1) {
+            free(out);
+            return NULL;
+        }
+        out[i] = (unsigned char)byte;
+    }
+    *len = hex_len / 2;
+    return out;
+}
+
+static void PrintResult(void* user_data, uint64_t job_id, uint32_t tx_index, uint32_t input_index, kernel_ScriptVerifyStatus status)
+{
+    (void)user_data;
+    (void)job_id;
+    (void)tx_index;
+    printf("input %u: %s\n", input_index, status == kernel_SCRIPT_VERIFY_OK ? "valid" : "invalid");
+}
+
+int main(int argc, char* argv[])
+{
+    // Spends two outputs, which pay to OP_TRUE and to OP_FALSE.
+    static const char* const default_args[] = {
+        "0200000002010101010101010101010101010101010101010101010101010101010101010100000000"
+        "00ffffffff010101010101010101010101010101010101010101010101010101010101010101000000"
+        "00ffffffff01e803000000000000015100000000",
+        "51",
+        "00",
+    };
+    const char* const* args = (const char* const*)argv + 1;
+    size_t num_args = argc - 1;
+    if (num_args == 0) {
+        args = default_args;
+        num_args = sizeof(default_args) / sizeof(default_args[0]);
+    }
+
+    size_t tx_len;
+    unsigned char* tx = ParseHex(args[0], &tx_len);
+    const size_t num_inputs = num_args - 1;
+    kernel_TransactionOutput* spent = calloc(num_inputs + 1, sizeof(kernel_TransactionOutput));
+    int ret = tx != NULL && spent != NULL ? EXIT_SUCCESS : EXIT_FAILURE;
+    for (size_t i = 0; i < num_inputs && ret == EXIT_SUCCESS; ++i) {
+        spent[i].script_pubkey = ParseHex(args[1 + i], &spent[i].script_pubkey_len);
+        // Only signatures commit to the amount, so the scripts here don't need it.
+        spent[i].amount = 0;
+        if (spent[i].script_pubkey == NULL) ret = EXIT_FAILURE;
+    }
+    if (ret != EXIT_SUCCESS) fprintf(stderr, "Invalid hex argument\n");
+
+    kernel_ScriptVerifyBatch* batch = NULL;
+    if (ret == EXIT_SUCCESS) {
+        batch = kernel_script_verify_batch_create(/*worker_threads=*/2);
+        if (batch == NULL) {
+            fprintf(stderr, "Could not create the batch\n");
+            ret = EXIT_FAILURE;
+        }
+    }
+    if (ret == EXIT_SUCCESS) {
+        // Verification starts right away. More transactions could be added
+        // here, each with its own job id.
+        const kernel_ScriptVerifyStatus status = kernel_script_verify_batch_add_transaction(
+            batch, /*job_id=*/0, tx, tx_len, spent, num_inputs, kernel_SCRIPT_FLAGS_VERIFY_ALL);
+        if (status != kernel_SCRIPT_VERIFY_OK) {
+            fprintf(stderr, "Could not add the transaction: error %d\n", (int)status);
+            ret = EXIT_FAILURE;
+        }
+    }
+    // The batch copies what it is given, so the buffers can be freed now.
+    for (size_t i = 0; spent != NULL && i < num_inputs; ++i) free((void*)spent[i].script_pubkey);
+    free(spent);
+    free(tx);
+
+    if (ret == EXIT_SUCCESS) {
+        const size_t failures = kernel_script_verify_batch_complete(batch, PrintResult, NULL);
+        if (failures == SIZE_MAX) {
+            fprintf(stderr, "Verification failed with an internal error\n");
+            ret = EXIT_FAILURE;
+        } else if (failures > 0) {
+            printf("%zu input(s) failed verification\n", failures);
+            ret = EXIT_FAILURE;
+        }
+    }
+    kernel_script_verify_batch_destroy(batch);
+    return ret;
+}
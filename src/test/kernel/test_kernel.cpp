@@ -0,0 +1,170 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <kernel/bitcoinkernel.h>
+
+#define BOOST_TEST_MODULE Bitcoin Kernel Test Suite
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+// The tests only use the C interface, and build the serialized transactions
+// and blocks they pass to it by hand.
+
+namespace {
+const std::vector<unsigned char> OP_TRUE_SCRIPT{0x51};
+const std::vector<unsigned char> OP_FALSE_SCRIPT{0x00};
+
+void WriteLE(std::vector<unsigned char>& out, uint64_t value, size_t size)
+{
+    for (size_t i{0}; i < size; ++i) out.push_back((value >> (8 * i)) & 0xff);
+}
+
+//! Serialize a transaction spending num_inputs outputs with empty scriptSigs.
+std::vector<unsigned char> MakeTx(size_t num_inputs, unsigned char prevout_tag)
+{
+    std::vector<unsigned char> tx;
+    WriteLE(tx, 2, 4);
+    tx.push_back(num_inputs);
+    for (size_t i{0}; i < num_inputs; ++i) {
+        tx.insert(tx.end(), 32, prevout_tag);
+        WriteLE(tx, i, 4);
+        tx.push_back(0);
+        WriteLE(tx, 0xffffffff, 4);
+    }
+    tx.push_back(1);
+    WriteLE(tx, 1000, 8);
+    tx.push_back(OP_TRUE_SCRIPT.size());
+    tx.insert(tx.end(), OP_TRUE_SCRIPT.begin(), OP_TRUE_SCRIPT.end());
+    WriteLE(tx, 0, 4);
+    return tx;
+}
+
+//! Serialize a block with a coinbase followed by the given transactions.
+std::vector<unsigned char> MakeBlock(const std::vector<std::vector<unsigned char>>& txs)
+{
+    std::vector<unsigned char> block(80, 0);
+    block.push_back(1 + txs.size());
+    WriteLE(block, 2, 4);
+    block.push_back(1);
+    block.insert(block.end(), 32, 0);
+    WriteLE(block, 0xffffffff, 4);
+    block.push_back(2);
+    block.push_back(0x51);
+    block.push_back(0x51);
+    WriteLE(block, 0xffffffff, 4);
+    block.push_back(1);
+    WriteLE(block, 5000, 8);
+    block.push_back(OP_TRUE_SCRIPT.size());
+    block.insert(block.end(), OP_TRUE_SCRIPT.begin(), OP_TRUE_SCRIPT.end());
+    WriteLE(block, 0, 4);
+    for (const auto& tx : txs) block.insert(block.end(), tx.begin(), tx.end());
+    return block;
+}
+
+kernel_TransactionOutput Output(const std::vector<unsigned char>& script)
+{
+    return {script.data(), script.size(), 1000};
+}
+
+//! Job, transaction and input index and status of each reported input.
+using Result = std::tuple<uint64_t, uint32_t, uint32_t, kernel_ScriptVerifyStatus>;
+
+void Collect(void* user_data, uint64_t job_id, uint32_t tx_index, uint32_t input_index, kernel_ScriptVerifyStatus status)
+{
+    static_cast<std::vector<Result>*>(user_data)->emplace_back(job_id, tx_index, input_index, status);
+}
+
+struct Batch {
+    kernel_ScriptVerifyBatch* const batch;
+    explicit Batch(int worker_threads) : batch{kernel_script_verify_batch_create(worker_threads)} { BOOST_REQUIRE(batch); }
+    ~Batch() { kernel_script_verify_batch_destroy(batch); }
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(script_verify_batch_create)
+{
+    BOOST_CHECK(kernel_script_verify_batch_create(-1) == nullptr);
+    // Without worker threads, the caller of complete verifies every input.
+    Batch batch{0};
+    const auto tx{MakeTx(1, 1)};
+    const auto spent{Output(OP_TRUE_SCRIPT)};
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_add_transaction(batch.batch, 1, tx.data(), tx.size(), &spent, 1, kernel_SCRIPT_FLAGS_VERIFY_ALL), kernel_SCRIPT_VERIFY_OK);
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_complete(batch.batch, nullptr, nullptr), 0U);
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_pending(batch.batch), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(script_verify_batch_results)
+{
+    Batch batch{2};
+    const auto tx{MakeTx(3, 1)};
+    const std::vector<kernel_TransactionOutput> spent{Output(OP_TRUE_SCRIPT), Output(OP_FALSE_SCRIPT), Output(OP_TRUE_SCRIPT)};
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_add_transaction(batch.batch, 7, tx.data(), tx.size(), spent.data(), spent.size(), kernel_SCRIPT_FLAGS_VERIFY_ALL), kernel_SCRIPT_VERIFY_OK);
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_add_input(batch.batch, 8, tx.data(), tx.size(), spent.data(), spent.size(), 1, kernel_SCRIPT_FLAGS_VERIFY_NONE), kernel_SCRIPT_VERIFY_OK);
+
+    // Results are reported in the order the inputs were added, and a failed
+    // input doesn't stop the others from being verified.
+    std::vector<Result> results;
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_complete(batch.batch, Collect, &results), 2U);
+    const std::vector<Result> expected{
+        {7, 0, 0, kernel_SCRIPT_VERIFY_OK},
+        {7, 0, 1, kernel_SCRIPT_VERIFY_ERROR_INVALID},
+        {7, 0, 2, kernel_SCRIPT_VERIFY_OK},
+        {8, 0, 1, kernel_SCRIPT_VERIFY_ERROR_INVALID},
+    };
+    BOOST_CHECK(results == expected);
+
+    // The batch can be reused.
+    results.clear();
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_add_input(batch.batch, 9, tx.data(), tx.size(), spent.data(), spent.size(), 2, kernel_SCRIPT_FLAGS_VERIFY_ALL), kernel_SCRIPT_VERIFY_OK);
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_complete(batch.batch, Collect, &results), 0U);
+    BOOST_CHECK((results == std::vector<Result>{{9, 0, 2, kernel_SCRIPT_VERIFY_OK}}));
+}
+
+BOOST_AUTO_TEST_CASE(script_verify_batch_block)
+{
+    Batch batch{2};
+    const auto block{MakeBlock({MakeTx(1, 1), MakeTx(2, 2)})};
+    const std::vector<kernel_TransactionOutput> spent{Output(OP_TRUE_SCRIPT), Output(OP_TRUE_SCRIPT), Output(OP_FALSE_SCRIPT)};
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_add_block(batch.batch, 3, block.data(), block.size(), spent.data(), spent.size() - 1, kernel_SCRIPT_FLAGS_VERIFY_ALL), kernel_SCRIPT_VERIFY_ERROR_SPENT_OUTPUTS_MISMATCH);
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_add_block(batch.batch, 3, block.data(), block.size() - 1, spent.data(), spent.size(), kernel_SCRIPT_FLAGS_VERIFY_ALL), kernel_SCRIPT_VERIFY_ERROR_TX_DESERIALIZE);
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_add_block(batch.batch, 3, block.data(), block.size(), spent.data(), spent.size(), kernel_SCRIPT_FLAGS_VERIFY_ALL), kernel_SCRIPT_VERIFY_OK);
+
+    std::vector<Result> results;
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_complete(batch.batch, Collect, &results), 1U);
+    const std::vector<Result> expected{
+        {3, 1, 0, kernel_SCRIPT_VERIFY_OK},
+        {3, 2, 0, kernel_SCRIPT_VERIFY_OK},
+        {3, 2, 1, kernel_SCRIPT_VERIFY_ERROR_INVALID},
+    };
+    BOOST_CHECK(results == expected);
+}
+
+BOOST_AUTO_TEST_CASE(script_verify_batch_errors)
+{
+    Batch batch{1};
+    const auto tx{MakeTx(2, 1)};
+    const std::vector<kernel_TransactionOutput> spent{Output(OP_TRUE_SCRIPT), Output(OP_TRUE_SCRIPT)};
+    const auto add{[&](const std::vector<unsigned char>& data, size_t spent_len, unsigned int flags) {
+        return kernel_script_verify_batch_add_transaction(batch.batch, 0, data.data(), data.size(), spent.data(), spent_len, flags);
+    }};
+
+    BOOST_CHECK_EQUAL(add({0x02, 0x00}, 2, kernel_SCRIPT_FLAGS_VERIFY_ALL), kernel_SCRIPT_VERIFY_ERROR_TX_DESERIALIZE);
+    auto trailing{tx};
+    trailing.push_back(0);
+    BOOST_CHECK_EQUAL(add(trailing, 2, kernel_SCRIPT_FLAGS_VERIFY_ALL), kernel_SCRIPT_VERIFY_ERROR_TX_DESERIALIZE);
+    BOOST_CHECK_EQUAL(add(tx, 1, kernel_SCRIPT_FLAGS_VERIFY_ALL), kernel_SCRIPT_VERIFY_ERROR_SPENT_OUTPUTS_MISMATCH);
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_add_transaction(batch.batch, 0, tx.data(), tx.size(), nullptr, 2, kernel_SCRIPT_FLAGS_VERIFY_ALL), kernel_SCRIPT_VERIFY_ERROR_SPENT_OUTPUTS_MISMATCH);
+    BOOST_CHECK_EQUAL(add(tx, 2, kernel_SCRIPT_FLAGS_VERIFY_ALL | (1U << 30)), kernel_SCRIPT_VERIFY_ERROR_INVALID_FLAGS);
+    BOOST_CHECK_EQUAL(add(tx, 2, kernel_SCRIPT_FLAGS_VERIFY_WITNESS), kernel_SCRIPT_VERIFY_ERROR_INVALID_FLAGS_COMBINATION);
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_add_input(batch.batch, 0, tx.data(), tx.size(), spent.data(), spent.size(), 2, kernel_SCRIPT_FLAGS_VERIFY_ALL), kernel_SCRIPT_VERIFY_ERROR_TX_INPUT_INDEX);
+
+    // Rejected work isn't queued.
+    std::vector<Result> results;
+    BOOST_CHECK_EQUAL(kernel_script_verify_batch_complete(batch.batch, Collect, &results), 0U);
+    BOOST_CHECK(results.empty());
+}
@@ -251,6 +251,22 @@ BOOST_AUTO_TEST_CASE(pubkey_unserialize)
     }
 }
 
+BOOST_AUTO_TEST_CASE(pubkey_get_key_ids)
+{
+    std::vector<CPubKey> pubkeys;
+    for (int i = 0; i < 11; ++i) {
+        pubkeys.push_back(GenerateRandomQKey().GetPubKey());
+    }
+    // Invalid keys hash their invalid marker, just like GetID does.
+    pubkeys.push_back(UnserializePubkey({0x02}));
+    const std::vector<CKeyID> ids{GetKeyIDs(pubkeys)};
+    BOOST_REQUIRE_EQUAL(ids.size(), pubkeys.size());
+    for (size_t i = 0; i < pubkeys.size(); ++i) {
+        BOOST_CHECK(ids[i] == pubkeys[i].GetID());
+    }
+    BOOST_CHECK(GetKeyIDs({}).empty());
+}
+
 BOOST_AUTO_TEST_CASE(bip340_test_vectors)
 {
     static const std::vector<std::pair<std::array<std::string, 3>, bool>> VECTORS = {
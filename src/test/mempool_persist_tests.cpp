@@ -0,0 +1,185 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <consensus/validation.h>
+#include <node/mempool_persist.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+#include <txmempool.h>
+#include <util/fs.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <vector>
+
+using node::CheckpointMempool;
+using node::DumpMempool;
+using node::LoadMempool;
+
+struct MempoolPersistSetup : public TestChain100Setup {
+    const fs::path m_mempool_path{m_args.GetDataDirNet() / "mempool.dat"};
+    const CScript m_spk{GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()))};
+
+    //! Spend an output of parent to num_outputs outputs and submit it.
+    CTransactionRef Spend(const CTransactionRef& parent, uint32_t vout, size_t num_outputs = 1)
+    {
+        const CAmount amount{(parent->vout[vout].nValue - CENT) / CAmount(num_outputs)};
+        const std::vector<CTxOut> outputs(num_outputs, CTxOut{amount, m_spk});
+        return MakeTransactionRef(CreateValidMempoolTransaction({parent}, {COutPoint{parent->GetHash(), vout}},
+                                                                /*input_height=*/1, {coinbaseKey}, outputs));
+    }
+
+    void Submit(const CTransactionRef& tx)
+    {
+        LOCK(cs_main);
+        BOOST_REQUIRE_EQUAL(m_node.chainman->ProcessTransaction(tx).m_result_type, MempoolAcceptResult::ResultType::VALID);
+    }
+
+    void Remove(const CTransactionRef& tx)
+    {
+        LOCK2(cs_main, m_node.mempool->cs);
+        m_node.mempool->removeRecursive(*tx, MemPoolRemovalReason::EXPIRY);
+    }
+
+    bool InMempool(const CTransactionRef& tx) const
+    {
+        return m_node.mempool->exists(GenTxid::Wtxid(tx->GetWitnessHash()));
+    }
+
+    //! Empty the mempool and load the mempool file into it.
+    void Reload()
+    {
+        for (const auto& info : WITH_LOCK(m_node.mempool->cs, return m_node.mempool->infoAll())) {
+            Remove(info.tx);
+        }
+        BOOST_REQUIRE_EQUAL(m_node.mempool->size(), 0U);
+        BOOST_REQUIRE(LoadMempool(*m_node.mempool, m_mempool_path, m_node.chainman->ActiveChainstate(), {}));
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(mempool_persist_tests, MempoolPersistSetup)
+
+BOOST_AUTO_TEST_CASE(torn_tail)
+{
+    const CTransactionRef parent{Spend(m_coinbase_txns[0], 0)};
+    BOOST_REQUIRE(DumpMempool(*m_node.mempool, m_mempool_path));
+    const auto dumped_size{fs::file_size(m_mempool_path)};
+
+    // A crash while appending the child leaves part of its chunk behind.
+    const CTransactionRef child{Spend(parent, 0)};
+    BOOST_REQUIRE(CheckpointMempool(*m_node.mempool, m_mempool_path));
+    BOOST_REQUIRE_GT(fs::file_size(m_mempool_path), dumped_size + 100);
+    fs::resize_file(m_mempool_path, dumped_size + 100);
+    Reload();
+    BOOST_CHECK(InMempool(parent));
+    BOOST_CHECK(!InMempool(child));
+
+    // The file no longer ends where it was last written, so it is rewritten.
+    Submit(child);
+    BOOST_REQUIRE(CheckpointMempool(*m_node.mempool, m_mempool_path));
+    Reload();
+    BOOST_CHECK(InMempool(parent));
+    BOOST_CHECK(InMempool(child));
+
+    // Same for a chunk whose checksum doesn't match.
+    const CTransactionRef grandchild{Spend(child, 0)};
+    const auto checkpointed_size{fs::file_size(m_mempool_path)};
+    BOOST_REQUIRE(CheckpointMempool(*m_node.mempool, m_mempool_path));
+    {
+        FILE* file{fsbridge::fopen(m_mempool_path, "rb+")};
+        BOOST_REQUIRE(file);
+        BOOST_REQUIRE_EQUAL(std::fseek(file, checkpointed_size + 100, SEEK_SET), 0);
+        const int byte{std::fgetc(file)};
+        BOOST_REQUIRE_EQUAL(std::fseek(file, checkpointed_size + 100, SEEK_SET), 0);
+        std::fputc(byte ^ 0xff, file);
+        std::fclose(file);
+    }
+    Reload();
+    BOOST_CHECK(InMempool(parent));
+    BOOST_CHECK(InMempool(child));
+    BOOST_CHECK(!InMempool(grandchild));
+}
+
+BOOST_AUTO_TEST_CASE(remove_replay)
+{
+    const CTransactionRef parent{Spend(m_coinbase_txns[0], 0, /*num_outputs=*/2)};
+    const CTransactionRef child1{Spend(parent, 0)};
+    const CTransactionRef child2{Spend(parent, 1)};
+    BOOST_REQUIRE(DumpMempool(*m_node.mempool, m_mempool_path));
+    const auto dumped_size{fs::file_size(m_mempool_path)};
+
+    Remove(child1);
+    BOOST_REQUIRE(CheckpointMempool(*m_node.mempool, m_mempool_path));
+    // Removed and added again, so loaded from its second record.
+    Remove(child2);
+    BOOST_REQUIRE(CheckpointMempool(*m_node.mempool, m_mempool_path));
+    Submit(child2);
+    BOOST_REQUIRE(CheckpointMempool(*m_node.mempool, m_mempool_path));
+    // Appended to rather than rewritten.
+    BOOST_CHECK_GT(fs::file_size(m_mempool_path), dumped_size);
+
+    Reload();
+    BOOST_CHECK_EQUAL(m_node.mempool->size(), 2U);
+    BOOST_CHECK(InMempool(parent));
+    BOOST_CHECK(!InMempool(child1));
+    BOOST_CHECK(InMempool(child2));
+}
+
+BOOST_AUTO_TEST_CASE(compaction)
+{
+    const CTransactionRef tx{Spend(m_coinbase_txns[0], 0)};
+    BOOST_REQUIRE(DumpMempool(*m_node.mempool, m_mempool_path));
+    const auto dumped_size{fs::file_size(m_mempool_path)};
+
+    // Remove and add the transaction until most of a large file is taken by
+    // its removed records.
+    while (fs::file_size(m_mempool_path) <= (1 << 20)) {
+        Remove(tx);
+        BOOST_REQUIRE(CheckpointMempool(*m_node.mempool, m_mempool_path, fsbridge::fopen, /*skip_file_commit=*/true));
+        Submit(tx);
+        BOOST_REQUIRE(CheckpointMempool(*m_node.mempool, m_mempool_path, fsbridge::fopen, /*skip_file_commit=*/true));
+    }
+
+    // The rewrite started in the background is waited for by the next
+    // checkpoint that doesn't run in the background.
+    BOOST_REQUIRE(CheckpointMempool(*m_node.mempool, m_mempool_path, fsbridge::fopen, /*skip_file_commit=*/true, /*background=*/true));
+    BOOST_REQUIRE(CheckpointMempool(*m_node.mempool, m_mempool_path));
+    BOOST_CHECK_LT(fs::file_size(m_mempool_path), 2 * dumped_size);
+
+    Reload();
+    BOOST_CHECK_EQUAL(m_node.mempool->size(), 1U);
+    BOOST_CHECK(InMempool(tx));
+}
+
+BOOST_AUTO_TEST_CASE(reorg_ordering)
+{
+    const CTransactionRef parent{Spend(m_coinbase_txns[0], 0)};
+    const CTransactionRef child{Spend(parent, 0)};
+    BOOST_REQUIRE(DumpMempool(*m_node.mempool, m_mempool_path));
+
+    // Mining the parent leaves its child in the mempool.
+    CreateAndProcessBlock({CMutableTransaction{*parent}}, m_spk);
+    BOOST_REQUIRE(!InMempool(parent));
+    BOOST_REQUIRE(InMempool(child));
+    BOOST_REQUIRE(CheckpointMempool(*m_node.mempool, m_mempool_path));
+
+    // Disconnecting the block adds the parent back, after its child in the
+    // file.
+    {
+        BlockValidationState state;
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip())));
+    }
+    BOOST_REQUIRE(InMempool(parent));
+    BOOST_REQUIRE(CheckpointMempool(*m_node.mempool, m_mempool_path));
+
+    Reload();
+    BOOST_CHECK(InMempool(parent));
+    BOOST_CHECK(InMempool(child));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -7,10 +7,13 @@
 #include <test/util/txmempool.h>
 #include <txmempool.h>
 #include <util/time.h>
+#include <validationinterface.h>
 
 #include <test/util/setup_common.h>
 
 #include <boost/test/unit_test.hpp>
+
+#include <algorithm>
 #include <vector>
 
 BOOST_FIXTURE_TEST_SUITE(mempool_tests, TestingSetup)
@@ -804,4 +807,170 @@ BOOST_AUTO_TEST_CASE(MempoolAncestryTestsDiamond)
     BOOST_CHECK_EQUAL(descendants, 4ULL);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolRemoveForBlockTest)
+{
+    TestMemPoolEntryHelper entry;
+    const auto make_tx{[](const COutPoint& prevout, uint32_t n) {
+        CMutableTransaction tx;
+        tx.vin.emplace_back(prevout);
+        tx.vout.emplace_back(10 * COIN, CScript() << OP_11 << OP_EQUAL);
+        tx.nLockTime = n;
+        return tx;
+    }};
+    // parent -> child -> grandchild, where only parent is confirmed
+    const auto parent{make_tx(COutPoint{Txid::FromUint256(uint256{1}), 0}, 0)};
+    const auto child{make_tx(COutPoint{parent.GetHash(), 0}, 0)};
+    const auto grandchild{make_tx(COutPoint{child.GetHash(), 0}, 0)};
+    // other -> conflicted -> conflicted_child, where conflicted is double
+    // spent by a block transaction that isn't in the mempool
+    const auto other{make_tx(COutPoint{Txid::FromUint256(uint256{2}), 0}, 0)};
+    CMutableTransaction conflicted{make_tx(COutPoint{other.GetHash(), 0}, 0)};
+    conflicted.vin.emplace_back(Txid::FromUint256(uint256{3}), 0);
+    const auto conflicted_child{make_tx(COutPoint{conflicted.GetHash(), 0}, 0)};
+    const auto double_spend{make_tx(COutPoint{Txid::FromUint256(uint256{3}), 0}, 1)};
+
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    LOCK2(::cs_main, pool.cs);
+    for (const auto& tx : {parent, child, grandchild, other, conflicted, conflicted_child}) {
+        AddToMempool(pool, entry.Fee(1000).FromTx(tx));
+    }
+    pool.PrioritiseTransaction(conflicted.GetHash(), 100);
+    BOOST_CHECK_EQUAL(pool.GetEntry(grandchild.GetHash())->GetCountWithAncestors(), 3U);
+    BOOST_CHECK_EQUAL(pool.GetEntry(other.GetHash())->GetCountWithDescendants(), 3U);
+
+    pool.removeForBlock({MakeTransactionRef(parent), MakeTransactionRef(double_spend)}, 1);
+    BOOST_CHECK_EQUAL(pool.size(), 3U);
+    BOOST_CHECK(!pool.exists(GenTxid::Txid(parent.GetHash())));
+    BOOST_CHECK(!pool.exists(GenTxid::Txid(conflicted.GetHash())));
+    BOOST_CHECK(!pool.exists(GenTxid::Txid(conflicted_child.GetHash())));
+    BOOST_CHECK(pool.GetPrioritisedTransactions().empty());
+
+    const auto child_entry{pool.GetEntry(child.GetHash())};
+    const auto grandchild_entry{pool.GetEntry(grandchild.GetHash())};
+    const auto other_entry{pool.GetEntry(other.GetHash())};
+    BOOST_CHECK(child_entry->GetMemPoolParentsConst().empty());
+    BOOST_CHECK_EQUAL(child_entry->GetCountWithAncestors(), 1U);
+    BOOST_CHECK_EQUAL(child_entry->GetSizeWithAncestors(), child_entry->GetTxSize());
+    BOOST_CHECK_EQUAL(child_entry->GetModFeesWithAncestors(), 1000);
+    BOOST_CHECK_EQUAL(child_entry->GetCountWithDescendants(), 2U);
+    BOOST_CHECK_EQUAL(grandchild_entry->GetCountWithAncestors(), 2U);
+    BOOST_CHECK_EQUAL(grandchild_entry->GetSigOpCostWithAncestors(), 2 * grandchild_entry->GetSigOpCost());
+    BOOST_CHECK(other_entry->GetMemPoolChildrenConst().empty());
+    BOOST_CHECK_EQUAL(other_entry->GetCountWithDescendants(), 1U);
+    BOOST_CHECK_EQUAL(other_entry->GetSizeWithDescendants(), other_entry->GetTxSize());
+    BOOST_CHECK_EQUAL(other_entry->GetModFeesWithDescendants(), 1000);
+}
+
+BOOST_AUTO_TEST_CASE(MempoolTrimToSizeBatchTest)
+{
+    TestMemPoolEntryHelper entry;
+    const auto make_tx{[](const COutPoint& prevout, uint32_t n) {
+        CMutableTransaction tx;
+        tx.vin.emplace_back(prevout);
+        tx.vout.emplace_back(10 * COIN, CScript() << OP_11 << OP_EQUAL);
+        tx.nLockTime = n;
+        return tx;
+    }};
+    // parent has a free and a cheap child, low and high are unrelated
+    CMutableTransaction parent{make_tx(COutPoint{Txid::FromUint256(uint256{1}), 0}, 0)};
+    parent.vout.emplace_back(10 * COIN, CScript() << OP_11 << OP_EQUAL);
+    const auto free_child{make_tx(COutPoint{parent.GetHash(), 0}, 0)};
+    const auto cheap_child{make_tx(COutPoint{parent.GetHash(), 1}, 0)};
+    const auto low{make_tx(COutPoint{Txid::FromUint256(uint256{2}), 0}, 0)};
+    const auto high{make_tx(COutPoint{Txid::FromUint256(uint256{3}), 0}, 0)};
+
+    MemPoolTest& pool = static_cast<MemPoolTest&>(*Assert(m_node.mempool));
+    LOCK2(::cs_main, pool.cs);
+    AddToMempool(pool, entry.Fee(10000).FromTx(parent));
+    AddToMempool(pool, entry.Fee(0).FromTx(free_child));
+    AddToMempool(pool, entry.Fee(100).FromTx(cheap_child));
+    AddToMempool(pool, entry.Fee(50).FromTx(low));
+    AddToMempool(pool, entry.Fee(20000).FromTx(high));
+
+    // Only the lowest package goes when a single one is enough.
+    size_t usage{pool.DynamicMemoryUsage()};
+    std::vector<COutPoint> no_spends;
+    pool.TrimToSize(usage - 1, &no_spends);
+    BOOST_CHECK_EQUAL(pool.size(), 4U);
+    BOOST_CHECK(!pool.exists(GenTxid::Txid(free_child.GetHash())));
+    BOOST_CHECK(no_spends.empty());
+    BOOST_CHECK_EQUAL(pool.GetEntry(parent.GetHash())->GetCountWithDescendants(), 2U);
+    BOOST_CHECK_EQUAL(pool.GetEvictionStats().txs, 1U);
+    BOOST_CHECK_EQUAL(pool.GetEvictionStats().bytes, uint64_t(GetVirtualTransactionSize(CTransaction{free_child})));
+    BOOST_CHECK_EQUAL(pool.GetEvictionStats().usage, usage - pool.DynamicMemoryUsage());
+
+    // low and cheap_child are evicted together, which raises the descendant
+    // score of parent above that of high.
+    usage = pool.DynamicMemoryUsage();
+    pool.TrimToSize(usage * 2 / 3, &no_spends);
+    BOOST_CHECK_EQUAL(pool.size(), 2U);
+    BOOST_CHECK(pool.exists(GenTxid::Txid(parent.GetHash())));
+    BOOST_CHECK(pool.exists(GenTxid::Txid(high.GetHash())));
+    BOOST_CHECK_EQUAL(no_spends.size(), 1U);
+    BOOST_CHECK(no_spends[0] == low.vin[0].prevout);
+    const auto parent_entry{pool.GetEntry(parent.GetHash())};
+    BOOST_CHECK(parent_entry->GetMemPoolChildrenConst().empty());
+    BOOST_CHECK_EQUAL(parent_entry->GetCountWithDescendants(), 1U);
+    BOOST_CHECK_EQUAL(parent_entry->GetSizeWithDescendants(), parent_entry->GetTxSize());
+    BOOST_CHECK_EQUAL(parent_entry->GetModFeesWithDescendants(), 10000);
+    BOOST_CHECK_EQUAL(pool.GetEvictionStats().txs, 3U);
+    BOOST_CHECK_EQUAL(pool.GetMinFee(1).GetFeePerK(), CFeeRate(100, GetVirtualTransactionSize(CTransaction{cheap_child})).GetFeePerK() + 1000);
+}
+
+BOOST_AUTO_TEST_CASE(MempoolRemoveForBlockOrderTest)
+{
+    // Each transaction conflicting with the block is removed along with its
+    // descendants in txid order, like removeRecursive does, and the groups
+    // follow the order of the block transactions.
+    struct RemovalSubscriber final : CValidationInterface {
+        std::vector<Txid> m_removed;
+        void TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t) override
+        {
+            BOOST_CHECK(reason == MemPoolRemovalReason::CONFLICT);
+            m_removed.push_back(tx->GetHash());
+        }
+    };
+    TestMemPoolEntryHelper entry;
+    const auto make_tx{[](const COutPoint& prevout, uint32_t n, size_t num_outputs) {
+        CMutableTransaction tx;
+        tx.vin.emplace_back(prevout);
+        tx.vout.assign(num_outputs, CTxOut{COIN, CScript() << OP_11 << OP_EQUAL});
+        tx.nLockTime = n;
+        return tx;
+    }};
+    std::vector<CMutableTransaction> mempool_txs;
+    std::vector<CTransactionRef> block;
+    std::vector<Txid> expected;
+    for (uint32_t group{0}; group < 2; ++group) {
+        const COutPoint prevout{Txid::FromUint256(uint256{1}), group};
+        const auto conflicted{make_tx(prevout, 0, 4)};
+        std::vector<Txid> removed{conflicted.GetHash()};
+        mempool_txs.push_back(conflicted);
+        for (uint32_t i{0}; i < 4; ++i) {
+            mempool_txs.push_back(make_tx(COutPoint{conflicted.GetHash(), i}, 0, 1));
+            removed.push_back(mempool_txs.back().GetHash());
+            mempool_txs.push_back(make_tx(COutPoint{mempool_txs.back().GetHash(), 0}, 0, 1));
+            removed.push_back(mempool_txs.back().GetHash());
+        }
+        std::sort(removed.begin(), removed.end());
+        expected.insert(expected.end(), removed.begin(), removed.end());
+        block.push_back(MakeTransactionRef(make_tx(prevout, 1, 1)));
+    }
+
+    const auto sub{std::make_shared<RemovalSubscriber>()};
+    m_node.validation_signals->RegisterSharedValidationInterface(sub);
+    {
+        CTxMemPool& pool = *Assert(m_node.mempool);
+        LOCK2(::cs_main, pool.cs);
+        for (const auto& tx : mempool_txs) {
+            AddToMempool(pool, entry.Fee(1000).FromTx(tx));
+        }
+        pool.removeForBlock(block, 1);
+        BOOST_CHECK_EQUAL(pool.size(), 0U);
+    }
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    m_node.validation_signals->UnregisterSharedValidationInterface(sub);
+    BOOST_CHECK(sub->m_removed == expected);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,164 @@
+// Copyright (c) 2025-present The QBTC developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <memusage.h>
+#include <nodehashmap.h>
+#include <support/allocators/pool.h>
+#include <test/util/poolresourcetester.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+//! A deliberately weak hash, so that many keys share tags and groups.
+struct WeakHasher {
+    size_t operator()(uint64_t key) const noexcept { return key % 1021; }
+};
+
+using TestMap = NodeHashMap<uint64_t, uint64_t, WeakHasher, std::equal_to<uint64_t>, sizeof(std::pair<const uint64_t, uint64_t>)>;
+using TestMapResource = TestMap::allocator_type::ResourceType;
+
+void CheckEqual(const TestMap& map, const std::unordered_map<uint64_t, uint64_t>& expected)
+{
+    BOOST_REQUIRE_EQUAL(map.size(), expected.size());
+    size_t count{0};
+    for (const auto& [key, value] : map) {
+        const auto it{expected.find(key)};
+        BOOST_REQUIRE(it != expected.end());
+        BOOST_CHECK_EQUAL(it->second, value);
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, expected.size());
+    for (const auto& [key, value] : expected) {
+        const auto it{map.find(key)};
+        BOOST_REQUIRE(it != map.end());
+        BOOST_CHECK_EQUAL(it->second, value);
+    }
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(nodehashmap_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    TestMapResource resource;
+    TestMap map{0, WeakHasher{}, std::equal_to<uint64_t>{}, &resource};
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK_EQUAL(map.bucket_count(), 0U);
+    BOOST_CHECK(map.find(1) == map.end());
+    BOOST_CHECK(map.begin() == map.end());
+    BOOST_CHECK_EQUAL(map.erase(1), 0U);
+
+    auto [it, inserted] = map.try_emplace(1, 10);
+    BOOST_CHECK(inserted);
+    BOOST_CHECK_EQUAL(it->second, 10U);
+    std::tie(it, inserted) = map.try_emplace(1, 20);
+    BOOST_CHECK(!inserted);
+    BOOST_CHECK_EQUAL(it->second, 10U);
+    std::tie(it, inserted) = map.emplace(1, 30);
+    BOOST_CHECK(!inserted);
+    BOOST_CHECK_EQUAL(it->second, 10U);
+    map[2] = 40;
+    BOOST_CHECK_EQUAL(map.size(), 2U);
+    BOOST_CHECK_EQUAL(map.count(2), 1U);
+
+    // Nodes don't move when the index grows.
+    const auto* node{&*map.find(1)};
+    for (uint64_t i = 3; i < 1000; ++i) map[i] = i;
+    BOOST_CHECK_EQUAL(&*map.find(1), node);
+
+    BOOST_CHECK_EQUAL(map.erase(1), 1U);
+    BOOST_CHECK(map.find(1) == map.end());
+    map.clear();
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK(map.begin() == map.end());
+    PoolResourceTester::CheckAllDataAccountedFor(resource);
+}
+
+BOOST_AUTO_TEST_CASE(random_operations)
+{
+    TestMapResource resource;
+    {
+        TestMap map{0, WeakHasher{}, std::equal_to<uint64_t>{}, &resource};
+        std::unordered_map<uint64_t, uint64_t> expected;
+
+        for (int i = 0; i < 20000; ++i) {
+            const uint64_t key{m_rng.randrange<uint64_t>(3000)};
+            switch (m_rng.randrange(5)) {
+            case 0:
+            case 1: {
+                const uint64_t value{m_rng.rand64()};
+                const bool inserted{map.try_emplace(key, value).second};
+                BOOST_CHECK_EQUAL(inserted, expected.try_emplace(key, value).second);
+                break;
+            }
+            case 2: {
+                BOOST_CHECK_EQUAL(map.erase(key), expected.erase(key));
+                break;
+            }
+            case 3: {
+                // Erase through an iterator, and check the returned iterator
+                // continues the iteration.
+                if (auto it{map.find(key)}; it != map.end()) {
+                    auto next{std::next(it)};
+                    const bool at_end{next == map.end()};
+                    const uint64_t next_key{at_end ? 0 : next->first};
+                    auto ret{map.erase(it)};
+                    BOOST_CHECK(at_end ? ret == map.end() : ret->first == next_key);
+                    expected.erase(key);
+                }
+                break;
+            }
+            case 4: {
+                const auto it{map.find(key)};
+                BOOST_CHECK_EQUAL(it != map.end(), expected.contains(key));
+                break;
+            }
+            }
+            if (i % 1000 == 0) CheckEqual(map, expected);
+        }
+        CheckEqual(map, expected);
+
+        // Memory usage includes the index and the pool.
+        BOOST_CHECK(memusage::DynamicUsage(map) >= resource.ChunkSizeBytes() + map.bucket_count() * (1 + sizeof(void*)));
+    }
+    PoolResourceTester::CheckAllDataAccountedFor(resource);
+}
+
+BOOST_AUTO_TEST_CASE(churn)
+{
+    TestMapResource resource;
+    {
+        // Inserting and erasing distinct keys while the size stays small
+        // reuses deleted slots instead of growing the index without bound.
+        TestMap map{0, WeakHasher{}, std::equal_to<uint64_t>{}, &resource};
+        for (uint64_t i = 0; i < 100000; ++i) {
+            map[i] = i;
+            if (i >= 100) BOOST_REQUIRE_EQUAL(map.erase(i - 100), 1U);
+        }
+        BOOST_CHECK_EQUAL(map.size(), 100U);
+        BOOST_CHECK(map.bucket_count() <= 256);
+        for (uint64_t i = 100000 - 100; i < 100000; ++i) BOOST_CHECK(map.find(i) != map.end());
+    }
+    PoolResourceTester::CheckAllDataAccountedFor(resource);
+}
+
+BOOST_AUTO_TEST_CASE(reserve)
+{
+    TestMapResource resource;
+    TestMap map{0, WeakHasher{}, std::equal_to<uint64_t>{}, &resource};
+    map.reserve(1000);
+    const size_t bucket_count{map.bucket_count()};
+    BOOST_CHECK(bucket_count >= 1000);
+    for (uint64_t i = 0; i < 1000; ++i) map[i] = i;
+    BOOST_CHECK_EQUAL(map.bucket_count(), bucket_count);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <kernel/script_verify_batch.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <script/interpreter.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+using kernel::ScriptVerifyBatch;
+
+namespace {
+constexpr unsigned int FLAGS{SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_WITNESS};
+
+//! Transaction with one input for each of the given spent outputs.
+CTransactionRef SpendingTx(const std::vector<CTxOut>& spent_outputs, uint8_t seed)
+{
+    CMutableTransaction mtx;
+    for (uint32_t i{0}; i < spent_outputs.size(); ++i) {
+        mtx.vin.emplace_back(COutPoint{Txid::FromUint256(uint256{seed}), i});
+    }
+    mtx.vout.emplace_back(1, CScript() << OP_TRUE);
+    return MakeTransactionRef(mtx);
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(script_verify_batch_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(verify_transactions)
+{
+    const CTxOut valid{1, CScript() << OP_TRUE};
+    const CTxOut invalid{1, CScript() << OP_FALSE};
+    for (const int worker_threads : {0, 3}) {
+        ScriptVerifyBatch batch{worker_threads};
+        const std::vector<CTxOut> spent{valid, invalid, valid};
+        for (uint64_t job_id{0}; job_id < 100; ++job_id) {
+            batch.AddTransaction(job_id, SpendingTx(spent, job_id), spent, FLAGS);
+        }
+        // Only verify the failing input of this one.
+        batch.AddTransaction(100, SpendingTx(spent, 100), spent, FLAGS, /*input_index=*/1);
+
+        const auto results{batch.Complete()};
+        BOOST_CHECK_EQUAL(batch.Pending(), 0U);
+        BOOST_REQUIRE_EQUAL(results.size(), 100U * 3 + 1);
+        for (size_t i{0}; i < results.size(); ++i) {
+            BOOST_CHECK_EQUAL(results[i].job_id, i / 3);
+            BOOST_CHECK_EQUAL(results[i].input_index, i == 300 ? 1 : i % 3);
+            BOOST_CHECK_EQUAL(results[i].valid, results[i].input_index != 1);
+            BOOST_CHECK_EQUAL(results[i].error, results[i].valid ? SCRIPT_ERR_OK : SCRIPT_ERR_EVAL_FALSE);
+        }
+
+        // The batch can be reused.
+        batch.AddTransaction(7, SpendingTx({valid}, 7), {valid}, FLAGS);
+        const auto reused{batch.Complete()};
+        BOOST_REQUIRE_EQUAL(reused.size(), 1U);
+        BOOST_CHECK(reused[0].valid);
+        BOOST_CHECK_EQUAL(reused[0].job_id, 7U);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(verify_block)
+{
+    const CTxOut valid{1, CScript() << OP_TRUE};
+    const CTxOut invalid{1, CScript() << OP_FALSE};
+    CBlock block;
+    CMutableTransaction coinbase;
+    coinbase.vin.emplace_back(COutPoint{});
+    coinbase.vout.emplace_back(1, CScript() << OP_TRUE);
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+    block.vtx.push_back(SpendingTx({valid, valid}, 1));
+    block.vtx.push_back(SpendingTx({invalid}, 2));
+    const std::vector<CTxOut> spent{valid, valid, invalid};
+
+    ScriptVerifyBatch batch{2};
+    BOOST_CHECK_THROW(batch.AddBlock(1, block, std::span{spent}.first(2), FLAGS), std::invalid_argument);
+    batch.AddBlock(1, block, spent, FLAGS);
+    const auto results{batch.Complete()};
+    BOOST_REQUIRE_EQUAL(results.size(), 3U);
+    BOOST_CHECK_EQUAL(results[0].tx_index, 1U);
+    BOOST_CHECK_EQUAL(results[1].tx_index, 1U);
+    BOOST_CHECK_EQUAL(results[1].input_index, 1U);
+    BOOST_CHECK_EQUAL(results[2].tx_index, 2U);
+    BOOST_CHECK(results[0].valid && results[1].valid && !results[2].valid);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_arguments)
+{
+    const CTxOut valid{1, CScript() << OP_TRUE};
+    ScriptVerifyBatch batch{1};
+    const auto tx{SpendingTx({valid, valid}, 1)};
+    BOOST_CHECK_THROW(batch.AddTransaction(0, tx, {valid}, FLAGS), std::invalid_argument);
+    BOOST_CHECK_THROW(batch.AddTransaction(0, tx, {valid, valid}, FLAGS, /*input_index=*/2), std::invalid_argument);
+    BOOST_CHECK_THROW(batch.AddTransaction(0, tx, {valid, valid}, SCRIPT_VERIFY_WITNESS), std::invalid_argument);
+    BOOST_CHECK(batch.Complete().empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -185,6 +185,21 @@ BOOST_AUTO_TEST_CASE(streams_vector_reader_rvalue)
     BOOST_CHECK(reader.empty());
 }
 
+BOOST_AUTO_TEST_CASE(streams_span_writer)
+{
+    std::array<std::byte, 6> buffer{};
+    SpanWriter writer{buffer};
+    writer << uint8_t{1} << uint32_t{0x05040302};
+    BOOST_CHECK_EQUAL(writer.size(), 1U);
+    BOOST_CHECK_EQUAL(HexStr(buffer), "010203040500");
+
+    // Writing past the end of the span throws an error and leaves it intact.
+    BOOST_CHECK_THROW(writer << uint16_t{0xffff}, std::ios_base::failure);
+    writer << uint8_t{6};
+    BOOST_CHECK_EQUAL(writer.size(), 0U);
+    BOOST_CHECK_EQUAL(HexStr(buffer), "010203040506");
+}
+
 BOOST_AUTO_TEST_CASE(bitstream_reader_writer)
 {
     DataStream data{};
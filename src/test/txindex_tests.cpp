@@ -10,6 +10,9 @@
 #include <test/util/setup_common.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_SUITE(txindex_tests)
@@ -50,6 +53,24 @@ BOOST_FIXTURE_TEST_CASE(txindex_initial_sync, TestChain100Setup)
         }
     }
 
+    // Check that batched lookups agree with single lookups, including misses.
+    std::vector<uint256> tx_hashes;
+    for (const auto& txn : m_coinbase_txns) tx_hashes.push_back(txn->GetHash());
+    tx_hashes.push_back(tx_hashes.front());
+    tx_hashes.push_back(genesis_block.vtx[0]->GetHash());
+    std::reverse(tx_hashes.begin(), tx_hashes.end());
+    std::vector<uint256> block_hashes;
+    const auto txs{txindex.FindTxs(tx_hashes, block_hashes)};
+    BOOST_REQUIRE_EQUAL(txs.size(), tx_hashes.size());
+    BOOST_REQUIRE_EQUAL(block_hashes.size(), tx_hashes.size());
+    BOOST_CHECK(!txs.front());
+    for (size_t i = 1; i < tx_hashes.size(); ++i) {
+        BOOST_REQUIRE(txs[i]);
+        BOOST_CHECK_EQUAL(txs[i]->GetHash(), tx_hashes[i]);
+        BOOST_REQUIRE(txindex.FindTx(tx_hashes[i], block_hash, tx_disk));
+        BOOST_CHECK_EQUAL(block_hashes[i], block_hash);
+    }
+
     // Check that new transactions in new blocks make it into the index.
     for (int i = 0; i < 10; i++) {
         CScript coinbase_script_pub_key = GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
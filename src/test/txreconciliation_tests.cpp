@@ -8,6 +8,10 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <set>
+#include <vector>
+
 BOOST_FIXTURE_TEST_SUITE(txreconciliation_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(RegisterPeerTest)
@@ -81,4 +85,171 @@ BOOST_AUTO_TEST_CASE(IsPeerRegisteredTest)
     BOOST_CHECK(!tracker.IsPeerRegistered(peer_id0));
 }
 
+BOOST_AUTO_TEST_CASE(ReconciliationRoundTest)
+{
+    // The initiator reaches the responder over an outbound connection; both use peer id 0.
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    const uint64_t initiator_salt{initiator.PreRegisterPeer(0)};
+    const uint64_t responder_salt{responder.PreRegisterPeer(0)};
+    BOOST_REQUIRE_EQUAL(initiator.RegisterPeer(0, /*is_peer_inbound=*/false, 1, responder_salt), ReconciliationRegisterResult::SUCCESS);
+    BOOST_REQUIRE_EQUAL(responder.RegisterPeer(0, /*is_peer_inbound=*/true, 1, initiator_salt), ReconciliationRegisterResult::SUCCESS);
+    BOOST_CHECK(initiator.IsInitiator(0));
+    BOOST_CHECK(!responder.IsInitiator(0));
+
+    // Only the initiator requests reconciliations, and only one at a time.
+    BOOST_CHECK(!responder.InitiateReconciliationRequest(0, 0s));
+
+    // Both sides know 30 shared transactions; each also has 5 the other lacks.
+    std::set<Wtxid> only_initiator, only_responder;
+    for (int i = 0; i < 40; ++i) {
+        const Wtxid wtxid{Wtxid::FromUint256(m_rng.rand256())};
+        if (i < 5) {
+            only_initiator.insert(wtxid);
+            BOOST_CHECK(initiator.AddToSet(0, wtxid));
+        } else if (i < 10) {
+            only_responder.insert(wtxid);
+            BOOST_CHECK(responder.AddToSet(0, wtxid));
+        } else {
+            BOOST_CHECK(initiator.AddToSet(0, wtxid));
+            BOOST_CHECK(responder.AddToSet(0, wtxid));
+        }
+    }
+
+    const auto request{initiator.InitiateReconciliationRequest(0, 0s)};
+    BOOST_REQUIRE(request);
+    BOOST_CHECK_EQUAL(request->first, 35);
+    BOOST_CHECK(!initiator.InitiateReconciliationRequest(0, 0s));
+
+    const auto sketch{responder.HandleReconciliationRequest(0, request->first, request->second, 0s)};
+    BOOST_REQUIRE(sketch && !sketch->empty());
+    const auto difference{initiator.HandleSketch(0, *sketch)};
+    BOOST_REQUIRE(difference);
+    BOOST_CHECK(difference->success);
+    BOOST_CHECK(std::set<Wtxid>(difference->announce.begin(), difference->announce.end()) == only_initiator);
+    BOOST_CHECK_EQUAL(difference->ask_shortids.size(), only_responder.size());
+
+    const auto announce{responder.HandleReconciliationDifference(0, difference->success, difference->ask_shortids)};
+    BOOST_REQUIRE(announce);
+    BOOST_CHECK(std::set<Wtxid>(announce->begin(), announce->end()) == only_responder);
+
+    // The round is over, messages out of turn are protocol violations.
+    BOOST_CHECK(!initiator.HandleSketch(0, *sketch));
+    BOOST_CHECK(!responder.HandleReconciliationDifference(0, true, {}));
+    BOOST_CHECK(initiator.InitiateReconciliationRequest(0, 0s));
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationFailureTest)
+{
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    const uint64_t initiator_salt{initiator.PreRegisterPeer(0)};
+    const uint64_t responder_salt{responder.PreRegisterPeer(0)};
+    BOOST_REQUIRE_EQUAL(initiator.RegisterPeer(0, false, 1, responder_salt), ReconciliationRegisterResult::SUCCESS);
+    BOOST_REQUIRE_EQUAL(responder.RegisterPeer(0, true, 1, initiator_salt), ReconciliationRegisterResult::SUCCESS);
+
+    // Disjoint sets, but the request claims the initiator's set is empty: the sketch is too
+    // small and the round fails, so both sides flood their whole set.
+    std::vector<Wtxid> initiator_txs, responder_txs;
+    for (int i = 0; i < 20; ++i) {
+        initiator_txs.push_back(Wtxid::FromUint256(m_rng.rand256()));
+        responder_txs.push_back(Wtxid::FromUint256(m_rng.rand256()));
+        BOOST_CHECK(initiator.AddToSet(0, initiator_txs.back()));
+        BOOST_CHECK(responder.AddToSet(0, responder_txs.back()));
+    }
+    BOOST_REQUIRE(initiator.InitiateReconciliationRequest(0, 0s));
+    const auto sketch{responder.HandleReconciliationRequest(0, /*peer_set_size=*/0, /*peer_q=*/0, 0s)};
+    BOOST_REQUIRE(sketch);
+    const auto difference{initiator.HandleSketch(0, *sketch)};
+    BOOST_REQUIRE(difference);
+    BOOST_CHECK(!difference->success);
+    BOOST_CHECK(std::is_permutation(difference->announce.begin(), difference->announce.end(), initiator_txs.begin(), initiator_txs.end()));
+    const auto announce{responder.HandleReconciliationDifference(0, false, {})};
+    BOOST_REQUIRE(announce);
+    BOOST_CHECK(std::is_permutation(announce->begin(), announce->end(), responder_txs.begin(), responder_txs.end()));
+
+    // A difference too large for any sketch is signalled with an empty one.
+    BOOST_REQUIRE(initiator.InitiateReconciliationRequest(0, 0s));
+    for (size_t i = 0; i < MAX_SKETCH_CAPACITY + 1; ++i) BOOST_CHECK(responder.AddToSet(0, Wtxid::FromUint256(m_rng.rand256())));
+    const auto empty_sketch{responder.HandleReconciliationRequest(0, 0, 0, 0s)};
+    BOOST_REQUIRE(empty_sketch);
+    BOOST_CHECK(empty_sketch->empty());
+    BOOST_CHECK(initiator.HandleSketch(0, *empty_sketch)->success == false);
+
+    // Malformed sketches are protocol violations.
+    BOOST_REQUIRE(initiator.InitiateReconciliationRequest(0, 0s));
+    BOOST_CHECK(!initiator.HandleSketch(0, std::vector<uint8_t>(3)));
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationTimeoutTest)
+{
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    const uint64_t initiator_salt{initiator.PreRegisterPeer(0)};
+    const uint64_t responder_salt{responder.PreRegisterPeer(0)};
+    BOOST_REQUIRE_EQUAL(initiator.RegisterPeer(0, false, 1, responder_salt), ReconciliationRegisterResult::SUCCESS);
+    BOOST_REQUIRE_EQUAL(responder.RegisterPeer(0, true, 1, initiator_salt), ReconciliationRegisterResult::SUCCESS);
+
+    std::vector<Wtxid> initiator_txs, responder_txs;
+    for (int i = 0; i < 5; ++i) {
+        initiator_txs.push_back(Wtxid::FromUint256(m_rng.rand256()));
+        responder_txs.push_back(Wtxid::FromUint256(m_rng.rand256()));
+        BOOST_CHECK(initiator.AddToSet(0, initiator_txs.back()));
+        BOOST_CHECK(responder.AddToSet(0, responder_txs.back()));
+    }
+
+    // Nothing expires while no round is ongoing.
+    BOOST_CHECK(initiator.ExpireReconciliation(0, 1h).empty());
+    BOOST_CHECK(responder.ExpireReconciliation(0, 1h).empty());
+
+    const auto start{100s};
+    const auto request{initiator.InitiateReconciliationRequest(0, start)};
+    BOOST_REQUIRE(request);
+    BOOST_REQUIRE(responder.HandleReconciliationRequest(0, request->first, request->second, start));
+    // A transaction arriving during the round waits in the responder's set.
+    responder_txs.push_back(Wtxid::FromUint256(m_rng.rand256()));
+    BOOST_CHECK(responder.AddToSet(0, responder_txs.back()));
+
+    // Neither the sketch nor the reconcildiff arrives in time: both sides flood what they held.
+    BOOST_CHECK(initiator.ExpireReconciliation(0, start + RECON_RESPONSE_TIMEOUT).empty());
+    BOOST_CHECK(responder.ExpireReconciliation(0, start + RECON_RESPONSE_TIMEOUT).empty());
+    const auto initiator_flood{initiator.ExpireReconciliation(0, start + RECON_RESPONSE_TIMEOUT + 1s)};
+    BOOST_CHECK(std::is_permutation(initiator_flood.begin(), initiator_flood.end(), initiator_txs.begin(), initiator_txs.end()));
+    const auto responder_flood{responder.ExpireReconciliation(0, start + RECON_RESPONSE_TIMEOUT + 1s)};
+    BOOST_CHECK(std::is_permutation(responder_flood.begin(), responder_flood.end(), responder_txs.begin(), responder_txs.end()));
+
+    // The round is over, so late replies are protocol violations, and a new round can start.
+    BOOST_CHECK(!initiator.HandleSketch(0, std::vector<uint8_t>(4)));
+    BOOST_CHECK(!responder.HandleReconciliationDifference(0, true, {}));
+    BOOST_CHECK(initiator.ExpireReconciliation(0, 1h).empty());
+    BOOST_CHECK(initiator.InitiateReconciliationRequest(0, 1h));
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationSetTest)
+{
+    TxReconciliationTracker tracker(TXRECONCILIATION_VERSION);
+    const Wtxid wtxid{Wtxid::FromUint256(m_rng.rand256())};
+
+    // Transactions are always flooded to peers we do not reconcile with.
+    BOOST_CHECK(tracker.ShouldFanoutTo(wtxid, 0));
+    BOOST_CHECK(!tracker.AddToSet(0, wtxid));
+
+    tracker.PreRegisterPeer(0);
+    BOOST_REQUIRE_EQUAL(tracker.RegisterPeer(0, /*is_peer_inbound=*/true, 1, 1), ReconciliationRegisterResult::SUCCESS);
+
+    // Fanout is stable per (transaction, peer) and picks a fraction of transactions.
+    int fanout{0};
+    for (int i = 0; i < 1000; ++i) {
+        const Wtxid tx{Wtxid::FromUint256(m_rng.rand256())};
+        const bool should_fanout{tracker.ShouldFanoutTo(tx, 0)};
+        BOOST_CHECK_EQUAL(should_fanout, tracker.ShouldFanoutTo(tx, 0));
+        fanout += should_fanout;
+    }
+    BOOST_CHECK(fanout > 0 && fanout < 500);
+
+    // A full set makes the caller flood instead.
+    for (size_t i = 0; i < MAX_RECONSET_SIZE; ++i) BOOST_CHECK(tracker.AddToSet(0, Wtxid::FromUint256(m_rng.rand256())));
+    BOOST_CHECK(!tracker.AddToSet(0, wtxid));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -11,6 +11,7 @@
 #include <test/util/setup_common.h>
 #include <txmempool.h>
 #include <util/chaintype.h>
+#include <util/vector.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
@@ -385,4 +386,33 @@ BOOST_FIXTURE_TEST_CASE(checkinputs_test, Dersig100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(scriptcheck_caches_signature, BasicTestingSetup)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    const CTxOut spent{1, CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG};
+    CMutableTransaction mtx;
+    mtx.vin.emplace_back(COutPoint{Txid::FromUint256(uint256{1}), 0});
+    mtx.vout.emplace_back(1, CScript() << OP_TRUE);
+    const uint256 sighash{SignatureHash(spent.scriptPubKey, mtx, 0, SIGHASH_ALL, spent.nValue, SigVersion::BASE)};
+    std::vector<unsigned char> sig;
+    BOOST_REQUIRE(key.Sign(sighash, sig));
+    mtx.vin[0].scriptSig << Cat(sig, {SIGHASH_ALL});
+    const CTransaction tx{mtx};
+
+    SignatureCache signature_cache{DEFAULT_SIGNATURE_CACHE_BYTES};
+    uint256 entry;
+    signature_cache.ComputeEntryDilithium(entry, sighash, sig, key.GetPubKey());
+    BOOST_CHECK(!signature_cache.Get(entry, /*erase=*/false));
+
+    // A check that doesn't store leaves the cache alone, one that does stores
+    // the Dilithium signature.
+    PrecomputedTransactionData txdata;
+    txdata.Init(tx, {spent});
+    BOOST_CHECK(!CScriptCheck(spent, tx, signature_cache, 0, SCRIPT_VERIFY_P2SH, /*cacheIn=*/false, &txdata)().has_value());
+    BOOST_CHECK(!signature_cache.Get(entry, /*erase=*/false));
+    BOOST_CHECK(!CScriptCheck(spent, tx, signature_cache, 0, SCRIPT_VERIFY_P2SH, /*cacheIn=*/true, &txdata)().has_value());
+    BOOST_CHECK(signature_cache.Get(entry, /*erase=*/false));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
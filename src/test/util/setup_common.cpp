@@ -231,7 +231,8 @@ ChainTestingSetup::ChainTestingSetup(const ChainType chainType, TestOpts opts)
             // Use synchronous task runner while fuzzing to avoid non-determinism
             EnableFuzzDeterminism() ?
                 std::make_unique<ValidationSignals>(std::make_unique<util::ImmediateTaskRunner>()) :
-                std::make_unique<ValidationSignals>(std::make_unique<SerialTaskRunner>(*m_node.scheduler));
+                std::make_unique<ValidationSignals>(std::make_unique<SerialTaskRunner>(*m_node.scheduler),
+                                                    [this] { return std::make_unique<SerialTaskRunner>(*m_node.scheduler); });
         {
             // Ensure deterministic coverage by waiting for m_service_thread to be running
             std::promise<void> promise;
@@ -147,4 +147,23 @@ BOOST_FIXTURE_TEST_CASE(chainstate_update_tip, TestChain100Setup)
     BOOST_CHECK_EQUAL(curr_tip, get_notify_tip());
 }
 
+//! Test that VerifyDB, which reads and checks blocks in parallel batches, accepts
+//! a valid chain at every level and for depths which are not a multiple of the batch size.
+BOOST_FIXTURE_TEST_CASE(chainstate_verifydb, TestChain100Setup)
+{
+    ChainstateManager& chainman = *Assert(m_node.chainman);
+    LOCK(::cs_main);
+    Chainstate& chainstate{chainman.ActiveChainstate()};
+    const uint256 tip_hash{chainstate.m_chain.Tip()->GetBlockHash()};
+    for (int level = 0; level <= 4; ++level) {
+        for (int depth : {1, 6, 7, 0}) {
+            BOOST_CHECK(CVerifyDB(chainman.GetNotifications()).VerifyDB(
+                            chainstate, chainman.GetConsensus(), chainstate.CoinsTip(), level, depth) == VerifyDBResult::SUCCESS);
+        }
+    }
+    // Verification works on a copy of the coins view and leaves the chainstate alone.
+    BOOST_CHECK_EQUAL(chainstate.m_chain.Tip()->GetBlockHash(), tip_hash);
+    BOOST_CHECK_EQUAL(chainstate.CoinsTip().GetBestBlock(), tip_hash);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
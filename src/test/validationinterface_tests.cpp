@@ -11,7 +11,11 @@
 #include <kernel/chain.h>
 #include <validationinterface.h>
 
+#include <algorithm>
 #include <atomic>
+#include <future>
+#include <string>
+#include <thread>
 
 BOOST_FIXTURE_TEST_SUITE(validationinterface_tests, ChainTestingSetup)
 
@@ -101,4 +105,113 @@ BOOST_AUTO_TEST_CASE(unregister_all_during_call)
     BOOST_CHECK(destroyed);
 }
 
+class QueueTestSubscriber final : public CValidationInterface
+{
+public:
+    QueueTestSubscriber(std::string name, std::function<void()> on_call)
+        : m_name{std::move(name)}, m_on_call{std::move(on_call)} {}
+    void ChainStateFlushed(ChainstateRole, const CBlockLocator&) override { m_on_call(); }
+    std::string ValidationInterfaceName() const override { return m_name; }
+
+private:
+    const std::string m_name;
+    const std::function<void()> m_on_call;
+};
+
+// A subscriber stuck in a callback must not hold back the callbacks of other
+// subscribers, which have their own queues.
+BOOST_AUTO_TEST_CASE(slow_subscriber_does_not_block_others)
+{
+    // Another scheduler thread, so that two subscriber queues can run in parallel.
+    m_node.scheduler->m_extra_service_threads.emplace_back([&] { m_node.scheduler->serviceQueue(); });
+
+    std::promise<void> release;
+    std::shared_future<void> released{release.get_future()};
+    std::promise<void> fast_done;
+    int fast_calls{0};
+    QueueTestSubscriber slow{"slow", [&] { released.wait(); }};
+    QueueTestSubscriber fast{"fast", [&] { if (++fast_calls == 3) fast_done.set_value(); }};
+    auto& signals{*m_node.validation_signals};
+    signals.RegisterValidationInterface(&slow);
+    signals.RegisterValidationInterface(&fast);
+    for (int i{0}; i < 3; ++i) signals.ChainStateFlushed(ChainstateRole::NORMAL, CBlockLocator{});
+
+    const auto find{[](const std::vector<ValidationSubscriberStats>& stats, const std::string& name) {
+        auto it{std::find_if(stats.begin(), stats.end(), [&](const auto& s) { return s.name == name; })};
+        BOOST_REQUIRE(it != stats.end());
+        return *it;
+    }};
+
+    // All notifications reach the fast subscriber while the slow one is still
+    // stuck in the first.
+    fast_done.get_future().wait();
+    auto slow_stats{find(signals.GetSubscriberStats(), "slow")};
+    BOOST_CHECK_EQUAL(slow_stats.pending, 3U);
+    BOOST_CHECK_EQUAL(slow_stats.delivered, 0U);
+    BOOST_CHECK_EQUAL(signals.CallbacksPending(), 3U);
+
+    release.set_value();
+    signals.SyncWithValidationInterfaceQueue();
+    const auto stats{signals.GetSubscriberStats()};
+    for (const auto& name : {"slow", "fast"}) {
+        const auto sub_stats{find(stats, name)};
+        BOOST_CHECK_EQUAL(sub_stats.pending, 0U);
+        BOOST_CHECK_EQUAL(sub_stats.delivered, 3U);
+    }
+    BOOST_CHECK_EQUAL(find(stats, "slow").max_pending, 3U);
+    BOOST_CHECK(find(stats, "slow").max_wait >= find(stats, "fast").max_wait);
+    BOOST_CHECK_EQUAL(signals.CallbacksPending(), 0U);
+
+    signals.UnregisterValidationInterface(&slow);
+    signals.UnregisterValidationInterface(&fast);
+    for (const auto& sub_stats : signals.GetSubscriberStats()) {
+        BOOST_CHECK(sub_stats.name != "slow" && sub_stats.name != "fast");
+    }
+}
+
+// Short-lived subscribers, like the one submitblock registers for every call,
+// must not accumulate: once an unregistered subscriber's callbacks have run,
+// its task runner is reused.
+BOOST_AUTO_TEST_CASE(unregistered_subscribers_are_pruned)
+{
+    // Own scheduler, stopped before the task runners are destroyed.
+    CScheduler scheduler;
+    scheduler.m_service_thread = std::thread{[&] { scheduler.serviceQueue(); }};
+    int runners_made{0};
+    ValidationSignals signals{std::make_unique<SerialTaskRunner>(scheduler),
+                              [&] { ++runners_made; return std::make_unique<SerialTaskRunner>(scheduler); }};
+    int calls{0};
+    for (int i{0}; i < 50; ++i) {
+        auto sub{std::make_shared<QueueTestSubscriber>("temp", [&] { ++calls; })};
+        signals.RegisterSharedValidationInterface(sub);
+        signals.ChainStateFlushed(ChainstateRole::NORMAL, CBlockLocator{});
+        signals.SyncWithValidationInterfaceQueue();
+        signals.UnregisterSharedValidationInterface(sub);
+    }
+    BOOST_CHECK_EQUAL(calls, 50);
+    BOOST_CHECK_EQUAL(runners_made, 1);
+
+    // A subscriber unregistered with callbacks still queued keeps its task
+    // runner until they have run.
+    std::promise<void> release;
+    std::shared_future<void> released{release.get_future()};
+    std::promise<void> started;
+    auto slow{std::make_shared<QueueTestSubscriber>("slow", [&] { started.set_value(); released.wait(); })};
+    signals.RegisterSharedValidationInterface(slow);
+    signals.ChainStateFlushed(ChainstateRole::NORMAL, CBlockLocator{});
+    signals.ChainStateFlushed(ChainstateRole::NORMAL, CBlockLocator{});
+    started.get_future().wait();
+    signals.UnregisterSharedValidationInterface(slow);
+    auto other{std::make_shared<QueueTestSubscriber>("other", [] {})};
+    signals.RegisterSharedValidationInterface(other);
+    BOOST_CHECK_EQUAL(runners_made, 2);
+    release.set_value();
+    signals.SyncWithValidationInterfaceQueue();
+    signals.UnregisterSharedValidationInterface(other);
+    signals.RegisterSharedValidationInterface(slow);
+    BOOST_CHECK_EQUAL(runners_made, 2);
+    signals.UnregisterSharedValidationInterface(slow);
+    scheduler.stop();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
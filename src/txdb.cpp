@@ -71,6 +71,14 @@ std::optional<Coin> CCoinsViewDB::GetCoin(const COutPoint& outpoint) const
     return std::nullopt;
 }
 
+std::vector<std::optional<Coin>> CCoinsViewDB::GetCoins(std::span<const COutPoint> outpoints) const
+{
+    std::vector<CoinEntry> entries;
+    entries.reserve(outpoints.size());
+    for (const auto& outpoint : outpoints) entries.emplace_back(&outpoint);
+    return m_db->ReadMany<Coin>(std::span<const CoinEntry>{entries});
+}
+
 bool CCoinsViewDB::HaveCoin(const COutPoint &outpoint) const {
     return m_db->Exists(CoinEntry(&outpoint));
 }
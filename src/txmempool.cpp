@@ -12,6 +12,7 @@
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
 #include <logging.h>
+#include <memusage.h>
 #include <policy/policy.h>
 #include <policy/settings.h>
 #include <random.h>
@@ -30,8 +31,10 @@
 #include <cmath>
 #include <numeric>
 #include <optional>
+#include <queue>
 #include <ranges>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 
 TRACEPOINT_SEMAPHORE(mempool, added);
@@ -508,6 +511,7 @@ void CTxMemPool::addNewTransaction(CTxMemPool::txiter newit, CTxMemPool::setEntr
     m_total_fee += entry.GetFee();
 
     txns_randomized.emplace_back(newit->GetSharedTx());
+    wtxids_randomized.emplace_back(newit->GetTx().GetWitnessHash());
     newit->idx_randomized = txns_randomized.size() - 1;
 
     TRACEPOINT(mempool, added,
@@ -549,10 +553,16 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
         // Remove entry from txns_randomized by replacing it with the back and deleting the back.
         txns_randomized[it->idx_randomized] = std::move(txns_randomized.back());
         txns_randomized.pop_back();
-        if (txns_randomized.size() * 2 < txns_randomized.capacity())
+        wtxids_randomized[it->idx_randomized] = wtxids_randomized.back();
+        wtxids_randomized.pop_back();
+        if (txns_randomized.size() * 2 < txns_randomized.capacity()) {
             txns_randomized.shrink_to_fit();
-    } else
+            wtxids_randomized.shrink_to_fit();
+        }
+    } else {
         txns_randomized.clear();
+        wtxids_randomized.clear();
+    }
 
     totalTxSize -= it->GetTxSize();
     m_total_fee -= it->GetFee();
@@ -644,19 +654,26 @@ void CTxMemPool::removeForReorg(CChain& chain, std::function<bool(txiter)> check
     }
 }
 
-void CTxMemPool::removeConflicts(const CTransaction &tx)
+template <typename Fn>
+void CTxMemPool::ForEachRelative(txiter entry, bool descendants, std::vector<txiter>& stack, Fn&& fn)
 {
-    // Remove transactions which depend on inputs of tx, recursively
     AssertLockHeld(cs);
-    for (const CTxIn &txin : tx.vin) {
-        auto it = mapNextTx.find(txin.prevout);
-        if (it != mapNextTx.end()) {
-            const CTransaction &txConflict = *it->second;
-            if (txConflict != tx)
-            {
-                ClearPrioritisation(txConflict.GetHash());
-                removeRecursive(txConflict, MemPoolRemovalReason::CONFLICT);
-            }
+    WITH_FRESH_EPOCH(m_epoch);
+    visited(entry);
+    stack.assign(1, entry);
+    while (!stack.empty()) {
+        const txiter it{stack.back()};
+        stack.pop_back();
+        const auto visit{[&](const CTxMemPoolEntry& relative) EXCLUSIVE_LOCKS_REQUIRED(cs, m_epoch) {
+            const txiter relative_it{mapTx.iterator_to(relative)};
+            if (visited(relative_it)) return;
+            fn(relative_it);
+            stack.push_back(relative_it);
+        }};
+        if (descendants) {
+            for (const CTxMemPoolEntry& child : it->GetMemPoolChildrenConst()) visit(child);
+        } else {
+            for (const CTxMemPoolEntry& parent : it->GetMemPoolParentsConst()) visit(parent);
         }
     }
 }
@@ -670,18 +687,122 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
     Assume(!m_have_changeset);
     std::vector<RemovedMempoolTransactionInfo> txs_removed_for_block;
     txs_removed_for_block.reserve(vtx.size());
-    for (const auto& tx : vtx)
+
+    // Collect all entries the block removes first, in the same order as
+    // removing the block's transactions one at a time would: each in-mempool
+    // block transaction, followed by the transactions conflicting with it and
+    // their descendants. Like removeRecursive, each conflict and its
+    // descendants are removed in txid order, so that removal notifications
+    // are unchanged. Visiting an entry means it is queued for removal.
+    std::vector<std::pair<txiter, MemPoolRemovalReason>> removals;
     {
-        txiter it = mapTx.find(tx->GetHash());
-        if (it != mapTx.end()) {
-            setEntries stage;
-            stage.insert(it);
-            txs_removed_for_block.emplace_back(*it);
-            RemoveStaged(stage, true, MemPoolRemovalReason::BLOCK);
+        WITH_FRESH_EPOCH(m_epoch);
+        for (const auto& tx : vtx) {
+            if (const auto it{mapTx.find(tx->GetHash())}; it != mapTx.end() && !visited(it)) {
+                removals.emplace_back(it, MemPoolRemovalReason::BLOCK);
+                txs_removed_for_block.emplace_back(*it);
+            }
+            for (const CTxIn& txin : tx->vin) {
+                const auto spender{mapNextTx.find(txin.prevout)};
+                if (spender == mapNextTx.end() || spender->second->GetHash() == tx->GetHash()) continue;
+                const txiter conflict{mapTx.find(spender->second->GetHash())};
+                // Skip conflicts that are already being removed along with an
+                // earlier transaction of the block.
+                if (visited(conflict)) continue;
+                ClearPrioritisation(conflict->GetTx().GetHash());
+                const size_t conflict_begin{removals.size()};
+                removals.emplace_back(conflict, MemPoolRemovalReason::CONFLICT);
+                for (size_t i{conflict_begin}; i < removals.size(); ++i) {
+                    for (const CTxMemPoolEntry& child : removals[i].first->GetMemPoolChildrenConst()) {
+                        const txiter child_it{mapTx.iterator_to(child)};
+                        if (!visited(child_it)) removals.emplace_back(child_it, MemPoolRemovalReason::CONFLICT);
+                    }
+                }
+                std::sort(removals.begin() + conflict_begin, removals.end(), [](const auto& a, const auto& b) {
+                    return CompareIteratorByHash{}(a.first, b.first);
+                });
+            }
+            ClearPrioritisation(tx->GetHash());
+        }
+    }
+
+    // Sum up how the package state of each remaining entry changes, while all
+    // links are still in place, so that every affected entry is modified only
+    // once. Confirmed transactions are no longer ancestors of their
+    // descendants, and every removed transaction is no longer a descendant of
+    // its ancestors.
+    struct StateUpdate {
+        bool removed{false};
+        int32_t ancestor_size{0};
+        CAmount ancestor_fee{0};
+        int64_t ancestor_count{0};
+        int64_t ancestor_sigops{0};
+        int32_t descendant_size{0};
+        CAmount descendant_fee{0};
+        int64_t descendant_count{0};
+    };
+    // Most removed transactions have no in-mempool relatives, so skip them.
+    const auto has_relatives{[](txiter it) {
+        return !it->GetMemPoolParentsConst().empty() || !it->GetMemPoolChildrenConst().empty();
+    }};
+    std::unordered_map<const CTxMemPoolEntry*, StateUpdate> updates;
+    for (const auto& [it, reason] : removals) {
+        if (has_relatives(it)) updates[&*it].removed = true;
+    }
+    // Remaining entries in the order they were reached, which keeps memory
+    // accesses local when applying the updates.
+    std::vector<txiter> updated;
+    const auto get_update{[&](txiter it) -> StateUpdate& {
+        const auto [update, inserted]{updates.try_emplace(&*it)};
+        if (inserted) updated.push_back(it);
+        return update->second;
+    }};
+    std::vector<txiter> stack;
+    for (const auto& [it, reason] : removals) {
+        if (!has_relatives(it)) continue;
+        const int32_t size{it->GetTxSize()};
+        const CAmount fee{it->GetModifiedFee()};
+        if (reason == MemPoolRemovalReason::BLOCK) {
+            const int64_t sigops{it->GetSigOpCost()};
+            ForEachRelative(it, /*descendants=*/true, stack, [&](txiter descendant) {
+                auto& update{get_update(descendant)};
+                update.ancestor_size -= size;
+                update.ancestor_fee -= fee;
+                update.ancestor_count -= 1;
+                update.ancestor_sigops -= sigops;
+            });
         }
-        removeConflicts(*tx);
-        ClearPrioritisation(tx->GetHash());
+        ForEachRelative(it, /*descendants=*/false, stack, [&](txiter ancestor) {
+            auto& update{get_update(ancestor)};
+            update.descendant_size -= size;
+            update.descendant_fee -= fee;
+            update.descendant_count -= 1;
+        });
+    }
+    for (const txiter it : updated) {
+        const StateUpdate& update{updates.at(&*it)};
+        if (update.removed) continue;
+        mapTx.modify(it, [&update](CTxMemPoolEntry& e) {
+            if (update.ancestor_count != 0) {
+                e.UpdateAncestorState(update.ancestor_size, update.ancestor_fee, update.ancestor_count, update.ancestor_sigops);
+            }
+            if (update.descendant_count != 0) {
+                e.UpdateDescendantState(update.descendant_size, update.descendant_fee, update.descendant_count);
+            }
+        });
     }
+
+    // Sever the links between removed and remaining entries.
+    for (const auto& [it, reason] : removals) {
+        for (const CTxMemPoolEntry& parent : it->GetMemPoolParentsConst()) {
+            UpdateChild(mapTx.iterator_to(parent), it, false);
+        }
+        UpdateChildrenForRemoval(it);
+    }
+    for (const auto& [it, reason] : removals) {
+        removeUnchecked(it, reason);
+    }
+
     if (m_opts.signals) {
         m_opts.signals->MempoolTransactionsRemovedForBlock(txs_removed_for_block, nBlockHeight);
     }
@@ -712,6 +833,7 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
         innerUsage += it->DynamicMemoryUsage();
         const CTransaction& tx = it->GetTx();
         innerUsage += memusage::DynamicUsage(it->GetMemPoolParentsConst()) + memusage::DynamicUsage(it->GetMemPoolChildrenConst());
+        assert(wtxids_randomized.at(it->idx_randomized) == tx.GetWitnessHash());
         CTxMemPoolEntry::Parents setParentCheck;
         for (const CTxIn &txin : tx.vin) {
             // Check that every mempool transaction's inputs refer to available coins, or other mempool tx's.
@@ -789,6 +911,7 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
         assert(&tx == it->second);
     }
 
+    assert(wtxids_randomized.size() == txns_randomized.size());
     assert(totalTxSize == checkTotal);
     assert(m_total_fee == check_total_fee);
     assert(innerUsage == cachedInnerUsage);
@@ -1063,7 +1186,7 @@ void CCoinsViewMemPool::Reset()
 size_t CTxMemPool::DynamicMemoryUsage() const {
     LOCK(cs);
     // Estimate the overhead of mapTx to be 15 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(txns_randomized) + cachedInnerUsage;
+    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(txns_randomized) + memusage::DynamicUsage(wtxids_randomized) + cachedInnerUsage;
 }
 
 void CTxMemPool::RemoveUnbroadcastTx(const uint256& txid, const bool unchecked) {
@@ -1155,45 +1278,220 @@ void CTxMemPool::trackPackageRemoved(const CFeeRate& rate) {
     }
 }
 
-void CTxMemPool::TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpendsRemaining) {
+namespace {
+/** A mempool entry's place in the descendant score order, after the packages
+ *  already selected for eviction are taken out of its descendant state. */
+struct EvictionCandidate {
+    double mod_fee;
+    double size;
+    std::chrono::seconds time;
+    CTxMemPool::txiter it;
+    uint64_t version;
+};
+
+EvictionCandidate MakeEvictionCandidate(CTxMemPool::txiter it, int32_t removed_size, CAmount removed_fee, uint64_t version)
+{
+    // Same as CompareTxMemPoolEntryByDescendantScore::GetModFeeAndSize.
+    const int64_t size_with_descendants{it->GetSizeWithDescendants() - removed_size};
+    const CAmount mod_fees_with_descendants{it->GetModFeesWithDescendants() - removed_fee};
+    const double f1 = (double)it->GetModifiedFee() * size_with_descendants;
+    const double f2 = (double)mod_fees_with_descendants * it->GetTxSize();
+    if (f2 > f1) {
+        return {double(mod_fees_with_descendants), double(size_with_descendants), it->GetTime(), it, version};
+    }
+    return {double(it->GetModifiedFee()), double(it->GetTxSize()), it->GetTime(), it, version};
+}
+
+//! Whether a sorts before b in CompareTxMemPoolEntryByDescendantScore.
+bool EvictBefore(const EvictionCandidate& a, const EvictionCandidate& b)
+{
+    const double f1 = a.mod_fee * b.size;
+    const double f2 = a.size * b.mod_fee;
+    if (f1 == f2) return a.time >= b.time;
+    return f1 < f2;
+}
+} // namespace
+
+unsigned int CTxMemPool::EvictPackages(size_t deficit, CFeeRate& max_removed, std::vector<COutPoint>* no_spends_remaining)
+{
     AssertLockHeld(cs);
-    Assume(!m_have_changeset);
 
-    unsigned nTxnRemoved = 0;
-    CFeeRate maxFeeRateRemoved(0);
-    while (!mapTx.empty() && DynamicMemoryUsage() > sizelimit) {
-        indexed_transaction_set::index<descendant_score>::type::iterator it = mapTx.get<descendant_score>().begin();
+    // Evicting a package never lowers the descendant score of the entries that
+    // remain, it only raises the score of the package's ancestors. So the next
+    // package to evict is rooted either at the first entry of the descendant
+    // score index that no selected package affects, or at the lowest of the
+    // affected ancestors, which are rescored in a heap instead of the index.
+    // Heap items made stale by a later rescore are dropped lazily.
+    struct EvictionState {
+        bool selected{false};
+        //! Package that selected the entry, or that last changed its descendant state.
+        uint32_t package{0};
+        int32_t removed_size{0};
+        CAmount removed_fee{0};
+        int64_t removed_count{0};
+        uint64_t version{0};
+    };
+    std::unordered_map<const CTxMemPoolEntry*, EvictionState> states;
+    // Remaining entries whose descendant state changes, in the order reached.
+    std::vector<txiter> updated;
+    std::vector<txiter> removals;
+    const auto heap_order{[](const EvictionCandidate& a, const EvictionCandidate& b) { return EvictBefore(b, a); }};
+    std::priority_queue<EvictionCandidate, std::vector<EvictionCandidate>, decltype(heap_order)> rescored{heap_order};
+    const auto& by_score{mapTx.get<descendant_score>()};
+    auto next_unaffected{by_score.begin()};
+
+    // Upper bound on the memory usage removing an entry releases, following
+    // DynamicMemoryUsage(). The entry's links from remaining relatives count
+    // as released too.
+    const size_t link_usage{memusage::IncrementalDynamicUsage(CTxMemPoolEntry::Parents{})};
+    const auto usage_bound{[&](txiter it) EXCLUSIVE_LOCKS_REQUIRED(cs) {
+        const CTxMemPoolEntry::Parents& parents{it->GetMemPoolParentsConst()};
+        const CTxMemPoolEntry::Children& children{it->GetMemPoolChildrenConst()};
+        return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)) + it->DynamicMemoryUsage() +
+               memusage::DynamicUsage(parents) + memusage::DynamicUsage(children) +
+               (parents.size() + children.size()) * link_usage +
+               it->GetTx().vin.size() * memusage::IncrementalDynamicUsage(mapNextTx);
+    }};
+    size_t released{0};
+    const auto released_bound{[&]() EXCLUSIVE_LOCKS_REQUIRED(cs) {
+        // Removing entries may shrink the randomized transaction vectors.
+        if ((txns_randomized.size() - removals.size()) * 2 < txns_randomized.capacity()) {
+            return released + memusage::DynamicUsage(txns_randomized) + memusage::DynamicUsage(wtxids_randomized);
+        }
+        return released;
+    }};
+
+    // Only select another package while the mempool is certain to still be
+    // over its limit without it, so that the result is the same as evicting
+    // one package at a time.
+    std::vector<txiter> stack, rescore;
+    uint32_t package{0};
+    while (removals.empty() || released_bound() < deficit) {
+        while (next_unaffected != by_score.end() && states.contains(&*next_unaffected)) ++next_unaffected;
+        while (!rescored.empty()) {
+            const EvictionState& state{states.at(&*rescored.top().it)};
+            if (!state.selected && state.version == rescored.top().version) break;
+            rescored.pop();
+        }
+        txiter root;
+        if (next_unaffected == by_score.end()) {
+            if (rescored.empty()) break;
+            root = rescored.top().it;
+        } else {
+            root = mapTx.project<0>(next_unaffected);
+            if (!rescored.empty() && EvictBefore(rescored.top(), MakeEvictionCandidate(root, 0, 0, 0))) {
+                root = rescored.top().it;
+            }
+        }
+        ++package;
 
         // We set the new mempool min fee to the feerate of the removed set, plus the
         // "minimum reasonable fee rate" (ie some value under which we consider txn
         // to have 0 fee). This way, we don't allow txn to enter mempool with feerate
         // equal to txn which were removed with no block in between.
-        CFeeRate removed(it->GetModFeesWithDescendants(), it->GetSizeWithDescendants());
+        const EvictionState& root_state{states[&*root]};
+        CFeeRate removed(root->GetModFeesWithDescendants() - root_state.removed_fee, root->GetSizeWithDescendants() - root_state.removed_size);
         removed += m_opts.incremental_relay_feerate;
         trackPackageRemoved(removed);
-        maxFeeRateRemoved = std::max(maxFeeRateRemoved, removed);
-
-        setEntries stage;
-        CalculateDescendants(mapTx.project<0>(it), stage);
-        nTxnRemoved += stage.size();
+        max_removed = std::max(max_removed, removed);
+
+        // Select the root and its descendants not selected by an earlier package.
+        const size_t begin{removals.size()};
+        const auto select{[&](txiter it) EXCLUSIVE_LOCKS_REQUIRED(cs) {
+            EvictionState& state{states[&*it]};
+            state.selected = true;
+            state.package = package;
+            removals.push_back(it);
+            released += usage_bound(it);
+        }};
+        select(root);
+        for (size_t i{begin}; i < removals.size(); ++i) {
+            for (const CTxMemPoolEntry& child : removals[i]->GetMemPoolChildrenConst()) {
+                const auto state{states.find(&child)};
+                if (state == states.end() || !state->second.selected) select(mapTx.iterator_to(child));
+            }
+        }
 
-        std::vector<CTransaction> txn;
-        if (pvNoSpendsRemaining) {
-            txn.reserve(stage.size());
-            for (txiter iter : stage)
-                txn.push_back(iter->GetTx());
+        // Take the package out of the descendant state of its remaining ancestors.
+        rescore.clear();
+        for (size_t i{begin}; i < removals.size(); ++i) {
+            const txiter it{removals[i]};
+            if (it->GetMemPoolParentsConst().empty()) continue;
+            ForEachRelative(it, /*descendants=*/false, stack, [&](txiter ancestor) {
+                EvictionState& state{states[&*ancestor]};
+                if (state.selected) return;
+                if (state.removed_count == 0) updated.push_back(ancestor);
+                if (state.package != package) {
+                    state.package = package;
+                    rescore.push_back(ancestor);
+                }
+                state.removed_size += it->GetTxSize();
+                state.removed_fee += it->GetModifiedFee();
+                state.removed_count += 1;
+            });
+        }
+        for (const txiter it : rescore) {
+            EvictionState& state{states.at(&*it)};
+            rescored.push(MakeEvictionCandidate(it, state.removed_size, state.removed_fee, ++state.version));
         }
-        RemoveStaged(stage, false, MemPoolRemovalReason::SIZELIMIT);
-        if (pvNoSpendsRemaining) {
-            for (const CTransaction& tx : txn) {
-                for (const CTxIn& txin : tx.vin) {
-                    if (exists(GenTxid::Txid(txin.prevout.hash))) continue;
-                    pvNoSpendsRemaining->push_back(txin.prevout);
+
+        if (no_spends_remaining) {
+            for (size_t i{begin}; i < removals.size(); ++i) {
+                for (const CTxIn& txin : removals[i]->GetTx().vin) {
+                    // A parent selected by an earlier package would have
+                    // selected this entry too, so only this package counts.
+                    if (const auto parent{mapTx.find(txin.prevout.hash)}; parent != mapTx.end()) {
+                        const auto state{states.find(&*parent)};
+                        if (state == states.end() || !state->second.selected) continue;
+                    }
+                    no_spends_remaining->push_back(txin.prevout);
                 }
             }
         }
     }
 
+    // Apply the changes once per remaining entry, then remove the packages.
+    for (const txiter it : updated) {
+        const EvictionState& state{states.at(&*it)};
+        if (state.selected) continue;
+        mapTx.modify(it, [&state](CTxMemPoolEntry& e) {
+            e.UpdateDescendantState(-state.removed_size, -state.removed_fee, -state.removed_count);
+        });
+    }
+    for (const txiter it : removals) {
+        for (const CTxMemPoolEntry& parent : it->GetMemPoolParentsConst()) {
+            UpdateChild(mapTx.iterator_to(parent), it, false);
+        }
+        UpdateChildrenForRemoval(it);
+    }
+    for (const txiter it : removals) {
+        m_eviction_stats.bytes += it->GetTxSize();
+        removeUnchecked(it, MemPoolRemovalReason::SIZELIMIT);
+    }
+    return removals.size();
+}
+
+void CTxMemPool::TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpendsRemaining) {
+    AssertLockHeld(cs);
+    Assume(!m_have_changeset);
+
+    const auto start{SteadyClock::now()};
+    const size_t usage_before{DynamicMemoryUsage()};
+    size_t usage{usage_before};
+    unsigned nTxnRemoved = 0;
+    CFeeRate maxFeeRateRemoved(0);
+    // Packages are evicted in batches, and the usage is measured again after
+    // each batch.
+    while (!mapTx.empty() && usage > sizelimit) {
+        nTxnRemoved += EvictPackages(usage - sizelimit, maxFeeRateRemoved, pvNoSpendsRemaining);
+        usage = DynamicMemoryUsage();
+    }
+
+    if (nTxnRemoved > 0) {
+        m_eviction_stats.txs += nTxnRemoved;
+        m_eviction_stats.usage += usage_before - usage;
+        m_eviction_stats.time += std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - start);
+    }
     if (maxFeeRateRemoved > CFeeRate(0)) {
         LogDebug(BCLog::MEMPOOL, "Removed %u txn, rolling minimum fee bumped to %s\n", nTxnRemoved, maxFeeRateRemoved.ToString());
     }
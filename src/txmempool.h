@@ -32,6 +32,7 @@
 #include <boost/multi_index_container.hpp>
 
 #include <atomic>
+#include <chrono>
 #include <map>
 #include <optional>
 #include <set>
@@ -392,6 +393,7 @@ public:
 
     using txiter = indexed_transaction_set::nth_index<0>::type::const_iterator;
     std::vector<CTransactionRef> txns_randomized GUARDED_BY(cs); //!< All transactions in mapTx, in random order
+    std::vector<Wtxid> wtxids_randomized GUARDED_BY(cs); //!< Witness hashes of txns_randomized, in the same order
 
     typedef std::set<txiter, CompareIteratorByHash> setEntries;
 
@@ -463,7 +465,6 @@ public:
      *                                        and updates an entry's LockPoints.
      * */
     void removeForReorg(CChain& chain, std::function<bool(txiter)> filter_final_and_mature) EXCLUSIVE_LOCKS_REQUIRED(cs, cs_main);
-    void removeConflicts(const CTransaction& tx) EXCLUSIVE_LOCKS_REQUIRED(cs);
     void removeForBlock(const std::vector<CTransactionRef>& vtx, unsigned int nBlockHeight) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     bool CompareDepthAndScore(const uint256& hasha, const uint256& hashb, bool wtxid=false);
@@ -603,6 +604,20 @@ public:
       */
     void TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpendsRemaining = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    /** Totals of the transactions TrimToSize evicted. */
+    struct EvictionStats {
+        uint64_t txs{0};                   //!< Number of evicted transactions
+        uint64_t bytes{0};                 //!< Sum of their virtual sizes
+        uint64_t usage{0};                 //!< Memory usage released by evicting them
+        std::chrono::microseconds time{0}; //!< Time spent in TrimToSize while evicting
+    };
+
+    const EvictionStats& GetEvictionStats() const EXCLUSIVE_LOCKS_REQUIRED(cs)
+    {
+        AssertLockHeld(cs);
+        return m_eviction_stats;
+    }
+
     /** Expire all transaction (and their dependencies) in the mempool older than time. Return the number of removed transactions. */
     int Expire(std::chrono::seconds time) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
@@ -761,6 +776,17 @@ private:
     void UpdateForRemoveFromMempool(const setEntries &entriesToRemove, bool updateDescendants) EXCLUSIVE_LOCKS_REQUIRED(cs);
     /** Sever link between specified transaction and direct children. */
     void UpdateChildrenForRemoval(txiter entry) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    /** Call fn for each in-mempool descendant (or ancestor) of entry, not
+     *  including entry itself. stack is scratch space that is reused across
+     *  calls to avoid allocations. */
+    template <typename Fn>
+    void ForEachRelative(txiter entry, bool descendants, std::vector<txiter>& stack, Fn&& fn) EXCLUSIVE_LOCKS_REQUIRED(cs) LOCKS_EXCLUDED(m_epoch);
+    /** Evict the packages with the lowest descendant score, in the order
+     *  TrimToSize picks them, while it is certain that the memory usage
+     *  released so far does not cover deficit. Returns the number of
+     *  evicted transactions. */
+    unsigned int EvictPackages(size_t deficit, CFeeRate& max_removed, std::vector<COutPoint>* no_spends_remaining) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    EvictionStats m_eviction_stats GUARDED_BY(cs);
 
     /** Before calling removeUnchecked for a given transaction,
      *  UpdateForRemoveFromMempool must be called on the entire (dependent) set
@@ -59,6 +59,7 @@
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
 #include <util/string.h>
+#include <util/thread.h>
 #include <util/time.h>
 #include <util/trace.h>
 #include <util/translation.h>
@@ -67,13 +68,16 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <deque>
 #include <numeric>
 #include <optional>
 #include <ranges>
 #include <span>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <unordered_set>
 #include <utility>
 
 using kernel::CCoinsStats;
@@ -832,12 +836,22 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
     m_view.SetBackend(m_viewmempool);
 
     const CCoinsViewCache& coins_cache = m_active_chainstate.CoinsTip();
-    // do all inputs exist?
+    // Load the coins spent by this tx that are not cached yet in one batch.
+    // This adds them to the coins cache (coins_cache.cacheCoins), so they are
+    // recorded in coins_to_uncache first, to be removed later if this tx
+    // turns out to be invalid. Outputs of mempool transactions are found by
+    // m_viewmempool rather than in the database, so leave them out.
+    std::vector<COutPoint> prevouts;
     for (const CTxIn& txin : tx.vin) {
         if (!coins_cache.HaveCoinInCache(txin.prevout)) {
             coins_to_uncache.push_back(txin.prevout);
+            if (!m_pool.exists(GenTxid::Txid(txin.prevout.hash))) prevouts.push_back(txin.prevout);
         }
+    }
+    coins_cache.PrefetchCoins(prevouts);
 
+    // do all inputs exist?
+    for (const CTxIn& txin : tx.vin) {
         // Note: this call may add txin.prevout to the coins cache
         // (coins_cache.cacheCoins) by way of FetchCoin(). It should be removed
         // later (via coins_to_uncache) if this tx turns out to be invalid.
@@ -1729,11 +1743,15 @@ PackageMempoolAcceptResult MemPoolAccept::AcceptPackage(const Package& package,
         // Since this check can bring new coins into the coins cache, keep track of these coins and
         // uncache them if we don't end up submitting this package to the mempool.
         const CCoinsViewCache& coins_tip_cache = m_active_chainstate.CoinsTip();
+        std::vector<COutPoint> confirmed_prevouts;
         for (const auto& input : child->vin) {
             if (!coins_tip_cache.HaveCoinInCache(input.prevout)) {
                 args.m_coins_to_uncache.push_back(input.prevout);
+                if (!unconfirmed_parent_txids.contains(input.prevout.hash)) confirmed_prevouts.push_back(input.prevout);
             }
         }
+        // Look up the coins that must be confirmed in one batch.
+        coins_tip_cache.PrefetchCoins(confirmed_prevouts);
         // Using the MemPoolAccept m_view cache allows us to look up these same coins faster later.
         // This should be connecting directly to CoinsTip, not to m_viewmempool, because we specifically
         // require inputs to be confirmed if they aren't in the package.
@@ -2603,6 +2621,23 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
              Ticks<SecondsDouble>(m_chainman.time_forks),
              Ticks<MillisecondsDouble>(m_chainman.time_forks) / m_chainman.num_blocks_total);
 
+    // Load the coins spent by this block in one batch rather than with one
+    // database lookup per input as each is first accessed. Outputs created
+    // within the block cannot be in the database, so leave them out.
+    {
+        std::unordered_set<Txid, SaltedTxidHasher> block_txids;
+        block_txids.reserve(block.vtx.size());
+        for (const auto& tx : block.vtx) block_txids.insert(tx->GetHash());
+        std::vector<COutPoint> prevouts;
+        for (const auto& tx : block.vtx) {
+            if (tx->IsCoinBase()) continue;
+            for (const CTxIn& txin : tx->vin) {
+                if (!block_txids.contains(txin.prevout.hash)) prevouts.push_back(txin.prevout);
+            }
+        }
+        view.PrefetchCoins(prevouts);
+    }
+
     CBlockUndo blockundo;
 
     // Precomputed transaction data pointers must not be invalidated
@@ -3223,6 +3258,8 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
     const auto time_6{SteadyClock::now()};
     m_chainman.time_post_connect += time_6 - time_5;
     m_chainman.time_total += time_6 - time_1;
+    ++m_blocks_connected;
+    m_time_blocks_connected += time_6 - time_1;
     LogDebug(BCLog::BENCH, "  - Connect postprocess: %.2fms [%.2fs (%.2fms/blk)]\n",
              Ticks<MillisecondsDouble>(time_6 - time_5),
              Ticks<SecondsDouble>(m_chainman.time_post_connect),
@@ -4704,6 +4741,54 @@ bool Chainstate::LoadChainTip()
     return true;
 }
 
+namespace {
+/**
+ * Reads a block for CVerifyDB and runs the checks up to level 2 on it: CheckBlock() and reading
+ * its undo data. These do not depend on the chainstate, so they run on several blocks at once.
+ */
+class VerifyDBBlockCheck
+{
+private:
+    const BlockManager* m_blockman;
+    const Consensus::Params* m_consensus_params;
+    int m_check_level;
+    int m_height;
+    uint256 m_hash;
+    uint256 m_prev_hash;
+    FlatFilePos m_block_pos;
+    FlatFilePos m_undo_pos;
+    CBlock* m_block;
+
+public:
+    VerifyDBBlockCheck(const BlockManager& blockman, const Consensus::Params& consensus_params, int check_level, const CBlockIndex& index, CBlock& block)
+        EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
+        : m_blockman{&blockman}, m_consensus_params{&consensus_params}, m_check_level{check_level}, m_height{index.nHeight},
+          m_hash{index.GetBlockHash()}, m_prev_hash{index.pprev->GetBlockHash()},
+          m_block_pos{index.GetBlockPos()}, m_undo_pos{index.GetUndoPos()}, m_block{&block} {}
+
+    std::optional<std::string> operator()()
+    {
+        // check level 0: read from disk
+        if (!m_blockman->ReadBlock(*m_block, m_block_pos, m_hash)) {
+            return strprintf("ReadBlock failed at %d, hash=%s", m_height, m_hash.ToString());
+        }
+        // check level 1: verify block validity
+        BlockValidationState state;
+        if (m_check_level >= 1 && !CheckBlock(*m_block, state, *m_consensus_params)) {
+            return strprintf("found bad block at %d, hash=%s (%s)", m_height, m_hash.ToString(), state.ToString());
+        }
+        // check level 2: verify undo validity
+        if (m_check_level >= 2 && !m_undo_pos.IsNull()) {
+            CBlockUndo undo;
+            if (!m_blockman->ReadBlockUndo(undo, m_undo_pos, m_prev_hash)) {
+                return strprintf("found bad undo data at %d, hash=%s", m_height, m_hash.ToString());
+            }
+        }
+        return std::nullopt;
+    }
+};
+} // namespace
+
 CVerifyDB::CVerifyDB(Notifications& notifications)
     : m_notifications{notifications}
 {
@@ -4745,68 +4830,86 @@ VerifyDBResult CVerifyDB::VerifyDB(
 
     const bool is_snapshot_cs{chainstate.m_from_snapshot_blockhash};
 
-    for (pindex = chainstate.m_chain.Tip(); pindex && pindex->pprev; pindex = pindex->pprev) {
-        const int percentageDone = std::max(1, std::min(99, (int)(((double)(chainstate.m_chain.Height() - pindex->nHeight)) / (double)nCheckDepth * (nCheckLevel >= 4 ? 50 : 100))));
-        if (reportDone < percentageDone / 10) {
-            // report every 10% step
-            LogPrintf("Verification progress: %d%%\n", percentageDone);
-            reportDone = percentageDone / 10;
-        }
-        m_notifications.progress(_("Verifying blocks…"), percentageDone, false);
-        if (pindex->nHeight <= chainstate.m_chain.Height() - nCheckDepth) {
-            break;
-        }
-        if ((chainstate.m_blockman.IsPruneMode() || is_snapshot_cs) && !(pindex->nStatus & BLOCK_HAVE_DATA)) {
-            // If pruning or running under an assumeutxo snapshot, only go
-            // back as far as we have data.
-            LogPrintf("VerifyDB(): block verification stopping at height %d (no data). This could be due to pruning or use of an assumeutxo snapshot.\n", pindex->nHeight);
-            skipped_no_block_data = true;
-            break;
-        }
-        CBlock block;
-        // check level 0: read from disk
-        if (!chainstate.m_blockman.ReadBlock(block, *pindex)) {
-            LogPrintf("Verification error: ReadBlock failed at %d, hash=%s\n", pindex->nHeight, pindex->GetBlockHash().ToString());
-            return VerifyDBResult::CORRUPTED_BLOCK_DB;
+    // Blocks are read and checked up to level 2 in batches of one per thread, which bounds the
+    // memory used. Levels 3 and 4 then process each batch in chain order.
+    const int worker_threads{std::clamp(chainstate.m_chainman.m_options.worker_threads_num, 0, MAX_SCRIPTCHECK_THREADS)};
+    CCheckQueue<VerifyDBBlockCheck> block_check_queue{/*batch_size=*/1, worker_threads, "verifydb"};
+    std::vector<CBlock> blocks(worker_threads + 1);
+    std::vector<CBlockIndex*> batch;
+    const auto read_batch{[&](int check_level) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+        CCheckQueueControl<VerifyDBBlockCheck> control(block_check_queue);
+        std::vector<VerifyDBBlockCheck> checks;
+        checks.reserve(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            checks.emplace_back(chainstate.m_blockman, consensus_params, check_level, *batch[i], blocks[i]);
+        }
+        control.Add(std::move(checks));
+        return control.Complete();
+    }};
+    SteadyClock::duration time_check{}, time_disconnect{}, time_reconnect{};
+
+    pindex = chainstate.m_chain.Tip();
+    for (bool done{false}; !done;) {
+        batch.clear();
+        for (; pindex && pindex->pprev && batch.size() < blocks.size(); pindex = pindex->pprev) {
+            if (pindex->nHeight <= chainstate.m_chain.Height() - nCheckDepth) {
+                done = true;
+                break;
+            }
+            if ((chainstate.m_blockman.IsPruneMode() || is_snapshot_cs) && !(pindex->nStatus & BLOCK_HAVE_DATA)) {
+                // If pruning or running under an assumeutxo snapshot, only go
+                // back as far as we have data.
+                LogPrintf("VerifyDB(): block verification stopping at height %d (no data). This could be due to pruning or use of an assumeutxo snapshot.\n", pindex->nHeight);
+                skipped_no_block_data = true;
+                done = true;
+                break;
+            }
+            batch.push_back(pindex);
         }
-        // check level 1: verify block validity
-        if (nCheckLevel >= 1 && !CheckBlock(block, state, consensus_params)) {
-            LogPrintf("Verification error: found bad block at %d, hash=%s (%s)\n",
-                      pindex->nHeight, pindex->GetBlockHash().ToString(), state.ToString());
+        if (batch.empty()) break;
+
+        // check levels 0-2: read blocks and undo data, and verify their validity
+        const auto time_start{SteadyClock::now()};
+        if (const auto error{read_batch(nCheckLevel)}) {
+            LogPrintf("Verification error: %s\n", *error);
             return VerifyDBResult::CORRUPTED_BLOCK_DB;
         }
-        // check level 2: verify undo validity
-        if (nCheckLevel >= 2 && pindex) {
-            CBlockUndo undo;
-            if (!pindex->GetUndoPos().IsNull()) {
-                if (!chainstate.m_blockman.ReadBlockUndo(undo, *pindex)) {
-                    LogPrintf("Verification error: found bad undo data at %d, hash=%s\n", pindex->nHeight, pindex->GetBlockHash().ToString());
-                    return VerifyDBResult::CORRUPTED_BLOCK_DB;
-                }
-            }
-        }
-        // check level 3: check for inconsistencies during memory-only disconnect of tip blocks
-        size_t curr_coins_usage = coins.DynamicMemoryUsage() + chainstate.CoinsTip().DynamicMemoryUsage();
+        time_check += SteadyClock::now() - time_start;
 
-        if (nCheckLevel >= 3) {
-            if (curr_coins_usage <= chainstate.m_coinstip_cache_size_bytes) {
-                assert(coins.GetBestBlock() == pindex->GetBlockHash());
-                DisconnectResult res = chainstate.DisconnectBlock(block, pindex, coins);
-                if (res == DISCONNECT_FAILED) {
-                    LogPrintf("Verification error: irrecoverable inconsistency in block data at %d, hash=%s\n", pindex->nHeight, pindex->GetBlockHash().ToString());
-                    return VerifyDBResult::CORRUPTED_BLOCK_DB;
-                }
-                if (res == DISCONNECT_UNCLEAN) {
-                    nGoodTransactions = 0;
-                    pindexFailure = pindex;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            CBlockIndex* const index{batch[i]};
+            const int percentageDone = std::max(1, std::min(99, (int)(((double)(chainstate.m_chain.Height() - index->nHeight)) / (double)nCheckDepth * (nCheckLevel >= 4 ? 50 : 100))));
+            if (reportDone < percentageDone / 10) {
+                // report every 10% step
+                LogPrintf("Verification progress: %d%%\n", percentageDone);
+                reportDone = percentageDone / 10;
+            }
+            m_notifications.progress(_("Verifying blocks…"), percentageDone, false);
+            // check level 3: check for inconsistencies during memory-only disconnect of tip blocks
+            size_t curr_coins_usage = coins.DynamicMemoryUsage() + chainstate.CoinsTip().DynamicMemoryUsage();
+
+            if (nCheckLevel >= 3) {
+                if (curr_coins_usage <= chainstate.m_coinstip_cache_size_bytes) {
+                    const auto time_disconnect_start{SteadyClock::now()};
+                    assert(coins.GetBestBlock() == index->GetBlockHash());
+                    DisconnectResult res = chainstate.DisconnectBlock(blocks[i], index, coins);
+                    if (res == DISCONNECT_FAILED) {
+                        LogPrintf("Verification error: irrecoverable inconsistency in block data at %d, hash=%s\n", index->nHeight, index->GetBlockHash().ToString());
+                        return VerifyDBResult::CORRUPTED_BLOCK_DB;
+                    }
+                    if (res == DISCONNECT_UNCLEAN) {
+                        nGoodTransactions = 0;
+                        pindexFailure = index;
+                    } else {
+                        nGoodTransactions += blocks[i].vtx.size();
+                    }
+                    time_disconnect += SteadyClock::now() - time_disconnect_start;
                 } else {
-                    nGoodTransactions += block.vtx.size();
+                    skipped_l3_checks = true;
                 }
-            } else {
-                skipped_l3_checks = true;
             }
+            if (chainstate.m_chainman.m_interrupt) return VerifyDBResult::INTERRUPTED;
         }
-        if (chainstate.m_chainman.m_interrupt) return VerifyDBResult::INTERRUPTED;
     }
     if (pindexFailure) {
         LogPrintf("Verification error: coin database inconsistencies found (last %i blocks, %i good transactions before that)\n", chainstate.m_chain.Height() - pindexFailure->nHeight + 1, nGoodTransactions);
@@ -4819,31 +4922,42 @@ VerifyDBResult CVerifyDB::VerifyDB(
     // store block count as we move pindex at check level >= 4
     int block_count = chainstate.m_chain.Height() - pindex->nHeight;
 
-    // check level 4: try reconnecting blocks
+    // check level 4: try reconnecting blocks. ConnectBlock() hands script checks to the
+    // chainstate's script check queue; blocks are read ahead a batch at a time.
     if (nCheckLevel >= 4 && !skipped_l3_checks) {
+        const auto time_reconnect_start{SteadyClock::now()};
         while (pindex != chainstate.m_chain.Tip()) {
-            const int percentageDone = std::max(1, std::min(99, 100 - (int)(((double)(chainstate.m_chain.Height() - pindex->nHeight)) / (double)nCheckDepth * 50)));
-            if (reportDone < percentageDone / 10) {
-                // report every 10% step
-                LogPrintf("Verification progress: %d%%\n", percentageDone);
-                reportDone = percentageDone / 10;
+            batch.clear();
+            for (CBlockIndex* next{pindex}; next != chainstate.m_chain.Tip() && batch.size() < blocks.size();) {
+                next = chainstate.m_chain.Next(next);
+                batch.push_back(next);
             }
-            m_notifications.progress(_("Verifying blocks…"), percentageDone, false);
-            pindex = chainstate.m_chain.Next(pindex);
-            CBlock block;
-            if (!chainstate.m_blockman.ReadBlock(block, *pindex)) {
-                LogPrintf("Verification error: ReadBlock failed at %d, hash=%s\n", pindex->nHeight, pindex->GetBlockHash().ToString());
+            if (const auto error{read_batch(/*check_level=*/0)}) {
+                LogPrintf("Verification error: %s\n", *error);
                 return VerifyDBResult::CORRUPTED_BLOCK_DB;
             }
-            if (!chainstate.ConnectBlock(block, state, pindex, coins)) {
-                LogPrintf("Verification error: found unconnectable block at %d, hash=%s (%s)\n", pindex->nHeight, pindex->GetBlockHash().ToString(), state.ToString());
-                return VerifyDBResult::CORRUPTED_BLOCK_DB;
+            for (size_t i = 0; i < batch.size(); ++i) {
+                pindex = batch[i];
+                const int percentageDone = std::max(1, std::min(99, 100 - (int)(((double)(chainstate.m_chain.Height() - pindex->nHeight)) / (double)nCheckDepth * 50)));
+                if (reportDone < percentageDone / 10) {
+                    // report every 10% step
+                    LogPrintf("Verification progress: %d%%\n", percentageDone);
+                    reportDone = percentageDone / 10;
+                }
+                m_notifications.progress(_("Verifying blocks…"), percentageDone, false);
+                if (!chainstate.ConnectBlock(blocks[i], state, pindex, coins)) {
+                    LogPrintf("Verification error: found unconnectable block at %d, hash=%s (%s)\n", pindex->nHeight, pindex->GetBlockHash().ToString(), state.ToString());
+                    return VerifyDBResult::CORRUPTED_BLOCK_DB;
+                }
+                if (chainstate.m_chainman.m_interrupt) return VerifyDBResult::INTERRUPTED;
             }
-            if (chainstate.m_chainman.m_interrupt) return VerifyDBResult::INTERRUPTED;
         }
+        time_reconnect = SteadyClock::now() - time_reconnect_start;
     }
 
     LogPrintf("Verification: No coin database inconsistencies in last %i blocks (%i transactions)\n", block_count, nGoodTransactions);
+    LogPrintf("Verification time: %.2fs reading and checking blocks (levels 0-2, %i threads), %.2fs disconnecting (level 3), %.2fs reconnecting (level 4)\n",
+              Ticks<SecondsDouble>(time_check), worker_threads + 1, Ticks<SecondsDouble>(time_disconnect), Ticks<SecondsDouble>(time_reconnect));
 
     if (skipped_l3_checks) {
         return VerifyDBResult::SKIPPED_L3_CHECKS;
@@ -5868,6 +5982,153 @@ static void SnapshotUTXOHashBreakpoint(const util::SignalInterrupt& interrupt)
     if (interrupt) throw StopHashingException();
 }
 
+namespace {
+//! A batch of coins deserialized from a UTXO snapshot file, in file order.
+using SnapshotCoinsBatch = std::vector<std::pair<COutPoint, Coin>>;
+
+/**
+ * Reads and sanity-checks the coins of a UTXO snapshot on a dedicated thread,
+ * handing them to the loading thread in bounded batches.
+ *
+ * Deserializing QBTC coins (with their large Dilithium scripts) is a sizeable
+ * share of snapshot load time, so this lets it overlap with inserting into and
+ * flushing the snapshot chainstate's coins cache.
+ */
+class SnapshotCoinsReader
+{
+    //! Coins per batch. Small enough that a queue of Dilithium-sized coins
+    //! stays within a few tens of MB.
+    static constexpr size_t BATCH_SIZE{4096};
+    //! Batches which may be decoded ahead of the loading thread.
+    static constexpr size_t MAX_QUEUED_BATCHES{4};
+
+    AutoFile& m_file;
+    const uint64_t m_coins_count;
+    const int m_base_height;
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<SnapshotCoinsBatch> m_batches GUARDED_BY(m_mutex);
+    std::optional<bilingual_str> m_error GUARDED_BY(m_mutex);
+    bool m_done GUARDED_BY(m_mutex){false};
+    bool m_stop GUARDED_BY(m_mutex){false};
+
+    std::thread m_thread;
+
+    //! Queue a batch for the loading thread. Returns false if the reader should stop.
+    bool Push(SnapshotCoinsBatch&& batch) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || m_batches.size() < MAX_QUEUED_BATCHES; });
+        if (m_stop) return false;
+        m_batches.push_back(std::move(batch));
+        m_cv.notify_all();
+        return true;
+    }
+
+    void Finish(std::optional<bilingual_str> error) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        m_error = std::move(error);
+        m_done = true;
+        m_cv.notify_all();
+    }
+
+    void ThreadRead() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        uint64_t coins_left{m_coins_count};
+        uint64_t coins_read{0};
+        SnapshotCoinsBatch batch;
+        batch.reserve(BATCH_SIZE);
+
+        try {
+            while (coins_left > 0) {
+                Txid txid;
+                m_file >> txid;
+                size_t coins_per_txid{0};
+                coins_per_txid = ReadCompactSize(m_file);
+
+                if (coins_per_txid > coins_left) {
+                    return Finish(Untranslated("Mismatch in coins count in snapshot metadata and actual snapshot data"));
+                }
+
+                for (size_t i = 0; i < coins_per_txid; i++) {
+                    COutPoint outpoint;
+                    Coin coin;
+                    outpoint.n = static_cast<uint32_t>(ReadCompactSize(m_file));
+                    outpoint.hash = txid;
+                    m_file >> coin;
+                    if (coin.nHeight > m_base_height ||
+                        outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
+                    ) {
+                        return Finish(Untranslated(strprintf("Bad snapshot data after deserializing %d coins",
+                                  m_coins_count - coins_left)));
+                    }
+                    if (!MoneyRange(coin.out.nValue)) {
+                        return Finish(Untranslated(strprintf("Bad snapshot data after deserializing %d coins - bad tx out value",
+                                  m_coins_count - coins_left)));
+                    }
+                    batch.emplace_back(std::move(outpoint), std::move(coin));
+
+                    --coins_left;
+                    ++coins_read;
+
+                    if (batch.size() == BATCH_SIZE || coins_left == 0) {
+                        if (!Push(std::move(batch))) return Finish(std::nullopt);
+                        batch = {};
+                        batch.reserve(BATCH_SIZE);
+                    }
+                }
+            }
+        } catch (const std::ios_base::failure&) {
+            return Finish(Untranslated(strprintf("Bad snapshot format or truncated snapshot after deserializing %d coins",
+                      coins_read)));
+        } catch (const std::exception& e) {
+            // Anything else escaping this thread would terminate the node, so
+            // fail the load instead.
+            return Finish(Untranslated(strprintf("Failed to read snapshot after deserializing %d coins: %s",
+                      coins_read, e.what())));
+        }
+        Finish(std::nullopt);
+    }
+
+public:
+    SnapshotCoinsReader(AutoFile& coins_file, uint64_t coins_count, int base_height)
+        : m_file{coins_file}, m_coins_count{coins_count}, m_base_height{base_height}
+    {
+        m_thread = std::thread(&util::TraceThread, "snapshotread", [this] { ThreadRead(); });
+    }
+
+    ~SnapshotCoinsReader()
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    //! Block until the next batch of coins is available. An empty batch means
+    //! the reader is done, either because all coins were read or because of an
+    //! error (see GetError()).
+    SnapshotCoinsBatch Next() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_done || !m_batches.empty(); });
+        if (m_batches.empty()) return {};
+        SnapshotCoinsBatch batch{std::move(m_batches.front())};
+        m_batches.pop_front();
+        m_cv.notify_all();
+        return batch;
+    }
+
+    //! The reason reading stopped early, if any. Only meaningful once Next()
+    //! returned an empty batch.
+    std::optional<bilingual_str> GetError() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        return WITH_LOCK(m_mutex, return m_error);
+    }
+};
+} // namespace
+
 util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
     Chainstate& snapshot_chainstate,
     AutoFile& coins_file,
@@ -5906,41 +6167,17 @@ util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
     }
 
     const uint64_t coins_count = metadata.m_coins_count;
-    uint64_t coins_left = metadata.m_coins_count;
 
-    LogPrintf("[snapshot] loading %d coins from snapshot %s\n", coins_left, base_blockhash.ToString());
+    LogPrintf("[snapshot] loading %d coins from snapshot %s\n", coins_count, base_blockhash.ToString());
     int64_t coins_processed{0};
 
-    while (coins_left > 0) {
-        try {
-            Txid txid;
-            coins_file >> txid;
-            size_t coins_per_txid{0};
-            coins_per_txid = ReadCompactSize(coins_file);
-
-            if (coins_per_txid > coins_left) {
-                return util::Error{Untranslated("Mismatch in coins count in snapshot metadata and actual snapshot data")};
-            }
+    {
+        SnapshotCoinsReader reader{coins_file, coins_count, base_height};
 
-            for (size_t i = 0; i < coins_per_txid; i++) {
-                COutPoint outpoint;
-                Coin coin;
-                outpoint.n = static_cast<uint32_t>(ReadCompactSize(coins_file));
-                outpoint.hash = txid;
-                coins_file >> coin;
-                if (coin.nHeight > base_height ||
-                    outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
-                ) {
-                    return util::Error{Untranslated(strprintf("Bad snapshot data after deserializing %d coins",
-                              coins_count - coins_left))};
-                }
-                if (!MoneyRange(coin.out.nValue)) {
-                    return util::Error{Untranslated(strprintf("Bad snapshot data after deserializing %d coins - bad tx out value",
-                              coins_count - coins_left))};
-                }
+        for (SnapshotCoinsBatch batch{reader.Next()}; !batch.empty(); batch = reader.Next()) {
+            for (auto& [outpoint, coin] : batch) {
                 coins_cache.EmplaceCoinInternalDANGER(std::move(outpoint), std::move(coin));
 
-                --coins_left;
                 ++coins_processed;
 
                 if (coins_processed % 1000000 == 0) {
@@ -5973,11 +6210,13 @@ util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
                     }
                 }
             }
-        } catch (const std::ios_base::failure&) {
-            return util::Error{Untranslated(strprintf("Bad snapshot format or truncated snapshot after deserializing %d coins",
-                      coins_processed))};
+        }
+
+        if (auto error{reader.GetError()}) {
+            return util::Error{std::move(*error)};
         }
     }
+    assert(static_cast<uint64_t>(coins_processed) == coins_count);
 
     // Important that we set this. This and the coins_cache accesses above are
     // sort of a layer violation, but either we reach into the innards of
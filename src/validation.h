@@ -650,6 +650,11 @@ public:
     //! The cache size of the in-memory coins view.
     size_t m_coinstip_cache_size_bytes{0};
 
+    //! Number of blocks connected to this chainstate since startup, and the
+    //! time spent connecting them. Reported as throughput by getchainstates.
+    int64_t m_blocks_connected GUARDED_BY(::cs_main){0};
+    SteadyClock::duration m_time_blocks_connected GUARDED_BY(::cs_main){};
+
     //! Resize the CoinsViews caches dynamically and flush state to disk.
     //! @returns true unless an error occurred during the flush.
     bool ResizeCoinsCaches(size_t coinstip_size, size_t coinsdb_size)
@@ -15,102 +15,272 @@
 #include <primitives/transaction.h>
 #include <util/check.h>
 #include <util/task_runner.h>
+#include <util/time.h>
 
+#include <algorithm>
+#include <atomic>
 #include <future>
-#include <unordered_map>
+#include <string>
 #include <utility>
 
 /**
- * ValidationSignalsImpl manages a list of shared_ptr<CValidationInterface> callbacks.
+ * ValidationSignalsImpl manages the registered CValidationInterface callbacks.
  *
- * A std::unordered_map is used to track what callbacks are currently
- * registered, and a std::list is used to store the callbacks that are
- * currently registered as well as any callbacks that are just unregistered
- * and about to be deleted when they are done executing.
+ * Every subscriber has its own ordered queue of background callbacks, on its
+ * own task runner if a task runner factory was given and on the shared task
+ * runner otherwise. A subscriber that is unregistered while callbacks are
+ * still queued for it is kept around until they have run (as no-ops). Its
+ * task runner is then kept for reuse by the next subscriber, as it may still
+ * be finishing the last callback.
  */
 class ValidationSignalsImpl
 {
 private:
+    struct Subscriber {
+        //! Reset on unregistration. Queued callbacks hold their own reference,
+        //! so that the subscriber is destroyed after they have run.
+        std::shared_ptr<CValidationInterface> callbacks;
+        const std::string name;
+        std::unique_ptr<util::TaskRunnerInterface> task_runner;
+        std::atomic<bool> registered{true};
+        std::atomic<size_t> pending{0};
+        std::atomic<size_t> max_pending{0};
+        std::atomic<uint64_t> delivered{0};
+        std::atomic<int64_t> total_wait_us{0};
+        std::atomic<int64_t> max_wait_us{0};
+        std::atomic<int64_t> total_run_us{0};
+
+        Subscriber(std::shared_ptr<CValidationInterface> callbacks_in, std::string name_in, std::unique_ptr<util::TaskRunnerInterface> task_runner_in)
+            : callbacks{std::move(callbacks_in)}, name{std::move(name_in)}, task_runner{std::move(task_runner_in)} {}
+    };
+
+    static void UpdateMax(std::atomic<size_t>& max, size_t value)
+    {
+        size_t prev{max.load(std::memory_order_relaxed)};
+        while (prev < value && !max.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {}
+    }
+
+    static void UpdateMax(std::atomic<int64_t>& max, int64_t value)
+    {
+        int64_t prev{max.load(std::memory_order_relaxed)};
+        while (prev < value && !max.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {}
+    }
+
     Mutex m_mutex;
-    //! List entries consist of a callback pointer and reference count. The
-    //! count is equal to the number of current executions of that entry, plus 1
-    //! if it's registered. It cannot be 0 because that would imply it is
-    //! unregistered and also not being executed (so shouldn't exist).
-    struct ListEntry { std::shared_ptr<CValidationInterface> callbacks; int count = 1; };
-    std::list<ListEntry> m_list GUARDED_BY(m_mutex);
-    std::unordered_map<CValidationInterface*, std::list<ListEntry>::iterator> m_map GUARDED_BY(m_mutex);
+    //! Registered subscribers, in registration order
+    std::vector<std::unique_ptr<Subscriber>> m_subscribers GUARDED_BY(m_mutex);
+    //! Unregistered subscribers with callbacks still queued, see class comment
+    std::vector<std::unique_ptr<Subscriber>> m_retired GUARDED_BY(m_mutex);
+    //! Task runners of pruned subscribers, see class comment
+    std::vector<std::unique_ptr<util::TaskRunnerInterface>> m_idle_runners GUARDED_BY(m_mutex);
+    const ValidationSignals::TaskRunnerFactory m_make_task_runner;
+
+    util::TaskRunnerInterface& TaskRunner(Subscriber& sub) { return sub.task_runner ? *sub.task_runner : *m_task_runner; }
+
+    void Retire(std::vector<std::unique_ptr<Subscriber>>::iterator it) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        (*it)->registered = false;
+        (*it)->callbacks.reset();
+        m_retired.push_back(std::move(*it));
+        m_subscribers.erase(it);
+        PruneRetired();
+    }
+
+    //! Append the task runners of all subscribers, registered or not. Task
+    //! runners are only destroyed with this object.
+    void CollectTaskRunners(std::vector<util::TaskRunnerInterface*>& runners) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        for (const auto* subs : {&m_subscribers, &m_retired}) {
+            for (const auto& sub : *subs) {
+                if (sub->task_runner) runners.push_back(sub->task_runner.get());
+            }
+        }
+        for (const auto& runner : m_idle_runners) runners.push_back(runner.get());
+    }
+
+    void PruneRetired() EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        // pending is only increased under m_mutex while registered, so it
+        // stays at zero once it got there.
+        std::erase_if(m_retired, [&](auto& sub) {
+            if (sub->pending > 0) return false;
+            if (sub->task_runner) m_idle_runners.push_back(std::move(sub->task_runner));
+            return true;
+        });
+    }
 
 public:
-    std::unique_ptr<util::TaskRunnerInterface> m_task_runner;
+    const std::unique_ptr<util::TaskRunnerInterface> m_task_runner;
 
-    explicit ValidationSignalsImpl(std::unique_ptr<util::TaskRunnerInterface> task_runner)
-        : m_task_runner{std::move(Assert(task_runner))} {}
+    ValidationSignalsImpl(std::unique_ptr<util::TaskRunnerInterface> task_runner, ValidationSignals::TaskRunnerFactory make_task_runner)
+        : m_make_task_runner{std::move(make_task_runner)}, m_task_runner{std::move(Assert(task_runner))} {}
 
-    void Register(std::shared_ptr<CValidationInterface> callbacks) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    void Register(std::shared_ptr<CValidationInterface> callbacks, std::string name) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
         LOCK(m_mutex);
-        auto inserted = m_map.emplace(callbacks.get(), m_list.end());
-        if (inserted.second) inserted.first->second = m_list.emplace(m_list.end());
-        inserted.first->second->callbacks = std::move(callbacks);
+        for (const auto& sub : m_subscribers) {
+            if (sub->callbacks.get() == callbacks.get()) {
+                sub->callbacks = std::move(callbacks);
+                return;
+            }
+        }
+        std::unique_ptr<util::TaskRunnerInterface> task_runner;
+        if (m_make_task_runner) {
+            PruneRetired();
+            if (m_idle_runners.empty()) {
+                task_runner = Assert(m_make_task_runner());
+            } else {
+                task_runner = std::move(m_idle_runners.back());
+                m_idle_runners.pop_back();
+            }
+        }
+        m_subscribers.push_back(std::make_unique<Subscriber>(std::move(callbacks), std::move(name), std::move(task_runner)));
     }
 
     void Unregister(CValidationInterface* callbacks) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
         LOCK(m_mutex);
-        auto it = m_map.find(callbacks);
-        if (it != m_map.end()) {
-            if (!--it->second->count) m_list.erase(it->second);
-            m_map.erase(it);
-        }
+        auto it = std::find_if(m_subscribers.begin(), m_subscribers.end(), [&](const auto& sub) { return sub->callbacks.get() == callbacks; });
+        if (it != m_subscribers.end()) Retire(it);
     }
 
-    //! Clear unregisters every previously registered callback, erasing every
-    //! map entry. After this call, the list may still contain callbacks that
-    //! are currently executing, but it will be cleared when they are done
-    //! executing.
+    //! Clear unregisters every previously registered callback. Callbacks that
+    //! are currently executing or queued keep their subscriber alive until
+    //! they are done.
     void Clear() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
         LOCK(m_mutex);
-        for (const auto& entry : m_map) {
-            if (!--entry.second->count) m_list.erase(entry.second);
-        }
-        m_map.clear();
+        while (!m_subscribers.empty()) Retire(std::prev(m_subscribers.end()));
     }
 
+    //! Call f synchronously for every registered subscriber.
     template<typename F> void Iterate(F&& f) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
-        WAIT_LOCK(m_mutex, lock);
-        for (auto it = m_list.begin(); it != m_list.end();) {
-            ++it->count;
-            {
-                REVERSE_LOCK(lock);
-                f(*it->callbacks);
+        std::vector<std::shared_ptr<CValidationInterface>> callbacks;
+        {
+            LOCK(m_mutex);
+            callbacks.reserve(m_subscribers.size());
+            for (const auto& sub : m_subscribers) callbacks.push_back(sub->callbacks);
+        }
+        for (const auto& cb : callbacks) f(*cb);
+    }
+
+    //! Queue f for every registered subscriber, to be called on its task runner.
+    template<typename F> void Enqueue(F f) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        // Share the event, and whatever it captured, between all queues.
+        auto shared_f{std::make_shared<const F>(std::move(f))};
+        std::vector<std::pair<Subscriber*, std::shared_ptr<CValidationInterface>>> targets;
+        const auto queued{SteadyClock::now()};
+        {
+            LOCK(m_mutex);
+            targets.reserve(m_subscribers.size());
+            for (const auto& sub : m_subscribers) {
+                // Count the callback as pending before the subscriber can be
+                // unregistered, so that it is not pruned meanwhile.
+                UpdateMax(sub->max_pending, ++sub->pending);
+                targets.emplace_back(sub.get(), sub->callbacks);
             }
-            it = --it->count ? std::next(it) : m_list.erase(it);
         }
+        // Insert outside of m_mutex, as the task runner may run the callback
+        // right away.
+        for (auto& [sub, callbacks] : targets) {
+            TaskRunner(*sub).insert([sub, callbacks = std::move(callbacks), shared_f, queued] {
+                const auto start{SteadyClock::now()};
+                if (sub->registered) (*shared_f)(*callbacks);
+                const auto wait_us{Ticks<std::chrono::microseconds>(start - queued)};
+                sub->total_wait_us += wait_us;
+                UpdateMax(sub->max_wait_us, wait_us);
+                sub->total_run_us += Ticks<std::chrono::microseconds>(SteadyClock::now() - start);
+                ++sub->delivered;
+                --sub->pending;
+            });
+        }
+    }
+
+    //! Call func once every queue has run the callbacks queued before it.
+    void Barrier(std::function<void()> func) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        std::vector<util::TaskRunnerInterface*> runners{m_task_runner.get()};
+        {
+            LOCK(m_mutex);
+            // Unregistered subscribers may still be running a callback.
+            CollectTaskRunners(runners);
+        }
+        auto remaining{std::make_shared<std::atomic<size_t>>(runners.size())};
+        auto shared_func{std::make_shared<std::function<void()>>(std::move(func))};
+        for (auto* runner : runners) {
+            runner->insert([remaining, shared_func] {
+                if (--*remaining == 0) (*shared_func)();
+            });
+        }
+    }
+
+    void Flush() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        std::vector<util::TaskRunnerInterface*> runners;
+        {
+            LOCK(m_mutex);
+            CollectTaskRunners(runners);
+        }
+        for (auto* runner : runners) runner->flush();
+        m_task_runner->flush();
+    }
+
+    size_t MaxPending() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        size_t max_pending{0};
+        for (const auto& sub : m_subscribers) max_pending = std::max(max_pending, sub->pending.load());
+        return max_pending;
+    }
+
+    std::vector<ValidationSubscriberStats> Stats() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        std::vector<ValidationSubscriberStats> stats;
+        stats.reserve(m_subscribers.size());
+        for (const auto& sub : m_subscribers) {
+            stats.push_back({
+                .name = sub->name,
+                .pending = sub->pending,
+                .max_pending = sub->max_pending,
+                .delivered = sub->delivered,
+                .total_wait = std::chrono::microseconds{sub->total_wait_us},
+                .max_wait = std::chrono::microseconds{sub->max_wait_us},
+                .total_run = std::chrono::microseconds{sub->total_run_us},
+            });
+        }
+        return stats;
     }
 };
 
-ValidationSignals::ValidationSignals(std::unique_ptr<util::TaskRunnerInterface> task_runner)
-    : m_internals{std::make_unique<ValidationSignalsImpl>(std::move(task_runner))} {}
+ValidationSignals::ValidationSignals(std::unique_ptr<util::TaskRunnerInterface> task_runner, TaskRunnerFactory make_task_runner)
+    : m_internals{std::make_unique<ValidationSignalsImpl>(std::move(task_runner), std::move(make_task_runner))} {}
 
 ValidationSignals::~ValidationSignals() = default;
 
 void ValidationSignals::FlushBackgroundCallbacks()
 {
-    m_internals->m_task_runner->flush();
+    m_internals->Flush();
 }
 
 size_t ValidationSignals::CallbacksPending()
 {
-    return m_internals->m_task_runner->size();
+    return m_internals->MaxPending();
+}
+
+std::vector<ValidationSubscriberStats> ValidationSignals::GetSubscriberStats()
+{
+    return m_internals->Stats();
 }
 
 void ValidationSignals::RegisterSharedValidationInterface(std::shared_ptr<CValidationInterface> callbacks)
 {
     // Each connection captures the shared_ptr to ensure that each callback is
     // executed before the subscriber is destroyed. For more details see #18338.
-    m_internals->Register(std::move(callbacks));
+    auto name{callbacks->ValidationInterfaceName()};
+    m_internals->Register(std::move(callbacks), std::move(name));
 }
 
 void ValidationSignals::RegisterValidationInterface(CValidationInterface* callbacks)
@@ -137,7 +307,7 @@ void ValidationSignals::UnregisterAllValidationInterfaces()
 
 void ValidationSignals::CallFunctionInValidationInterfaceQueue(std::function<void()> func)
 {
-    m_internals->m_task_runner->insert(std::move(func));
+    m_internals->Barrier(std::move(func));
 }
 
 void ValidationSignals::SyncWithValidationInterfaceQueue()
@@ -159,9 +329,9 @@ void ValidationSignals::SyncWithValidationInterfaceQueue()
     do {                                                       \
         auto local_name = (name);                              \
         LOG_EVENT("Enqueuing " fmt, local_name, __VA_ARGS__);  \
-        m_internals->m_task_runner->insert([=] { \
+        m_internals->Enqueue([=](CValidationInterface& callbacks) { \
             LOG_EVENT(fmt, local_name, __VA_ARGS__);           \
-            event();                                           \
+            event(callbacks);                                  \
         });                                                    \
     } while (0)
 
@@ -173,8 +343,8 @@ void ValidationSignals::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlo
     // the chain actually updates. One way to ensure this is for the caller to invoke this signal
     // in the same critical section where the chain is updated
 
-    auto event = [pindexNew, pindexFork, fInitialDownload, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.UpdatedBlockTip(pindexNew, pindexFork, fInitialDownload); });
+    auto event = [pindexNew, pindexFork, fInitialDownload](CValidationInterface& callbacks) {
+        callbacks.UpdatedBlockTip(pindexNew, pindexFork, fInitialDownload);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: new block hash=%s fork block hash=%s (in IBD=%s)", __func__,
                           pindexNew->GetBlockHash().ToString(),
@@ -190,8 +360,8 @@ void ValidationSignals::ActiveTipChange(const CBlockIndex& new_tip, bool is_ibd)
 
 void ValidationSignals::TransactionAddedToMempool(const NewMempoolTransactionInfo& tx, uint64_t mempool_sequence)
 {
-    auto event = [tx, mempool_sequence, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.TransactionAddedToMempool(tx, mempool_sequence); });
+    auto event = [tx, mempool_sequence](CValidationInterface& callbacks) {
+        callbacks.TransactionAddedToMempool(tx, mempool_sequence);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: txid=%s wtxid=%s", __func__,
                           tx.info.m_tx->GetHash().ToString(),
@@ -199,8 +369,8 @@ void ValidationSignals::TransactionAddedToMempool(const NewMempoolTransactionInf
 }
 
 void ValidationSignals::TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence) {
-    auto event = [tx, reason, mempool_sequence, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.TransactionRemovedFromMempool(tx, reason, mempool_sequence); });
+    auto event = [tx, reason, mempool_sequence](CValidationInterface& callbacks) {
+        callbacks.TransactionRemovedFromMempool(tx, reason, mempool_sequence);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: txid=%s wtxid=%s reason=%s", __func__,
                           tx->GetHash().ToString(),
@@ -209,8 +379,8 @@ void ValidationSignals::TransactionRemovedFromMempool(const CTransactionRef& tx,
 }
 
 void ValidationSignals::BlockConnected(ChainstateRole role, const std::shared_ptr<const CBlock> &pblock, const CBlockIndex *pindex) {
-    auto event = [role, pblock, pindex, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.BlockConnected(role, pblock, pindex); });
+    auto event = [role, pblock, pindex](CValidationInterface& callbacks) {
+        callbacks.BlockConnected(role, pblock, pindex);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: block hash=%s block height=%d", __func__,
                           pblock->GetHash().ToString(),
@@ -219,8 +389,8 @@ void ValidationSignals::BlockConnected(ChainstateRole role, const std::shared_pt
 
 void ValidationSignals::MempoolTransactionsRemovedForBlock(const std::vector<RemovedMempoolTransactionInfo>& txs_removed_for_block, unsigned int nBlockHeight)
 {
-    auto event = [txs_removed_for_block, nBlockHeight, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.MempoolTransactionsRemovedForBlock(txs_removed_for_block, nBlockHeight); });
+    auto event = [txs_removed_for_block, nBlockHeight](CValidationInterface& callbacks) {
+        callbacks.MempoolTransactionsRemovedForBlock(txs_removed_for_block, nBlockHeight);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: block height=%s txs removed=%s", __func__,
                           nBlockHeight,
@@ -229,8 +399,8 @@ void ValidationSignals::MempoolTransactionsRemovedForBlock(const std::vector<Rem
 
 void ValidationSignals::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex)
 {
-    auto event = [pblock, pindex, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.BlockDisconnected(pblock, pindex); });
+    auto event = [pblock, pindex](CValidationInterface& callbacks) {
+        callbacks.BlockDisconnected(pblock, pindex);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: block hash=%s block height=%d", __func__,
                           pblock->GetHash().ToString(),
@@ -238,8 +408,8 @@ void ValidationSignals::BlockDisconnected(const std::shared_ptr<const CBlock>& p
 }
 
 void ValidationSignals::ChainStateFlushed(ChainstateRole role, const CBlockLocator &locator) {
-    auto event = [role, locator, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.ChainStateFlushed(role, locator); });
+    auto event = [role, locator](CValidationInterface& callbacks) {
+        callbacks.ChainStateFlushed(role, locator);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: block hash=%s", __func__,
                           locator.IsNull() ? "null" : locator.vHave.front().ToString());
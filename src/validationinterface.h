@@ -11,10 +11,12 @@
 #include <primitives/transaction.h>
 #include <sync.h>
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace util {
@@ -157,28 +159,56 @@ protected:
      * has been received and connected to the headers tree, though not validated yet.
      */
     virtual void NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& block) {};
+    /**
+     * Name of this subscriber, used to report the backlog of its callbacks.
+     */
+    virtual std::string ValidationInterfaceName() const { return "unnamed"; }
     friend class ValidationSignals;
     friend class ValidationInterfaceTest;
 };
 
+/** Callback backlog of one validation interface subscriber */
+struct ValidationSubscriberStats {
+    std::string name;
+    //! Callbacks queued and not run yet
+    size_t pending{0};
+    //! Most callbacks that were queued at once
+    size_t max_pending{0};
+    //! Callbacks run
+    uint64_t delivered{0};
+    //! Time callbacks were queued before running, in total and at most
+    std::chrono::microseconds total_wait{0};
+    std::chrono::microseconds max_wait{0};
+    //! Time spent running callbacks
+    std::chrono::microseconds total_run{0};
+};
+
 class ValidationSignalsImpl;
 class ValidationSignals {
 private:
     std::unique_ptr<ValidationSignalsImpl> m_internals;
 
 public:
+    using TaskRunnerFactory = std::function<std::unique_ptr<util::TaskRunnerInterface>()>;
+
     // The task runner will block validation if it calls its insert method's
-    // func argument synchronously. In this class func contains a loop that
-    // dispatches a single validation event to all subscribers sequentially.
-    explicit ValidationSignals(std::unique_ptr<util::TaskRunnerInterface> task_runner);
+    // func argument synchronously. Each validation event is queued once per
+    // subscriber. If make_task_runner is given, every subscriber gets its own
+    // task runner from it, so that a slow subscriber only holds back its own
+    // callbacks. Otherwise all subscribers share task_runner.
+    explicit ValidationSignals(std::unique_ptr<util::TaskRunnerInterface> task_runner, TaskRunnerFactory make_task_runner = {});
 
     ~ValidationSignals();
 
     /** Call any remaining callbacks on the calling thread */
     void FlushBackgroundCallbacks();
 
+    /** Largest number of callbacks queued for a single subscriber */
     size_t CallbacksPending();
 
+    /** Callback backlog of every registered subscriber, in registration order */
+    std::vector<ValidationSubscriberStats> GetSubscriberStats();
+
     /** Register subscriber */
     void RegisterValidationInterface(CValidationInterface* callbacks);
     /** Unregister subscriber. DEPRECATED. This is not safe to use when the RPC server or main message handler thread is running. */
@@ -196,8 +226,9 @@ public:
     void UnregisterSharedValidationInterface(std::shared_ptr<CValidationInterface> callbacks);
 
     /**
-     * Pushes a function to callback onto the notification queue, guaranteeing any
+     * Pushes a function to callback onto the notification queues, guaranteeing any
      * callbacks generated prior to now are finished when the function is called.
+     * The function is called once, on the thread of the queue that drains last.
      *
      * Be very careful blocking on func to be called if any locks are held -
      * validation interface clients may not be able to make progress as they often
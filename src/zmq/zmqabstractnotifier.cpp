@@ -23,6 +23,14 @@ bool CZMQAbstractNotifier::NotifyTransaction(const CTransaction &/*transaction*/
     return true;
 }
 
+bool CZMQAbstractNotifier::NotifyTransactions(const std::vector<CTransactionRef>& transactions)
+{
+    for (const CTransactionRef& tx : transactions) {
+        if (!NotifyTransaction(*tx)) return false;
+    }
+    return true;
+}
+
 bool CZMQAbstractNotifier::NotifyBlockConnect(const CBlockIndex * /*CBlockIndex*/)
 {
     return true;
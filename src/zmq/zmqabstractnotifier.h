@@ -5,13 +5,16 @@
 #ifndef BITCOIN_ZMQ_ZMQABSTRACTNOTIFIER_H
 #define BITCOIN_ZMQ_ZMQABSTRACTNOTIFIER_H
 
+#include <primitives/transaction.h>
+
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 class CBlockIndex;
-class CTransaction;
 class CZMQAbstractNotifier;
 
 using CZMQNotifierFactory = std::function<std::unique_ptr<CZMQAbstractNotifier>()>;
@@ -20,6 +23,7 @@ class CZMQAbstractNotifier
 {
 public:
     static const int DEFAULT_ZMQ_SNDHWM {1000};
+    static const bool DEFAULT_ZMQ_NODROP {false};
 
     CZMQAbstractNotifier() : outbound_message_high_water_mark(DEFAULT_ZMQ_SNDHWM) {}
     virtual ~CZMQAbstractNotifier();
@@ -35,11 +39,14 @@ public:
     std::string GetAddress() const { return address; }
     void SetAddress(const std::string &a) { address = a; }
     int GetOutboundMessageHighWaterMark() const { return outbound_message_high_water_mark; }
+    uint64_t GetDroppedMessages() const { return m_dropped_messages; }
     void SetOutboundMessageHighWaterMark(const int sndhwm) {
         if (sndhwm >= 0) {
             outbound_message_high_water_mark = sndhwm;
         }
     }
+    bool GetNoDrop() const { return m_no_drop; }
+    void SetNoDrop(bool no_drop) { m_no_drop = no_drop; }
 
     virtual bool Initialize(void *pcontext) = 0;
     virtual void Shutdown() = 0;
@@ -56,12 +63,17 @@ public:
     virtual bool NotifyTransactionRemoval(const CTransaction &transaction, uint64_t mempool_sequence);
     // Notifies of transactions added to mempool or appearing in blocks
     virtual bool NotifyTransaction(const CTransaction &transaction);
+    // Notifies of the transactions of a connected or disconnected block, by
+    // default one NotifyTransaction call each
+    virtual bool NotifyTransactions(const std::vector<CTransactionRef>& transactions);
 
 protected:
     void* psocket{nullptr};
     std::string type;
     std::string address;
     int outbound_message_high_water_mark; // aka SNDHWM
+    bool m_no_drop{false}; //!< set ZMQ_XPUB_NODROP, so that messages reaching the high water mark are counted
+    std::atomic<uint64_t> m_dropped_messages{0}; //!< messages not sent because a subscriber reached the high water mark, with m_no_drop
 };
 
 #endif // BITCOIN_ZMQ_ZMQABSTRACTNOTIFIER_H
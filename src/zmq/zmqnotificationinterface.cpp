@@ -49,6 +49,7 @@ std::unique_ptr<CZMQNotificationInterface> CZMQNotificationInterface::Create(std
         return std::make_unique<CZMQPublishRawBlockNotifier>(get_block_by_index);
     };
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
+    factories["pubrawtxbatch"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionBatchNotifier>;
     factories["pubsequence"] = CZMQAbstractNotifier::Create<CZMQPublishSequenceNotifier>;
 
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
@@ -66,6 +67,7 @@ std::unique_ptr<CZMQNotificationInterface> CZMQNotificationInterface::Create(std
             notifier->SetType(entry.first);
             notifier->SetAddress(address);
             notifier->SetOutboundMessageHighWaterMark(static_cast<int>(gArgs.GetIntArg(arg + "hwm", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM)));
+            notifier->SetNoDrop(gArgs.GetBoolArg(arg + "nodrop", CZMQAbstractNotifier::DEFAULT_ZMQ_NODROP));
             notifiers.push_back(std::move(notifier));
         }
     }
@@ -181,12 +183,9 @@ void CZMQNotificationInterface::BlockConnected(ChainstateRole role, const std::s
     if (role == ChainstateRole::BACKGROUND) {
         return;
     }
-    for (const CTransactionRef& ptx : pblock->vtx) {
-        const CTransaction& tx = *ptx;
-        TryForEachAndRemoveFailed(notifiers, [&tx](CZMQAbstractNotifier* notifier) {
-            return notifier->NotifyTransaction(tx);
-        });
-    }
+    TryForEachAndRemoveFailed(notifiers, [&pblock](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyTransactions(pblock->vtx);
+    });
 
     // Next we notify BlockConnect listeners for *all* blocks
     TryForEachAndRemoveFailed(notifiers, [pindexConnected](CZMQAbstractNotifier* notifier) {
@@ -196,12 +195,9 @@ void CZMQNotificationInterface::BlockConnected(ChainstateRole role, const std::s
 
 void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexDisconnected)
 {
-    for (const CTransactionRef& ptx : pblock->vtx) {
-        const CTransaction& tx = *ptx;
-        TryForEachAndRemoveFailed(notifiers, [&tx](CZMQAbstractNotifier* notifier) {
-            return notifier->NotifyTransaction(tx);
-        });
-    }
+    TryForEachAndRemoveFailed(notifiers, [&pblock](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyTransactions(pblock->vtx);
+    });
 
     // Next we notify BlockDisconnect listeners for *all* blocks
     TryForEachAndRemoveFailed(notifiers, [pindexDisconnected](CZMQAbstractNotifier* notifier) {
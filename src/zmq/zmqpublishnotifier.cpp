@@ -24,11 +24,12 @@
 #include <zmq.h>
 
 #include <cassert>
-#include <cstdarg>
+#include <cerrno>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -44,48 +45,68 @@ static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_RAWTXBATCH = "rawtxbatch";
 static const char *MSG_SEQUENCE  = "sequence";
 
-// Internal function to send multipart message
-static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
+static void zmq_free_vector(void* /*data*/, void* hint)
 {
-    va_list args;
-    va_start(args, size);
-
-    while (1)
-    {
-        zmq_msg_t msg;
+    delete static_cast<std::vector<uint8_t>*>(hint);
+}
 
-        int rc = zmq_msg_init_size(&msg, size);
-        if (rc != 0)
-        {
-            zmqError("Unable to initialize ZMQ msg");
-            va_end(args);
-            return -1;
-        }
+// Internal function to hand a buffer over to a ZMQ msg, which frees it once sent
+static bool zmq_msg_init_vector(zmq_msg_t& msg, std::vector<uint8_t>&& buffer)
+{
+    auto owned{std::make_unique<std::vector<uint8_t>>(std::move(buffer))};
+    if (zmq_msg_init_data(&msg, owned->data(), owned->size(), zmq_free_vector, owned.get()) != 0) {
+        zmqError("Unable to initialize ZMQ msg");
+        return false;
+    }
+    owned.release();
+    return true;
+}
 
-        void *buf = zmq_msg_data(&msg);
-        memcpy(buf, data, size);
+static bool zmq_msg_init_copy(zmq_msg_t& msg, const void* data, size_t size)
+{
+    if (zmq_msg_init_size(&msg, size) != 0) {
+        zmqError("Unable to initialize ZMQ msg");
+        return false;
+    }
+    memcpy(zmq_msg_data(&msg), data, size);
+    return true;
+}
 
-        data = va_arg(args, const void*);
+// Internal function to send multipart message. The caller initializes all parts
+// but the first and the last, which are set to the command and the LE 4-byte
+// sequence number. All parts are closed. Returns -1 on error, 1 if the message
+// was dropped because a subscriber reached the high water mark, 0 otherwise.
+static int zmq_send_multipart(void *sock, const char* command, std::vector<zmq_msg_t>& parts, uint32_t sequence)
+{
+    assert(parts.size() >= 2);
+    unsigned char msgseq[sizeof(uint32_t)];
+    WriteLE32(msgseq, sequence);
+    // The command is a constant string, which ZMQ can send without copying.
+    if (zmq_msg_init_data(&parts.front(), const_cast<char*>(command), strlen(command), nullptr, nullptr) != 0) {
+        zmqError("Unable to initialize ZMQ msg");
+        for (size_t i = 1; i + 1 < parts.size(); ++i) zmq_msg_close(&parts[i]);
+        return -1;
+    }
+    if (!zmq_msg_init_copy(parts.back(), msgseq, sizeof(msgseq))) {
+        for (size_t i = 0; i + 1 < parts.size(); ++i) zmq_msg_close(&parts[i]);
+        return -1;
+    }
 
-        rc = zmq_msg_send(&msg, sock, data ? ZMQ_SNDMORE : 0);
-        if (rc == -1)
-        {
-            zmqError("Unable to send ZMQ msg");
-            zmq_msg_close(&msg);
-            va_end(args);
-            return -1;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        const int flags{ZMQ_DONTWAIT | (i + 1 < parts.size() ? ZMQ_SNDMORE : 0)};
+        if (zmq_msg_send(&parts[i], sock, flags) == -1) {
+            // With ZMQ_XPUB_NODROP a full subscriber queue fails the first part
+            // instead of dropping the message silently.
+            const bool dropped{i == 0 && zmq_errno() == EAGAIN};
+            if (!dropped) zmqError("Unable to send ZMQ msg");
+            for (size_t j = i; j < parts.size(); ++j) zmq_msg_close(&parts[j]);
+            return dropped ? 1 : -1;
         }
-
-        zmq_msg_close(&msg);
-
-        if (!data)
-            break;
-
-        size = va_arg(args, size_t);
+        zmq_msg_close(&parts[i]);
     }
-    va_end(args);
     return 0;
 }
 
@@ -128,6 +149,23 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
             return false;
         }
 
+        if (m_no_drop) {
+#ifdef ZMQ_XPUB_NODROP
+            // Fail the send of messages that reach the high water mark of any
+            // subscriber instead of dropping them silently for that subscriber,
+            // so that they can be counted (libzmq 4.1 and later).
+            const int no_drop_option {1};
+            rc = zmq_setsockopt(psocket, ZMQ_XPUB_NODROP, &no_drop_option, sizeof(no_drop_option));
+            if (rc != 0) {
+                zmqError("Failed to set ZMQ_XPUB_NODROP");
+                zmq_close(psocket);
+                return false;
+            }
+#else
+            LogPrintf("zmq: ZMQ_XPUB_NODROP is not supported by this libzmq, ignoring -zmq%snodrop\n", type);
+#endif
+        }
+
         const int so_keepalive_option {1};
         rc = zmq_setsockopt(psocket, ZMQ_TCP_KEEPALIVE, &so_keepalive_option, sizeof(so_keepalive_option));
         if (rc != 0) {
@@ -205,13 +243,40 @@ bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command, const void
     assert(psocket);
 
     /* send three parts, command & data & a LE 4byte sequence number */
-    unsigned char msgseq[sizeof(uint32_t)];
-    WriteLE32(msgseq, nSequence);
-    int rc = zmq_send_multipart(psocket, command, strlen(command), data, size, msgseq, (size_t)sizeof(uint32_t), nullptr);
+    std::vector<zmq_msg_t> parts(3);
+    if (!zmq_msg_init_copy(parts[1], data, size)) return false;
+    return SendZmqParts(command, zmq_send_multipart(psocket, command, parts, nSequence));
+}
+
+bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command, std::vector<std::vector<uint8_t>>&& buffers)
+{
+    assert(psocket);
+
+    /* send the command, a part per buffer and a LE 4byte sequence number */
+    std::vector<zmq_msg_t> parts(buffers.size() + 2);
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        if (!zmq_msg_init_vector(parts[i + 1], std::move(buffers[i]))) {
+            // Only the parts of the buffers before this one are initialized.
+            // The command part is not set until zmq_send_multipart.
+            for (size_t j = 0; j < i; ++j) zmq_msg_close(&parts[j + 1]);
+            return false;
+        }
+    }
+    return SendZmqParts(command, zmq_send_multipart(psocket, command, parts, nSequence));
+}
+
+bool CZMQAbstractPublishNotifier::SendZmqParts(const char* command, int rc)
+{
     if (rc == -1)
         return false;
 
-    /* increment memory only sequence number after sending */
+    if (rc == 1) {
+        ++m_dropped_messages;
+        LogDebug(BCLog::ZMQ, "Dropped %s message to %s, outbound message high water mark reached\n", command, this->address);
+    }
+
+    /* increment memory only sequence number after sending, or dropping, so that
+       subscribers can detect dropped messages */
     nSequence++;
 
     return true;
@@ -243,22 +308,51 @@ bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
 {
     LogDebug(BCLog::ZMQ, "Publish rawblock %s to %s\n", pindex->GetBlockHash().GetHex(), this->address);
 
-    std::vector<uint8_t> block{};
-    if (!m_get_block_by_index(block, *pindex)) {
+    std::vector<std::vector<uint8_t>> block(1);
+    if (!m_get_block_by_index(block[0], *pindex)) {
         zmqError("Can't read block from disk");
         return false;
     }
 
-    return SendZmqMessage(MSG_RAWBLOCK, block.data(), block.size());
+    // Send the block as read from disk, without copying it again.
+    return SendZmqMessage(MSG_RAWBLOCK, std::move(block));
+}
+
+static std::vector<uint8_t> SerializeTransaction(const CTransaction& transaction)
+{
+    std::vector<uint8_t> data;
+    data.reserve(transaction.GetTotalSize());
+    VectorWriter{data, 0} << TX_WITH_WITNESS(transaction);
+    return data;
 }
 
 bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
 {
     uint256 hash = transaction.GetHash();
     LogDebug(BCLog::ZMQ, "Publish rawtx %s to %s\n", hash.GetHex(), this->address);
-    DataStream ss;
-    ss << TX_WITH_WITNESS(transaction);
-    return SendZmqMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
+    std::vector<std::vector<uint8_t>> data;
+    data.push_back(SerializeTransaction(transaction));
+    return SendZmqMessage(MSG_RAWTX, std::move(data));
+}
+
+bool CZMQPublishRawTransactionBatchNotifier::NotifyTransaction(const CTransaction &transaction)
+{
+    uint256 hash = transaction.GetHash();
+    LogDebug(BCLog::ZMQ, "Publish rawtxbatch %s to %s\n", hash.GetHex(), this->address);
+    std::vector<std::vector<uint8_t>> data;
+    data.push_back(SerializeTransaction(transaction));
+    return SendZmqMessage(MSG_RAWTXBATCH, std::move(data));
+}
+
+bool CZMQPublishRawTransactionBatchNotifier::NotifyTransactions(const std::vector<CTransactionRef>& transactions)
+{
+    LogDebug(BCLog::ZMQ, "Publish rawtxbatch of %d transactions to %s\n", transactions.size(), this->address);
+    std::vector<std::vector<uint8_t>> data;
+    data.reserve(transactions.size());
+    for (const CTransactionRef& tx : transactions) {
+        data.push_back(SerializeTransaction(*tx));
+    }
+    return SendZmqMessage(MSG_RAWTXBATCH, std::move(data));
 }
 
 // Helper function to send a 'sequence' topic message with the following structure:
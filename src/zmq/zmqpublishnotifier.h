@@ -20,6 +20,9 @@ class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
 private:
     uint32_t nSequence {0U}; //!< upcounting per message sequence number
 
+    //! Account for the result of zmq_send_multipart
+    bool SendZmqParts(const char* command, int rc);
+
 public:
 
     /* send zmq multipart message
@@ -30,6 +33,14 @@ public:
     */
     bool SendZmqMessage(const char *command, const void* data, size_t size);
 
+    /* send zmq multipart message without copying the body
+       parts:
+          * command
+          * one part per buffer, handed over to ZMQ and freed once sent
+          * message sequence number
+    */
+    bool SendZmqMessage(const char *command, std::vector<std::vector<uint8_t>>&& buffers);
+
     bool Initialize(void *pcontext) override;
     void Shutdown() override;
 };
@@ -63,6 +74,15 @@ public:
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
+/* Publishes the transactions of a connected or disconnected block as one
+   message with a part per transaction, and mempool transactions one by one */
+class CZMQPublishRawTransactionBatchNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyTransaction(const CTransaction &transaction) override;
+    bool NotifyTransactions(const std::vector<CTransactionRef>& transactions) override;
+};
+
 class CZMQPublishSequenceNotifier : public CZMQAbstractPublishNotifier
 {
 public:
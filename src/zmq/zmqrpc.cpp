@@ -32,6 +32,8 @@ static RPCHelpMan getzmqnotifications()
                             {RPCResult::Type::STR, "type", "Type of notification"},
                             {RPCResult::Type::STR, "address", "Address of the publisher"},
                             {RPCResult::Type::NUM, "hwm", "Outbound message high water mark"},
+                            {RPCResult::Type::BOOL, "nodrop", "Whether messages reaching the outbound message high water mark are counted as dropped (see -zmqpub<type>nodrop)"},
+                            {RPCResult::Type::NUM, "dropped", "Number of messages not sent because a subscriber reached the outbound message high water mark, 0 unless nodrop is set"},
                         }},
                     }
                 },
@@ -48,6 +50,8 @@ static RPCHelpMan getzmqnotifications()
             obj.pushKV("type", n->GetType());
             obj.pushKV("address", n->GetAddress());
             obj.pushKV("hwm", n->GetOutboundMessageHighWaterMark());
+            obj.pushKV("nodrop", n->GetNoDrop());
+            obj.pushKV("dropped", n->GetDroppedMessages());
             result.push_back(std::move(obj));
         }
     }
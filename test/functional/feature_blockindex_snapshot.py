@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+# Copyright (c) The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test loading the block index from a snapshot written at shutdown (`-blockindexsnapshot` option)."""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+
+
+class BlockIndexSnapshotTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.extra_args = [['-blockindexsnapshot=1']]
+
+    def chain_state(self):
+        node = self.nodes[0]
+        info = node.getblockchaininfo()
+        return info['blocks'], info['headers'], info['bestblockhash'], info['chainwork'], node.getchaintips()
+
+    def run_test(self):
+        node = self.nodes[0]
+        snapshot_path = node.blocks_path / "blockindex.dat"
+        # Leave a stale fork in the block index as well.
+        fork_tip = node.getbestblockhash()
+        self.generate(node, 3)
+        node.invalidateblock(node.getblockhash(node.getblockcount() - 2))
+        self.generate(node, 5)
+        node.reconsiderblock(fork_tip)
+        expected = self.chain_state()
+
+        self.log.info("A clean shutdown writes a snapshot, which the next startup loads")
+        with node.assert_debug_log(["Wrote block index snapshot of"]):
+            self.stop_node(0)
+        assert snapshot_path.exists()
+        with node.assert_debug_log(["block index entries from snapshot"]):
+            self.start_node(0)
+        assert_equal(self.chain_state(), expected)
+        assert node.verifychain(4, 0)
+
+        self.log.info("A snapshot is used once, so it is ignored after an unclean shutdown")
+        self.generate(node, 2)
+        expected = self.chain_state()
+        # Flush the new blocks, so that they survive the unclean shutdown.
+        node.gettxoutsetinfo()
+        node.kill_process()
+        with node.assert_debug_log(expected_msgs=[], unexpected_msgs=["block index entries from snapshot"]):
+            self.start_node(0)
+        assert_equal(self.chain_state(), expected)
+
+        self.log.info("A corrupt snapshot falls back to the block index database")
+        self.stop_node(0)
+        data = bytearray(snapshot_path.read_bytes())
+        data[100] ^= 0xff
+        snapshot_path.write_bytes(data)
+        with node.assert_debug_log(["is unusable (checksum mismatch)"]):
+            self.start_node(0)
+        assert_equal(self.chain_state(), expected)
+
+        self.log.info("Disabling the option removes the snapshot")
+        self.restart_node(0, extra_args=['-blockindexsnapshot=0'])
+        assert not snapshot_path.exists()
+        assert_equal(self.chain_state(), expected)
+
+
+if __name__ == '__main__':
+    BlockIndexSnapshotTest(__file__).main()
@@ -8,7 +8,12 @@ import json
 import os
 from dataclasses import dataclass
 from test_framework.test_framework import BitcoinTestFramework
-from test_framework.util import assert_equal, assert_greater_than_or_equal
+from test_framework.util import (
+    assert_equal,
+    assert_greater_than_or_equal,
+    assert_raises_rpc_error,
+    get_rpc_proxy,
+)
 from threading import Thread
 from typing import Optional
 import subprocess
@@ -18,6 +23,7 @@ RPC_INVALID_PARAMETER      = -8
 RPC_METHOD_NOT_FOUND       = -32601
 RPC_INVALID_REQUEST        = -32600
 RPC_PARSE_ERROR            = -32700
+RPC_METHOD_BUSY            = -37
 
 
 @dataclass
@@ -88,6 +94,15 @@ def test_work_queue_getblock(node, got_exceeded_error):
             got_exceeded_error.append(True)
 
 
+def wait_for_height(node, height, timeout=30000):
+    """Call waitforblockheight on a connection of its own, to block a worker thread."""
+    get_rpc_proxy(node.url, 0, timeout=60, coveragedir=node.coverage_dir).waitforblockheight(height, timeout)
+
+
+def active_commands(rpc):
+    return [command['method'] for command in rpc.getrpcinfo()['active_commands']]
+
+
 class RPCInterfaceTest(BitcoinTestFramework):
     def set_test_params(self):
         self.num_nodes = 1
@@ -238,11 +253,54 @@ class RPCInterfaceTest(BitcoinTestFramework):
         for t in threads:
             t.join()
 
+    def test_method_limit(self):
+        self.log.info("Testing -rpcmethodlimit...")
+        node = self.nodes[0]
+        self.stop_node(0)
+        node.assert_start_raises_init_error(['-rpcmethodlimit=waitfornewblock'], "Error: Invalid -rpcmethodlimit=waitfornewblock, expected <method>:<n> with n > 0")
+        node.assert_start_raises_init_error(['-rpcmethodlimit=waitfornewblock:0'], "Error: Invalid -rpcmethodlimit=waitfornewblock:0, expected <method>:<n> with n > 0")
+        node.assert_start_raises_init_error(['-rpcmethodlimit=nosuchmethod:1'], "Error: Invalid -rpcmethodlimit=nosuchmethod:1, unknown RPC method nosuchmethod")
+        self.start_node(0, ['-rpcmethodlimit=waitforblockheight:1'])
+
+        waiting = Thread(target=wait_for_height, args=(node, node.getblockcount() + 1))
+        waiting.start()
+        self.wait_until(lambda: 'waitforblockheight' in active_commands(node))
+        assert_raises_rpc_error(RPC_METHOD_BUSY, "Too many concurrent waitforblockheight calls (limit 1)", node.waitforblockheight, 0)
+        expect_http_rpc_status(503, RPC_METHOD_BUSY, node, "waitforblockheight", [0])
+        # Other methods are unaffected
+        node.getblockcount()
+        self.generate(node, 1, sync_fun=self.no_op)
+        waiting.join()
+        node.waitforblockheight(0)
+
+    def test_method_priority(self):
+        self.log.info("Testing that wallet and control calls don't wait for other calls...")
+        self.restart_node(0, ['-rpcthreads=2'])
+        node = self.nodes[0]
+        # Calls run at the priority of their method. Calls of methods other
+        # than wallet and control methods never occupy every worker thread, so
+        # those are served while the only other worker is busy and more calls
+        # are queued.
+        height = node.getblockcount() + 1
+        waiting = [Thread(target=wait_for_height, args=(node, height, 5000)) for _ in range(2)]
+        for thread in waiting:
+            thread.start()
+        self.wait_until(lambda: 'waitforblockheight' in active_commands(node))
+        assert_equal(active_commands(node).count('waitforblockheight'), 1)
+        if self.is_wallet_compiled():
+            node.createwallet("priority")
+            assert_equal(node.getwalletinfo()['walletname'], "priority")
+        assert waiting[1].is_alive()
+        for thread in waiting:
+            thread.join()
+
     def run_test(self):
         self.test_getrpcinfo()
         self.test_batch_requests()
         self.test_http_status_codes()
         self.test_work_queue_exceeded()
+        self.test_method_limit()
+        self.test_method_priority()
 
 
 if __name__ == '__main__':
@@ -54,7 +54,7 @@ class ZMQSubscriber:
 
     # Receive message from publisher and verify that topic and sequence match
     def _receive_from_publisher_and_check(self):
-        topic, body, seq = self.socket.recv_multipart()
+        topic, *bodies, seq = self.socket.recv_multipart()
         # Topic should match the subscriber topic.
         assert_equal(topic, self.topic)
         # Sequence should be incremental.
@@ -64,13 +64,18 @@ class ZMQSubscriber:
         else:
             assert_equal(received_seq, self.sequence)
         self.sequence += 1
-        return body
+        return bodies
 
     def receive(self):
+        body, = self._receive_from_publisher_and_check()
+        return body
+
+    # Receive a message with any number of body parts (rawtxbatch)
+    def receive_batch(self):
         return self._receive_from_publisher_and_check()
 
     def receive_sequence(self):
-        body = self._receive_from_publisher_and_check()
+        body, = self._receive_from_publisher_and_check()
         hash = body[:32].hex()
         label = chr(body[32])
         mempool_sequence = None if len(body) != 32+1+8 else struct.unpack("<Q", body[32+1:])[0]
@@ -125,6 +130,7 @@ class ZMQTest (BitcoinTestFramework):
                 self.test_basic(unix=True)
             else:
                 self.log.info("Skipping ipc test, because UNIX sockets are not supported.")
+            self.test_rawtxbatch()
             self.test_sequence()
             self.test_mempool_sync()
             self.test_reorg()
@@ -253,16 +259,35 @@ class ZMQTest (BitcoinTestFramework):
 
         self.log.info("Test the getzmqnotifications RPC")
         assert_equal(self.nodes[0].getzmqnotifications(), [
-            {"type": "pubhashblock", "address": address, "hwm": 1000},
-            {"type": "pubhashtx", "address": address, "hwm": 1000},
-            {"type": "pubrawblock", "address": address, "hwm": 1000},
-            {"type": "pubrawtx", "address": address, "hwm": 1000},
+            {"type": "pubhashblock", "address": address, "hwm": 1000, "nodrop": False, "dropped": 0},
+            {"type": "pubhashtx", "address": address, "hwm": 1000, "nodrop": False, "dropped": 0},
+            {"type": "pubrawblock", "address": address, "hwm": 1000, "nodrop": False, "dropped": 0},
+            {"type": "pubrawtx", "address": address, "hwm": 1000, "nodrop": False, "dropped": 0},
         ])
 
         assert_equal(self.nodes[1].getzmqnotifications(), [])
         if unix:
             os.unlink(socket_path)
 
+    def test_rawtxbatch(self):
+        self.log.info("Testing rawtxbatch")
+        address = f"tcp://127.0.0.1:{self.zmq_port_base}"
+        rawtx, rawtxbatch = self.setup_zmq_test([(topic, address) for topic in ["rawtx", "rawtxbatch"]])
+
+        self.log.info("Mempool transactions are published one per message")
+        txs = [self.wallet.send_self_transfer(from_node=self.nodes[0]) for _ in range(3)]
+        for tx in txs:
+            raw = rawtx.receive()
+            assert_equal(rawtxbatch.receive_batch(), [raw])
+            assert_equal(tx['wtxid'], hash256_reversed(raw).hex())
+
+        self.log.info("Block transactions are published as one message, in block order")
+        block_hash = self.generatetoaddress(self.nodes[0], 1, ADDRESS_BCRT1_UNSPENDABLE)[0]
+        block_txs = [bytes.fromhex(tx['hex']) for tx in self.nodes[0].getblock(block_hash, 2)['tx']]
+        assert_equal(len(block_txs), len(txs) + 1)
+        assert_equal(rawtxbatch.receive_batch(), block_txs)
+        assert_equal([rawtx.receive() for _ in block_txs], block_txs)
+
     def test_reorg(self):
 
         address = f"tcp://127.0.0.1:{self.zmq_port_base}"
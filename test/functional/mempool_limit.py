@@ -15,6 +15,7 @@ from test_framework.util import (
     assert_equal,
     assert_fee_amount,
     assert_greater_than,
+    assert_greater_than_or_equal,
     assert_raises_rpc_error,
 )
 from test_framework.wallet import (
@@ -425,9 +426,15 @@ class MempoolLimitTest(BitcoinTestFramework):
         assert_greater_than(worst_feerate_btcvb, package_fee / package_vsize)
         assert_greater_than(mempoolmin_feerate, tx_parent_just_below["fee"] / (tx_parent_just_below["tx"].get_vsize()))
         assert_greater_than(package_fee / package_vsize, mempoolmin_feerate / 1000)
+        eviction_before = node.getmempoolinfo()["eviction"]
         res = node.submitpackage([tx_parent_just_below["hex"], tx_child_just_above["hex"]])
         for wtxid in [tx_parent_just_below["wtxid"], tx_child_just_above["wtxid"]]:
             assert_equal(res["tx-results"][wtxid]["error"], "mempool full")
+        # The evicted package is reported by getmempoolinfo
+        eviction = node.getmempoolinfo()["eviction"]
+        assert_greater_than_or_equal(eviction["txs"] - eviction_before["txs"], 2)
+        assert_greater_than_or_equal(eviction["bytes"] - eviction_before["bytes"], package_vsize)
+        assert_greater_than(eviction["usage"], eviction_before["usage"])
 
         self.log.info('Test passing a value below the minimum (5 MB) to -maxmempool throws an error')
         self.stop_node(0)
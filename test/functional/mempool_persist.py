@@ -43,6 +43,7 @@ from test_framework.p2p import P2PTxInvStore
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import (
     assert_equal,
+    assert_greater_than,
     assert_greater_than_or_equal,
     assert_raises_rpc_error,
 )
@@ -194,6 +195,7 @@ class MempoolPersistTest(BitcoinTestFramework):
         os.rmdir(mempooldotnew1)
 
         self.test_importmempool_union()
+        self.test_incremental_dump()
         self.test_persist_unbroadcast()
 
     def test_persist_unbroadcast(self):
@@ -218,6 +220,24 @@ class MempoolPersistTest(BitcoinTestFramework):
         node0.mockscheduler(16 * 60)  # 15 min + 1 for buffer
         self.wait_until(lambda: len(conn.get_invs()) == 1)
 
+    def test_incremental_dump(self):
+        self.log.debug("Check that a node loading its mempool.dat only appends to it on shutdown")
+        node0 = self.nodes[0]
+        self.start_node(0)
+        mempooldat0 = node0.chain_path / "mempool.dat"
+        old_dump = mempooldat0.read_bytes()
+        old_txids = node0.getrawmempool()
+        new_txid = self.mini_wallet.send_self_transfer(from_node=node0)["txid"]
+        self.stop_node(0)
+        new_dump = mempooldat0.read_bytes()
+        assert_greater_than(len(new_dump), len(old_dump))
+        assert_equal(new_dump[:len(old_dump)], old_dump)
+
+        self.log.debug("Check that the appended transactions are loaded")
+        self.start_node(0)
+        assert_equal(sorted(old_txids + [new_txid]), sorted(node0.getrawmempool()))
+        self.stop_node(0)
+
     def test_importmempool_union(self):
         self.log.debug("Submit different transactions to node0 and node1's mempools")
         self.start_node(0)
@@ -59,6 +59,7 @@ from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import (
     assert_not_equal,
     assert_equal,
+    assert_greater_than,
     softfork_active,
 )
 from test_framework.wallet import MiniWallet
@@ -449,6 +450,12 @@ class CompactBlocksTest(BitcoinTestFramework):
             peer.send_and_ping(msg)
             assert_equal(int(node.getbestblockhash(), 16), tip)
 
+        def cmpctblock_stats(node):
+            stats = [peer["cmpctblock"] for peer in node.getpeerinfo()]
+            return {key: sum(s[key] for s in stats) for key in ("reconstructed", "roundtrips", "bytes")}
+
+        stats_before = cmpctblock_stats(node)
+
         # First try announcing compactblocks that won't reconstruct, and verify
         # that we receive getblocktxn messages back.
         utxo = self.utxos.pop(0)
@@ -514,6 +521,12 @@ class CompactBlocksTest(BitcoinTestFramework):
             # Shouldn't have gotten a request for any transaction
             assert "getblocktxn" not in test_node.last_message
 
+        self.log.info("Check compact block reconstruction statistics in getpeerinfo")
+        stats_after = cmpctblock_stats(node)
+        assert_equal(stats_after["reconstructed"] - stats_before["reconstructed"], 4)
+        assert_equal(stats_after["roundtrips"] - stats_before["roundtrips"], 3)
+        assert_greater_than(stats_after["bytes"], stats_before["bytes"])
+
     # Incorrectly responding to a getblocktxn shouldn't cause the block to be
     # permanently failed.
     def test_incorrect_blocktxn_response(self, test_node):
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+# Copyright (c) The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test transaction relay through set reconciliation (BIP 330).
+
+Relay the same number of transactions over a fully connected network of nodes, first flooding
+them and then with -txreconciliation, check that all of them propagate either way and log the
+announcement bandwidth spent per transaction.
+"""
+
+from itertools import combinations
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+from test_framework.wallet import MiniWallet
+
+NUM_TXS = 60
+# Messages spent on announcing transactions, rather than on transferring them.
+ANNOUNCEMENT_MSGS = ["inv", "getdata", "reqrecon", "sketch", "reconcildiff"]
+RECONCILIATION_MSGS = ["reqrecon", "sketch", "reconcildiff"]
+
+
+class TxReconciliationRelayTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 4
+        self.noban_tx_relay = True
+
+    def setup_network(self):
+        self.setup_nodes()
+        self.connect_all()
+
+    def connect_all(self):
+        for a, b in combinations(range(self.num_nodes), 2):
+            self.connect_nodes(a, b)
+
+    def bytes_sent(self, msgs):
+        return sum(peer["bytessent_per_msg"].get(msg, 0) for node in self.nodes for peer in node.getpeerinfo() for msg in msgs)
+
+    def relay_txs(self, reconcile):
+        self.log.info(f"Relay {NUM_TXS} transactions {'with' if reconcile else 'without'} reconciliation")
+        self.restart_all(["-txreconciliation"] if reconcile else [])
+        before = self.bytes_sent(ANNOUNCEMENT_MSGS)
+
+        txids = []
+        for i in range(NUM_TXS):
+            tx = self.wallet.send_self_transfer(from_node=self.nodes[i % self.num_nodes])
+            txids.append(tx["txid"])
+        # Reconciliation rounds start every few seconds, give them time to finish.
+        self.sync_mempools(timeout=120)
+        for node in self.nodes:
+            assert_equal(set(txids), set(node.getrawmempool()))
+
+        reconciliation_bytes = self.bytes_sent(RECONCILIATION_MSGS)
+        if reconcile:
+            assert reconciliation_bytes > 0
+        else:
+            assert_equal(reconciliation_bytes, 0)
+        bytes_per_tx = (self.bytes_sent(ANNOUNCEMENT_MSGS) - before) / NUM_TXS
+        self.log.info(f"Announcement bytes per relayed transaction: {bytes_per_tx:.1f}")
+        self.generate(self.nodes[0], 1)
+        return bytes_per_tx
+
+    def restart_all(self, extra_args):
+        for i in range(self.num_nodes):
+            self.restart_node(i, extra_args=extra_args)
+        self.connect_all()
+
+    def run_test(self):
+        self.wallet = MiniWallet(self.nodes[0])
+        self.generate(self.wallet, 2 * NUM_TXS)
+        self.generate(self.nodes[0], 100)
+
+        flood = self.relay_txs(reconcile=False)
+        erlay = self.relay_txs(reconcile=True)
+        self.log.info(f"Reconciliation changed announcement bandwidth by {100 * (erlay - flood) / flood:+.1f}%")
+
+
+if __name__ == '__main__':
+    TxReconciliationRelayTest(__file__).main()
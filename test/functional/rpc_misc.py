@@ -14,6 +14,7 @@ from test_framework.util import (
 )
 
 from test_framework.authproxy import JSONRPCException
+from test_framework.test_node import ErrorMatch
 
 
 class RpcMiscTest(BitcoinTestFramework):
@@ -80,22 +81,46 @@ class RpcMiscTest(BitcoinTestFramework):
         assert_equal(node.getindexinfo(), {})
 
         # Restart the node with indices and wait for them to sync
-        self.restart_node(0, ["-txindex", "-blockfilterindex", "-coinstatsindex"])
+        self.restart_node(0, ["-txindex", "-blockfilterindex", "-coinstatsindex", "-dboption=blocksize=8192", "-dboption=txindex:bloombits=0", "-dboption=compression=1"])
         self.wait_until(lambda: all(i["synced"] for i in node.getindexinfo().values()))
 
-        # Returns a list of all running indices by default
-        values = {"synced": True, "best_block_height": 200}
+        # Returns a list of all running indices by default. Compression was
+        # requested, but leveldb is built without Snappy.
+        db_options = {"block_size": 8192, "bloom_bits": 10, "write_buffer": 0, "compression": False, "max_file_size": 32 << 20}
+        values = {"synced": True, "best_block_height": 200, "db_options": db_options}
+        txindex_values = {**values, "db_options": {**db_options, "bloom_bits": 0}}
         assert_equal(
             node.getindexinfo(),
             {
-                "txindex": values,
+                "txindex": txindex_values,
                 "basic block filter index": values,
                 "coinstatsindex": values,
             }
         )
         # Specifying an index by name returns only the status of that index
-        for i in {"txindex", "basic block filter index", "coinstatsindex"}:
+        for i in {"basic block filter index", "coinstatsindex"}:
             assert_equal(node.getindexinfo(i), {i: values})
+        assert_equal(node.getindexinfo("txindex"), {"txindex": txindex_values})
+        assert_equal(node.gettxoutsetinfo("none")["db_options"], db_options)
+
+        self.log.info("test getvalidationqueueinfo")
+        # Every subscriber, including each index, has its own notification queue
+        self.generate(node, 1)
+        node.syncwithvalidationinterfacequeue()
+        queues = {q["name"]: q for q in node.getvalidationqueueinfo()}
+        assert {"peerman", "txindex", "basic block filter index", "coinstatsindex"}.issubset(queues)
+        for q in queues.values():
+            assert_greater_than_or_equal(q["max_pending"], q["pending"])
+            assert_greater_than_or_equal(q["max_wait_ms"], 0)
+        assert_greater_than(queues["txindex"]["delivered"], 0)
+        assert_greater_than(queues["txindex"]["max_pending"], 0)
+
+        self.log.info("test invalid -dboption values")
+        self.stop_node(0)
+        node.assert_start_raises_init_error(["-dboption=mempool:bloombits=0"], "Error: Unknown database 'mempool' in -dboption.", match=ErrorMatch.PARTIAL_REGEX)
+        node.assert_start_raises_init_error(["-dboption=blocksize=1"], "Error: -dboption blocksize must be between 1024 and 4194304", match=ErrorMatch.PARTIAL_REGEX)
+        node.assert_start_raises_init_error(["-dboption=bloombits"], "Error: Invalid -dboption value 'bloombits'.", match=ErrorMatch.PARTIAL_REGEX)
+        self.start_node(0)
 
         # Specifying an unknown index name returns an empty result
         assert_equal(node.getindexinfo("foo"), {})
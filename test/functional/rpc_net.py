@@ -150,6 +150,14 @@ class NetTest(BitcoinTestFramework):
                 "addr_relay_enabled": False,
                 "bip152_hb_from": False,
                 "bip152_hb_to": False,
+                "cmpctblock": {
+                    "bytes": 0,
+                    "bytes_per_block": 0,
+                    "prefilled": 0,
+                    "reconstructed": 0,
+                    "roundtrip_rate": 0,
+                    "roundtrips": 0,
+                },
                 "bytesrecv_per_msg": {},
                 "bytessent_per_msg": {},
                 "connection_type": "inbound",
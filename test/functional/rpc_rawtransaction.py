@@ -83,6 +83,7 @@ class RawTransactionsTest(BitcoinTestFramework):
         self.wallet = MiniWallet(self.nodes[0])
 
         self.getrawtransaction_tests()
+        self.getrawtransactions_tests()
         self.createrawtransaction_tests()
         self.sendrawtransaction_tests()
         self.sendrawtransaction_testmempoolaccept_tests()
@@ -176,6 +177,42 @@ class RawTransactionsTest(BitcoinTestFramework):
         block = self.nodes[0].getblock(self.nodes[0].getblockhash(0))
         assert_raises_rpc_error(-5, "The genesis block coinbase is not considered an ordinary transaction", self.nodes[0].getrawtransaction, block['merkleroot'])
 
+    def getrawtransactions_tests(self):
+        self.log.info("Test getrawtransactions")
+        confirmed = [self.wallet.send_self_transfer(from_node=self.nodes[0]) for _ in range(3)]
+        [block] = self.generate(self.nodes[0], 1)
+        mempool_tx = self.wallet.send_self_transfer(from_node=self.nodes[0])
+        self.sync_mempools()
+        sync_txindex(self, self.nodes[0])
+        unknown_txid = "00" * 32
+        txids = [confirmed[2]['txid'], mempool_tx['txid'], unknown_txid, confirmed[0]['txid'], confirmed[2]['txid']]
+
+        # Each result is the same as getrawtransaction's, or null if the
+        # transaction is not found.
+        assert_equal(self.nodes[0].getrawtransactions(txids), [confirmed[2]['hex'], mempool_tx['hex'], None, confirmed[0]['hex'], confirmed[2]['hex']])
+        for verbosity in [1, 2]:
+            result = self.nodes[0].getrawtransactions(txids, verbosity)
+            assert_equal(result[2], None)
+            for txid, gottx in zip(txids, result):
+                if txid != unknown_txid:
+                    assert_equal(gottx, self.nodes[0].getrawtransaction(txid, verbosity))
+        assert_equal(self.nodes[0].getrawtransactions([]), [])
+
+        # Without -txindex, only mempool transactions are found.
+        assert_equal(self.nodes[1].getrawtransactions(txids), [None, mempool_tx['hex'], None, None, None])
+
+        # With a blockhash, only transactions of that block are found.
+        for n in [0, 1]:
+            result = self.nodes[n].getrawtransactions(txids=txids, verbosity=1, blockhash=block)
+            assert_equal([gottx and gottx['txid'] for gottx in result], [confirmed[2]['txid'], None, None, confirmed[0]['txid'], confirmed[2]['txid']])
+            assert_equal(result[0]['in_active_chain'], True)
+            assert_raises_rpc_error(-5, "Block hash not found", self.nodes[n].getrawtransactions, txids=txids, blockhash=unknown_txid)
+
+        assert_raises_rpc_error(-8, "txid must be of length 64", self.nodes[0].getrawtransactions, ["abcd"])
+        genesis_coinbase = self.nodes[0].getblock(self.nodes[0].getblockhash(0))['merkleroot']
+        assert_raises_rpc_error(-5, "The genesis block coinbase is not considered an ordinary transaction", self.nodes[0].getrawtransactions, [genesis_coinbase])
+        self.generate(self.nodes[0], 1)
+
     def getrawtransaction_verbosity_tests(self):
         tx = self.wallet.send_self_transfer(from_node=self.nodes[1])['txid']
         [block1] = self.generate(self.nodes[1], 1)